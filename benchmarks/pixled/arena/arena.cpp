@@ -0,0 +1,105 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/*
+ * Compares heap and Arena allocation of the `sequence.gif` example
+ * animation graph: count of allocations, time to copy the graph, and frame
+ * evaluation time.
+ *
+ * To reproduce a long running heap, the heap graph is copied while other
+ * allocations are interleaved.
+ */
+
+const std::size_t COPIES = 10000;
+const pixled::index_t SIZE = 64;
+const pixled::time FRAMES = 100;
+
+/*
+ * Output that discards colors.
+ */
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color& c, std::size_t i) override {
+		}
+};
+
+template<typename Duration>
+double ms(Duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double run(pixled::Animation& animation) {
+	pixled::LedPanel panel(SIZE, SIZE, pixled::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	pixled::Runtime runtime(panel, output, animation);
+	auto start = std::chrono::steady_clock::now();
+	for(pixled::time t = 0; t < FRAMES; t++)
+		runtime.next();
+	return ms(std::chrono::steady_clock::now() - start) / FRAMES;
+}
+
+int main(int argc, char** argv) {
+	pixled::Blink anim1(pixled::PURPLE, 4);
+	pixled::hsb anim2(pixled::RadialRainbowWave(32, 40, pixled::point(8, 8)), 1.0, 1.0);
+	pixled::Sequence anim3({
+			{pixled::RED, 10},
+			{pixled::GREEN, 10},
+			{pixled::BLUE, 10}
+			});
+	pixled::Sequence anim({
+			{anim1, 20},
+			{anim2, 20},
+			{anim3, 40},
+			{anim2, 40}
+			});
+
+	// Heap
+	pixled::resetAllocationStats();
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < COPIES; i++)
+		pixled::FctWrapper<pixled::color> copy(anim);
+	double heap_copy = ms(std::chrono::steady_clock::now() - start) / COPIES;
+	std::size_t heap_allocations = pixled::allocationStats().heap_allocations / COPIES;
+
+	std::vector<std::unique_ptr<std::uint8_t[]>> noise;
+	std::vector<pixled::FctWrapper<pixled::color>> heap_copies;
+	for(std::size_t i = 0; i < 100; i++) {
+		heap_copies.emplace_back(anim);
+		for(std::size_t j = 0; j < 100; j++)
+			noise.emplace_back(new std::uint8_t[16 + j % 64]);
+	}
+	pixled::resetAllocationStats();
+	double heap_frame = run(const_cast<pixled::Animation&>(heap_copies.back().get()));
+	std::size_t frame_allocations = pixled::allocationStats().heap_allocations / FRAMES;
+
+	// Arena
+	pixled::Arena arena(64 * 1024);
+	pixled::resetAllocationStats();
+	start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < COPIES; i++) {
+		{
+			pixled::ArenaScope scope(arena);
+			pixled::FctWrapper<pixled::color> copy(anim);
+		}
+		arena.clear();
+	}
+	double arena_copy = ms(std::chrono::steady_clock::now() - start) / COPIES;
+	std::size_t arena_allocations = pixled::allocationStats().arena_allocations / COPIES;
+	std::size_t arena_heap_allocations = pixled::allocationStats().heap_allocations / COPIES;
+
+	pixled::ArenaScope scope(arena);
+	pixled::FctWrapper<pixled::color> arena_anim(anim);
+	double arena_frame = run(const_cast<pixled::Animation&>(arena_anim.get()));
+
+	std::cout << "Evaluation: " << frame_allocations << " allocations/frame" << std::endl;
+	std::cout << "Heap:  " << heap_allocations << " heap allocations, "
+		<< heap_copy * 1000 << " us/copy, "
+		<< heap_frame << " ms/frame" << std::endl;
+	std::cout << "Arena: " << arena_heap_allocations << " heap allocations, "
+		<< arena_allocations << " arena allocations (" << arena.used() << " B), "
+		<< arena_copy * 1000 << " us/copy, "
+		<< arena_frame << " ms/frame" << std::endl;
+}
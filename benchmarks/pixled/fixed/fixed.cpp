@@ -0,0 +1,69 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+
+/*
+ * Compares the evaluation time of the same animation, built with float
+ * and fixed-point Functions.
+ *
+ * The host usually has an FPU, so this benchmark only gives an idea of the
+ * overhead of fixed-point arithmetic: the fixed-point animation is
+ * expected to be much faster on FPU-less devices.
+ */
+
+using namespace pixled;
+
+const index_t SIZE = 128;
+const pixled::time FRAMES = 20;
+const int RUNS = 10;
+
+/*
+ * Output that discards colors.
+ */
+class NullOutput : public Output {
+	public:
+		void write(const color& c, std::size_t i) override {
+		}
+};
+
+void run(const char* name, Animation& animation) {
+	LedPanel panel(SIZE, SIZE, LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	Runtime runtime(panel, output, animation);
+	// Best run, to limit the noise of other processes
+	double best = 0;
+	for(int run = 0; run < RUNS; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for(pixled::time t = 0; t < FRAMES; t++)
+			runtime.next();
+		std::chrono::duration<double, std::milli> duration
+			= std::chrono::steady_clock::now() - start;
+		if(run == 0 || duration.count() < best)
+			best = duration.count();
+	}
+	std::cout << std::left << std::setw(8) << name << std::right
+		<< std::fixed << std::setprecision(3)
+		<< best / FRAMES << " ms/frame, "
+		<< std::setprecision(1)
+		<< SIZE * SIZE * FRAMES / best / 1000 << " Mleds/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+	{
+		hsb animation(
+				180.f * (1.f + Sine(Cast<float>(T() % 40) / 40.f + Cast<float>(I()) / 64.f)),
+				1.f,
+				.5f + .5f * Triangle(Cast<float>(T() % 20) / 20.f + Cast<float>(I()) / 128.f)
+				);
+		run("float", animation);
+	}
+	{
+		fixed_hsb animation(
+				fixed(180) * (fixed(1) + FixedSine(Cast<fixed>(T() % 40) / fixed(40) + Cast<fixed>(I()) / fixed(64))),
+				fixed(1),
+				fixed(.5f) + fixed(.5f) * FixedTriangle(Cast<fixed>(T() % 20) / fixed(20) + Cast<fixed>(I()) / fixed(128))
+				);
+		run("fixed", animation);
+	}
+}
@@ -0,0 +1,113 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+/*
+ * Measures the compression ratio and the decoding speed of the
+ * DeltaFrameCache on the `sequence.gif` and `dynamic_blooming_rainbow.gif`
+ * example animations.
+ *
+ * Animations are run on the 16x16 panel of the examples, and on a 256x256
+ * panel where all the geometric parameters are scaled accordingly.
+ */
+
+const pixled::time DECODED_PERIODS = 20;
+
+/*
+ * Output that copies frames to a buffer.
+ */
+class BufferOutput : public pixled::Output {
+	public:
+		std::vector<std::uint8_t> buffer;
+
+		BufferOutput(std::size_t size) : buffer(3 * size) {}
+
+		void write(const pixled::color& c, std::size_t i) override {
+			buffer[3*i] = c.red();
+			buffer[3*i+1] = c.green();
+			buffer[3*i+2] = c.blue();
+		}
+
+		void writeFrame(const std::uint8_t* frame, std::size_t led_count) override {
+			std::memcpy(buffer.data(), frame, 3*led_count);
+		}
+};
+
+void run(const char* name, pixled::Mapping& mapping, pixled::Animation& animation) {
+	BufferOutput output(mapping.size());
+	pixled::Runtime runtime(mapping, output, animation);
+	runtime.enableFrameCache(pixled::DELTA_FRAMES);
+	const pixled::FrameCache& cache = *runtime.frameCache();
+
+	// Fills the cache
+	for(pixled::time t = 0; t < cache.period(); t++)
+		runtime.next();
+
+	auto start = std::chrono::steady_clock::now();
+	for(pixled::time t = 0; t < DECODED_PERIODS * cache.period(); t++)
+		output.writeFrame(cache.load(t), cache.ledCount());
+	std::chrono::duration<double, std::micro> duration
+		= std::chrono::steady_clock::now() - start;
+	double frame_duration = duration.count() / (DECODED_PERIODS * cache.period());
+
+	std::size_t raw_size = cache.period() * cache.frameSize();
+	std::cout << std::left << std::setw(26) << name << std::right
+		<< std::setw(7) << cache.ledCount() << " leds "
+		<< std::setw(4) << cache.period() << " frames: "
+		<< std::setw(9) << raw_size << " B raw, "
+		<< std::setw(8) << cache.memory() << " B delta (x"
+		<< std::fixed << std::setprecision(1)
+		<< (double) raw_size / cache.memory() << "), decoding "
+		<< std::setprecision(2) << frame_duration << " us/frame ("
+		<< std::setprecision(0) << 1e6 / frame_duration << " fps)"
+		<< std::endl;
+}
+
+void sequence(pixled::index_t size) {
+	float scale = size / 16.f;
+	pixled::LedPanel panel(size, size, pixled::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+
+	pixled::Blink anim1(pixled::PURPLE, 4);
+	pixled::hsb anim2(pixled::RadialRainbowWave(
+				32 * scale, 40, pixled::point(8 * scale, 8 * scale)
+				), 1.0, 1.0);
+	pixled::Sequence anim3({
+			{pixled::RED, 10},
+			{pixled::GREEN, 10},
+			{pixled::BLUE, 10}
+			});
+	pixled::Sequence anim({
+			{anim1, 20},
+			{anim2, 20},
+			{anim3, 40},
+			{anim2, 40}
+			});
+
+	run("sequence", panel, anim);
+}
+
+void dynamic_blooming_rainbow(pixled::index_t size) {
+	float scale = size / 16.f;
+	pixled::LedPanel panel(size, size, pixled::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+
+	pixled::hsb rainbow(pixled::Rainbow(20), 1.0, 1.0);
+	pixled::Blooming blooming(
+			rainbow,
+			pixled::Point(
+				pixled::Wave<pixled::coordinate>(40, 8 * scale, 4 * scale),
+				9 * scale),
+			pixled::Wave<pixled::coordinate>(20, 10 * scale, 5 * scale)
+			);
+
+	run("dynamic_blooming_rainbow", panel, blooming);
+}
+
+int main(int argc, char** argv) {
+	for(pixled::index_t size : {16, 256}) {
+		sequence(size);
+		dynamic_blooming_rainbow(size);
+	}
+}
@@ -0,0 +1,69 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+
+/*
+ * Renders frames of an animation, records them to a frame stream, and plays
+ * the recording back.
+ */
+
+const int SIZE = 64;
+const int FRAMES = 400;
+const char* PATH = "frame_stream_benchmark.pxfs";
+
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color&, std::size_t) override {
+		}
+		void writeFrame(const std::uint8_t*, std::size_t) override {
+		}
+};
+
+template<typename Step>
+double frames_per_second(Step&& step) {
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < FRAMES; i++)
+		step();
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return FRAMES / duration.count();
+}
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	mapping::LedPanel panel(SIZE, SIZE, mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	chroma::hsb animation {
+		360.f * signal::Sine(geometry::X() / (float) SIZE + Cast<float>(chrono::T()) / 100.f),
+		1.f,
+		.5f + .5f * signal::Sine(geometry::Y() / (float) SIZE)
+	};
+
+	Runtime runtime(panel, output, animation);
+	double render = frames_per_second([&runtime] {
+			runtime.next();
+			});
+
+	double record;
+	{
+		FrameRecorder recorder(PATH, panel, 60);
+		Runtime recorded(panel, recorder, animation);
+		record = frames_per_second([&recorded] {
+				recorded.next();
+				});
+	}
+
+	FramePlayer player(PATH);
+	double play = frames_per_second([&player, &output] {
+			player.next(output);
+			});
+	std::remove(PATH);
+
+	std::cout << FRAMES << " frames of " << SIZE*SIZE << " leds" << std::endl
+		<< std::fixed << std::setprecision(1)
+		<< "render " << std::setw(12) << render << " frames/s" << std::endl
+		<< "record " << std::setw(12) << record << " frames/s" << std::endl
+		<< "play   " << std::setw(12) << play << " frames/s" << std::endl;
+}
@@ -0,0 +1,112 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <malloc.h>
+#include <new>
+
+/*
+ * Measures the memory used by copies of example animations, and their
+ * evaluation time.
+ *
+ * Memory is reported as the count of Function allocations, and as the
+ * memory actually used by the allocator (including its own overhead) to
+ * store a copy of the animation.
+ */
+
+static std::size_t allocated = 0;
+
+void* operator new(std::size_t size) {
+	void* ptr = std::malloc(size);
+	if(ptr == nullptr)
+		throw std::bad_alloc();
+	// Usable size plus the malloc chunk header
+	allocated += malloc_usable_size(ptr) + sizeof(std::size_t);
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	if(ptr != nullptr)
+		allocated -= malloc_usable_size(ptr) + sizeof(std::size_t);
+	std::free(ptr);
+}
+
+const pixled::index_t SIZE = 128;
+const pixled::time FRAMES = 20;
+const int RUNS = 10;
+
+/*
+ * Output that discards colors.
+ */
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color& c, std::size_t i) override {
+		}
+};
+
+void run(const char* name, const pixled::Animation& animation) {
+	pixled::resetAllocationStats();
+	std::size_t used = allocated;
+	pixled::FctWrapper<pixled::color>* copy
+		= new pixled::FctWrapper<pixled::color>(animation);
+	std::size_t allocations = pixled::allocationStats().heap_allocations;
+	std::size_t bytes = allocated - used;
+
+	pixled::LedPanel panel(SIZE, SIZE, pixled::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	pixled::Runtime runtime(panel, output, const_cast<pixled::Animation&>(copy->get()));
+	// Best run, to limit the noise of other processes
+	double best = 0;
+	for(int run = 0; run < RUNS; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for(pixled::time t = 0; t < FRAMES; t++)
+			runtime.next();
+		std::chrono::duration<double, std::milli> duration
+			= std::chrono::steady_clock::now() - start;
+		if(run == 0 || duration.count() < best)
+			best = duration.count();
+	}
+	delete copy;
+
+	std::cout << std::left << std::setw(26) << name << std::right
+		<< std::setw(4) << allocations << " allocations, "
+		<< std::setw(6) << bytes << " B, "
+		<< std::fixed << std::setprecision(3)
+		<< best / FRAMES << " ms/frame" << std::endl;
+}
+
+int main(int argc, char** argv) {
+	{
+		pixled::Blink anim1(pixled::PURPLE, 4);
+		pixled::hsb anim2(pixled::RadialRainbowWave(32, 40, pixled::point(8, 8)), 1.0, 1.0);
+		pixled::Sequence anim3({
+				{pixled::RED, 10},
+				{pixled::GREEN, 10},
+				{pixled::BLUE, 10}
+				});
+		pixled::Sequence anim({
+				{anim1, 20},
+				{anim2, 20},
+				{anim3, 40},
+				{anim2, 40}
+				});
+		run("sequence", anim);
+	}
+	{
+		pixled::hsb rainbow(pixled::Rainbow(20), 1.0, 1.0);
+		pixled::Blooming blooming(
+				rainbow,
+				pixled::Point(pixled::Wave<pixled::coordinate>(40, 8, 4), 9),
+				pixled::Wave<pixled::coordinate>(20, 10, 5)
+				);
+		run("dynamic_blooming_rainbow", blooming);
+	}
+	{
+		pixled::hsb wave(
+				pixled::RainbowWave(20, 40, pixled::line(pixled::point(0, 0), pixled::point(1, 1))),
+				1.0, pixled::LinearUnitWave(10, 20, pixled::line(pixled::point(0, 0), pixled::point(1, 1)))
+				);
+		run("rainbow_linear_unit_wave", wave);
+	}
+}
@@ -0,0 +1,73 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+ * Loads serialized scenes, as a scene switch would, and compares the load
+ * time to a frame budget.
+ */
+
+const int LOADS = 10000;
+const double FRAME_BUDGET = 1e6 / 60;
+
+template<typename Load>
+double microseconds_per_load(Load&& load) {
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LOADS; i++)
+		load();
+	std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() / LOADS;
+}
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	std::vector<std::pair<const char*, std::vector<std::uint8_t>>> scenes {
+		{"rainbow", serialize(hsb(Rainbow(40), 1.f, 1.f))},
+		{"sine_radial_t", serialize(hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(
+							Distance(Point(X(), Y()), point(8, 8)) / 8.f - T() / 10.f))))},
+		{"conditional_eq", serialize(If<color>(
+					Cast<int>(X() + Y()) % 2 == 0,
+					rgb(0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, 42)), 0),
+					rgb(0, 0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, 43)))))},
+		{"insane_triangle_radial_t", serialize(hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(
+							Distance(
+								Point(X(), Y()),
+								Point(
+									Cast<coordinate>(8.f * (1.f + Sine(T() / 30.f))),
+									8.f + 3.f * Triangle(8.f * (1.f + Sine(T() / 30.f)) / 8.f)))
+							/ 8.f - T() / 10.f))))}
+	};
+
+	alignas(std::max_align_t) static std::uint8_t buffer[16384];
+	Arena arena(buffer, sizeof(buffer));
+	unsigned long checksum = 0;
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "scene                      bytes  arena  own arena (us)  user arena (us)" << std::endl;
+	for(auto& scene : scenes) {
+		const std::vector<std::uint8_t>& data = scene.second;
+		double owned = microseconds_per_load([&data, &checksum] () {
+				FunctionGraph<color> graph(data);
+				checksum += graph.memory();
+				});
+		double user = microseconds_per_load([&data, &arena, &checksum] () {
+				{
+					FunctionGraph<color> graph(data.data(), data.size(), arena);
+					checksum += graph.memory();
+				}
+				arena.clear();
+				});
+		FunctionGraph<color> graph(data);
+		std::cout << std::left << std::setw(25) << scene.first << std::right
+			<< std::setw(7) << data.size()
+			<< std::setw(7) << graph.memory()
+			<< std::setw(16) << owned
+			<< std::setw(17) << user << std::endl;
+	}
+	std::cout << "frame budget at 60 fps: " << FRAME_BUDGET << " us" << std::endl
+		<< "(" << checksum << ")" << std::endl;
+}
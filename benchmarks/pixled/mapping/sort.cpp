@@ -0,0 +1,90 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <vector>
+
+/*
+ * Measures the effect of Mapping::sort() on the locality of spatially indexed
+ * lookups.
+ *
+ * The animation samples a row-major texture at the location of each led.
+ * Since the panel is wired column by column, leds are iterated by default in
+ * an order that jumps a full texture row at each step.
+ */
+
+const pixled::index_t SIZE = 1024;
+const pixled::time FRAMES = 20;
+
+/*
+ * Samples a static texture, stored row by row, at the current led location.
+ */
+class Texture : public pixled::base::Function<pixled::color> {
+	private:
+		const std::vector<pixled::color>& texels;
+
+	public:
+		Texture(const std::vector<pixled::color>& texels)
+			: texels(texels) {}
+
+		pixled::color operator()(pixled::led l, pixled::time t) const override {
+			std::size_t x = (std::size_t) l.location.x;
+			std::size_t y = (std::size_t) l.location.y;
+			return texels[y * SIZE + x];
+		}
+
+		Texture* copy() const override {
+			return new Texture(texels);
+		}
+};
+
+/*
+ * Output that stores the current frame in memory.
+ */
+class BufferOutput : public pixled::Output {
+	public:
+		std::vector<std::uint8_t> buffer;
+
+		BufferOutput(std::size_t size) : buffer(3 * size) {}
+
+		void write(const pixled::color& c, std::size_t i) override {
+			buffer[3*i] = c.red();
+			buffer[3*i+1] = c.green();
+			buffer[3*i+2] = c.blue();
+		}
+};
+
+double run(pixled::Mapping& mapping, pixled::Animation& animation) {
+	BufferOutput output(mapping.size());
+	pixled::Runtime runtime(mapping, output, animation);
+	// Warm up
+	runtime.next();
+
+	auto start = std::chrono::steady_clock::now();
+	for(pixled::time t = 0; t < FRAMES; t++)
+		runtime.next();
+	std::chrono::duration<double, std::milli> duration
+		= std::chrono::steady_clock::now() - start;
+	return duration.count() / FRAMES;
+}
+
+int main(int argc, char** argv) {
+	std::vector<pixled::color> texels;
+	texels.reserve(SIZE * SIZE);
+	for(pixled::index_t i = 0; i < SIZE * SIZE; i++)
+		texels.push_back(pixled::color::hsb(i % 360, 1, 1));
+	Texture texture(texels);
+
+	pixled::LedPanel panel(SIZE, SIZE, pixled::TOP_DOWN_DOWN_TOP_FROM_LEFT);
+	std::cout << "Panel: " << SIZE << "x" << SIZE
+		<< " (" << panel.size() << " leds), column wired" << std::endl;
+
+	std::cout << "Wiring order:  " << run(panel, texture) << " ms/frame" << std::endl;
+
+	pixled::LedPanel morton_panel(SIZE, SIZE, pixled::TOP_DOWN_DOWN_TOP_FROM_LEFT);
+	morton_panel.sort(pixled::MORTON_CURVE);
+	std::cout << "Morton order:  " << run(morton_panel, texture) << " ms/frame" << std::endl;
+
+	pixled::LedPanel hilbert_panel(SIZE, SIZE, pixled::TOP_DOWN_DOWN_TOP_FROM_LEFT);
+	hilbert_panel.sort(pixled::HILBERT_CURVE);
+	std::cout << "Hilbert order: " << run(hilbert_panel, texture) << " ms/frame" << std::endl;
+}
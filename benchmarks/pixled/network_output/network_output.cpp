@@ -0,0 +1,45 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+ * Streams frames to hundreds of universes on localhost, with E1.31 and
+ * Art-Net. No receiver is listening: packets are dropped by the kernel once
+ * sent.
+ */
+
+const std::size_t UNIVERSES = 500;
+const std::size_t LEDS = UNIVERSES * pixled::NetworkOutput::MAX_UNIVERSE_LEDS;
+const int FRAMES = 400;
+
+double frames_per_second(pixled::NETWORK_PROTOCOL protocol) {
+	pixled::NetworkOutput output(protocol, "127.0.0.1", 45678);
+	output.addUniverses(1, LEDS);
+	output.setSync(UNIVERSES + 1);
+
+	std::vector<std::uint8_t> frame(3*LEDS);
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < FRAMES; i++) {
+		std::fill(frame.begin(), frame.end(), (std::uint8_t) i);
+		output.writeFrame(frame.data(), LEDS);
+		output.endFrame();
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	if(output.sendErrors() > 0)
+		std::cerr << output.sendErrors() << " send errors" << std::endl;
+	return FRAMES / duration.count();
+}
+
+int main(int argc, char** argv) {
+	double e131 = frames_per_second(pixled::E131);
+	double artnet = frames_per_second(pixled::ARTNET);
+
+	std::cout << FRAMES << " frames of " << UNIVERSES << " universes ("
+		<< LEDS << " leds)" << std::endl
+		<< std::fixed << std::setprecision(1)
+		<< "E1.31   " << std::setw(10) << e131 << " frames/s" << std::endl
+		<< "Art-Net " << std::setw(10) << artnet << " frames/s" << std::endl;
+}
@@ -0,0 +1,50 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+
+/*
+ * Renders a time range of an animation with a Runtime, and then with an
+ * OfflineRenderer rendering frames in parallel.
+ */
+
+const int SIZE = 64;
+const int FRAMES = 400;
+
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color&, std::size_t) override {
+		}
+		void writeFrame(const std::uint8_t*, std::size_t) override {
+		}
+};
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	mapping::LedPanel panel(SIZE, SIZE, mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	chroma::hsb animation {
+		360.f * signal::Sine(geometry::X() / (float) SIZE + Cast<float>(chrono::T()) / 100.f),
+		1.f,
+		.5f + .5f * signal::Sine(geometry::Y() / (float) SIZE)
+	};
+
+	Runtime runtime(panel, output, animation);
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < FRAMES; i++)
+		runtime.next();
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	double sequential = FRAMES / duration.count();
+
+	ThreadPool pool;
+	OfflineRenderer renderer(panel, animation, pool);
+	renderer.render(0, FRAMES, output);
+
+	std::cout << FRAMES << " frames of " << SIZE*SIZE << " leds, "
+		<< pool.threadCount() << " threads, ring of "
+		<< renderer.ringSize() << " frames" << std::endl
+		<< std::fixed << std::setprecision(1)
+		<< "runtime  " << std::setw(8) << sequential << " frames/s" << std::endl
+		<< "offline  " << std::setw(8) << renderer.framesPerSecond() << " frames/s" << std::endl;
+}
@@ -0,0 +1,95 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+/*
+ * Compares OutputStage::apply() to a per led gamma correction, dimming and
+ * current limiting computed with std::pow, as usually done in Output
+ * implementations, and measures the cost of processing 16 bits frames with
+ * dithering.
+ */
+
+const std::size_t LED_COUNT = 100000;
+const int RUNS = 100;
+const float GAMMA = 2.2f;
+const float BRIGHTNESS = .5f;
+// Low enough for the limiter to be triggered
+const std::uint32_t BUDGET = LED_COUNT * 50;
+
+/*
+ * Per led std::pow implementation.
+ */
+void pow_stage(std::uint8_t* frame, std::size_t led_count) {
+	float sum = 0;
+	for(std::size_t i = 0; i < 3*led_count; i++) {
+		float v = 255.f * std::pow(frame[i] / 255.f, GAMMA) * BRIGHTNESS;
+		frame[i] = (std::uint8_t) (v + .5f);
+		sum += frame[i];
+	}
+	if(sum > BUDGET) {
+		float scale = BUDGET / sum;
+		for(std::size_t i = 0; i < 3*led_count; i++)
+			frame[i] = (std::uint8_t) (frame[i] * scale);
+	}
+}
+
+template<typename T, typename Stage>
+double run(const std::vector<T>& input, Stage&& stage) {
+	std::vector<T> frame(input.size());
+	double best = 0;
+	for(int run = 0; run < RUNS; run++) {
+		std::copy(input.begin(), input.end(), frame.begin());
+		auto start = std::chrono::steady_clock::now();
+		stage(frame.data(), LED_COUNT);
+		std::chrono::duration<double, std::micro> duration
+			= std::chrono::steady_clock::now() - start;
+		if(run == 0 || duration.count() < best)
+			best = duration.count();
+	}
+	return best;
+}
+
+int main(int argc, char** argv) {
+	std::mt19937 rd;
+	std::uniform_int_distribution<int> rd_value(0, 255);
+	std::vector<std::uint8_t> input(3*LED_COUNT);
+	for(auto& v : input)
+		v = rd_value(rd);
+	std::vector<std::uint16_t> input16(3*LED_COUNT);
+	for(auto& v : input16)
+		v = rd_value(rd) * 257 + rd_value(rd);
+
+	pixled::OutputStage output_stage;
+	output_stage.setGamma(GAMMA);
+	output_stage.setBrightness(255 * BRIGHTNESS);
+	output_stage.setCurrentBudget(BUDGET);
+
+	double pow_time = run(input, pow_stage);
+	double lut_time = run(input, [&output_stage] (std::uint8_t* frame, std::size_t led_count) {
+			output_stage.apply(frame, led_count);
+			});
+
+	std::vector<std::uint8_t> output(3*LED_COUNT);
+	double times16[3];
+	pixled::OutputStage::DITHERING methods[3] = {
+		pixled::OutputStage::NO_DITHERING,
+		pixled::OutputStage::TEMPORAL_DITHERING,
+		pixled::OutputStage::TEMPORAL_SPATIAL_DITHERING
+	};
+	for(int i = 0; i < 3; i++) {
+		output_stage.setDithering(methods[i]);
+		times16[i] = run(input16, [&output_stage, &output] (std::uint16_t* frame, std::size_t led_count) {
+				output_stage.apply(frame, output.data(), led_count);
+				});
+	}
+
+	std::cout << std::fixed << std::setprecision(1)
+		<< "std::pow     " << std::setw(8) << pow_time << " us/frame" << std::endl
+		<< "OutputStage  " << std::setw(8) << lut_time << " us/frame" << std::endl
+		<< "16 bits      " << std::setw(8) << times16[0] << " us/frame" << std::endl
+		<< "temporal     " << std::setw(8) << times16[1] << " us/frame" << std::endl
+		<< "spatial      " << std::setw(8) << times16[2] << " us/frame" << std::endl;
+}
@@ -0,0 +1,69 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/*
+ * Parses a textual scene, and compares its rendering speed to the same
+ * scene written in C++.
+ */
+
+const int PARSES = 10000;
+const int FRAMES = 200;
+const char* SCENE = "hsb(Rainbow(20), 1, .5 + .5 * Sine("
+	"Distance(Point(X(), Y()), point(8, 8)) / 8 - T() / (5 * 2.f)))";
+
+/*
+ * Output that sums the colors, so that frames can't be optimized out.
+ */
+class SumOutput : public pixled::Output {
+	public:
+		unsigned long sum = 0;
+
+		void write(const pixled::color& c, std::size_t) override {
+			sum += c.red() + c.green() + c.blue();
+		}
+};
+
+template<typename Step>
+double microseconds_per_step(int count, Step&& step) {
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < count; i++)
+		step();
+	std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() / count;
+}
+
+double microseconds_per_frame(pixled::Animation& animation, SumOutput& output) {
+	pixled::LedPanel panel(64, 64, pixled::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	pixled::Runtime runtime(panel, output, animation);
+	return microseconds_per_step(FRAMES, [&runtime] () {runtime.next();});
+}
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	unsigned long checksum = 0;
+	double parse_time = microseconds_per_step(PARSES, [&checksum] () {
+			FctWrapper<color> scene(RED);
+			checksum += parse(SCENE, scene);
+			});
+
+	FctWrapper<color> parsed(RED);
+	parse(SCENE, parsed);
+	FunctionGraph<color> graph(serialize(*parsed));
+	hsb native(Rainbow(20), 1.f, .5f + .5f * Sine(
+				Distance(Point(X(), Y()), point(8, 8)) / 8 - T() / 10.f));
+
+	SumOutput native_output;
+	SumOutput graph_output;
+	double native_time = microseconds_per_frame(native, native_output);
+	double graph_time = microseconds_per_frame(graph, graph_output);
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "parse          " << std::setw(10) << parse_time << " us" << std::endl
+		<< "C++ scene      " << std::setw(10) << native_time << " us/frame" << std::endl
+		<< "parsed scene   " << std::setw(10) << graph_time << " us/frame" << std::endl
+		<< "(" << checksum << ", " << (native_output.sum == graph_output.sum) << ")" << std::endl;
+}
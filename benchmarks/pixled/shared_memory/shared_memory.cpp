@@ -0,0 +1,74 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+ * Publishes large frames to a shared memory ring, and reads them back as a
+ * driver process would.
+ */
+
+const std::size_t LEDS = 100000;
+const int FRAMES = 2000;
+const char* NAME = "/pixled_benchmark";
+
+/*
+ * Driver that sums the components of each frame.
+ */
+class SumOutput : public pixled::Output {
+	public:
+		unsigned long sum = 0;
+
+		void write(const pixled::color&, std::size_t) override {
+		}
+		void writeFrame(const std::uint8_t* frame, std::size_t led_count) override {
+			unsigned long frame_sum = 0;
+			for(std::size_t i = 0; i < 3*led_count; i++)
+				frame_sum += frame[i];
+			sum += frame_sum;
+		}
+};
+
+template<typename Step>
+double frames_per_second(Step&& step) {
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < FRAMES; i++)
+		step(i);
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return FRAMES / duration.count();
+}
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	SharedMemoryOutput output(NAME, LEDS);
+	SharedMemoryReader reader(NAME);
+	SumOutput driver;
+	std::vector<std::uint8_t> frame(3*LEDS);
+	std::vector<std::uint8_t> copy(3*LEDS);
+
+	auto publish = [&output, &frame] (int i) {
+		std::fill(frame.begin(), frame.end(), (std::uint8_t) i);
+		output.writeFrame(frame.data(), LEDS);
+		output.endFrame();
+	};
+	double published = frames_per_second(publish);
+	double copied = frames_per_second([&publish, &reader, &copy, &driver] (int i) {
+			publish(i);
+			reader.read(copy.data());
+			driver.writeFrame(copy.data(), LEDS);
+			});
+	double read_output = frames_per_second([&publish, &reader, &driver] (int i) {
+			publish(i);
+			reader.read(driver);
+			});
+
+	std::cout << FRAMES << " frames of " << LEDS << " leds" << std::endl
+		<< std::fixed << std::setprecision(1)
+		<< "publish                   " << std::setw(10) << published << " frames/s" << std::endl
+		<< "publish + copy            " << std::setw(10) << copied << " frames/s" << std::endl
+		<< "publish + read to output  " << std::setw(10) << read_output << " frames/s" << std::endl
+		<< "(" << driver.sum << ")" << std::endl;
+}
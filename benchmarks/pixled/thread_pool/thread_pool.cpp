@@ -0,0 +1,71 @@
+#include "pixled.h"
+
+#include <chrono>
+#include <iomanip>
+
+/*
+ * Renders frames of many independent Runtimes sequentially, and then on a
+ * ThreadPool, both as one task per Runtime and by splitting each frame in
+ * tasks.
+ */
+
+const int RUNTIME_COUNT = 16;
+const int SIZE = 64;
+const int FRAMES = 20;
+
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color&, std::size_t) override {
+		}
+		void writeFrame(const std::uint8_t*, std::size_t) override {
+		}
+};
+
+template<typename Step>
+double frames_per_second(Step&& step) {
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < FRAMES; i++)
+		step();
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return RUNTIME_COUNT * FRAMES / duration.count();
+}
+
+int main(int argc, char** argv) {
+	using namespace pixled;
+
+	mapping::LedPanel panel(SIZE, SIZE, mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	chroma::hsb animation {
+		360.f * signal::Sine(geometry::X() / (float) SIZE + Cast<float>(chrono::T()) / 100.f),
+		1.f,
+		.5f + .5f * signal::Sine(geometry::Y() / (float) SIZE)
+	};
+	std::vector<std::unique_ptr<Runtime>> runtimes;
+	for(int i = 0; i < RUNTIME_COUNT; i++)
+		runtimes.emplace_back(new Runtime(panel, output, animation));
+
+	ThreadPool pool;
+
+	double sequential = frames_per_second([&runtimes] {
+			for(auto& runtime : runtimes)
+				runtime->next();
+			});
+	double per_runtime = frames_per_second([&runtimes, &pool] {
+			pool.parallelFor(runtimes.size(), [&runtimes] (std::size_t i) {
+					runtimes[i]->next();
+					});
+			});
+	for(auto& runtime : runtimes)
+		runtime->setThreadPool(&pool, 512);
+	double split = frames_per_second([&runtimes] {
+			for(auto& runtime : runtimes)
+				runtime->next();
+			});
+
+	std::cout << RUNTIME_COUNT << " runtimes of " << SIZE*SIZE << " leds, "
+		<< pool.threadCount() << " threads" << std::endl
+		<< std::fixed << std::setprecision(1)
+		<< "sequential   " << std::setw(8) << sequential << " frames/s" << std::endl
+		<< "per runtime  " << std::setw(8) << per_runtime << " frames/s" << std::endl
+		<< "split frames " << std::setw(8) << split << " frames/s" << std::endl;
+}
@@ -7,6 +7,14 @@
 #include "pixled/chrono/chrono.h"
 #include "pixled/output.h"
 #include "pixled/runtime.h"
+#include "pixled/scheduler.h"
+#include "pixled/pool_scheduler.h"
+#include "pixled/offline_renderer.h"
+#include "pixled/frame_stream.h"
+#include "pixled/network_output.h"
+#include "pixled/shared_memory.h"
+#include "pixled/graph.h"
+#include "pixled/parser.h"
 
 /**
  * Main pixled namespace.
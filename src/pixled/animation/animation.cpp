@@ -1,37 +1,78 @@
 #include "animation.h"
 
+#include <algorithm>
+
 namespace pixled { namespace animation {
 
 	float Rainbow::operator()(led l, time t) const {
-		return 180.f * (sin(l, t) + 1.f);
+		return 180.f * (std::sin(2*PI * chrono::phase(t, this->call<0>(l, t))) + 1.f);
+	}
+
+	time Rainbow::periodicity() const {
+		return detail::period_periodicity(this->arg<0>(), 1);
+	}
+
+	bool Rainbow::mayChange(led l, time t) const {
+		return true;
 	}
 
 	float RainbowWave::operator()(led l, time t) const {
-		float d = geometry::LineDistance(this->arg<2>(), l.location)(l, t);
-		return 180.f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - (float) t / this->call<1>(l, t))));
+		float d = distance(l.location, this->call<2>(l, t));
+		return 180.f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - chrono::phase(t, this->call<1>(l, t)))));
+	}
+
+	time RainbowWave::periodicity() const {
+		return detail::period_periodicity(this->arg<1>(), this->argsPeriodicity());
+	}
+
+	bool RainbowWave::mayChange(led l, time t) const {
+		return true;
 	}
 
 	float RadialRainbowWave::operator()(led l, time t) const {
-		float d = geometry::Distance(this->arg<2>(), l.location)(l, t);
-		return 180.f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - (float) t / this->call<1>(l, t))));
+		float d = distance(l.location, this->call<2>(l, t));
+		return 180.f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - chrono::phase(t, this->call<1>(l, t)))));
+	}
+
+	time RadialRainbowWave::periodicity() const {
+		return detail::period_periodicity(this->arg<1>(), this->argsPeriodicity());
+	}
+
+	bool RadialRainbowWave::mayChange(led l, time t) const {
+		return true;
 	}
 
 	float LinearUnitWave::operator()(led l, time t) const {
-		float d = geometry::LineDistance(this->arg<2>(), l.location)(l, t);
-		return .5f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - (float) t / this->call<1>(l, t))));
+		float d = distance(l.location, this->call<2>(l, t));
+		return .5f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - chrono::phase(t, this->call<1>(l, t)))));
+	}
+
+	time LinearUnitWave::periodicity() const {
+		return detail::period_periodicity(this->arg<1>(), this->argsPeriodicity());
+	}
+
+	bool LinearUnitWave::mayChange(led l, time t) const {
+		return true;
 	}
 
 	float RadialUnitWave::operator()(led l, time t) const {
-		float d = geometry::Distance(this->arg<2>(), l.location)(l, t);
-		return .5f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - (float) t / this->call<1>(l, t))));
+		float d = distance(l.location, this->call<2>(l, t));
+		return .5f * (1.f + std::sin(2*PI*(d / this->call<0>(l, t) - chrono::phase(t, this->call<1>(l, t)))));
 	}
 
-	color Blooming::operator()(led l, time t) const {
-		color color = this->call<0>(l, t);
+	time RadialUnitWave::periodicity() const {
+		return detail::period_periodicity(this->arg<1>(), this->argsPeriodicity());
+	}
+
+	bool RadialUnitWave::mayChange(led l, time t) const {
+		return true;
+	}
+
+	float Blooming::brightness(led l, time t) const {
 		// Max distance from center point, where b = epsilon
 		float D = this->call<2>(l, t);
 		// Distance from c to center point
-		float d = geometry::Distance(this->arg<1>(), l.location)(l, t);
+		float d = distance(l.location, this->call<1>(l, t));
 
 		// The brightness decreases as a 1 / x light functions, scaled
 		// so that when d = D, b = epsilon.
@@ -40,36 +81,96 @@ namespace pixled { namespace animation {
 		float b = 1 / (1 + alpha * d);
 		if(b < epsilon)
 			b = 0.;
+		return b;
+	}
 
-		color.setBrightness(b);
+	color Blooming::operator()(led l, time t) const {
+		color color = this->call<0>(l, t);
+		color.setBrightness(brightness(l, t));
 		return color;
 	}
 
+	bool Blooming::mayChange(led l, time t) const {
+		if(!this->arg<1>().mayChange(l, t) && !this->arg<2>().mayChange(l, t)
+				&& !this->arg<0>().mayChange(l, t))
+			return false;
+		return brightness(l, t) > 0 || brightness(l, t+1) > 0;
+	}
+
+	std::size_t Sequence::segment(time t) const {
+		auto it = std::upper_bound(
+				animations.begin(), animations.end(), t % duration,
+				[] (time t, const std::pair<time, FctWrapper<color>>& item) {
+					return t < item.first;
+				});
+		return it - animations.begin() - 1;
+	}
+
 	color Sequence::operator()(led l, time t) const {
-		if(t >= cache_time && t < cache_time + cache_time_duration)
-			return (**cache)(l, t);
-		auto it = animations.upper_bound(t % duration);
-		auto prev_it = it;
-		--prev_it;
-		cache_time = t;
-		if(it==animations.end()) {
-			cache_time_duration = duration - prev_it->first;
-		} else {
-			cache_time_duration = it->first - prev_it->first;
+		return animations[segment(t)].second(l, t);
+	}
+
+	time Sequence::periodicity() const {
+		time periodicity = duration;
+		for(auto& item : animations)
+			periodicity = detail::periodicity_lcm(periodicity, (*item.second).periodicity());
+		return periodicity;
+	}
+
+	bool Sequence::mayChange(led l, time t) const {
+		std::size_t i = segment(t);
+		time end = i + 1 < animations.size() ? animations[i+1].first : duration;
+		if((t % duration) + 1 >= end && animations.size() > 1)
+			// Last frame of the current segment
+			return true;
+		return (*animations[i].second).mayChange(l, t);
+	}
+
+	bool Sequence::stateless() const {
+		for(auto& item : animations)
+			if(!(*item.second).stateless())
+				return false;
+		return true;
+	}
+
+	bool Sequence::serialize(serialization::Writer& writer) const {
+		if(animations.empty() || !writer.node(
+					NODE, serialization::COLOR_VALUE,
+					serialization::COLOR_VALUE, animations.size(), 8 * animations.size()))
+			return false;
+		for(std::size_t i = 0; i < animations.size(); i++) {
+			time end = i + 1 < animations.size() ? animations[i+1].first : duration;
+			writer.value(end - animations[i].first);
 		}
-		auto& anim_ptr = prev_it->second;
-		cache = &anim_ptr;
-		return (*anim_ptr)(l, t);
+		for(auto& item : animations)
+			if(!(*item.second).serialize(writer))
+				return false;
+		return true;
 	}
 
 	Sequence* Sequence::copy() const {
 		return new Sequence(*this);
 	}
 
+	bool Blink::on(led l, time t) const {
+		return std::sin(2*PI * chrono::phase(t, this->call<1>(l, t))) > 0;
+	}
+
 	color Blink::operator()(led l, time t) const {
-		if(square(l, t) > 0) {
+		if(on(l, t)) {
 			return this->call<0>(l, t);
 		}
 		return black;
 	}
+
+	bool Blink::mayChange(led l, time t) const {
+		bool on = this->on(l, t);
+		if(on != this->on(l, t+1))
+			return true;
+		return on && this->arg<0>().mayChange(l, t);
+	}
+
+	time Blink::periodicity() const {
+		return detail::period_periodicity(this->arg<1>(), this->argsPeriodicity());
+	}
 }}
@@ -2,7 +2,8 @@
 #define ANIMATION_H
 
 #include <vector>
-#include <map>
+#include <initializer_list>
+#include "../containers.h"
 #include "../chrono/chrono.h"
 #include "../signal/signal.h"
 #include "../geometry/geometry.h"
@@ -30,13 +31,23 @@ namespace pixled { namespace animation {
 		class Wave : public Function<Wave<R>, R, time, R, R> {
 			public:
 				using Function<Wave<R>, R, time, R, R>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::WAVE_NODE;
 
 				R operator()(led l, time t) const override {
 					return this->template call<1>(l, t)
 						+ this->template call<2>(l, t) * std::sin(
-								2*PI * t / this->template call<0>(l, t)
+								2*PI * chrono::phase(t, this->template call<0>(l, t))
 								);
 				}
+
+				time periodicity() const override {
+					return detail::period_periodicity(
+							this->template arg<0>(), this->argsPeriodicity());
+				}
+
+				bool mayChange(led l, time t) const override {
+					return true;
+				}
 		};
 
 	/**
@@ -50,6 +61,7 @@ namespace pixled { namespace animation {
 	class LinearUnitWave : public Function<LinearUnitWave, float, coordinate, time, line> {
 		public:
 			using Function<LinearUnitWave, float, coordinate, time, line>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::LINEAR_UNIT_WAVE_NODE;
 
 			/*
 			 * f1 : lambda
@@ -57,6 +69,10 @@ namespace pixled { namespace animation {
 			 * f3 : time period
 			 */
 			float operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -70,6 +86,7 @@ namespace pixled { namespace animation {
 	class RadialUnitWave : public Function<RadialUnitWave, float, coordinate, time, point> {
 		public:
 			using Function<RadialUnitWave, float, coordinate, time, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::RADIAL_UNIT_WAVE_NODE;
 
 			/*
 			 * f1 : lambda
@@ -77,6 +94,10 @@ namespace pixled { namespace animation {
 			 * f3 : time period
 			 */
 			float operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -86,15 +107,15 @@ namespace pixled { namespace animation {
 	 * @retval float rainbow hue in `[0, 360]`
 	 */
 	class Rainbow : public Function<Rainbow, float, time> {
-		private:
-			signal::Sine sin {
-				Cast<float>(chrono::T()) / Cast<float>(this->arg<0>())
-			};
-
 		public:
 			using Function<Rainbow, float, time>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::RAINBOW_NODE;
 
 			float operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -108,8 +129,13 @@ namespace pixled { namespace animation {
 	class RainbowWave : public Function<RainbowWave, float, float, time, line> {
 		public:
 			using Function<RainbowWave, float, float, time, line>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::RAINBOW_WAVE_NODE;
 
 			float operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -123,8 +149,13 @@ namespace pixled { namespace animation {
 	class RadialRainbowWave : public Function<RadialRainbowWave, float, coordinate, time, point> {
 		public:
 			using Function<RadialRainbowWave, float, coordinate, time, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::RADIAL_RAINBOW_WAVE_NODE;
 
 			float operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -137,10 +168,19 @@ namespace pixled { namespace animation {
 	 * @param coordinate blooming radius
 	 */
 	class Blooming : public Function<Blooming, color, color, point, coordinate> {
+		private:
+			float brightness(led l, time t) const;
+
 		public:
 			using Function<Blooming, color, color, point, coordinate>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::BLOOMING_NODE;
 
 			color operator()(led l, time t) const override;
+
+			/**
+			 * Leds out of the blooming radius at `t` and `t+1` stay black.
+			 */
+			bool mayChange(led l, time t) const override;
 	};
 
 
@@ -153,16 +193,26 @@ namespace pixled { namespace animation {
 	 */
 	class Blink : public Function<Blink, color, color, time> {
 		private:
-			signal::Square square {
-				Cast<float>(chrono::T()) // parameter
-				/ Cast<float>(this->arg<1>()) // period
-			};
 			color black {color::rgb(0, 0, 0)};
 
+			/**
+			 * True iff the animation is on at time `t`, i.e. during the
+			 * first half of the period.
+			 */
+			bool on(led l, time t) const;
+
 		public:
 			using Function<Blink, color, color, time>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::BLINK_NODE;
 
 			color operator()(led l, time t) const override;
+
+			time periodicity() const override;
+
+			/**
+			 * Leds stay black while the animation is off.
+			 */
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -197,13 +247,18 @@ namespace pixled { namespace animation {
 	 */
 	class Sequence : public base::Function<color> {
 		private:
-			std::map<time, FctWrapper<color>> animations;
+			// Animations, sorted by start time in the Sequence, stored with
+			// the Sequence in the active Arena
+			arena_vector<std::pair<time, FctWrapper<color>>, PIXLED_SEQUENCE_CAPACITY> animations;
 			time duration = 0;
 
-			mutable const FctWrapper<color>* cache;
-			mutable time cache_time = 0;
-			mutable time cache_time_duration = 0;
+			/**
+			 * Index of the animation played at time `t`.
+			 */
+			std::size_t segment(time t) const;
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::SEQUENCE_NODE;
+
 			/**
 			 * Initializes an emty Sequence.
 			 *
@@ -230,11 +285,37 @@ namespace pixled { namespace animation {
 			 *
 			 * @param sequence a SequenceItem list describing the sequence.
 			 */
-			Sequence(std::vector<SequenceItem> sequence) {
-				for(auto item : sequence)
+			Sequence(std::initializer_list<SequenceItem> sequence) {
+				animations.reserve(sequence.size());
+				for(const auto& item : sequence)
 					this->add(item.animation, item.duration);
 			}
 
+#ifndef PIXLED_NO_HEAP
+			/**
+			 * Sequence constructor.
+			 *
+			 * @param sequence a SequenceItem list describing the sequence.
+			 */
+			Sequence(const std::vector<SequenceItem>& sequence) {
+				animations.reserve(sequence.size());
+				for(const auto& item : sequence)
+					this->add(item.animation, item.duration);
+			}
+#endif
+
+			/**
+			 * Reserves the storage of `count` items, so that adding them
+			 * performs a single allocation.
+			 *
+			 * @param count count of items
+			 * @return reference to the current sequence
+			 */
+			Sequence& reserve(std::size_t count) {
+				animations.reserve(count);
+				return *this;
+			}
+
 			/**
 			 * Adds an item to the Sequence.
 			 *
@@ -254,16 +335,38 @@ namespace pixled { namespace animation {
 			 */
 			template<typename Anim>
 				Sequence& add(Anim&& animation, time duration) {
-					animations.insert({this->duration, std::forward<Anim>(animation)});
-					cache_time = this->duration;
-					cache = &animations.at(cache_time);
+					animations.emplace_back(this->duration, std::forward<Anim>(animation));
 					this->duration+=duration;
-					cache_time_duration=duration;
 					return *this;
 				}
 
 			color operator()(led l, time t) const override;
 
+			/**
+			 * The periodicity of a Sequence is the least common multiple of
+			 * its total duration and of the periodicities of its
+			 * animations.
+			 */
+			time periodicity() const override;
+
+			/**
+			 * Within a Sequence segment, the Sequence may only change if the
+			 * current animation may change.
+			 */
+			bool mayChange(led l, time t) const override;
+
+			/**
+			 * A Sequence is stateless if all its animations are
+			 * stateless.
+			 */
+			bool stateless() const override;
+
+			/**
+			 * Writes the duration of each animation, followed by the
+			 * animations.
+			 */
+			bool serialize(serialization::Writer& writer) const override;
+
 			Sequence* copy() const override;
 	};
 
@@ -0,0 +1,184 @@
+#include "arena.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace pixled {
+	/**
+	 * Allocation counters, that can be updated from any thread.
+	 */
+	struct AtomicAllocationStats {
+		std::atomic<std::size_t> heap_allocations {0};
+		std::atomic<std::size_t> heap_bytes {0};
+		std::atomic<std::size_t> arena_allocations {0};
+		std::atomic<std::size_t> arena_bytes {0};
+		std::atomic<std::size_t> heap_deallocations {0};
+	};
+
+	static AtomicAllocationStats stats;
+	// Arena currently activated by an ArenaScope on this thread
+	static thread_local Arena* active_arena = nullptr;
+	// List of all the live Arenas, guarded by arenas_lock
+	static Arena* arenas = nullptr;
+	// Count of live Arenas, so that heap Functions are freed without
+	// locking the list when no Arena exists
+	static std::atomic<std::size_t> arena_count {0};
+	static std::atomic_flag arenas_lock = ATOMIC_FLAG_INIT;
+
+	/**
+	 * Spin lock guarding the Arena list, that is only held to link, unlink
+	 * or scan Arenas.
+	 */
+	class ArenasLock {
+		public:
+			ArenasLock() {
+				while(arenas_lock.test_and_set(std::memory_order_acquire)) {
+				}
+			}
+			~ArenasLock() {
+				arenas_lock.clear(std::memory_order_release);
+			}
+	};
+
+	static const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+	static void count(std::atomic<std::size_t>& counter, std::size_t value) {
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	AllocationStats allocationStats() {
+		return {
+			stats.heap_allocations.load(std::memory_order_relaxed),
+			stats.heap_bytes.load(std::memory_order_relaxed),
+			stats.arena_allocations.load(std::memory_order_relaxed),
+			stats.arena_bytes.load(std::memory_order_relaxed),
+			stats.heap_deallocations.load(std::memory_order_relaxed)
+		};
+	}
+
+	void resetAllocationStats() {
+		stats.heap_allocations.store(0, std::memory_order_relaxed);
+		stats.heap_bytes.store(0, std::memory_order_relaxed);
+		stats.arena_allocations.store(0, std::memory_order_relaxed);
+		stats.arena_bytes.store(0, std::memory_order_relaxed);
+		stats.heap_deallocations.store(0, std::memory_order_relaxed);
+	}
+
+	void Arena::link() {
+		ArenasLock lock;
+		next_arena = arenas;
+		arenas = this;
+		arena_count++;
+	}
+
+#ifndef PIXLED_NO_HEAP
+	Arena::Arena(std::size_t capacity)
+		: buffer(new std::uint8_t[capacity]), _capacity(capacity), owned(true) {
+			link();
+		}
+#endif
+
+	Arena::Arena(void* buffer, std::size_t capacity)
+		: buffer((std::uint8_t*) buffer), _capacity(capacity), owned(false) {
+			link();
+		}
+
+	void* Arena::allocate(std::size_t size) {
+		// Aligns the current position
+		std::uintptr_t address = (std::uintptr_t) (buffer + _used);
+		std::size_t padding = (ALIGNMENT - address % ALIGNMENT) % ALIGNMENT;
+		if(padding + size > _capacity - _used)
+			return nullptr;
+		void* ptr = buffer + _used + padding;
+		_used += padding + size;
+		_allocations++;
+		return ptr;
+	}
+
+	bool Arena::contains(const void* ptr) const {
+		return ptr >= buffer && ptr < buffer + _capacity;
+	}
+
+	void Arena::clear() {
+		_used = 0;
+		_allocations = 0;
+	}
+
+	std::size_t Arena::capacity() const {
+		return _capacity;
+	}
+
+	std::size_t Arena::used() const {
+		return _used;
+	}
+
+	std::size_t Arena::allocations() const {
+		return _allocations;
+	}
+
+	Arena* Arena::find(const void* ptr) {
+		if(arena_count.load(std::memory_order_acquire) == 0)
+			return nullptr;
+		ArenasLock lock;
+		for(Arena* arena = arenas; arena != nullptr; arena = arena->next_arena)
+			if(arena->contains(ptr))
+				return arena;
+		return nullptr;
+	}
+
+	Arena::~Arena() {
+		{
+			ArenasLock lock;
+			Arena** arena = &arenas;
+			while(*arena != this)
+				arena = &(*arena)->next_arena;
+			*arena = next_arena;
+			arena_count--;
+		}
+		if(active_arena == this)
+			active_arena = nullptr;
+#ifndef PIXLED_NO_HEAP
+		if(owned)
+			delete[] buffer;
+#endif
+	}
+
+	ArenaScope::ArenaScope(Arena& arena)
+		: previous(active_arena) {
+			active_arena = &arena;
+		}
+
+	ArenaScope::~ArenaScope() {
+		active_arena = previous;
+	}
+
+	namespace detail {
+		void* allocate_function(std::size_t size) {
+			if(active_arena != nullptr) {
+				std::size_t used = active_arena->used();
+				void* ptr = active_arena->allocate(size);
+				if(ptr != nullptr) {
+					count(stats.arena_allocations, 1);
+					count(stats.arena_bytes, active_arena->used() - used);
+					return ptr;
+				}
+			}
+#ifdef PIXLED_NO_HEAP
+			std::abort();
+#else
+			count(stats.heap_allocations, 1);
+			count(stats.heap_bytes, size);
+			return ::operator new(size);
+#endif
+		}
+
+		void free_function(void* ptr) {
+			if(ptr == nullptr || Arena::find(ptr) != nullptr)
+				return;
+#ifndef PIXLED_NO_HEAP
+			count(stats.heap_deallocations, 1);
+			::operator delete(ptr);
+#endif
+		}
+	}
+}
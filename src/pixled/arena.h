@@ -0,0 +1,268 @@
+#ifndef PIXLED_ARENA_H
+#define PIXLED_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include "config.h"
+
+namespace pixled {
+	/**
+	 * Counters of the dynamic allocations of base::Function instances, and
+	 * of the storage of their variable-size arguments (see
+	 * detail::ArenaAllocator).
+	 *
+	 * Counters are cumulative since the start of the program, or since the
+	 * last call to resetAllocationStats(), and count the allocations of all
+	 * the threads.
+	 */
+	struct AllocationStats {
+		/**
+		 * Count of base::Function instances allocated on the heap.
+		 */
+		std::size_t heap_allocations;
+		/**
+		 * Total size of the base::Function instances allocated on the
+		 * heap, in bytes.
+		 */
+		std::size_t heap_bytes;
+		/**
+		 * Count of base::Function instances allocated in an Arena.
+		 */
+		std::size_t arena_allocations;
+		/**
+		 * Total size of the base::Function instances allocated in an
+		 * Arena, in bytes, including alignment padding.
+		 */
+		std::size_t arena_bytes;
+		/**
+		 * Count of base::Function instances freed from the heap.
+		 */
+		std::size_t heap_deallocations;
+	};
+
+	/**
+	 * Returns a snapshot of the current allocation counters.
+	 *
+	 * @return allocation counters
+	 */
+	AllocationStats allocationStats();
+
+	/**
+	 * Resets all the allocation counters to 0.
+	 */
+	void resetAllocationStats();
+
+	/**
+	 * A memory region in which base::Function instances can be allocated
+	 * contiguously.
+	 *
+	 * By default, each base::Function copy (e.g. when it is wrapped in a
+	 * FctWrapper) is individually allocated on the heap. When an Arena is
+	 * activated with an ArenaScope, base::Function instances are instead
+	 * allocated one after the other in the Arena, in the order of their
+	 * construction. Since a Function is always allocated before its
+	 * arguments, a copied animation graph is stored contiguously in
+	 * topological order.
+	 *
+	 * Deleting a base::Function allocated in an Arena does nothing: the
+	 * memory of all the Functions is freed at once when the Arena is
+	 * cleared or destroyed. The Arena must so outlive all the Functions
+	 * allocated in it.
+	 *
+	 * When the Arena is full, Functions are allocated on the heap. In
+	 * heap-free mode (see PIXLED_NO_HEAP), Functions can only be allocated in
+	 * an Arena built from a user provided buffer, and the program is aborted
+	 * if no Arena is active or if the active Arena is full.
+	 *
+	 * Functions can be copied and destroyed from any thread: the list of
+	 * live Arenas used to free Functions is guarded by a lock, and Arenas
+	 * are activated per thread (see ArenaScope). An Arena itself is not
+	 * synchronized, so it must only be active on one thread at a time.
+	 *
+	 * ```cpp
+	 * pixled::Arena arena(4096);
+	 * {
+	 * 	pixled::ArenaScope scope(arena);
+	 * 	// All the nodes of the sequence are allocated in the arena
+	 * 	pixled::Sequence anim({
+	 * 		{anim1, 20},
+	 * 		{anim2, 20}
+	 * 		});
+	 * 	...
+	 * }
+	 * ```
+	 */
+	class Arena {
+		private:
+			std::uint8_t* buffer;
+			std::size_t _capacity;
+			bool owned;
+			std::size_t _used = 0;
+			std::size_t _allocations = 0;
+
+			Arena* next_arena = nullptr;
+
+			void link();
+
+		public:
+#ifndef PIXLED_NO_HEAP
+			/**
+			 * Arena constructor.
+			 *
+			 * A buffer of `capacity` bytes is allocated on the heap.
+			 *
+			 * @param capacity arena size in bytes
+			 */
+			Arena(std::size_t capacity);
+#endif
+			/**
+			 * Arena constructor.
+			 *
+			 * The arena uses the provided buffer, that is not owned by the
+			 * Arena (e.g. a static buffer).
+			 *
+			 * @param buffer arena memory
+			 * @param capacity size of `buffer` in bytes
+			 */
+			Arena(void* buffer, std::size_t capacity);
+
+			Arena(const Arena&) = delete;
+			Arena& operator=(const Arena&) = delete;
+
+			/**
+			 * Allocates `size` bytes in the Arena.
+			 *
+			 * The returned memory is aligned for any fundamental type.
+			 *
+			 * @param size size to allocate, in bytes
+			 * @return allocated memory, or `nullptr` if the Arena is full
+			 */
+			void* allocate(std::size_t size);
+
+			/**
+			 * Returns true if and only if `ptr` points to the memory of
+			 * this Arena.
+			 *
+			 * @param ptr pointer to check
+			 * @return true iff `ptr` is in the Arena
+			 */
+			bool contains(const void* ptr) const;
+
+			/**
+			 * Frees all the allocations at once.
+			 *
+			 * All the Functions allocated in the Arena must have been
+			 * destroyed.
+			 */
+			void clear();
+
+			/**
+			 * Arena size, in bytes.
+			 *
+			 * @return capacity
+			 */
+			std::size_t capacity() const;
+			/**
+			 * Currently allocated size, in bytes.
+			 *
+			 * @return used size
+			 */
+			std::size_t used() const;
+			/**
+			 * Count of allocations performed in this Arena since it was
+			 * created or cleared.
+			 *
+			 * @return allocation count
+			 */
+			std::size_t allocations() const;
+
+			/**
+			 * Returns the Arena that contains `ptr`, if any.
+			 *
+			 * @param ptr pointer to check
+			 * @return Arena that contains `ptr`, or `nullptr`
+			 */
+			static Arena* find(const void* ptr);
+
+			~Arena();
+	};
+
+	/**
+	 * Activates an Arena for the lifetime of this scope.
+	 *
+	 * All the base::Function instances dynamically allocated while the
+	 * ArenaScope is alive are allocated in the Arena. Scopes can be nested:
+	 * the previously active Arena is restored when the scope is destroyed.
+	 *
+	 * The Arena is only activated on the calling thread: Functions
+	 * allocated by other threads, e.g. by ThreadPool workers, are not
+	 * allocated in it.
+	 */
+	class ArenaScope {
+		private:
+			Arena* previous;
+
+		public:
+			/**
+			 * Activates `arena`.
+			 *
+			 * @param arena arena in which Functions are allocated
+			 */
+			ArenaScope(Arena& arena);
+
+			ArenaScope(const ArenaScope&) = delete;
+			ArenaScope& operator=(const ArenaScope&) = delete;
+
+			/**
+			 * Restores the previously active Arena.
+			 */
+			~ArenaScope();
+	};
+
+	namespace detail {
+		/**
+		 * Allocates the memory of a base::Function, in the currently
+		 * active Arena if any, or else on the heap.
+		 */
+		void* allocate_function(std::size_t size);
+		/**
+		 * Frees the memory of a base::Function allocated with
+		 * allocate_function().
+		 */
+		void free_function(void* ptr);
+
+		/**
+		 * Standard allocator that allocates memory as a base::Function,
+		 * so that the containers of a Function (e.g. the items of a
+		 * Sequence) are stored in the active Arena with the Function
+		 * itself.
+		 *
+		 * @tparam T element type
+		 */
+		template<typename T>
+			struct ArenaAllocator {
+				typedef T value_type;
+
+				ArenaAllocator() = default;
+				template<typename U>
+					ArenaAllocator(const ArenaAllocator<U>&) {}
+
+				T* allocate(std::size_t n) {
+					return static_cast<T*>(allocate_function(n * sizeof(T)));
+				}
+				void deallocate(T* ptr, std::size_t) {
+					free_function(ptr);
+				}
+			};
+
+		template<typename T, typename U>
+			bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+				return true;
+			}
+		template<typename T, typename U>
+			bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+				return false;
+			}
+	}
+}
+#endif
@@ -21,6 +21,7 @@ namespace pixled {
 
 				public:
 					using Function<Plus<R, P1, P2>, R, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::PLUS_NODE;
 
 					R operator()(led l, time t) const override {
 						return this->template call<0>(l, t) + this->template call<1>(l, t);
@@ -143,6 +144,7 @@ namespace pixled {
 
 				public:
 					using Function<Minus<R, P1, P2>, R, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::MINUS_NODE;
 
 					R operator()(led l, time t) const override {
 						return this->template call<0>(l, t) - this->template call<1>(l, t);
@@ -265,6 +267,7 @@ namespace pixled {
 			class Multiplies : public Function<Multiplies<R, P1, P2>, R, P1, P2> {
 				public:
 					using Function<Multiplies<R, P1, P2>, R, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::MULTIPLIES_NODE;
 
 					R operator()(led l, time t) const override {
 						return this->template call<0>(l, t) * this->template call<1>(l, t);
@@ -391,6 +394,7 @@ namespace pixled {
 			class Divides : public Function<Divides<R, P1, P2>, R, P1, P2> {
 				public:
 					using Function<Divides<R, P1, P2>, R, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::DIVIDES_NODE;
 
 					R operator()(led l, time t) const override {
 						return this->template call<0>(l, t) / this->template call<1>(l, t);
@@ -513,6 +517,7 @@ namespace pixled {
 			class Modulus : public Function<Modulus<R, P1, P2>, R, P1, P2> {
 				public:
 					using Function<Modulus<R, P1, P2>, R, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::MODULUS_NODE;
 
 					R operator()(led l, time t) const override {
 						return this->template call<0>(l, t) % this->template call<1>(l, t);
@@ -6,6 +6,10 @@ namespace pixled { namespace chroma {
 		return color::hsb(this->call<0>(l, t), this->call<1>(l, t), this->call<2>(l, t));
 	}
 
+	color fixed_hsb::operator()(led l, time t) const {
+		return color::hsb(this->call<0>(l, t), this->call<1>(l, t), this->call<2>(l, t));
+	}
+
 	color rgb::operator()(led l, time t) const {
 		return color::rgb(this->call<0>(l, t), this->call<1>(l, t), this->call<2>(l, t));
 	}
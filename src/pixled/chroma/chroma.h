@@ -25,6 +25,27 @@ namespace pixled {
 		class hsb : public Function<hsb, color, float, float, float> {
 			public:
 				using Function<hsb, color, float, float, float>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::HSB_NODE;
+
+				color operator()(led l, time t) const override;
+		};
+
+		/**
+		 * Fixed-point HSB color function.
+		 *
+		 * Same as hsb, but with fixed-point parameters, so that colors are
+		 * computed without floating point arithmetic (see color::hsb(fixed,
+		 * fixed, fixed)).
+		 *
+		 * @retval color color instance
+		 * @param fixed hue in [0, 360]
+		 * @param fixed saturation in [0, 1]
+		 * @param fixed brightness in [0, 1]
+		 */
+		class fixed_hsb : public Function<fixed_hsb, color, fixed, fixed, fixed> {
+			public:
+				using Function<fixed_hsb, color, fixed, fixed, fixed>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::FIXED_HSB_NODE;
 
 				color operator()(led l, time t) const override;
 		};
@@ -46,6 +67,7 @@ namespace pixled {
 		class rgb : public Function<rgb, color, uint8_t, uint8_t, uint8_t> {
 			public:
 				using Function<rgb, color, uint8_t, uint8_t, uint8_t>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::RGB_NODE;
 
 				color operator()(led l, time t) const override;
 		};
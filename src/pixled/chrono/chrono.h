@@ -2,6 +2,7 @@
 #define PIXLED_TIME_TIME_H
 
 #include "../function.h"
+#include "../fixed.h"
 
 namespace pixled {
 	/**
@@ -10,14 +11,110 @@ namespace pixled {
 	namespace chrono {
 		/**
 		 * \Function that returns the current time.
+		 *
+		 * T is not periodic: its periodicity() is 0.
 		 */
 		class T : public base::Function<time> {
 			public:
+				static constexpr serialization::NODE_TYPE NODE = serialization::T_NODE;
+
 				time operator()(led l, time t) const override {
 					return t;
 				}
 
 				T* copy() const override {return new T;}
+
+				base::Function<time>* copyInline(void* buffer, std::size_t size) const override {
+					return detail::copy_inline(*this, buffer, size);
+				}
+
+				bool serialize(serialization::Writer& writer) const override {
+					return writer.node(
+							NODE, serialization::value_type<time>::id, nullptr, 0, 0);
+				}
+		};
+
+		/**
+		 * Position of the time `t` in the current period, in `[0, 1)`.
+		 *
+		 * The remainder of `t` by `period` is computed on integers before
+		 * the division, so that the result stays exact for arbitrarily
+		 * large times, e.g. when time steps are a fraction of a frame
+		 * (see Runtime::setTimeStep()).
+		 *
+		 * @param t time
+		 * @param period period, in time steps
+		 * @return phase in `[0, 1)`, or 0 if `period` is 0
+		 */
+		inline float phase(time t, time period) {
+			if(period == 0)
+				return 0;
+			return (float) (t % period) / period;
+		}
+
+		/**
+		 * \Function that returns the position of the current time in a
+		 * period, in `[0, 1)`.
+		 *
+		 * Phase can be used instead of `T() / period` as the parameter of
+		 * a periodic signal, such as `signal::Sine(Phase(period))`, to keep
+		 * a full precision whatever the current time.
+		 *
+		 * @retval float phase in `[0, 1)`
+		 * @param time period
+		 */
+		class Phase : public Function<Phase, float, time> {
+			public:
+				using Function<Phase, float, time>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::PHASE_NODE;
+
+				float operator()(led l, time t) const override {
+					return phase(t, this->call<0>(l, t));
+				}
+
+				time periodicity() const override {
+					return detail::period_periodicity(this->arg<0>(), this->argsPeriodicity());
+				}
+
+				/**
+				 * The phase changes at each time step, unless the period
+				 * is 0 or 1.
+				 */
+				bool mayChange(led l, time t) const override {
+					return this->call<0>(l, t) > 1 || this->arg<0>().mayChange(l, t);
+				}
+		};
+
+		/**
+		 * Fixed-point version of Phase, that can be used as the parameter
+		 * of signal::FixedSine and signal::FixedTriangle.
+		 *
+		 * @retval fixed phase in `[0, 1)`
+		 * @param time period
+		 */
+		class FixedPhase : public Function<FixedPhase, fixed, time> {
+			public:
+				using Function<FixedPhase, fixed, time>::Function;
+				static constexpr serialization::NODE_TYPE NODE = serialization::FIXED_PHASE_NODE;
+
+				fixed operator()(led l, time t) const override {
+					time period = this->call<0>(l, t);
+					if(period == 0)
+						return 0;
+					return fixed::fromRaw((std::int32_t) (
+								((std::uint64_t) (t % period) << fixed::FRACTIONAL_BITS) / period));
+				}
+
+				time periodicity() const override {
+					return detail::period_periodicity(this->arg<0>(), this->argsPeriodicity());
+				}
+
+				/**
+				 * See Phase::mayChange().
+				 */
+				bool mayChange(led l, time t) const override {
+					return this->call<0>(l, t) > 1 || this->arg<0>().mayChange(l, t);
+				}
 		};
 	}
 }
@@ -1,6 +1,26 @@
 #include "color.h"
 
 namespace pixled {
+	/**
+	 * Converts a component in [0, 1] to 16 bits.
+	 */
+	static std::uint16_t to_rgb16(double value) {
+		if(value <= 0.)
+			return 0;
+		if(value >= 1.)
+			return 65535;
+		return (std::uint16_t) (value * 65535 + .5);
+	}
+
+	void color::set_rgb(rgb_t& rgb, double r, double g, double b) {
+		rgb.r = (int) (r * 255);
+		rgb.g = (int) (g * 255);
+		rgb.b = (int) (b * 255);
+		rgb.r16 = to_rgb16(r);
+		rgb.g16 = to_rgb16(g);
+		rgb.b16 = to_rgb16(b);
+	}
+
 	void color::hsb_to_rgb(const hsb_t& hsb, rgb_t& rgb) {
 		double      hh, p, q, t, ff;
 		long        i;
@@ -16,9 +36,7 @@ namespace pixled {
 			r_out = brightness;
 			g_out = brightness;
 			b_out = brightness;
-			rgb.r = r_out * 255;
-			rgb.g = g_out * 255;
-			rgb.b = b_out * 255;
+			set_rgb(rgb, r_out, g_out, b_out);
 			return;
 		}
 
@@ -69,9 +87,78 @@ namespace pixled {
 				break;
 		}
 
-		rgb.r = r_out * 255;
-		rgb.g = g_out * 255;
-		rgb.b = b_out * 255;
+		set_rgb(rgb, r_out, g_out, b_out);
+	}
+
+	void color::hsb_to_rgb(fixed h, fixed s, fixed b, rgb_t& rgb) {
+		// Converts a value in [0, 1] to [0, 255]
+		auto to_rgb = [] (fixed value) {
+			return (value.raw() * 255) >> fixed::FRACTIONAL_BITS;
+		};
+		// Converts a value in [0, 1] to [0, 65535]
+		auto to_rgb16 = [] (fixed value) {
+			std::int32_t raw = value.raw();
+			return (std::uint16_t) (raw <= 0 ? 0 : raw >= fixed::ONE ? 65535 : raw);
+		};
+
+		if(s <= 0) {
+			rgb.r = to_rgb(b);
+			rgb.g = to_rgb(b);
+			rgb.b = to_rgb(b);
+			rgb.r16 = rgb.g16 = rgb.b16 = to_rgb16(b);
+			return;
+		}
+
+		std::int32_t hh = h.raw() % (360 * fixed::ONE);
+		if(hh < 0)
+			hh += 360 * fixed::ONE;
+		std::int32_t i = hh / (60 * fixed::ONE);
+		fixed ff = fixed::fromRaw((hh - i * 60 * fixed::ONE) / 60);
+		fixed p = b * (1 - s);
+		fixed q = b * (1 - s * ff);
+		fixed t = b * (1 - s * (1 - ff));
+
+		fixed r_out, g_out, b_out;
+		switch(i) {
+			case 0:
+				r_out = b;
+				g_out = t;
+				b_out = p;
+				break;
+			case 1:
+				r_out = q;
+				g_out = b;
+				b_out = p;
+				break;
+			case 2:
+				r_out = p;
+				g_out = b;
+				b_out = t;
+				break;
+			case 3:
+				r_out = p;
+				g_out = q;
+				b_out = b;
+				break;
+			case 4:
+				r_out = t;
+				g_out = p;
+				b_out = b;
+				break;
+			case 5:
+			default:
+				r_out = b;
+				g_out = p;
+				b_out = q;
+				break;
+		}
+
+		rgb.r = to_rgb(r_out);
+		rgb.g = to_rgb(g_out);
+		rgb.b = to_rgb(b_out);
+		rgb.r16 = to_rgb16(r_out);
+		rgb.g16 = to_rgb16(g_out);
+		rgb.b16 = to_rgb16(b_out);
 	}
 
 	void color::rgb_to_hsb(const rgb_t &rgb, hsb_t &hsb) {
@@ -118,24 +205,30 @@ namespace pixled {
 		_rgb.r = r;
 		_rgb.g = g;
 		_rgb.b = b;
+		_rgb.r16 = r * 257;
+		_rgb.g16 = g * 257;
+		_rgb.b16 = b * 257;
 		rgb_to_hsb(_rgb, _hsb);
 		return *this;
 	}
 
 	color& color::setRed(uint8_t r) {
 		_rgb.r = r;
+		_rgb.r16 = r * 257;
 		rgb_to_hsb(_rgb, _hsb);
 		return *this;
 	}
 
 	color& color::setGreen(uint8_t g) {
 		_rgb.g = g;
+		_rgb.g16 = g * 257;
 		rgb_to_hsb(_rgb, _hsb);
 		return *this;
 	}
 
 	color& color::setBlue(uint8_t b) {
 		_rgb.b = b;
+		_rgb.b16 = b * 257;
 		rgb_to_hsb(_rgb, _hsb);
 		return *this;
 	}
@@ -178,6 +271,15 @@ namespace pixled {
 		return c;
 	}
 
+	color color::hsb(fixed h, fixed s, fixed b) {
+		color c;
+		hsb_to_rgb(h, s, b, c._rgb);
+		c._hsb.h = static_cast<float>(h);
+		c._hsb.s = static_cast<float>(s);
+		c._hsb.b = static_cast<float>(b);
+		return c;
+	}
+
 	bool operator==(const color& c1, const color& c2) {
 		return c1.red() == c2.red() && c1.green() == c2.green() && c1.blue() == c1.blue();
 	}
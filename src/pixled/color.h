@@ -1,7 +1,9 @@
 #ifndef PIXLED_PIXEL_H
 #define PIXLED_PIXEL_H
 
+#include <cstdint>
 #include <iostream>
+#include "fixed.h"
 
 namespace pixled {
 	/**
@@ -10,9 +12,14 @@ namespace pixled {
 	class color {
 		private:
 			struct rgb_t {
-				int r;
-				int g;
-				int b;
+				std::uint8_t r;
+				std::uint8_t g;
+				std::uint8_t b;
+				// 16 bits components, that keep the precision of HSB
+				// colors
+				std::uint16_t r16;
+				std::uint16_t g16;
+				std::uint16_t b16;
 			};
 			rgb_t _rgb;
 
@@ -23,8 +30,10 @@ namespace pixled {
 			};
 			hsb_t _hsb;
 
+			static void set_rgb(rgb_t& rgb, double r, double g, double b);
 			static void rgb_to_hsb(const rgb_t& rgb, hsb_t& hsb);
 			static void hsb_to_rgb(const hsb_t& hsb, rgb_t& rgb);
+			static void hsb_to_rgb(fixed h, fixed s, fixed b, rgb_t& rgb);
 
 		public:
 			/**
@@ -40,6 +49,27 @@ namespace pixled {
 			 */
 			uint8_t blue() const {return _rgb.b;}
 
+			/**
+			 * Red color component, with a 16 bits precision, in [0,
+			 * 65535].
+			 *
+			 * When the color is built from HSB values, 16 bits
+			 * components keep low intensities that are lost in 8 bits
+			 * (see OutputStage::setDithering()). Otherwise, 8 bits
+			 * components are simply scaled.
+			 */
+			std::uint16_t red16() const {return _rgb.r16;}
+			/**
+			 * Green color component, with a 16 bits precision, in [0,
+			 * 65535].
+			 */
+			std::uint16_t green16() const {return _rgb.g16;}
+			/**
+			 * Blue color component, with a 16 bits precision, in [0,
+			 * 65535].
+			 */
+			std::uint16_t blue16() const {return _rgb.b16;}
+
 			/**
 			 * Hue, in [0, 360].
 			 */
@@ -125,6 +155,20 @@ namespace pixled {
 			 * @return color instance
 			 */
 			static color hsb(float h, float s, float b);
+			/**
+			 * Builds a color instance from fixed-point HSB values.
+			 *
+			 * The RGB components are computed with integer arithmetic
+			 * only, what is much faster than hsb(float, float, float)
+			 * on devices without FPU. HSB values are then only
+			 * converted to float to be stored.
+			 *
+			 * @param h hue
+			 * @param s saturation
+			 * @param b brightness
+			 * @return color instance
+			 */
+			static color hsb(fixed h, fixed s, fixed b);
 	};
 
 	/**
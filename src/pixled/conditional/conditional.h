@@ -33,6 +33,7 @@ namespace pixled {
 			class If : public Function<If<T>, T, bool, T, T> {
 				public:
 					using Function<If<T>, T, bool, T, T>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::IF_NODE;
 
 					T operator()(led l, time t) const override {
 						if(this->template call<0>(l, t))
@@ -56,6 +57,7 @@ namespace pixled {
 			class Equal : public Function<Equal<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<Equal<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::EQUAL_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) == this->template call<1>(l, t);
@@ -161,6 +163,7 @@ namespace pixled {
 			class NotEqual : public Function<NotEqual<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<NotEqual<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::NOT_EQUAL_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) != this->template call<1>(l, t);
@@ -266,6 +269,7 @@ namespace pixled {
 			class LessThan : public Function<LessThan<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<LessThan<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::LESS_THAN_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) < this->template call<1>(l, t);
@@ -371,6 +375,7 @@ namespace pixled {
 			class LessThanOrEqual : public Function<LessThanOrEqual<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<LessThanOrEqual<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::LESS_THAN_OR_EQUAL_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) <= this->template call<1>(l, t);
@@ -476,6 +481,7 @@ namespace pixled {
 			class GreaterThan : public Function<GreaterThan<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<GreaterThan<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::GREATER_THAN_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) > this->template call<1>(l, t);
@@ -581,6 +587,7 @@ namespace pixled {
 			class GreaterThanOrEqual : public Function<GreaterThanOrEqual<P1, P2>, bool, P1, P2> {
 				public:
 					using Function<GreaterThanOrEqual<P1, P2>, bool, P1, P2>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::GREATER_THAN_OR_EQUAL_NODE;
 
 					bool operator()(led l, time t) const override {
 						return this->template call<0>(l, t) >= this->template call<1>(l, t);
@@ -0,0 +1,84 @@
+#ifndef PIXLED_CONFIG_H
+#define PIXLED_CONFIG_H
+
+/**
+ * \file config.h
+ *
+ * Compile time configuration of the pixled library.
+ *
+ * All the options below can be defined from the build system (e.g. with the
+ * `PIXLED_NO_HEAP` CMake option, or with the corresponding ESP-IDF
+ * `menuconfig` entry), or by editing this file (e.g. for Arduino builds).
+ */
+
+#ifdef DOXYGEN_BUILD
+/**
+ * Heap-free build mode.
+ *
+ * When defined, the library does not perform any dynamic allocation:
+ * - base::Function instances can only be allocated in an Arena, that can
+ *   use a user provided static buffer (see ArenaScope). Allocating a
+ *   Function when no Arena is active or when the active Arena is full
+ *   aborts the program.
+ * - Sequence, Mapping, Scheduler and the textual animation parser use
+ *   fixed-capacity containers (see static_vector), which capacities are
+ *   defined by PIXLED_SEQUENCE_CAPACITY, PIXLED_MAPPING_CAPACITY,
+ *   PIXLED_SCHEDULER_CAPACITY and PIXLED_PARSER_CAPACITY.
+ * - Features that inherently require dynamic memory are disabled:
+ *   Mapping::sort(), Runtime::enableFrameCache() and the FrameCache
+ *   implementations, and Runtime::enableDirtyTracking().
+ *
+ * The size of all the pixled objects is so known at compile time (with
+ * `sizeof`), and the memory used by dynamically built animation graphs is
+ * known at init time with Arena::used().
+ */
+#define PIXLED_NO_HEAP
+#endif
+
+#ifdef DOXYGEN_BUILD
+/**
+ * Profiling build mode.
+ *
+ * When defined, the calls of all the base::Function nodes can be recorded by
+ * a Profiler, in order to find the expensive subtrees of an animation (see
+ * Runtime::setProfiler()).
+ *
+ * Profiling is disabled by default, in which case the instrumentation is
+ * completely compiled out. It is not available in heap-free mode.
+ */
+#define PIXLED_PROFILING
+#endif
+
+#ifndef PIXLED_SEQUENCE_CAPACITY
+/**
+ * Maximum count of items in a Sequence, in heap-free mode.
+ */
+#define PIXLED_SEQUENCE_CAPACITY 16
+#endif
+
+#ifndef PIXLED_MAPPING_CAPACITY
+/**
+ * Maximum count of leds stored in an explicit Mapping, in heap-free mode.
+ *
+ * Implicit mappings (see Mapping::implicitGrid()) do not store any led, and
+ * so are not limited.
+ */
+#define PIXLED_MAPPING_CAPACITY 256
+#endif
+
+#ifndef PIXLED_PARSER_CAPACITY
+/**
+ * Maximum count of pending arguments while parsing a textual animation (see
+ * parse()), in heap-free mode.
+ */
+#define PIXLED_PARSER_CAPACITY 32
+#endif
+
+#ifndef PIXLED_SCHEDULER_CAPACITY
+/**
+ * Maximum count of Runtimes driven by a Scheduler, in heap-free mode.
+ */
+#define PIXLED_SCHEDULER_CAPACITY 8
+#endif
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef PIXLED_CONTAINERS_H
+#define PIXLED_CONTAINERS_H
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "config.h"
+#include "arena.h"
+
+namespace pixled {
+	/**
+	 * A vector-like container with a fixed capacity, that stores its
+	 * elements inline and so never allocates dynamic memory.
+	 *
+	 * Only the subset of the `std::vector` interface used by pixled is
+	 * provided. Exceeding the capacity aborts the program.
+	 *
+	 * @tparam T element type
+	 * @tparam N capacity
+	 */
+	template<typename T, std::size_t N>
+		class static_vector {
+			private:
+				typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];
+				std::size_t _size = 0;
+
+				void check_capacity(std::size_t size) const {
+					if(size > N)
+						std::abort();
+				}
+
+			public:
+				/**
+				 * Element type.
+				 */
+				typedef T value_type;
+				/**
+				 * Iterator type.
+				 */
+				typedef T* iterator;
+				/**
+				 * Constant iterator type.
+				 */
+				typedef const T* const_iterator;
+
+				/**
+				 * Initializes an empty static_vector.
+				 */
+				static_vector() {}
+
+				/**
+				 * Initializes a static_vector with `count` copies of
+				 * `value`.
+				 */
+				static_vector(std::size_t count, const T& value = T()) {
+					resize(count, value);
+				}
+
+				/**
+				 * static_vector copy constructor.
+				 */
+				static_vector(const static_vector& other) {
+					for(const T& item : other)
+						push_back(item);
+				}
+
+				/**
+				 * static_vector move constructor.
+				 */
+				static_vector(static_vector&& other) {
+					for(T& item : other)
+						push_back(std::move(item));
+					other.clear();
+				}
+
+				/**
+				 * static_vector copy assignment.
+				 */
+				static_vector& operator=(const static_vector& other) {
+					if(this != &other) {
+						clear();
+						for(const T& item : other)
+							push_back(item);
+					}
+					return *this;
+				}
+
+				/**
+				 * static_vector move assignment.
+				 */
+				static_vector& operator=(static_vector&& other) {
+					if(this != &other) {
+						clear();
+						for(T& item : other)
+							push_back(std::move(item));
+						other.clear();
+					}
+					return *this;
+				}
+
+				/**
+				 * Appends a copy of `value`.
+				 */
+				void push_back(const T& value) {
+					emplace_back(value);
+				}
+
+				/**
+				 * Appends `value`.
+				 */
+				void push_back(T&& value) {
+					emplace_back(std::move(value));
+				}
+
+				/**
+				 * Appends an element built in place from `args`.
+				 */
+				template<typename... Args>
+					void emplace_back(Args&&... args) {
+						check_capacity(_size + 1);
+						new (&storage[_size]) T(std::forward<Args>(args)...);
+						_size++;
+					}
+
+				/**
+				 * Resizes the container, appending copies of `value` if
+				 * necessary.
+				 */
+				void resize(std::size_t size, const T& value = T()) {
+					check_capacity(size);
+					while(_size > size)
+						pop_back();
+					while(_size < size)
+						push_back(value);
+				}
+
+				/**
+				 * Replaces the content of the container by `count` copies
+				 * of `value`.
+				 */
+				void assign(std::size_t count, const T& value) {
+					clear();
+					resize(count, value);
+				}
+
+				/**
+				 * Checks the capacity: no memory is ever reserved.
+				 */
+				void reserve(std::size_t size) {
+					check_capacity(size);
+				}
+
+				/**
+				 * Removes the last element.
+				 */
+				void pop_back() {
+					_size--;
+					(*this)[_size].~T();
+				}
+
+				/**
+				 * Removes all the elements.
+				 */
+				void clear() {
+					while(_size > 0)
+						pop_back();
+				}
+
+				/**
+				 * Element count.
+				 */
+				std::size_t size() const {return _size;}
+				/**
+				 * Maximum element count.
+				 */
+				static constexpr std::size_t capacity() {return N;}
+				/**
+				 * True iff the container is empty.
+				 */
+				bool empty() const {return _size == 0;}
+
+				/**
+				 * Element access.
+				 */
+				T& operator[](std::size_t i) {
+					return *reinterpret_cast<T*>(&storage[i]);
+				}
+				/**
+				 * Element access.
+				 */
+				const T& operator[](std::size_t i) const {
+					return *reinterpret_cast<const T*>(&storage[i]);
+				}
+				/**
+				 * First element.
+				 */
+				T& front() {return (*this)[0];}
+				/**
+				 * First element.
+				 */
+				const T& front() const {return (*this)[0];}
+				/**
+				 * Last element.
+				 */
+				T& back() {return (*this)[_size-1];}
+				/**
+				 * Last element.
+				 */
+				const T& back() const {return (*this)[_size-1];}
+
+				/**
+				 * Pointer to the elements.
+				 */
+				T* data() {return reinterpret_cast<T*>(storage);}
+				/**
+				 * Pointer to the elements.
+				 */
+				const T* data() const {return reinterpret_cast<const T*>(storage);}
+
+				/**
+				 * Iterator to the first element.
+				 */
+				iterator begin() {return data();}
+				/**
+				 * Iterator past the last element.
+				 */
+				iterator end() {return data() + _size;}
+				/**
+				 * Iterator to the first element.
+				 */
+				const_iterator begin() const {return data();}
+				/**
+				 * Iterator past the last element.
+				 */
+				const_iterator end() const {return data() + _size;}
+
+				~static_vector() {
+					clear();
+				}
+		};
+
+#ifdef PIXLED_NO_HEAP
+	/**
+	 * Vector type used by pixled containers: a static_vector of capacity `N`
+	 * in heap-free mode (see PIXLED_NO_HEAP), or an `std::vector`
+	 * otherwise.
+	 */
+	template<typename T, std::size_t N>
+		using bounded_vector = static_vector<T, N>;
+
+	/**
+	 * Vector type used by the containers of base::Function instances: a
+	 * static_vector of capacity `N` in heap-free mode (see
+	 * PIXLED_NO_HEAP), or an `std::vector` allocated in the active Arena
+	 * otherwise (see detail::ArenaAllocator).
+	 */
+	template<typename T, std::size_t N>
+		using arena_vector = static_vector<T, N>;
+#else
+	/**
+	 * Vector type used by pixled containers: a static_vector of capacity `N`
+	 * in heap-free mode (see PIXLED_NO_HEAP), or an `std::vector`
+	 * otherwise.
+	 */
+	template<typename T, std::size_t N>
+		using bounded_vector = std::vector<T>;
+
+	/**
+	 * Vector type used by the containers of base::Function instances: a
+	 * static_vector of capacity `N` in heap-free mode (see
+	 * PIXLED_NO_HEAP), or an `std::vector` allocated in the active Arena
+	 * otherwise (see detail::ArenaAllocator).
+	 */
+	template<typename T, std::size_t N>
+		using arena_vector = std::vector<T, detail::ArenaAllocator<T>>;
+#endif
+}
+#endif
@@ -0,0 +1,248 @@
+#ifndef PIXLED_FIXED_H
+#define PIXLED_FIXED_H
+
+#include <cstdint>
+#include <type_traits>
+
+namespace pixled {
+	/**
+	 * Signed Q16.16 fixed-point number.
+	 *
+	 * fixed is a fundamental type that can be used instead of `float` as
+	 * the return type of \Functions on microcontrollers without FPU: all
+	 * its operations are performed with integer arithmetic. Values are
+	 * contained in `[-32768, 32768)`, with a precision of `1/65536`.
+	 *
+	 * fixed can be implicitly built from any arithmetic value, so that
+	 * constants can be passed to \Functions that take fixed arguments, and
+	 * so that arithmetic operators between fixed \Functions and constants
+	 * return fixed \Functions. The conversion to `float` is explicit.
+	 *
+	 * ```cpp
+	 * using namespace pixled;
+	 *
+	 * auto hue = fixed(180) * (1 + FixedSine(Cast<fixed>(T() % 40) / 40));
+	 * auto animation = fixed_hsb(hue, 1, 1);
+	 * ```
+	 *
+	 * \note
+	 * Floating point values are only converted when a fixed is built, so
+	 * fixed constants should be preferred to `float` constants in
+	 * animations that are evaluated on FPU-less devices.
+	 */
+	class fixed {
+		private:
+			std::int32_t value;
+
+			struct raw_tag {};
+			constexpr fixed(std::int32_t value, raw_tag) : value(value) {}
+
+		public:
+			/**
+			 * Count of bits used to represent the fractional part.
+			 */
+			static constexpr int FRACTIONAL_BITS = 16;
+			/**
+			 * Raw value of 1.
+			 */
+			static constexpr std::int32_t ONE = 1 << FRACTIONAL_BITS;
+
+			/**
+			 * fixed default constructor.
+			 *
+			 * The value is initialized to 0.
+			 */
+			constexpr fixed() : value(0) {}
+
+			/**
+			 * Builds a fixed from an integral `value`.
+			 *
+			 * @param value integral value
+			 */
+			template<typename T,
+				typename std::enable_if<std::is_integral<T>::value, bool>::type = true>
+				constexpr fixed(T value)
+				: value(static_cast<std::int32_t>(value) * ONE) {}
+
+			/**
+			 * Builds a fixed from a floating point `value`, rounded to
+			 * the nearest representable value.
+			 *
+			 * @param value floating point value
+			 */
+			template<typename T,
+				typename std::enable_if<std::is_floating_point<T>::value, bool>::type = true>
+				constexpr fixed(T value)
+				: value(static_cast<std::int32_t>(value * ONE + (value < 0 ? -.5f : .5f))) {}
+
+			/**
+			 * Builds a fixed from its raw Q16.16 representation.
+			 *
+			 * @param raw raw value, i.e. the value multiplied by ONE
+			 * @return fixed instance
+			 */
+			static constexpr fixed fromRaw(std::int32_t raw) {
+				return fixed(raw, raw_tag());
+			}
+
+			/**
+			 * Raw Q16.16 representation of this fixed.
+			 *
+			 * @return value multiplied by ONE
+			 */
+			constexpr std::int32_t raw() const {
+				return value;
+			}
+
+			/**
+			 * Converts this fixed to float.
+			 */
+			explicit constexpr operator float() const {
+				return static_cast<float>(value) / ONE;
+			}
+
+			/**
+			 * Adds `f` to this fixed.
+			 *
+			 * @param f value to add
+			 * @return reference to this fixed
+			 */
+			fixed& operator+=(fixed f) {
+				value += f.value;
+				return *this;
+			}
+
+			/**
+			 * Substracts `f` from this fixed.
+			 *
+			 * @param f value to substract
+			 * @return reference to this fixed
+			 */
+			fixed& operator-=(fixed f) {
+				value -= f.value;
+				return *this;
+			}
+
+			/**
+			 * Multiplies this fixed by `f`.
+			 *
+			 * @param f factor
+			 * @return reference to this fixed
+			 */
+			fixed& operator*=(fixed f) {
+				value = static_cast<std::int32_t>(
+						(static_cast<std::int64_t>(value) * f.value) >> FRACTIONAL_BITS);
+				return *this;
+			}
+
+			/**
+			 * Divides this fixed by `f`, that must not be 0.
+			 *
+			 * @param f divisor
+			 * @return reference to this fixed
+			 */
+			fixed& operator/=(fixed f) {
+				value = static_cast<std::int32_t>(
+						(static_cast<std::int64_t>(value) * ONE) / f.value);
+				return *this;
+			}
+
+			/**
+			 * Replaces this fixed by the remainder of its division by
+			 * `f`, that must not be 0. As for `std::fmod`, the result has
+			 * the sign of this fixed.
+			 *
+			 * @param f divisor
+			 * @return reference to this fixed
+			 */
+			fixed& operator%=(fixed f) {
+				value %= f.value;
+				return *this;
+			}
+	};
+
+	/**
+	 * @return `f1+f2`
+	 */
+	inline fixed operator+(fixed f1, fixed f2) {
+		return f1 += f2;
+	}
+
+	/**
+	 * @return `f1-f2`
+	 */
+	inline fixed operator-(fixed f1, fixed f2) {
+		return f1 -= f2;
+	}
+
+	/**
+	 * @return `-f`
+	 */
+	inline fixed operator-(fixed f) {
+		return fixed::fromRaw(-f.raw());
+	}
+
+	/**
+	 * @return `f1*f2`
+	 */
+	inline fixed operator*(fixed f1, fixed f2) {
+		return f1 *= f2;
+	}
+
+	/**
+	 * @return `f1/f2`
+	 */
+	inline fixed operator/(fixed f1, fixed f2) {
+		return f1 /= f2;
+	}
+
+	/**
+	 * @return remainder of `f1/f2`
+	 */
+	inline fixed operator%(fixed f1, fixed f2) {
+		return f1 %= f2;
+	}
+
+	/**
+	 * @return true iff `f1 == f2`
+	 */
+	inline bool operator==(fixed f1, fixed f2) {
+		return f1.raw() == f2.raw();
+	}
+
+	/**
+	 * @return true iff `f1 != f2`
+	 */
+	inline bool operator!=(fixed f1, fixed f2) {
+		return f1.raw() != f2.raw();
+	}
+
+	/**
+	 * @return true iff `f1 < f2`
+	 */
+	inline bool operator<(fixed f1, fixed f2) {
+		return f1.raw() < f2.raw();
+	}
+
+	/**
+	 * @return true iff `f1 <= f2`
+	 */
+	inline bool operator<=(fixed f1, fixed f2) {
+		return f1.raw() <= f2.raw();
+	}
+
+	/**
+	 * @return true iff `f1 > f2`
+	 */
+	inline bool operator>(fixed f1, fixed f2) {
+		return f1.raw() > f2.raw();
+	}
+
+	/**
+	 * @return true iff `f1 >= f2`
+	 */
+	inline bool operator>=(fixed f1, fixed f2) {
+		return f1.raw() >= f2.raw();
+	}
+}
+#endif
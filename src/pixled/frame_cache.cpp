@@ -0,0 +1,277 @@
+#include "frame_cache.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <cstring>
+
+namespace pixled {
+	FrameCache::FrameCache(time period, std::size_t led_count)
+		: _period(period), _led_count(led_count), stored(period, false) {
+		}
+
+	void FrameCache::markStored(time slot) {
+		if(!stored[slot]) {
+			stored[slot] = true;
+			stored_count++;
+		}
+	}
+
+	time FrameCache::period() const {
+		return _period;
+	}
+
+	std::size_t FrameCache::ledCount() const {
+		return _led_count;
+	}
+
+	std::size_t FrameCache::frameSize() const {
+		return 3*_led_count;
+	}
+
+	bool FrameCache::contains(time t) const {
+		return stored[t % _period];
+	}
+
+	bool FrameCache::complete() const {
+		return stored_count == _period;
+	}
+
+	RawFrameCache::RawFrameCache(time period, std::size_t led_count)
+		: FrameCache(period, led_count), frames(3*led_count*period) {
+		}
+
+	void RawFrameCache::store(time t, const std::uint8_t* frame) {
+		time slot = t % period();
+		std::memcpy(frames.data() + slot * frameSize(), frame, frameSize());
+		markStored(slot);
+	}
+
+	const std::uint8_t* RawFrameCache::load(time t) const {
+		return frames.data() + (t % period()) * frameSize();
+	}
+
+	std::size_t RawFrameCache::memory() const {
+		return frames.size();
+	}
+
+	/*
+	 * Each run starts with a header byte: the two most significant bits
+	 * encode the run type, and the 6 remaining bits the led count. Counts
+	 * greater or equal to RUN_COUNT_MAX are followed by a varint that
+	 * encodes count - RUN_COUNT_MAX.
+	 */
+	static const std::size_t RUN_COUNT_MAX = 0x3f;
+	/*
+	 * Frames that use a palette start with the palette size minus one,
+	 * followed by the rgb values of the palette.
+	 */
+	static const std::size_t PALETTE_SIZE_MAX = 256;
+
+	static void write_run(std::vector<std::uint8_t>& data, DeltaFrameCache::RUN_TYPE type, std::size_t count) {
+		if(count < RUN_COUNT_MAX) {
+			data.push_back(type << 6 | count);
+			return;
+		}
+		data.push_back(type << 6 | RUN_COUNT_MAX);
+		count -= RUN_COUNT_MAX;
+		while(count >= 0x80) {
+			data.push_back(0x80 | (count & 0x7f));
+			count >>= 7;
+		}
+		data.push_back(count);
+	}
+
+	static const std::uint8_t* read_run(const std::uint8_t* data, DeltaFrameCache::RUN_TYPE& type, std::size_t& count) {
+		type = (DeltaFrameCache::RUN_TYPE) (*data >> 6);
+		count = *data & RUN_COUNT_MAX;
+		data++;
+		if(count == RUN_COUNT_MAX) {
+			std::size_t shift = 0;
+			while(*data & 0x80) {
+				count += (std::size_t) (*data & 0x7f) << shift;
+				shift += 7;
+				data++;
+			}
+			count += (std::size_t) *data << shift;
+			data++;
+		}
+		return data;
+	}
+
+	static bool same_rgb(const std::uint8_t* c1, const std::uint8_t* c2) {
+		return c1[0] == c2[0] && c1[1] == c2[1] && c1[2] == c2[2];
+	}
+
+	DeltaFrameCache::DeltaFrameCache(time period, std::size_t led_count, time keyframe_interval)
+		: FrameCache(period, led_count),
+		keyframe_interval(keyframe_interval == 0 ? 1 : keyframe_interval),
+		entries(period), decoded(3*led_count), decoded_slot(period) {
+		}
+
+	void DeltaFrameCache::encode(time slot, const std::uint8_t* frame, const std::uint8_t* reference) {
+		std::size_t n = ledCount();
+		auto unchanged = [frame, reference] (std::size_t i) {
+			return reference != nullptr && same_rgb(frame + 3*i, reference + 3*i);
+		};
+		auto rgb_key = [frame] (std::size_t i) {
+			return (std::uint32_t) frame[3*i] << 16 | frame[3*i+1] << 8 | frame[3*i+2];
+		};
+
+		// Splits the frame in runs
+		runs.clear();
+		std::size_t copied_leds = 0;
+		std::size_t i = 0;
+		while(i < n) {
+			std::size_t j = i + 1;
+			if(unchanged(i)) {
+				while(j < n && unchanged(j))
+					j++;
+				runs.push_back({SKIP_RUN, i, j});
+			} else {
+				while(j < n && same_rgb(frame + 3*j, frame + 3*i))
+					j++;
+				if(j - i > 1) {
+					runs.push_back({FILL_RUN, i, j});
+				} else {
+					// Extends the copy run until an unchanged led or a run of
+					// at least two identical leds
+					while(j < n && !unchanged(j)
+							&& !(j + 1 < n && same_rgb(frame + 3*j, frame + 3*(j+1))))
+						j++;
+					runs.push_back({COPY_RUN, i, j});
+					copied_leds += j - i;
+				}
+			}
+			i = j;
+		}
+
+		// Builds a palette of the copied colors, if it saves memory
+		palette.clear();
+		bool use_palette = true;
+		for(auto& run : runs) {
+			if(run.type != COPY_RUN)
+				continue;
+			for(std::size_t j = run.begin; j < run.end && use_palette; j++) {
+				if(palette.count(rgb_key(j)) == 0) {
+					if(palette.size() == PALETTE_SIZE_MAX)
+						use_palette = false;
+					else
+						palette.insert({rgb_key(j), palette.size()});
+				}
+			}
+		}
+		use_palette = use_palette && palette.size() > 0
+			&& 1 + 3*palette.size() + copied_leds < 3*copied_leds;
+
+		entries[slot].palette = use_palette;
+		if(use_palette) {
+			std::size_t palette_offset = data.size() + 1;
+			data.push_back(palette.size() - 1);
+			data.resize(palette_offset + 3*palette.size());
+			for(auto& color : palette) {
+				std::uint8_t* rgb = &data[palette_offset + 3*color.second];
+				rgb[0] = color.first >> 16;
+				rgb[1] = color.first >> 8;
+				rgb[2] = color.first;
+			}
+		}
+
+		for(auto& run : runs) {
+			write_run(data, run.type, run.end - run.begin);
+			switch(run.type) {
+				case SKIP_RUN:
+					break;
+				case FILL_RUN:
+					data.insert(data.end(), frame + 3*run.begin, frame + 3*run.begin+3);
+					break;
+				case COPY_RUN:
+					if(use_palette) {
+						for(std::size_t j = run.begin; j < run.end; j++)
+							data.push_back(palette.at(rgb_key(j)));
+					} else {
+						data.insert(data.end(), frame + 3*run.begin, frame + 3*run.end);
+					}
+					break;
+			}
+		}
+	}
+
+	void DeltaFrameCache::decode(time slot) const {
+		std::uint8_t* frame = decoded.data();
+		if(entries[slot].keyframe)
+			std::memset(frame, 0, frameSize());
+		const std::uint8_t* run = data.data() + entries[slot].offset;
+		const std::uint8_t* palette = nullptr;
+		if(entries[slot].palette) {
+			palette = run + 1;
+			run = palette + 3 * ((std::size_t) *run + 1);
+		}
+		std::size_t i = 0;
+		while(i < ledCount()) {
+			RUN_TYPE type;
+			std::size_t count;
+			run = read_run(run, type, count);
+			switch(type) {
+				case SKIP_RUN:
+					break;
+				case FILL_RUN:
+					for(std::size_t j = i; j < i + count; j++) {
+						frame[3*j] = run[0];
+						frame[3*j+1] = run[1];
+						frame[3*j+2] = run[2];
+					}
+					run += 3;
+					break;
+				case COPY_RUN:
+					if(palette != nullptr) {
+						for(std::size_t j = i; j < i + count; j++) {
+							const std::uint8_t* rgb = palette + 3 * *run++;
+							frame[3*j] = rgb[0];
+							frame[3*j+1] = rgb[1];
+							frame[3*j+2] = rgb[2];
+						}
+					} else {
+						std::memcpy(frame + 3*i, run, 3*count);
+						run += 3*count;
+					}
+					break;
+			}
+			i += count;
+		}
+		decoded_slot = slot;
+	}
+
+	void DeltaFrameCache::store(time t, const std::uint8_t* frame) {
+		time slot = t % period();
+		bool keyframe = slot % keyframe_interval == 0 || decoded_slot + 1 != slot;
+
+		entries[slot].offset = data.size();
+		entries[slot].keyframe = keyframe;
+		encode(slot, frame, keyframe ? nullptr : decoded.data());
+
+		std::memcpy(decoded.data(), frame, frameSize());
+		decoded_slot = slot;
+		markStored(slot);
+		if(complete())
+			data.shrink_to_fit();
+	}
+
+	const std::uint8_t* DeltaFrameCache::load(time t) const {
+		time slot = t % period();
+		if(slot != decoded_slot) {
+			// Finds the first frame to decode, either a keyframe or the
+			// frame that follows the currently decoded frame
+			time first = slot;
+			while(!entries[first].keyframe && decoded_slot + 1 != first)
+				first--;
+			for(time s = first; s <= slot; s++)
+				decode(s);
+		}
+		return decoded.data();
+	}
+
+	std::size_t DeltaFrameCache::memory() const {
+		return data.size() + entries.size() * sizeof(entry) + decoded.size();
+	}
+}
+#endif
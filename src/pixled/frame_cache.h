@@ -0,0 +1,244 @@
+#ifndef PIXLED_FRAME_CACHE_H
+#define PIXLED_FRAME_CACHE_H
+
+#include "config.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "function.h"
+
+namespace pixled {
+	/**
+	 * Encoding used to store frames in a FrameCache.
+	 */
+	enum FRAME_ENCODING {
+		/**
+		 * Uncompressed frames: see RawFrameCache.
+		 */
+		RAW_FRAMES,
+		/**
+		 * Frames compressed as run-length encoded deltas against the
+		 * previous frame: see DeltaFrameCache.
+		 */
+		DELTA_FRAMES
+	};
+
+	/**
+	 * Stores all the frames of one period of a periodic animation.
+	 *
+	 * Frames are loaded and stored as raw rgb buffers, using the same layout
+	 * as Output::writeFrame(), so that a cached frame can be sent as is to an
+	 * Output. The actual storage format depends on the implementation.
+	 *
+	 * The frame at time `t` is stored in the slot `t % period()`: once all the
+	 * slots have been stored, the animation does not need to be evaluated
+	 * anymore.
+	 */
+	class FrameCache {
+		private:
+			time _period;
+			std::size_t _led_count;
+			std::vector<bool> stored;
+			std::size_t stored_count = 0;
+
+		protected:
+			/**
+			 * Marks the frame slot as stored.
+			 *
+			 * @param slot frame slot, in `[0, period())`
+			 */
+			void markStored(time slot);
+
+		public:
+			/**
+			 * FrameCache constructor.
+			 *
+			 * @param period animation period, in time steps
+			 * @param led_count count of leds in each frame
+			 */
+			FrameCache(time period, std::size_t led_count);
+
+			/**
+			 * Animation period cached by this FrameCache.
+			 *
+			 * @return period
+			 */
+			time period() const;
+			/**
+			 * Count of leds in each frame.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+			/**
+			 * Size of a frame, in bytes.
+			 *
+			 * @return `3*ledCount()`
+			 */
+			std::size_t frameSize() const;
+
+			/**
+			 * Returns true if and only if the frame corresponding to time
+			 * `t` has already been stored.
+			 *
+			 * @param t time
+			 * @return true iff the frame at time `t` is available
+			 */
+			bool contains(time t) const;
+			/**
+			 * Returns true if and only if all the frames of the period have
+			 * been stored.
+			 *
+			 * @return true iff the cache is complete
+			 */
+			bool complete() const;
+
+			/**
+			 * Stores the frame corresponding to time `t`.
+			 *
+			 * The behavior is undefined if the frame is already contained
+			 * in the cache.
+			 *
+			 * @param t time
+			 * @param frame rgb frame of frameSize() bytes
+			 */
+			virtual void store(time t, const std::uint8_t* frame) = 0;
+			/**
+			 * Loads the frame corresponding to time `t`.
+			 *
+			 * The returned buffer is only valid until the next call to
+			 * store() or load(). The behavior is undefined if the frame is
+			 * not contained in the cache.
+			 *
+			 * @param t time
+			 * @return rgb frame of frameSize() bytes
+			 */
+			virtual const std::uint8_t* load(time t) const = 0;
+
+			/**
+			 * Memory used to store the frames, in bytes.
+			 *
+			 * @return frame storage size
+			 */
+			virtual std::size_t memory() const = 0;
+
+			virtual ~FrameCache() {}
+	};
+
+	/**
+	 * A FrameCache that stores uncompressed frames.
+	 *
+	 * Memory for all the frames is allocated at construction, and frames are
+	 * directly loaded from the storage without any copy.
+	 */
+	class RawFrameCache : public FrameCache {
+		private:
+			std::vector<std::uint8_t> frames;
+
+		public:
+			/**
+			 * RawFrameCache constructor.
+			 *
+			 * @param period animation period, in time steps
+			 * @param led_count count of leds in each frame
+			 */
+			RawFrameCache(time period, std::size_t led_count);
+
+			void store(time t, const std::uint8_t* frame) override;
+			const std::uint8_t* load(time t) const override;
+			std::size_t memory() const override;
+	};
+
+	/**
+	 * A FrameCache that stores compressed frames.
+	 *
+	 * Each frame is encoded as a delta against the previous frame, when the
+	 * previous frame was the last one stored or loaded, or else as a
+	 * keyframe, i.e. a delta against a black frame. A keyframe is also
+	 * forced every `keyframe_interval` slots, so that loading any frame never
+	 * requires to decode more than `keyframe_interval` deltas.
+	 *
+	 * A delta is a sequence of led runs, each encoded as:
+	 * - a _skip_ run, for leds that are unchanged from the previous frame;
+	 * - a _fill_ run, for consecutive leds that are set to the same color;
+	 * - a _copy_ run, followed by the raw rgb values of the leds.
+	 *
+	 * When the leds of the copy runs of a frame use at most 256 distinct
+	 * colors, the frame starts with a palette of those colors, and copy runs
+	 * only store a one byte palette index per led.
+	 *
+	 * Static regions and solid colors are so reduced to a few bytes, and
+	 * frames are decoded with copies only, so that sequentially loading
+	 * frames (as the Runtime does) costs a single delta per frame.
+	 */
+	class DeltaFrameCache : public FrameCache {
+		public:
+			/**
+			 * Type of a run of leds in an encoded frame.
+			 */
+			enum RUN_TYPE : std::uint8_t {
+				/**
+				 * Leds unchanged from the previous frame.
+				 */
+				SKIP_RUN = 0,
+				/**
+				 * Leds set to the same color.
+				 */
+				FILL_RUN = 1,
+				/**
+				 * Leds set to arbitrary colors.
+				 */
+				COPY_RUN = 2
+			};
+
+		private:
+			struct entry {
+				std::size_t offset;
+				bool keyframe;
+				bool palette;
+			};
+			struct run {
+				RUN_TYPE type;
+				std::size_t begin;
+				std::size_t end;
+			};
+
+			time keyframe_interval;
+			std::vector<std::uint8_t> data;
+			std::vector<entry> entries;
+
+			// Encoding buffers
+			std::vector<run> runs;
+			std::unordered_map<std::uint32_t, std::uint8_t> palette;
+
+			mutable std::vector<std::uint8_t> decoded;
+			mutable time decoded_slot;
+
+			void encode(time slot, const std::uint8_t* frame, const std::uint8_t* reference);
+			void decode(time slot) const;
+
+		public:
+			/**
+			 * DeltaFrameCache constructor.
+			 *
+			 * @param period animation period, in time steps
+			 * @param led_count count of leds in each frame
+			 * @param keyframe_interval maximum count of slots between two
+			 * keyframes, where 0 is handled as 1 (only keyframes)
+			 */
+			DeltaFrameCache(time period, std::size_t led_count, time keyframe_interval = 32);
+
+			void store(time t, const std::uint8_t* frame) override;
+			const std::uint8_t* load(time t) const override;
+			/**
+			 * Memory used by the encoded frames, their index and the decoding
+			 * buffer.
+			 */
+			std::size_t memory() const override;
+	};
+}
+#endif
+#endif
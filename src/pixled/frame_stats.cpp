@@ -0,0 +1,99 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+
+namespace pixled {
+	constexpr std::size_t FrameStats::WINDOW;
+
+	FrameStats::FrameStats(std::uint32_t frame_budget)
+		: _frame_budget(frame_budget) {
+		reset();
+	}
+
+	void FrameStats::setFrameBudget(std::uint32_t frame_budget) {
+		_frame_budget = frame_budget;
+	}
+
+	std::uint32_t FrameStats::frameBudget() const {
+		return _frame_budget;
+	}
+
+	void FrameStats::setCallback(Callback callback, void* user_data, unsigned long period) {
+		this->callback = callback;
+		this->user_data = user_data;
+		callback_period = period;
+	}
+
+	void FrameStats::record(
+			std::uint32_t render_time, std::uint32_t output_time, std::size_t led_count) {
+		std::size_t slot = _frames % WINDOW;
+		render_times[slot] = render_time;
+		output_times[slot] = output_time;
+		led_counts[slot] = (std::uint32_t) led_count;
+		_frames++;
+		if(_frame_budget > 0 && render_time + output_time > _frame_budget)
+			_dropped_frames++;
+		if(callback && callback_period > 0 && _frames % callback_period == 0)
+			callback(*this, user_data);
+	}
+
+	unsigned long FrameStats::frames() const {
+		return _frames;
+	}
+
+	unsigned long FrameStats::droppedFrames() const {
+		return _dropped_frames;
+	}
+
+	FrameStats::Percentiles FrameStats::percentiles(std::uint32_t* times) const {
+		std::size_t count = std::min<unsigned long>(_frames, WINDOW);
+		if(count == 0)
+			return {0, 0, 0};
+		Percentiles result;
+		std::uint32_t* p50 = times + (count - 1) / 2;
+		std::nth_element(times, p50, times + count);
+		result.p50 = *p50;
+		std::uint32_t* p99 = times + (count - 1) * 99 / 100;
+		std::nth_element(times, p99, times + count);
+		result.p99 = *p99;
+		result.max = *std::max_element(times, times + count);
+		return result;
+	}
+
+	FrameStats::Percentiles FrameStats::renderTimes() const {
+		std::uint32_t times[WINDOW];
+		std::copy(render_times, render_times + WINDOW, times);
+		return percentiles(times);
+	}
+
+	FrameStats::Percentiles FrameStats::outputTimes() const {
+		std::uint32_t times[WINDOW];
+		std::copy(output_times, output_times + WINDOW, times);
+		return percentiles(times);
+	}
+
+	FrameStats::Percentiles FrameStats::frameTimes() const {
+		std::uint32_t times[WINDOW];
+		for(std::size_t i = 0; i < WINDOW; i++)
+			times[i] = render_times[i] + output_times[i];
+		return percentiles(times);
+	}
+
+	double FrameStats::ledsPerSecond() const {
+		std::size_t count = std::min<unsigned long>(_frames, WINDOW);
+		double leds = 0;
+		double time = 0;
+		for(std::size_t i = 0; i < count; i++) {
+			leds += led_counts[i];
+			time += render_times[i] + output_times[i];
+		}
+		if(time == 0)
+			return 0;
+		return leds * 1e6 / time;
+	}
+
+	void FrameStats::reset() {
+		_frames = 0;
+		_dropped_frames = 0;
+	}
+}
@@ -0,0 +1,185 @@
+#ifndef PIXLED_FRAME_STATS_H
+#define PIXLED_FRAME_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace pixled {
+	/**
+	 * Frame timing and jitter statistics.
+	 *
+	 * When attached to a Runtime (see Runtime::setFrameStats()), the time
+	 * spent to render each frame and to write it to the Output is recorded.
+	 * Percentiles are computed over a rolling window of the last WINDOW
+	 * frames, while frame counters are cumulative since the last reset().
+	 *
+	 * A frame is considered dropped when its total time (render and output)
+	 * exceeds the frame budget, e.g. `1000000 / 60` microseconds for a 60
+	 * fps animation.
+	 *
+	 * Times are measured in microseconds with `std::chrono::steady_clock`.
+	 * Recording a frame only stores its times in a ring buffer: all the
+	 * statistics are computed when they are queried.
+	 *
+	 * ```cpp
+	 * pixled::FrameStats stats(1000000 / 60);
+	 * stats.setCallback([] (const pixled::FrameStats& stats, void*) {
+	 * 		std::cout << "p99: " << stats.frameTimes().p99 << " us" << std::endl;
+	 * 		}, nullptr, 60);
+	 * runtime.setFrameStats(&stats);
+	 * ```
+	 */
+	class FrameStats {
+		public:
+			/**
+			 * Clock used to measure frame times.
+			 */
+			typedef std::chrono::steady_clock clock;
+
+			/**
+			 * Count of frames in the rolling window.
+			 */
+			static constexpr std::size_t WINDOW = 256;
+
+			/**
+			 * Function periodically called with the current statistics.
+			 *
+			 * @param stats frame statistics
+			 * @param user_data pointer passed to setCallback()
+			 */
+			typedef void (*Callback)(const FrameStats& stats, void* user_data);
+
+			/**
+			 * Distribution of times over the rolling window, in
+			 * microseconds.
+			 */
+			struct Percentiles {
+				/**
+				 * Median.
+				 */
+				std::uint32_t p50;
+				/**
+				 * 99th percentile.
+				 */
+				std::uint32_t p99;
+				/**
+				 * Maximum.
+				 */
+				std::uint32_t max;
+			};
+
+		private:
+			std::uint32_t _frame_budget;
+			std::uint32_t render_times[WINDOW];
+			std::uint32_t output_times[WINDOW];
+			std::uint32_t led_counts[WINDOW];
+			unsigned long _frames;
+			unsigned long _dropped_frames;
+
+			Callback callback = nullptr;
+			void* user_data = nullptr;
+			unsigned long callback_period = 0;
+
+			Percentiles percentiles(std::uint32_t* times) const;
+
+		public:
+			/**
+			 * Builds empty FrameStats.
+			 *
+			 * @param frame_budget maximum time of a frame, in
+			 * microseconds, or 0 to never count dropped frames
+			 */
+			FrameStats(std::uint32_t frame_budget = 0);
+
+			/**
+			 * Sets the frame budget.
+			 *
+			 * @param frame_budget maximum time of a frame, in
+			 * microseconds, or 0 to never count dropped frames
+			 */
+			void setFrameBudget(std::uint32_t frame_budget);
+
+			/**
+			 * Current frame budget.
+			 *
+			 * @return maximum time of a frame, in microseconds
+			 */
+			std::uint32_t frameBudget() const;
+
+			/**
+			 * Sets a `callback` called every `period` recorded frames.
+			 *
+			 * @param callback function called with these statistics, or
+			 * `nullptr` to disable the callback
+			 * @param user_data pointer passed to the callback
+			 * @param period count of frames between two calls
+			 */
+			void setCallback(Callback callback, void* user_data, unsigned long period);
+
+			/**
+			 * Records the times of a frame.
+			 *
+			 * This method is called by the Runtime, but can also be used
+			 * to record frames rendered by other means.
+			 *
+			 * @param render_time time spent to render the frame, in
+			 * microseconds
+			 * @param output_time time spent to write the frame to the
+			 * output, in microseconds
+			 * @param led_count count of leds in the frame
+			 */
+			void record(std::uint32_t render_time, std::uint32_t output_time, std::size_t led_count);
+
+			/**
+			 * Count of frames recorded since the last reset().
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			/**
+			 * Count of frames which total time exceeded the frame budget
+			 * since the last reset().
+			 *
+			 * @return count of dropped frames
+			 */
+			unsigned long droppedFrames() const;
+
+			/**
+			 * Distribution of render times over the rolling window.
+			 *
+			 * @return render time percentiles, in microseconds
+			 */
+			Percentiles renderTimes() const;
+
+			/**
+			 * Distribution of output times over the rolling window.
+			 *
+			 * @return output time percentiles, in microseconds
+			 */
+			Percentiles outputTimes() const;
+
+			/**
+			 * Distribution of total frame times (render and output) over
+			 * the rolling window.
+			 *
+			 * @return frame time percentiles, in microseconds
+			 */
+			Percentiles frameTimes() const;
+
+			/**
+			 * Throughput over the rolling window, as the count of leds
+			 * rendered and written per second of frame time.
+			 *
+			 * @return leds per second, or 0 if no frame was recorded
+			 */
+			double ledsPerSecond() const;
+
+			/**
+			 * Clears all the recorded frames.
+			 */
+			void reset();
+	};
+}
+#endif
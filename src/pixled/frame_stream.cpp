@@ -0,0 +1,288 @@
+#include "frame_stream.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef PIXLED_FRAME_PLAYER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pixled {
+	static const char MAGIC[4] = {'P', 'X', 'F', 'S'};
+
+	/**
+	 * Little endian encoding of the `size` bytes of `value` in `buffer`.
+	 */
+	static void store_le(std::uint8_t* buffer, std::uint64_t value, std::size_t size) {
+		for(std::size_t i = 0; i < size; i++)
+			buffer[i] = (std::uint8_t) (value >> (8*i));
+	}
+
+	/**
+	 * Decodes the little endian value of `size` bytes stored in `buffer`.
+	 */
+	static std::uint64_t load_le(const std::uint8_t* buffer, std::size_t size) {
+		std::uint64_t value = 0;
+		for(std::size_t i = 0; i < size; i++)
+			value |= (std::uint64_t) buffer[i] << (8*i);
+		return value;
+	}
+
+	/**
+	 * FNV-1a hash of `size` bytes, starting from `hash`.
+	 */
+	static std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t size) {
+		const std::uint8_t* bytes = (const std::uint8_t*) data;
+		for(std::size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	std::uint64_t mappingHash(const Mapping& mapping) {
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		mapping.forEach([&hash] (const led& led) {
+				std::uint8_t bytes[4*4];
+				store_le(bytes, led.index, 4);
+				const coordinate coordinates[3] = {
+					led.location.x, led.location.y, led.location.z
+				};
+				for(std::size_t i = 0; i < 3; i++) {
+					std::uint32_t bits;
+					std::memcpy(&bits, &coordinates[i], sizeof(bits));
+					store_le(&bytes[4*(i+1)], bits, 4);
+				}
+				hash = fnv1a(hash, bytes, sizeof(bytes));
+				});
+		return hash;
+	}
+
+	FrameRecorder::FrameRecorder(
+			const char* path, const Mapping& mapping, float fps,
+			FRAME_STREAM_ENCODING encoding)
+		: file(std::fopen(path, "wb")), encoding(encoding) {
+			std::size_t led_count = 0;
+			mapping.forEach([&led_count] (const led& led) {
+					if(led.index >= led_count)
+						led_count = led.index + 1;
+					});
+			// Leds that are not in the mapping are left black
+			frame.assign(3*led_count, 0);
+			if(!file)
+				return;
+
+			std::uint8_t header[frame_stream::HEADER_SIZE] {};
+			std::memcpy(header, MAGIC, sizeof(MAGIC));
+			store_le(&header[4], frame_stream::VERSION, 2);
+			store_le(&header[6], frame_stream::HEADER_SIZE, 2);
+			store_le(&header[8], led_count, 4);
+			store_le(&header[12], (std::uint32_t) std::lround(fps * 1000), 4);
+			store_le(&header[16], mappingHash(mapping), 8);
+			if(std::fwrite(header, sizeof(header), 1, file) != 1)
+				close();
+		}
+
+	bool FrameRecorder::isOpen() const {
+		return file != nullptr;
+	}
+
+	std::size_t FrameRecorder::ledCount() const {
+		return frame.size() / 3;
+	}
+
+	unsigned long FrameRecorder::frames() const {
+		return _frames;
+	}
+
+	void FrameRecorder::write(const color& color, std::size_t i) {
+		if(3*i >= frame.size())
+			return;
+		std::uint8_t* rgb = &frame[3*i];
+		rgb[0] = color.red();
+		rgb[1] = color.green();
+		rgb[2] = color.blue();
+	}
+
+	void FrameRecorder::writeFrame(const std::uint8_t* frame, std::size_t led_count) {
+		std::memcpy(this->frame.data(), frame, 3*std::min(led_count, ledCount()));
+	}
+
+	void FrameRecorder::writeChunk(
+			frame_stream::CHUNK_TYPE type,
+			const std::uint8_t* payload, std::size_t size) {
+		std::uint8_t header[frame_stream::CHUNK_HEADER_SIZE] {};
+		store_le(header, size, 4);
+		header[4] = type;
+		if(std::fwrite(header, sizeof(header), 1, file) != 1
+				|| (size > 0 && std::fwrite(payload, size, 1, file) != 1))
+			close();
+	}
+
+	void FrameRecorder::endFrame() {
+		if(!file)
+			return;
+		if(encoding == RLE_STREAM) {
+			encoded.clear();
+			std::size_t i = 0;
+			while(i < frame.size()) {
+				const std::uint8_t* rgb = &frame[i];
+				std::size_t run = 1;
+				while(run < 256 && i + 3*run < frame.size()
+						&& std::memcmp(rgb, &frame[i + 3*run], 3) == 0)
+					run++;
+				encoded.push_back((std::uint8_t) (run - 1));
+				encoded.insert(encoded.end(), rgb, rgb + 3);
+				i += 3*run;
+			}
+			if(encoded.size() < frame.size()) {
+				writeChunk(frame_stream::RLE_FRAME, encoded.data(), encoded.size());
+				_frames++;
+				return;
+			}
+		}
+		writeChunk(frame_stream::RAW_FRAME, frame.data(), frame.size());
+		_frames++;
+	}
+
+	void FrameRecorder::close() {
+		if(file) {
+			std::fclose(file);
+			file = nullptr;
+		}
+	}
+
+	FrameRecorder::~FrameRecorder() {
+		close();
+	}
+
+#ifdef PIXLED_FRAME_PLAYER
+	FramePlayer::FramePlayer(const char* path) {
+		int fd = open(path, O_RDONLY);
+		if(fd < 0)
+			return;
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapping != MAP_FAILED) {
+				data = (const std::uint8_t*) mapping;
+				size = st.st_size;
+				// Frames are usually played sequentially
+				madvise(mapping, size, MADV_SEQUENTIAL);
+			}
+		}
+		// The mapping stays valid once the file is closed
+		::close(fd);
+		if(data && !parse()) {
+			munmap((void*) data, size);
+			data = nullptr;
+		}
+	}
+
+	bool FramePlayer::parse() {
+		if(size < frame_stream::HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+			return false;
+		if(load_le(&data[4], 2) > frame_stream::VERSION)
+			return false;
+		std::size_t header_size = load_le(&data[6], 2);
+		if(header_size < frame_stream::HEADER_SIZE || header_size > size)
+			return false;
+		led_count = load_le(&data[8], 4);
+		_fps = load_le(&data[12], 4) / 1000.f;
+		mapping_hash = load_le(&data[16], 8);
+
+		std::size_t offset = header_size;
+		while(size - offset >= frame_stream::CHUNK_HEADER_SIZE) {
+			std::size_t payload = load_le(&data[offset], 4);
+			if(payload > size - offset - frame_stream::CHUNK_HEADER_SIZE)
+				// Truncated chunk
+				break;
+			switch(data[offset + 4]) {
+				case frame_stream::RAW_FRAME:
+					if(payload == 3*led_count)
+						chunks.push_back(&data[offset]);
+					break;
+				case frame_stream::RLE_FRAME:
+					if(payload % 4 == 0)
+						chunks.push_back(&data[offset]);
+					break;
+				default:
+					// Unknown chunks are skipped
+					break;
+			}
+			offset += frame_stream::CHUNK_HEADER_SIZE + payload;
+		}
+		return true;
+	}
+
+	bool FramePlayer::isOpen() const {
+		return data != nullptr;
+	}
+
+	std::size_t FramePlayer::ledCount() const {
+		return led_count;
+	}
+
+	float FramePlayer::fps() const {
+		return _fps;
+	}
+
+	std::uint64_t FramePlayer::mappingHash() const {
+		return mapping_hash;
+	}
+
+	std::size_t FramePlayer::frameCount() const {
+		return chunks.size();
+	}
+
+	std::size_t FramePlayer::position() const {
+		return _position;
+	}
+
+	void FramePlayer::seek(std::size_t frame) {
+		_position = frame;
+	}
+
+	void FramePlayer::play(std::size_t index, Output& output) {
+		const std::uint8_t* chunk = chunks[index];
+		const std::uint8_t* payload = chunk + frame_stream::CHUNK_HEADER_SIZE;
+		if(chunk[4] == frame_stream::RAW_FRAME) {
+			output.writeFrame(payload, led_count);
+			output.endFrame();
+			return;
+		}
+		std::size_t size = load_le(chunk, 4);
+		// Leds missing from a corrupted frame are left black
+		frame.assign(3*led_count, 0);
+		std::size_t i = 0;
+		for(std::size_t run = 0; run < size; run += 4) {
+			std::size_t count = payload[run] + 1;
+			for(std::size_t n = 0; n < count && i < frame.size(); n++) {
+				std::memcpy(&frame[i], &payload[run + 1], 3);
+				i += 3;
+			}
+		}
+		output.writeFrame(frame.data(), led_count);
+		output.endFrame();
+	}
+
+	bool FramePlayer::next(Output& output) {
+		if(_position >= chunks.size())
+			return false;
+		play(_position++, output);
+		return true;
+	}
+
+	FramePlayer::~FramePlayer() {
+		if(data)
+			munmap((void*) data, size);
+	}
+#endif
+}
+#endif
@@ -0,0 +1,318 @@
+#ifndef PIXLED_FRAME_STREAM_H
+#define PIXLED_FRAME_STREAM_H
+
+#include "config.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "output.h"
+#include "mapping.h"
+
+/**
+ * Defined when FramePlayer is available, i.e. on POSIX systems that support
+ * `mmap()`.
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define PIXLED_FRAME_PLAYER
+#endif
+
+namespace pixled {
+	/**
+	 * Frame stream file format.
+	 *
+	 * A frame stream is a header followed by a sequence of chunks. All the
+	 * integers are stored in little endian.
+	 *
+	 * The 32 bytes header contains:
+	 * | offset | size | content                                      |
+	 * |--------|------|----------------------------------------------|
+	 * | 0      | 4    | magic `PXFS`                                 |
+	 * | 4      | 2    | format VERSION                               |
+	 * | 6      | 2    | header size, in bytes                        |
+	 * | 8      | 4    | led count of each frame                      |
+	 * | 12     | 4    | frame rate, in thousandths of frames/s       |
+	 * | 16     | 8    | hash of the recorded mapping (see mappingHash()) |
+	 * | 24     | 8    | reserved                                     |
+	 *
+	 * Each chunk starts with an 8 bytes chunk header, the 4 bytes size of the
+	 * chunk payload followed by a 1 byte CHUNK_TYPE and 3 reserved bytes.
+	 * Readers skip chunks of unknown types.
+	 *
+	 * Each frame is stored in its own chunk, so that frames can be read in any
+	 * order.
+	 */
+	namespace frame_stream {
+		/**
+		 * Current version of the format.
+		 */
+		static const std::uint16_t VERSION = 1;
+		/**
+		 * Size of the file header.
+		 */
+		static const std::size_t HEADER_SIZE = 32;
+		/**
+		 * Size of the header of each chunk.
+		 */
+		static const std::size_t CHUNK_HEADER_SIZE = 8;
+
+		/**
+		 * Types of chunks.
+		 */
+		enum CHUNK_TYPE {
+			/**
+			 * Uncompressed frame, using the layout of
+			 * Output::writeFrame().
+			 */
+			RAW_FRAME = 1,
+			/**
+			 * Run-length encoded frame: a sequence of runs of 4 bytes,
+			 * the count of consecutive leds of the run minus one,
+			 * followed by their red, green and blue components.
+			 */
+			RLE_FRAME = 2
+		};
+	}
+
+	/**
+	 * Encoding of the frames recorded by a FrameRecorder.
+	 */
+	enum FRAME_STREAM_ENCODING {
+		/**
+		 * Frames are stored as is, and can be played without any copy.
+		 */
+		RAW_STREAM,
+		/**
+		 * Frames are run-length encoded when it reduces their size, what
+		 * is efficient for animations with large areas of a single
+		 * color.
+		 */
+		RLE_STREAM
+	};
+
+	/**
+	 * Hash of the indexes and locations of the leds of `mapping`, stored in
+	 * frame streams to check that a recording is played on the mapping it
+	 * was recorded with.
+	 *
+	 * @param mapping led mapping
+	 * @return 64 bits FNV-1a hash of the mapping
+	 */
+	std::uint64_t mappingHash(const Mapping& mapping);
+
+	/**
+	 * An Output that records the frames written by a Runtime to a frame
+	 * stream file (see frame_stream).
+	 *
+	 * Leds are buffered, and each frame is appended to the file when the
+	 * Runtime calls endFrame(). Leds that are not written in a frame keep
+	 * their previous color.
+	 *
+	 * ```cpp
+	 * pixled::FrameRecorder recorder("show.pxfs", panel, 60);
+	 * pixled::Runtime runtime(panel, recorder, animation);
+	 * for(int i = 0; i < 600; i++)
+	 * 	runtime.next();
+	 * ```
+	 *
+	 * Not available in heap-free mode.
+	 */
+	class FrameRecorder : public Output {
+		private:
+			std::FILE* file;
+			FRAME_STREAM_ENCODING encoding;
+			std::vector<std::uint8_t> frame;
+			std::vector<std::uint8_t> encoded;
+			unsigned long _frames = 0;
+
+			void writeChunk(
+					frame_stream::CHUNK_TYPE type,
+					const std::uint8_t* payload, std::size_t size);
+
+		public:
+			/**
+			 * Creates the file `path`, and writes the frame stream
+			 * header.
+			 *
+			 * @param path file path
+			 * @param mapping recorded led mapping, used to compute the led
+			 * count and the mappingHash()
+			 * @param fps frame rate stored in the header
+			 * @param encoding frame encoding
+			 */
+			FrameRecorder(
+					const char* path, const Mapping& mapping, float fps,
+					FRAME_STREAM_ENCODING encoding = RAW_STREAM);
+
+			FrameRecorder(const FrameRecorder&) = delete;
+			FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+			/**
+			 * Returns false if the file could not be created or written.
+			 *
+			 * @return true iff frames are recorded
+			 */
+			bool isOpen() const;
+
+			/**
+			 * Count of leds of each recorded frame.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+
+			/**
+			 * Count of frames recorded.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			void write(const color& color, std::size_t i) override;
+			void writeFrame(const std::uint8_t* frame, std::size_t led_count) override;
+
+			/**
+			 * Appends the current frame to the file.
+			 */
+			void endFrame() override;
+
+			/**
+			 * Closes the file.
+			 */
+			void close();
+
+			/**
+			 * Closes the file.
+			 */
+			~FrameRecorder();
+	};
+
+#ifdef PIXLED_FRAME_PLAYER
+	/**
+	 * Plays a frame stream file recorded by a FrameRecorder.
+	 *
+	 * The file is mapped in memory with `mmap()`, and raw frames are written
+	 * to the Output directly from the mapping with Output::writeFrame(),
+	 * without any copy: playing a recording only costs the I/O of the page
+	 * cache. Run-length encoded frames are decoded in a frame buffer.
+	 *
+	 * A truncated file, e.g. when a recording was interrupted, is played up
+	 * to its last complete frame.
+	 *
+	 * ```cpp
+	 * pixled::FramePlayer player("show.pxfs");
+	 * if(player.isOpen() && player.mappingHash() == pixled::mappingHash(panel))
+	 * 	while(player.next(output))
+	 * 		wait_next_frame();
+	 * ```
+	 *
+	 * Only available in heap mode, on POSIX systems (see
+	 * PIXLED_FRAME_PLAYER).
+	 */
+	class FramePlayer {
+		private:
+			const std::uint8_t* data = nullptr;
+			std::size_t size = 0;
+			std::size_t led_count = 0;
+			float _fps = 0;
+			std::uint64_t mapping_hash = 0;
+			// Chunk header of each frame
+			std::vector<const std::uint8_t*> chunks;
+			std::size_t _position = 0;
+			std::vector<std::uint8_t> frame;
+
+			bool parse();
+
+		public:
+			/**
+			 * Maps the file `path` in memory, and indexes its frames.
+			 *
+			 * @param path frame stream file
+			 */
+			FramePlayer(const char* path);
+
+			FramePlayer(const FramePlayer&) = delete;
+			FramePlayer& operator=(const FramePlayer&) = delete;
+
+			/**
+			 * Returns false if the file could not be mapped, or is not a
+			 * valid frame stream.
+			 *
+			 * @return true iff frames can be played
+			 */
+			bool isOpen() const;
+
+			/**
+			 * Count of leds of each frame.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+
+			/**
+			 * Frame rate of the recording.
+			 *
+			 * @return frames per second
+			 */
+			float fps() const;
+
+			/**
+			 * Hash of the mapping used to record the frames (see
+			 * pixled::mappingHash()).
+			 *
+			 * @return mapping hash
+			 */
+			std::uint64_t mappingHash() const;
+
+			/**
+			 * Count of frames in the recording.
+			 *
+			 * @return count of frames
+			 */
+			std::size_t frameCount() const;
+
+			/**
+			 * Index of the next frame played by next().
+			 *
+			 * @return current position
+			 */
+			std::size_t position() const;
+
+			/**
+			 * Sets the index of the next frame played by next().
+			 *
+			 * @param frame frame index
+			 */
+			void seek(std::size_t frame);
+
+			/**
+			 * Writes the frame at index `frame` to `output` with
+			 * Output::writeFrame(), and ends it with Output::endFrame(), as
+			 * a Runtime does.
+			 *
+			 * @param frame frame index, lower than frameCount()
+			 * @param output output receiving the frame
+			 */
+			void play(std::size_t frame, Output& output);
+
+			/**
+			 * Writes the frame at position() to `output`, and moves to the
+			 * next frame.
+			 *
+			 * @param output output receiving the frame
+			 * @return false, and does nothing, if all the frames have been
+			 * played
+			 */
+			bool next(Output& output);
+
+			/**
+			 * Unmaps the file.
+			 */
+			~FramePlayer();
+	};
+#endif
+}
+#endif
+#endif
@@ -1,10 +1,16 @@
 #ifndef FUNCTIONNAL_API_H
 #define FUNCTIONNAL_API_H
 
+#include <cstdint>
+#include <new>
+#include <type_traits>
 #include <utility>
+#include "arena.h"
 #include "color.h"
 #include "time.h"
 #include "mapping.h"
+#include "profiler.h"
+#include "serialization.h"
 
 
 namespace pixled {
@@ -61,10 +67,335 @@ namespace pixled {
 					 */
 					virtual Function<R>* copy() const = 0;
 
+					/**
+					 * Constructs a copy of this Function in the provided
+					 * `buffer`, if this Function is small enough.
+					 *
+					 * This is used by FctWrapper to store stateless leaf
+					 * Functions (such as chrono::T or geometry::X) inline,
+					 * without any allocation.
+					 *
+					 * The default implementation returns `nullptr`, so that
+					 * copy() is used instead.
+					 *
+					 * @param buffer memory in which the copy is constructed
+					 * @param size size of `buffer`, in bytes
+					 * @return copy constructed in `buffer`, or `nullptr` if
+					 * this Function can't be stored in `buffer`
+					 */
+					virtual Function<R>* copyInline(void* buffer, std::size_t size) const {
+						return nullptr;
+					}
+
+					/**
+					 * Time periodicity of this Function.
+					 *
+					 * Returns a period `p` such that this Function returns
+					 * the same value at times `t` and `t+p` on any led, 1 if
+					 * this Function does not depend on time, or 0 if no
+					 * such period is known (e.g. for chrono::T).
+					 *
+					 * This metadata can be used to cache the frames of
+					 * periodic animations (see Runtime::enableFrameCache()).
+					 *
+					 * The default implementation returns 0.
+					 *
+					 * @return time period, or 0 if unknown
+					 */
+					virtual time periodicity() const {
+						return 0;
+					}
+
+					/**
+					 * Returns false only if this Function is guaranteed to
+					 * return the same value on the led `l` at times `t` and
+					 * `t+1`. Colors are considered equal when their rgb
+					 * components are equal.
+					 *
+					 * This metadata is used by the Runtime to skip the
+					 * evaluation of static leds (see
+					 * Runtime::enableDirtyTracking()).
+					 *
+					 * The default implementation only returns false for time
+					 * invariant Functions (see periodicity()).
+					 *
+					 * @param l led
+					 * @param t time
+					 * @return false if the value on `l` can't change between
+					 * `t` and `t+1`
+					 */
+					virtual bool mayChange(led l, time t) const {
+						return periodicity() != 1;
+					}
+
+					/**
+					 * Returns true if this Function is a pure function of
+					 * `(led, time)`: its result does not depend on previous
+					 * calls, and it can be evaluated concurrently from
+					 * several threads.
+					 *
+					 * Frames of stateless animations can be rendered in any
+					 * order, e.g. in parallel across time or backward with
+					 * Runtime::prev(). All the built-in Functions are
+					 * stateless: a Function that keeps mutable state
+					 * between calls must override this method to return
+					 * false.
+					 *
+					 * The default implementation returns true.
+					 *
+					 * @return true iff this Function is stateless
+					 */
+					virtual bool stateless() const {
+						return true;
+					}
+
+					/**
+					 * Returns a pointer to the value of this Function if it
+					 * is a Constant, or `nullptr` otherwise.
+					 *
+					 * @return constant value, or `nullptr`
+					 */
+					virtual const R* constant() const {
+						return nullptr;
+					}
+
+					/**
+					 * Writes this Function and its functionnal arguments to
+					 * `writer`, in the Function graph binary format (see
+					 * serialization and serialize()).
+					 *
+					 * Built-in Functions and Constants of the types listed in
+					 * serialization::VALUE_TYPE can be serialized. The
+					 * default implementation returns false, so that graphs
+					 * containing user defined Functions can't be serialized.
+					 *
+					 * @param writer serialized graph writer
+					 * @return false if this Function can't be serialized
+					 */
+					virtual bool serialize(serialization::Writer& writer) const {
+						return false;
+					}
+
+					/**
+					 * Allocates the memory of a Function, in the currently
+					 * active Arena if any (see ArenaScope), or else on the
+					 * heap.
+					 */
+					static void* operator new(std::size_t size) {
+						return detail::allocate_function(size);
+					}
+
+					/**
+					 * Frees the memory of a Function. Nothing is done if
+					 * the Function was allocated in an Arena.
+					 */
+					static void operator delete(void* ptr) {
+						detail::free_function(ptr);
+					}
+
 					virtual ~Function() {}
 			};
 	}
 
+	/**
+	 * Implementation details, not directly accessible from the pixled
+	 * namespace.
+	 */
+	namespace detail {
+		/**
+		 * Copy constructs `f` in `buffer` if its size and alignment allow
+		 * it (see base::Function::copyInline()).
+		 *
+		 * @param f function to copy
+		 * @param buffer memory in which the copy is constructed
+		 * @param size size of `buffer`, in bytes
+		 * @return copy constructed in `buffer`, or `nullptr`
+		 */
+		template<typename Implem>
+			base::Function<typename Implem::Type>* copy_inline(
+					const Implem& f, void* buffer, std::size_t size) {
+				if(sizeof(Implem) > size
+						|| reinterpret_cast<std::uintptr_t>(buffer) % alignof(Implem) != 0)
+					return nullptr;
+				return ::new (buffer) Implem(f);
+			}
+
+		/**
+		 * Combines two periodicities (see base::Function::periodicity()).
+		 *
+		 * @return least common multiple of `p1` and `p2`, or 0 if one of them
+		 * is 0
+		 */
+		inline time periodicity_lcm(time p1, time p2) {
+			if(p1 == 0 || p2 == 0)
+				return 0;
+			time a = p1;
+			time b = p2;
+			while(b != 0) {
+				time r = a % b;
+				a = b;
+				b = r;
+			}
+			return p1 / a * p2;
+		}
+
+		/**
+		 * Combines the periodicities of the first `I` functions of the
+		 * `Args` tuple.
+		 */
+		template<std::size_t I, typename Args>
+			struct args_periodicity {
+				/**
+				 * @return combined periodicity of the first `I` functions
+				 */
+				static time get(const Args& args) {
+					return periodicity_lcm(
+							args_periodicity<I-1, Args>::get(args),
+							(*std::get<I-1>(args)).periodicity()
+							);
+				}
+			};
+
+		/**
+		 * Empty argument list case: does not depend on time.
+		 */
+		template<typename Args>
+			struct args_periodicity<0, Args> {
+				/**
+				 * @return 1
+				 */
+				static time get(const Args&) {
+					return 1;
+				}
+			};
+
+		/**
+		 * Returns true if one of the first `I` functions of the `Args` tuple
+		 * may change between `t` and `t+1` on the led `l`.
+		 */
+		template<std::size_t I, typename Args>
+			struct args_may_change {
+				/**
+				 * @return true iff one of the first `I` functions may change
+				 */
+				static bool get(const Args& args, led l, time t) {
+					return args_may_change<I-1, Args>::get(args, l, t)
+						|| (*std::get<I-1>(args)).mayChange(l, t);
+				}
+			};
+
+		/**
+		 * Empty argument list case: nothing can change.
+		 */
+		template<typename Args>
+			struct args_may_change<0, Args> {
+				/**
+				 * @return false
+				 */
+				static bool get(const Args&, led, time) {
+					return false;
+				}
+			};
+
+		/**
+		 * Returns true if all the first `I` functions of the `Args` tuple
+		 * are stateless.
+		 */
+		template<std::size_t I, typename Args>
+			struct args_stateless {
+				/**
+				 * @return true iff all the first `I` functions are
+				 * stateless
+				 */
+				static bool get(const Args& args) {
+					return args_stateless<I-1, Args>::get(args)
+						&& (*std::get<I-1>(args)).stateless();
+				}
+			};
+
+		/**
+		 * Empty argument list case: stateless.
+		 */
+		template<typename Args>
+			struct args_stateless<0, Args> {
+				/**
+				 * @return true
+				 */
+				static bool get(const Args&) {
+					return true;
+				}
+			};
+
+		/**
+		 * Serializes the first `I` functions of the `Args` tuple, in order.
+		 */
+		template<std::size_t I, typename Args>
+			struct args_serialize {
+				/**
+				 * @return true iff all the first `I` functions were
+				 * serialized
+				 */
+				static bool get(const Args& args, serialization::Writer& writer) {
+					return args_serialize<I-1, Args>::get(args, writer)
+						&& (*std::get<I-1>(args)).serialize(writer);
+				}
+			};
+
+		/**
+		 * Empty argument list case: nothing to serialize.
+		 */
+		template<typename Args>
+			struct args_serialize<0, Args> {
+				/**
+				 * @return true
+				 */
+				static bool get(const Args&, serialization::Writer&) {
+					return true;
+				}
+			};
+
+		/**
+		 * serialization::NODE_TYPE of the Function `Implem`, i.e.
+		 * `Implem::NODE` if defined, or serialization::UNKNOWN_NODE.
+		 */
+		template<typename Implem, typename Enable = void>
+			struct node_type {
+				/**
+				 * Unknown node.
+				 */
+				static constexpr serialization::NODE_TYPE value = serialization::UNKNOWN_NODE;
+			};
+
+		/**
+		 * Built-in Function case.
+		 */
+		template<typename Implem>
+			struct node_type<Implem, decltype(void(Implem::NODE))> {
+				/**
+				 * `Implem::NODE`
+				 */
+				static constexpr serialization::NODE_TYPE value = Implem::NODE;
+			};
+
+		/**
+		 * Periodicity of a Function that directly depends on `t` through
+		 * a `period` argument, such as a sine wave of `t / period`.
+		 *
+		 * @param period time period argument
+		 * @param args_periodicity combined periodicity of all the
+		 * functionnal arguments
+		 * @return least common multiple of the period and
+		 * `args_periodicity` if `period` is a Constant, 0 otherwise
+		 */
+		inline time period_periodicity(
+				const base::Function<time>& period, time args_periodicity) {
+			const time* value = period.constant();
+			if(value == nullptr)
+				return 0;
+			return periodicity_lcm(*value, args_periodicity);
+		}
+	}
+
 	/**
 	 * Checks if the specified type T is a pixled::Function.
 	 *
@@ -124,18 +455,159 @@ namespace pixled {
 				Constant<T>* copy() const override {
 					return new Constant<T>(_value);
 				}
+
+				/**
+				 * A Constant does not depend on time.
+				 *
+				 * @return 1
+				 */
+				time periodicity() const override {
+					return 1;
+				}
+
+				/**
+				 * A Constant never changes.
+				 *
+				 * @return false
+				 */
+				bool mayChange(led, time) const override {
+					return false;
+				}
+
+				/**
+				 * Returns a pointer to the constant value.
+				 *
+				 * @return constant value
+				 */
+				const T* constant() const override {
+					return &_value;
+				}
+
+				/**
+				 * Writes a serialization::CONSTANT_NODE.
+				 *
+				 * @return false if `T` can't be serialized
+				 */
+				bool serialize(serialization::Writer& writer) const override {
+					return writer.constant(_value);
+				}
 		};
 
 	/**
 	 * A smart pointer used to manage dynamically allocated virtual
 	 * base::Function instances.
 	 *
+	 * Constants and stateless leaf Functions (see
+	 * base::Function::copyInline()) are stored in an inline buffer, so that
+	 * wrapping them does not require any allocation. Calling the wrapper
+	 * with operator()() on a Constant also directly returns its value,
+	 * without any virtual call.
+	 *
 	 * @tparam R function return type
 	 */
 	template<typename R>
 		class FctWrapper {
 			private:
-				const base::Function<R>* fct;
+				/**
+				 * Inline buffer, large enough to store a Constant<R>.
+				 */
+				typedef typename std::aligned_storage<
+					sizeof(Constant<R>), alignof(Constant<R>)>::type Storage;
+
+				/**
+				 * Tag set on the lowest bit of `fct` when the wrapped
+				 * function is a Constant stored inline. Since Functions
+				 * are at least pointer aligned, this bit is otherwise
+				 * always 0.
+				 */
+				static constexpr std::uintptr_t CONSTANT_TAG = 1;
+
+				std::uintptr_t fct;
+				Storage storage;
+
+				/**
+				 * Tag of the adopt() constructor.
+				 */
+				struct adopt_tag {};
+
+				FctWrapper(base::Function<R>* fct, adopt_tag)
+					: fct(reinterpret_cast<std::uintptr_t>(fct)) {}
+
+				/**
+				 * Wrapped function, or `nullptr` if this FctWrapper is
+				 * dangling.
+				 */
+				const base::Function<R>* function() const {
+					return reinterpret_cast<const base::Function<R>*>(fct & ~CONSTANT_TAG);
+				}
+
+				/**
+				 * Inline Constant, only valid if `fct` is tagged with
+				 * CONSTANT_TAG.
+				 */
+				const Constant<R>* inlineConstant() const {
+					return reinterpret_cast<const Constant<R>*>(&storage);
+				}
+
+				/**
+				 * True iff the wrapped function is stored in `storage`.
+				 */
+				bool isInline() const {
+					const char* ptr = reinterpret_cast<const char*>(function());
+					const char* buffer = reinterpret_cast<const char*>(&storage);
+					return ptr >= buffer && ptr < buffer + sizeof(storage);
+				}
+
+				/**
+				 * Stores a Constant `value` inline.
+				 */
+				void wrapConstant(const R& value) {
+					const base::Function<R>* constant = ::new (&storage) Constant<R>(value);
+					fct = reinterpret_cast<std::uintptr_t>(constant) | CONSTANT_TAG;
+				}
+
+				/**
+				 * Wraps a copy of `f`. Constants and small functions are
+				 * stored inline.
+				 */
+				void wrap(const base::Function<R>& f) {
+					const R* value = f.constant();
+					if(value != nullptr) {
+						wrapConstant(*value);
+						return;
+					}
+					const base::Function<R>* copy = f.copyInline(&storage, sizeof(storage));
+					if(copy == nullptr)
+						copy = f.copy();
+					fct = reinterpret_cast<std::uintptr_t>(copy);
+				}
+
+				/**
+				 * Takes the wrapped function of `other`, that is left
+				 * dangling. Inline functions are copied.
+				 */
+				void take(FctWrapper<R>& other) {
+					if(other.fct != 0 && other.isInline()) {
+						wrap(*other.function());
+						other.release();
+					} else {
+						fct = other.fct;
+						other.fct = 0;
+					}
+				}
+
+				/**
+				 * Destroys the wrapped function, if any.
+				 */
+				void release() {
+					if(fct != 0) {
+						if(isInline())
+							function()->~Function();
+						else
+							delete function();
+						fct = 0;
+					}
+				}
 
 			public:
 				/**
@@ -155,18 +627,19 @@ namespace pixled {
 				 *
 				 * @param fct function to wrap
 				 */
-				FctWrapper(const base::Function<R>& fct)
-					: fct(fct.copy()) {
-					}
+				FctWrapper(const base::Function<R>& fct) {
+					wrap(fct);
+				}
 
 				/**
-				 * Initializes this FctWrapper with a Constant `value`.
+				 * Initializes this FctWrapper with a Constant `value`,
+				 * stored inline.
 				 *
 				 * @param value value of the Constant
 				 */
-				FctWrapper(R value)
-					: fct(new Constant<R>(value)) {
-					}
+				FctWrapper(R value) {
+					wrapConstant(value);
+				}
 
 				/**
 				 * FctWrapper copy constructor.
@@ -176,9 +649,9 @@ namespace pixled {
 				 *
 				 * @param other FctWrapper to copy from
 				 */
-				FctWrapper(const FctWrapper<R>& other)
-					: fct(other.fct->copy()) {
-					}
+				FctWrapper(const FctWrapper<R>& other) {
+					wrap(*other.function());
+				}
 
 				/**
 				 * FctWrapper move constructor.
@@ -188,9 +661,20 @@ namespace pixled {
 				 *
 				 * @param other FctWrapper to move from
 				 */
-				FctWrapper(FctWrapper<R>&& other) {
-					fct = other.fct;
-					other.fct = nullptr;
+				FctWrapper(FctWrapper<R>&& other) noexcept {
+					take(other);
+				}
+
+				/**
+				 * Wraps `fct` without any copy: the returned FctWrapper
+				 * takes the ownership of `fct`, that must have been
+				 * allocated with `new`.
+				 *
+				 * @param fct dynamically allocated function
+				 * @return FctWrapper owning `fct`
+				 */
+				static FctWrapper<R> adopt(base::Function<R>* fct) {
+					return FctWrapper<R>(fct, adopt_tag());
 				}
 
 				/**
@@ -205,9 +689,10 @@ namespace pixled {
 				 * @param other FctWrapper to copy from
 				 */
 				FctWrapper& operator=(const FctWrapper<R>& other) {
-					if(fct!=nullptr)
-						delete fct;
-					fct = other.fct->copy();
+					if(this != &other) {
+						release();
+						wrap(*other.function());
+					}
 					return *this;
 				}
 
@@ -223,10 +708,10 @@ namespace pixled {
 				 * @param other FctWrapper to move from
 				 */
 				FctWrapper& operator=(FctWrapper<R>&& other) {
-					if(fct!=nullptr)
-						delete fct;
-					fct = other.fct;
-					other.fct = nullptr;
+					if(this != &other) {
+						release();
+						take(other);
+					}
 					return *this;
 				}
 
@@ -239,14 +724,33 @@ namespace pixled {
 				 * @return wrapped function
 				 */
 				const base::Function<R>& operator*() const {
-					return *fct;
+					return *function();
 				}
 
 				/**
 				 * Gets a reference to the wrapped function.
 				 */
 				const base::Function<R>& get() const {
-					return *fct;
+					return *function();
+				}
+
+				/**
+				 * Calls the wrapped function on led `l` at time `t`.
+				 *
+				 * If the wrapped function is a Constant, its value is
+				 * directly returned without any virtual call. Otherwise,
+				 * the call is recorded by the active Profiler, if any (see
+				 * PIXLED_PROFILING).
+				 *
+				 * @param l led
+				 * @param t time
+				 * @return result of the wrapped function
+				 */
+				R operator()(const led& l, time t) const {
+					if(fct & CONSTANT_TAG)
+						return inlineConstant()->Constant<R>::operator()(l, t);
+					PIXLED_PROFILE_CALL(*function());
+					return (*function())(l, t);
 				}
 
 				/**
@@ -256,8 +760,7 @@ namespace pixled {
 				 * function is destroyed.
 				 */
 				~FctWrapper() {
-					if(fct!=nullptr)
-						delete fct;
+					release();
 				}
 		};
 
@@ -301,6 +804,11 @@ namespace pixled {
 	 * passed.
 	 *
 	 * \note
+	 * The default periodicity() and mayChange() of a Function are computed
+	 * from its arguments. Implementations that directly use the `t`
+	 * parameter of the call operator must override them accordingly.
+	 *
+	 * \note
 	 * It is possible to pass function arguments in almost all the way
 	 * available in C++, by l-value or r-value, since FctWrapper knows how to
 	 * handle all those cases without memory issues. Moreover, notice that f is
@@ -421,10 +929,71 @@ namespace pixled {
 				 */
 				template<std::size_t i>
 					typename std::tuple_element<i, decltype(args)>::type::Type call(led l, time t) const {
-						return (*std::get<i>(args))(l, t);
+						return std::get<i>(args)(l, t);
 					}
 
+				/**
+				 * Periodicity of this Function, computed by default as the
+				 * least common multiple of the periodicities of its
+				 * functionnal arguments.
+				 *
+				 * @return time period, or 0 if unknown
+				 *
+				 * @see base::Function::periodicity()
+				 */
+				time periodicity() const override {
+					return argsPeriodicity();
+				}
+
+				/**
+				 * By default, a Function may change between `t` and `t+1`
+				 * on the led `l` only if one of its functionnal arguments
+				 * may change.
+				 *
+				 * @see base::Function::mayChange()
+				 */
+				bool mayChange(led l, time t) const override {
+					return detail::args_may_change<sizeof...(Args), decltype(args)>::get(args, l, t);
+				}
+
+				/**
+				 * By default, a Function is stateless if all its
+				 * functionnal arguments are stateless.
+				 *
+				 * @see base::Function::stateless()
+				 */
+				bool stateless() const override {
+					return detail::args_stateless<sizeof...(Args), decltype(args)>::get(args);
+				}
+
+				/**
+				 * Writes the `Implem::NODE` node type of a built-in
+				 * Function, followed by its functionnal arguments.
+				 *
+				 * @return false if `Implem` does not define a NODE, or if
+				 * one of the arguments can't be serialized
+				 *
+				 * @see base::Function::serialize()
+				 */
+				bool serialize(serialization::Writer& writer) const override {
+					const serialization::VALUE_TYPE arg_types[] = {
+						serialization::value_type<Args>::id..., serialization::UNKNOWN_VALUE
+					};
+					return writer.node(
+							detail::node_type<Implem>::value, serialization::value_type<R>::id,
+							arg_types, sizeof...(Args), 0)
+						&& detail::args_serialize<sizeof...(Args), decltype(args)>::get(args, writer);
+				}
+
 			protected:
+				/**
+				 * Least common multiple of the periodicities of the
+				 * functionnal arguments, or 0 if one of them is unknown.
+				 */
+				time argsPeriodicity() const {
+					return detail::args_periodicity<sizeof...(Args), decltype(args)>::get(args);
+				}
+
 				/**
 				 * \copydoc pixled::base::Function::copy()
 				 */
@@ -433,10 +1002,6 @@ namespace pixled {
 				}
 		};
 
-	/**
-	 * Implementation details, not directly accessible from the pixled
-	 * namespace.
-	 */
 	namespace detail {
 		/**
 		 * Cast implementation.
@@ -463,14 +1028,40 @@ namespace pixled {
 					 */
 					Cast(base::Function<From>&& from)
 						: f(std::move(from)) {}
+					/**
+					 * Cast constructor that takes the function wrapped
+					 * by `from`, without any copy.
+					 */
+					Cast(FctWrapper<From>&& from)
+						: f(std::move(from)) {}
 
 					To operator()(led l, time t) const override {
-						return (*this->f)(l, t);
+						return static_cast<To>(this->f(l, t));
 					}
 
 					Cast<To, From>* copy() const override {
 						return new Cast(*f);
 					}
+
+					time periodicity() const override {
+						return (*f).periodicity();
+					}
+
+					bool mayChange(led l, time t) const override {
+						return (*f).mayChange(l, t);
+					}
+
+					bool stateless() const override {
+						return (*f).stateless();
+					}
+
+					bool serialize(serialization::Writer& writer) const override {
+						serialization::VALUE_TYPE from = serialization::value_type<From>::id;
+						return writer.node(
+								serialization::CAST_NODE, serialization::value_type<To>::id,
+								&from, 1, 0)
+							&& (*f).serialize(writer);
+					}
 			};
 	}
 
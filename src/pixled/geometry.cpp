@@ -2,7 +2,22 @@
 
 namespace pixled {
 	float distance(const point& p1, const point& p2) {
-		return std::sqrt(std::pow(p1.y - p2.y, 2) + std::pow(p1.x - p2.x, 2));
+		// Points of the same z plane, e.g. 2D points, skip the z term
+		if(p1.z == p2.z)
+			return std::sqrt(std::pow(p1.y - p2.y, 2) + std::pow(p1.x - p2.x, 2));
+		return std::sqrt(
+				std::pow(p1.y - p2.y, 2) + std::pow(p1.x - p2.x, 2) + std::pow(p1.z - p2.z, 2)
+				);
+	}
+
+	float distance(const point& p, const plane& pl) {
+		return std::abs(pl.a * p.x + pl.b * p.y + pl.c * p.z + pl.d) /
+			std::sqrt(std::pow(pl.a, 2) + std::pow(pl.b, 2) + std::pow(pl.c, 2));
+	}
+
+	float distance(const point& p, const line& l) {
+		return std::abs(l.a * p.x + l.b * p.y + l.c) /
+			std::sqrt(std::pow(l.a, 2) + std::pow(l.b, 2));
 	}
 
 	angle angle::fromRad(float value) {
@@ -35,14 +50,27 @@ namespace pixled {
 		}
 	}
 
+	plane::plane(point p, point normal)
+		: a(normal.x), b(normal.y), c(normal.z),
+		d(-(normal.x * p.x + normal.y * p.y + normal.z * p.z)) {}
+
+	plane::plane(point p0, point p1, point p2)
+		: plane(p0, {
+				// Cross product of (p1 - p0) and (p2 - p0)
+				(p1.y - p0.y) * (p2.z - p0.z) - (p1.z - p0.z) * (p2.y - p0.y),
+				(p1.z - p0.z) * (p2.x - p0.x) - (p1.x - p0.x) * (p2.z - p0.z),
+				(p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x)
+				}) {}
+
 	std::size_t point_hash::operator()(const point& p) const {
 		auto hash1 = std::hash<coordinate>{}(p.x);
 		auto hash2 = std::hash<coordinate>{}(p.y);
-		return hash1 ^ hash2;
+		auto hash3 = std::hash<coordinate>{}(p.z);
+		return hash1 ^ hash2 ^ hash3;
 	}
 
 	bool operator==(const point& c1, const point& c2) {
-			return (c1.x == c2.x) && (c1.y == c2.y);
+			return (c1.x == c2.x) && (c1.y == c2.y) && (c1.z == c2.z);
 	}
 
 	bool point_equal::operator()(const point& p1, const point& p2) const {
@@ -50,7 +78,10 @@ namespace pixled {
 	}
 
 	std::ostream& operator<<(std::ostream& o, const point& p) {
-		o << "(" << p.x << "," << p.y << ")";
+		o << "(" << p.x << "," << p.y;
+		if(p.z != 0)
+			o << "," << p.z;
+		o << ")";
 		return o;
 	}
 
@@ -18,7 +18,13 @@ namespace pixled {
 	typedef float coordinate;
 
 	/**
-	 * A basic 2D point.
+	 * A basic 3D point.
+	 *
+	 * 2D points are simply points with a null z coordinate, so that 2D
+	 * shapes can be defined without ever specifying z. Notice that the z
+	 * coordinate is always stored: a point, and so a led, is 4 bytes larger
+	 * than a 2D only point. Mappings don't store it for 2D leds (see
+	 * Mapping).
 	 */
 	struct point {
 		/**
@@ -29,10 +35,14 @@ namespace pixled {
 		 * y coordinate.
 		 */
 		coordinate y;
+		/**
+		 * z coordinate.
+		 */
+		coordinate z;
 		/**
 		 * point default constructor.
 		 *
-		 * The point is initialized at (0, 0).
+		 * The point is initialized at (0, 0, 0).
 		 */
 		point() : point(0, 0) {}
 
@@ -41,9 +51,10 @@ namespace pixled {
 		 *
 		 * @param x x coordinate
 		 * @param y y coordinate
+		 * @param z z coordinate
 		 */
-		point(coordinate x, coordinate y)
-			: x(x), y(y) {}
+		point(coordinate x, coordinate y, coordinate z = 0)
+			: x(x), y(y), z(z) {}
 	};
 
 	/**
@@ -165,6 +176,49 @@ namespace pixled {
 		line(point p0, point p1);
 	};
 
+	/**
+	 * A plane with equation a*x + b*y + c*z + d = 0
+	 */
+	struct plane {
+		/**
+		 * a
+		 */
+		coordinate a;
+		/**
+		 * b
+		 */
+		coordinate b;
+		/**
+		 * c
+		 */
+		coordinate c;
+		/**
+		 * d
+		 */
+		coordinate d;
+		/**
+		 * plane constructor.
+		 *
+		 * @param a a
+		 * @param b b
+		 * @param c c
+		 * @param d d
+		 */
+		plane(coordinate a, coordinate b, coordinate c, coordinate d)
+			: a(a), b(b), c(c), d(d) {}
+
+		/**
+		 * Builds a plane passing through `p`, orthogonal to the `normal`
+		 * vector.
+		 */
+		plane(point p, point normal);
+		/**
+		 * Builds a plane passing through the three specified points, that
+		 * must not be aligned.
+		 */
+		plane(point p0, point p1, point p2);
+	};
+
 	/**
 	 * A point hash function object.
 	 */
@@ -177,7 +231,8 @@ namespace pixled {
 		 * ```cpp
 		 * auto hash1 = std::hash<coordinate>{}(p.x);
 		 * auto hash2 = std::hash<coordinate>{}(p.y);
-		 * return hash1 ^ hash2;
+		 * auto hash3 = std::hash<coordinate>{}(p.z);
+		 * return hash1 ^ hash2 ^ hash3;
 		 * ```
 		 *
 		 * @return hash value of `p`
@@ -186,7 +241,7 @@ namespace pixled {
 	};
 
 	/**
-	 * Checks if the two points are equal, i.e. if their x/y coordinates are
+	 * Checks if the two points are equal, i.e. if their x/y/z coordinates are
 	 * equal.
 	 *
 	 * @return true iff `p1` == `p2`
@@ -207,17 +262,40 @@ namespace pixled {
 
 	/**
 	 * Point output stream operator.
+	 *
+	 * The z coordinate is only written if it is not null, so that 2D points
+	 * are printed as `(x,y)`.
 	 */
 	std::ostream& operator<<(std::ostream& o, const point& p);
 
 	/**
 	 * Returns the euclidian distance between the two points.
 	 *
+	 * The z term is skipped when both points have the same z coordinate,
+	 * so that distances between 2D points are computed as in 2D.
+	 *
 	 * @param p1 point 1
 	 * @param p2 point 2
 	 * @return distance between p1 and p2
 	 */
 	float distance(const point& p1, const point& p2);
+	/**
+	 * Returns the euclidian distance between a point and a plane.
+	 *
+	 * @param p point
+	 * @param pl plane
+	 * @return distance between p and pl
+	 */
+	float distance(const point& p, const plane& pl);
+	/**
+	 * Returns the distance between a point and a line, in the `(x, y)`
+	 * plane.
+	 *
+	 * @param p point
+	 * @param l line
+	 * @return distance between p and l
+	 */
+	float distance(const point& p, const line& l);
 	/**
 	 * Computes the cosine of `a`.
 	 *
@@ -4,22 +4,25 @@
 namespace pixled { namespace geometry {
 
 	float Distance::operator()(led l, time t) const {
-		point c1 = this->call<0>(l, t);
-		point c2 = this->call<1>(l, t);
-		return std::sqrt(std::pow(c2.y - c1.y, 2) + std::pow(c2.x - c1.x, 2));
+		return distance(this->call<0>(l, t), this->call<1>(l, t));
 	}
 
 	float LineDistance::operator()(led l, time t) const {
-		line _l = this->call<0>(l, t);
-		point point = this->call<1>(l, t);
-		return std::abs(_l.a * point.x + _l.b * point.y + _l.c) /
-			std::sqrt(std::pow(_l.a, 2) + std::pow(_l.b, 2));
+		return distance(this->call<1>(l, t), this->call<0>(l, t));
+	}
+
+	float PlaneDistance::operator()(led l, time t) const {
+		return distance(this->call<1>(l, t), this->call<0>(l, t));
 	}
 
 	point Point::operator()(led l, time t) const {
 		return {this->call<0>(l, t), this->call<1>(l, t)};
 	}
 
+	point Point3D::operator()(led l, time t) const {
+		return {this->call<0>(l, t), this->call<1>(l, t), this->call<2>(l, t)};
+	}
+
 	angle AngleDeg::operator()(led l, time t) const {
 		return angle::fromDeg(this->call<0>(l, t));
 	}
@@ -47,4 +50,12 @@ namespace pixled { namespace geometry {
 	line PointLine::operator()(led l, time t) const {
 		return {this->call<0>(l, t), this->call<1>(l, t)};
 	}
+
+	plane Plane::operator()(led l, time t) const {
+		return {this->call<0>(l, t), this->call<1>(l, t), this->call<2>(l, t), this->call<3>(l, t)};
+	}
+
+	plane NormalPlane::operator()(led l, time t) const {
+		return {this->call<0>(l, t), this->call<1>(l, t)};
+	}
 }}
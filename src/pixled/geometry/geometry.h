@@ -12,11 +12,26 @@ namespace pixled { namespace geometry {
 	 */
 	class X : public base::Function<coordinate> {
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::X_NODE;
+
 			coordinate operator()(led l, time t) const override {
 				return l.location.x;
 			}
 
 			X* copy() const override {return new X;}
+
+			base::Function<coordinate>* copyInline(void* buffer, std::size_t size) const override {
+				return detail::copy_inline(*this, buffer, size);
+			}
+
+			bool serialize(serialization::Writer& writer) const override {
+				return writer.node(
+						NODE, serialization::value_type<coordinate>::id, nullptr, 0, 0);
+			}
+
+			time periodicity() const override {return 1;}
+
+			bool mayChange(led, time) const override {return false;}
 	};
 
 	/**
@@ -26,11 +41,57 @@ namespace pixled { namespace geometry {
 	 */
 	class Y : public base::Function<coordinate> {
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::Y_NODE;
+
 			coordinate operator()(led l, time t) const override {
 				return l.location.y;
 			}
 
 			Y* copy() const override {return new Y;}
+
+			base::Function<coordinate>* copyInline(void* buffer, std::size_t size) const override {
+				return detail::copy_inline(*this, buffer, size);
+			}
+
+			bool serialize(serialization::Writer& writer) const override {
+				return writer.node(
+						NODE, serialization::value_type<coordinate>::id, nullptr, 0, 0);
+			}
+
+			time periodicity() const override {return 1;}
+
+			bool mayChange(led, time) const override {return false;}
+	};
+
+	/**
+	 * Z coordinate of the point on which the \Function is currently evaluated.
+	 *
+	 * The z coordinate of leds of 2D mappings is always 0.
+	 *
+	 * @retval coordinate current z coordinate
+	 */
+	class Z : public base::Function<coordinate> {
+		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::Z_NODE;
+
+			coordinate operator()(led l, time t) const override {
+				return l.location.z;
+			}
+
+			Z* copy() const override {return new Z;}
+
+			base::Function<coordinate>* copyInline(void* buffer, std::size_t size) const override {
+				return detail::copy_inline(*this, buffer, size);
+			}
+
+			bool serialize(serialization::Writer& writer) const override {
+				return writer.node(
+						NODE, serialization::value_type<coordinate>::id, nullptr, 0, 0);
+			}
+
+			time periodicity() const override {return 1;}
+
+			bool mayChange(led, time) const override {return false;}
 	};
 
 	/**
@@ -40,11 +101,26 @@ namespace pixled { namespace geometry {
 	 */
 	class I : public base::Function<index_t> {
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::I_NODE;
+
 			index_t operator()(led l, time t) const override {
 				return l.index;
 			}
 
 			I* copy() const override {return new I;}
+
+			base::Function<index_t>* copyInline(void* buffer, std::size_t size) const override {
+				return detail::copy_inline(*this, buffer, size);
+			}
+
+			bool serialize(serialization::Writer& writer) const override {
+				return writer.node(
+						NODE, serialization::value_type<index_t>::id, nullptr, 0, 0);
+			}
+
+			time periodicity() const override {return 1;}
+
+			bool mayChange(led, time) const override {return false;}
 	};
 
 	/**
@@ -57,6 +133,7 @@ namespace pixled { namespace geometry {
 	class Distance : public Function<Distance, coordinate, point, point> {
 		public:
 			using Function<Distance, coordinate, point, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::DISTANCE_NODE;
 
 			coordinate operator()(led l, time t) const override;
 	};
@@ -64,6 +141,10 @@ namespace pixled { namespace geometry {
 	/**
 	 * Computes the euclidian distance between a point and a line.
 	 *
+	 * The line is defined in the z=0 plane, and the z coordinate of the
+	 * point is ignored: in 3D, this is the distance to the vertical plane
+	 * that contains the line.
+	 *
 	 * @param line l
 	 * @param point p
 	 * @retval coordinate distance between `l` and `p`
@@ -71,6 +152,22 @@ namespace pixled { namespace geometry {
 	class LineDistance : public Function<LineDistance, coordinate, line, point> {
 		public:
 			using Function<LineDistance, coordinate, line, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::LINE_DISTANCE_NODE;
+
+			coordinate operator()(led l, time t) const override;
+	};
+
+	/**
+	 * Computes the euclidian distance between a point and a plane.
+	 *
+	 * @param plane pl
+	 * @param point p
+	 * @retval coordinate distance between `pl` and `p`
+	 */
+	class PlaneDistance : public Function<PlaneDistance, coordinate, plane, point> {
+		public:
+			using Function<PlaneDistance, coordinate, plane, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::PLANE_DISTANCE_NODE;
 
 			coordinate operator()(led l, time t) const override;
 	};
@@ -91,6 +188,25 @@ namespace pixled { namespace geometry {
 	class Point : public Function<Point, point, coordinate, coordinate> {
 		public:
 			using Function<Point, point, coordinate, coordinate>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::POINT_NODE;
+
+			point operator()(led l, time t) const override;
+	};
+
+	/**
+	 * Functionnal 3D point definition.
+	 *
+	 * Same as Point, with an additionnal z coordinate.
+	 *
+	 * @param coordinate X coordinate
+	 * @param coordinate Y coordinate
+	 * @param coordinate Z coordinate
+	 * @retval point the pixled::point defined by X/Y/Z
+	 */
+	class Point3D : public Function<Point3D, point, coordinate, coordinate, coordinate> {
+		public:
+			using Function<Point3D, point, coordinate, coordinate, coordinate>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::POINT_3D_NODE;
 
 			point operator()(led l, time t) const override;
 	};
@@ -110,6 +226,7 @@ namespace pixled { namespace geometry {
 	class AngleDeg : public Function<AngleDeg, angle, float> {
 		public:
 			using Function<AngleDeg, angle, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::ANGLE_DEG_NODE;
 
 			angle operator()(led l, time t) const override;
 	};
@@ -129,6 +246,7 @@ namespace pixled { namespace geometry {
 	class AngleRad : public Function<AngleRad, angle, float> {
 		public:
 			using Function<AngleRad, angle, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::ANGLE_RAD_NODE;
 
 			angle operator()(led l, time t) const override;
 	};
@@ -150,6 +268,7 @@ namespace pixled { namespace geometry {
 	class Line : public Function<Line, line, coordinate, coordinate, coordinate> {
 		public:
 		using Function<Line, line, coordinate, coordinate, coordinate>::Function;
+		static constexpr serialization::NODE_TYPE NODE = serialization::LINE_NODE;
 
 		line operator()(led l, time t) const override;
 	};
@@ -163,6 +282,7 @@ namespace pixled { namespace geometry {
 	class XLine : public Function<XLine, line, coordinate> {
 		public:
 		using Function<XLine, line, coordinate>::Function;
+		static constexpr serialization::NODE_TYPE NODE = serialization::X_LINE_NODE;
 
 		line operator()(led l, time t) const override;
 	};
@@ -176,6 +296,7 @@ namespace pixled { namespace geometry {
 	class YLine : public Function<YLine, line, coordinate> {
 		public:
 		using Function<YLine, line, coordinate>::Function;
+		static constexpr serialization::NODE_TYPE NODE = serialization::Y_LINE_NODE;
 
 		line operator()(led l, time t) const override;
 	};
@@ -190,10 +311,46 @@ namespace pixled { namespace geometry {
 	class AlphaLine : public Function<AlphaLine, line, point, angle> {
 		public:
 			using Function<AlphaLine, line, point, angle>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::ALPHA_LINE_NODE;
 
 			line operator()(led l, time t) const override;
 	};
 
+	/**
+	 * Functionnal plane definition.
+	 *
+	 * Notice the difference with pixled::plane, that is a **fundamental
+	 * type**, returned by this Plane \Function.
+	 *
+	 * @param coordinate a
+	 * @param coordinate b
+	 * @param coordinate c
+	 * @param coordinate d
+	 * @retval plane plane defined by `a*x + b*y + c*z + d=0`
+	 */
+	class Plane : public Function<Plane, plane, coordinate, coordinate, coordinate, coordinate> {
+		public:
+			using Function<Plane, plane, coordinate, coordinate, coordinate, coordinate>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::PLANE_NODE;
+
+			plane operator()(led l, time t) const override;
+	};
+
+	/**
+	 * Defines a plane from a point and a normal vector.
+	 *
+	 * @param point p
+	 * @param point normal
+	 * @retval plane passing through p, orthogonal to normal
+	 */
+	class NormalPlane : public Function<NormalPlane, plane, point, point> {
+		public:
+			using Function<NormalPlane, plane, point, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::NORMAL_PLANE_NODE;
+
+			plane operator()(led l, time t) const override;
+	};
+
 	/**
 	 * Defines a line from two points.
 	 *
@@ -204,6 +361,7 @@ namespace pixled { namespace geometry {
 	class PointLine : public Function<PointLine, line, point, point> {
 		public:
 			using Function<PointLine, line, point, point>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::POINT_LINE_NODE;
 
 			line operator()(led l, time t) const override;
 	};
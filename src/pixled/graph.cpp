@@ -0,0 +1,740 @@
+#include "graph.h"
+
+#include <algorithm>
+#include "animation/animation.h"
+#include "arithmetic/arithmetic.h"
+#include "chroma/chroma.h"
+#include "chrono/chrono.h"
+#include "conditional/conditional.h"
+#include "geometry/geometry.h"
+#include "random/random.h"
+#include "signal/signal.h"
+
+namespace pixled { namespace detail {
+	using namespace serialization;
+
+	// Alignment of the allocations of an Arena
+	static const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+	/**
+	 * Numeric types supported by the arithmetic and comparison nodes.
+	 */
+	typedef type_list<std::uint8_t, int, unsigned int, unsigned long, float, fixed> numeric_types;
+	/**
+	 * Numeric types supported by Wave and random distributions.
+	 */
+	typedef type_list<std::uint8_t, int, unsigned int, unsigned long, float> real_types;
+	/**
+	 * Types supported by Cast.
+	 */
+	typedef type_list<bool, std::uint8_t, int, unsigned int, unsigned long, float, fixed> scalar_types;
+	/**
+	 * Types supported by If.
+	 */
+	typedef type_list<
+		bool, std::uint8_t, int, unsigned int, unsigned long, float, fixed, point, color> if_types;
+
+	std::uint64_t node_key(
+			NODE_TYPE node, VALUE_TYPE result,
+			const VALUE_TYPE* arg_types, std::size_t arg_count) {
+		std::uint64_t key = (std::uint64_t) node << 56 | (std::uint64_t) arg_count << 48 | result;
+		std::size_t count = arg_count == VARIADIC ? 1 : arg_count;
+		for(std::size_t i = 0; i < count && i < 4; i++)
+			key |= (std::uint64_t) arg_types[i] << (40 - 8*i);
+		return key;
+	}
+
+	/**
+	 * Compile time sum.
+	 */
+	constexpr std::size_t sum() {
+		return 0;
+	}
+
+	/**
+	 * Compile time sum.
+	 */
+	template<typename... Values>
+		constexpr std::size_t sum(std::size_t value, Values... values) {
+			return value + sum(values...);
+		}
+
+	/**
+	 * Integer sequence, used to expand the arguments of a node.
+	 */
+	template<std::size_t... I>
+		struct indices {};
+
+	/**
+	 * Builds the sequence `indices<0, ..., N-1>`.
+	 */
+	template<std::size_t N, std::size_t... I>
+		struct make_indices : make_indices<N-1, N-1, I...> {};
+
+	/**
+	 * Builds the sequence `indices<0, ..., N-1>`.
+	 */
+	template<std::size_t... I>
+		struct make_indices<0, I...> {
+			typedef indices<I...> type;
+		};
+
+	/**
+	 * Builds a Function implemented with the pixled::Function CRTP scheme.
+	 */
+	template<typename Implem, typename R, typename... Args>
+		struct function_builder {
+			template<std::size_t... I>
+				static Implem* create(AnyFunction* args, indices<I...>) {
+					return new Implem(std::move(args[I].template get<Args>())...);
+				}
+
+			static bool build(NodeArguments& arguments, std::size_t, const std::uint8_t*, AnyFunction& function) {
+				AnyFunction args[sizeof...(Args)];
+				for(AnyFunction& arg : args)
+					if(!arguments.next(arg))
+						return false;
+				function.set<R>(FctWrapper<R>::adopt(
+							create(args, typename make_indices<sizeof...(Args)>::type())));
+				return true;
+			}
+
+			static NodeBuilder builder() {
+				const VALUE_TYPE arg_types[] = {value_type<Args>::id...};
+				return {
+					node_key(Implem::NODE, value_type<R>::id, arg_types, sizeof...(Args)),
+					sizeof(Implem), 0, 0, &build
+				};
+			}
+		};
+
+	/**
+	 * NodeBuilder of a CRTP Function, with the arguments of its base.
+	 */
+	template<typename Implem, typename R, typename... Args>
+		NodeBuilder function_node(const Function<Implem, R, Args...>*) {
+			return function_builder<Implem, R, Args...>::builder();
+		}
+
+	/**
+	 * Group of CRTP Functions.
+	 */
+	template<typename... Implems>
+		struct functions {
+			static constexpr std::size_t COUNT = sizeof...(Implems);
+
+			static void add(NodeBuilder*& builders) {
+				const NodeBuilder nodes[] = {function_node((Implems*) nullptr)...};
+				for(const NodeBuilder& node : nodes)
+					*builders++ = node;
+			}
+		};
+
+	/**
+	 * Group of stateless leaves, without arguments.
+	 */
+	template<typename... Implems>
+		struct leaves {
+			static constexpr std::size_t COUNT = sizeof...(Implems);
+
+			template<typename Implem>
+				static bool build(NodeArguments&, std::size_t, const std::uint8_t*, AnyFunction& function) {
+					typedef typename Implem::Type R;
+					function.set<R>(FctWrapper<R>(Implem()));
+					return true;
+				}
+
+			template<typename Implem>
+				static NodeBuilder builder() {
+					typedef typename Implem::Type R;
+					// Small leaves are stored inline by FctWrapper
+					std::size_t size = sizeof(Implem) <= sizeof(Constant<R>)
+						&& alignof(Implem) <= alignof(Constant<R>) ? 0 : sizeof(Implem);
+					return {node_key(Implem::NODE, value_type<R>::id, nullptr, 0), size, 0, 0, &build<Implem>};
+				}
+
+			static void add(NodeBuilder*& builders) {
+				const NodeBuilder nodes[] = {builder<Implems>()...};
+				for(const NodeBuilder& node : nodes)
+					*builders++ = node;
+			}
+		};
+
+	/**
+	 * Group of random engines, built from their period and seed.
+	 */
+	template<typename... Implems>
+		struct random_engines {
+			static constexpr std::size_t COUNT = sizeof...(Implems);
+
+			template<typename Implem>
+				static bool build(NodeArguments&, std::size_t, const std::uint8_t* payload, AnyFunction& function) {
+					time period = (time) load_le(payload, 8);
+					unsigned long seed = (unsigned long) load_le(payload + 8, 8);
+					if(period == 0)
+						return false;
+					function.set<random_engine>(FctWrapper<random_engine>::adopt(new Implem(period, seed)));
+					return true;
+				}
+
+			template<typename Implem>
+				static NodeBuilder builder() {
+					return {
+						node_key(Implem::NODE, RANDOM_ENGINE_VALUE, nullptr, 0),
+						sizeof(Implem), 0, 16, &build<Implem>
+					};
+				}
+
+			static void add(NodeBuilder*& builders) {
+				const NodeBuilder nodes[] = {builder<Implems>()...};
+				for(const NodeBuilder& node : nodes)
+					*builders++ = node;
+			}
+		};
+
+	/**
+	 * animation::Sequence, whose payload contains the duration of each
+	 * animation.
+	 */
+	struct sequences {
+		static constexpr std::size_t COUNT = 1;
+#ifdef PIXLED_NO_HEAP
+		// Items are stored in the Sequence itself
+		static constexpr std::size_t ITEM_SIZE = 0;
+#else
+		// Items are allocated in a single block after the Sequence
+		static constexpr std::size_t ITEM_SIZE = sizeof(std::pair<time, FctWrapper<color>>);
+#endif
+
+		static bool build(
+				NodeArguments& arguments, std::size_t arg_count,
+				const std::uint8_t* payload, AnyFunction& function) {
+#ifdef PIXLED_NO_HEAP
+			if(arg_count > PIXLED_SEQUENCE_CAPACITY)
+				return false;
+#endif
+			animation::Sequence* sequence = new animation::Sequence;
+			FctWrapper<color> wrapper = FctWrapper<color>::adopt(sequence);
+			sequence->reserve(arg_count);
+			for(std::size_t i = 0; i < arg_count; i++) {
+				time duration = (time) load_le(payload + 8*i, 8);
+				AnyFunction animation;
+				if(duration == 0 || !arguments.next(animation))
+					return false;
+				sequence->add(std::move(animation.get<color>()), duration);
+			}
+			function.set<color>(std::move(wrapper));
+			return true;
+		}
+
+		static void add(NodeBuilder*& builders) {
+			const VALUE_TYPE animation = COLOR_VALUE;
+			*builders++ = {
+				node_key(animation::Sequence::NODE, COLOR_VALUE, &animation, VARIADIC),
+				sizeof(animation::Sequence), ITEM_SIZE, 8, &build
+			};
+		}
+	};
+
+	/**
+	 * `Entry<T>` for each type of `Types`.
+	 */
+	template<template<typename> class Entry, typename Types>
+		struct for_each;
+
+	/**
+	 * `Entry<T>` for each type of `Types`.
+	 */
+	template<template<typename> class Entry, typename... Types>
+		struct for_each<Entry, type_list<Types...>> {
+			static constexpr std::size_t COUNT = sum(Entry<Types>::COUNT...);
+
+			static void add(NodeBuilder*& builders) {
+				// Braced lists are evaluated in order
+				const int expand[] = {0, (Entry<Types>::add(builders), 0)...};
+				(void) expand;
+			}
+		};
+
+	/**
+	 * `Entry<T1, T2>` for each pair of types of `Types1` and `Types2`.
+	 */
+	template<template<typename, typename> class Entry, typename Types1, typename Types2>
+		struct for_each_pair;
+
+	/**
+	 * `Entry<T1, T2>` for each pair of types of `Types1` and `Types2`.
+	 */
+	template<template<typename, typename> class Entry, typename... Types1, typename Types2>
+		struct for_each_pair<Entry, type_list<Types1...>, Types2> {
+			template<typename T1>
+				struct row {
+					template<typename T2>
+						using entry = Entry<T1, T2>;
+					typedef for_each<entry, Types2> type;
+				};
+
+			static constexpr std::size_t COUNT = sum(row<Types1>::type::COUNT...);
+
+			static void add(NodeBuilder*& builders) {
+				const int expand[] = {0, (row<Types1>::type::add(builders), 0)...};
+				(void) expand;
+			}
+		};
+
+	/**
+	 * A single Function, if `Enable`.
+	 */
+	template<typename Implem, bool Enable = true>
+		struct function_entry {
+			static constexpr std::size_t COUNT = 1;
+
+			static void add(NodeBuilder*& builders) {
+				*builders++ = function_node((Implem*) nullptr);
+			}
+		};
+
+	/**
+	 * Disabled entry.
+	 */
+	template<typename Implem>
+		struct function_entry<Implem, false> {
+			static constexpr std::size_t COUNT = 0;
+
+			static void add(NodeBuilder*&) {
+			}
+		};
+
+	/**
+	 * Arithmetic operation `Op`, returning the common type of its operands
+	 * as the pixled operators do.
+	 */
+	template<template<typename, typename, typename> class Op>
+		struct arithmetic_op {
+			template<typename P1, typename P2>
+				using entry = function_entry<Op<typename std::common_type<P1, P2>::type, P1, P2>>;
+		};
+
+	/**
+	 * The % operator is only defined on integers and fixed.
+	 */
+	template<typename P1, typename P2>
+		using modulus_entry = function_entry<
+		arithmetic::Modulus<typename std::common_type<P1, P2>::type, P1, P2>,
+		(std::is_integral<P1>::value && std::is_integral<P2>::value)
+			|| std::is_same<P1, fixed>::value || std::is_same<P2, fixed>::value>;
+
+	/**
+	 * True iff comparing `P1` and `P2` mixes signed and unsigned integers,
+	 * after integral promotions.
+	 */
+	template<typename P1, typename P2>
+		struct mixed_signedness {
+			static constexpr bool value = std::is_integral<P1>::value && std::is_integral<P2>::value
+				&& std::is_signed<typename std::common_type<P1, int>::type>::value
+				!= std::is_signed<typename std::common_type<P2, int>::type>::value;
+		};
+
+	/**
+	 * Comparison `Op`, except between signed and unsigned integers.
+	 */
+	template<template<typename, typename> class Op>
+		struct comparison_op {
+			template<typename P1, typename P2>
+				using entry = function_entry<Op<P1, P2>, !mixed_signedness<P1, P2>::value>;
+		};
+
+	/**
+	 * Builds a detail::Cast.
+	 */
+	template<typename To, typename From>
+		struct cast_builder {
+			static bool build(NodeArguments& arguments, std::size_t, const std::uint8_t*, AnyFunction& function) {
+				AnyFunction from;
+				if(!arguments.next(from))
+					return false;
+				function.set<To>(FctWrapper<To>::adopt(new Cast<To, From>(std::move(from.get<From>()))));
+				return true;
+			}
+		};
+
+	/**
+	 * Cast from `From` to `To`. A fixed can only be explicitly converted
+	 * to a float.
+	 */
+	template<typename To, typename From,
+		bool Enable = !std::is_same<From, fixed>::value
+			|| std::is_same<To, float>::value || std::is_same<To, fixed>::value>
+		struct cast_entry {
+			static constexpr std::size_t COUNT = 1;
+
+			static void add(NodeBuilder*& builders) {
+				const VALUE_TYPE from = value_type<From>::id;
+				*builders++ = {
+					node_key(CAST_NODE, value_type<To>::id, &from, 1),
+					sizeof(Cast<To, From>), 0, 0, &cast_builder<To, From>::build
+				};
+			}
+		};
+
+	/**
+	 * Disabled cast.
+	 */
+	template<typename To, typename From>
+		struct cast_entry<To, From, false> {
+			static constexpr std::size_t COUNT = 0;
+
+			static void add(NodeBuilder*&) {
+			}
+		};
+
+	template<typename To, typename From>
+		using cast_pair_entry = cast_entry<To, From>;
+
+	template<typename T>
+		using if_entry = function_entry<conditional::If<T>>;
+
+	template<typename R>
+		using wave_entry = function_entry<animation::Wave<R>>;
+
+	template<typename R>
+		using uniform_distribution_entry = function_entry<random::UniformDistribution<R>>;
+
+	template<typename R>
+		using normal_distribution_entry = function_entry<random::NormalDistribution<R>>;
+
+	/**
+	 * All the groups of built-in nodes.
+	 */
+	template<typename... Groups>
+		struct groups {
+			static constexpr std::size_t COUNT = sum(Groups::COUNT...);
+
+			static void add(NodeBuilder*& builders) {
+				const int expand[] = {0, (Groups::add(builders), 0)...};
+				(void) expand;
+			}
+		};
+
+	typedef groups<
+		leaves<chrono::T, geometry::X, geometry::Y, geometry::Z, geometry::I>,
+		functions<
+			chrono::Phase, chrono::FixedPhase,
+			chroma::hsb, chroma::fixed_hsb, chroma::rgb,
+			geometry::Distance, geometry::LineDistance, geometry::PlaneDistance,
+			geometry::Point, geometry::Point3D, geometry::AngleDeg, geometry::AngleRad,
+			geometry::Line, geometry::XLine, geometry::YLine, geometry::AlphaLine,
+			geometry::Plane, geometry::NormalPlane, geometry::PointLine,
+			signal::Sine, signal::Square, signal::Triangle, signal::Sawtooth,
+			signal::FixedSine, signal::FixedTriangle,
+			animation::LinearUnitWave, animation::RadialUnitWave, animation::Rainbow,
+			animation::RainbowWave, animation::RadialRainbowWave, animation::Blooming,
+			animation::Blink
+			>,
+		random_engines<random::RandomT, random::RandomXYT>,
+		sequences,
+		for_each_pair<arithmetic_op<arithmetic::Plus>::entry, numeric_types, numeric_types>,
+		for_each_pair<arithmetic_op<arithmetic::Minus>::entry, numeric_types, numeric_types>,
+		for_each_pair<arithmetic_op<arithmetic::Multiplies>::entry, numeric_types, numeric_types>,
+		for_each_pair<arithmetic_op<arithmetic::Divides>::entry, numeric_types, numeric_types>,
+		for_each_pair<modulus_entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::Equal>::entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::NotEqual>::entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::LessThan>::entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::LessThanOrEqual>::entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::GreaterThan>::entry, numeric_types, numeric_types>,
+		for_each_pair<comparison_op<conditional::GreaterThanOrEqual>::entry, numeric_types, numeric_types>,
+		for_each_pair<cast_pair_entry, scalar_types, scalar_types>,
+		for_each<if_entry, if_types>,
+		for_each<wave_entry, real_types>,
+		for_each<uniform_distribution_entry, real_types>,
+		for_each<normal_distribution_entry, real_types>
+		> built_in_nodes;
+
+	/**
+	 * NodeBuilders of all the built-in nodes, sorted by key.
+	 */
+	class Registry {
+		private:
+			NodeBuilder builders[built_in_nodes::COUNT];
+
+		public:
+			Registry() {
+				NodeBuilder* end = builders;
+				built_in_nodes::add(end);
+				std::sort(builders, end, [] (const NodeBuilder& b1, const NodeBuilder& b2) {
+						return b1.key < b2.key;
+						});
+			}
+
+			/**
+			 * Finds the first builder whose key is greater or equal to
+			 * `key`, and that has the same key when the bits not set in
+			 * `mask` are ignored.
+			 */
+			const NodeBuilder* find(std::uint64_t key, std::uint64_t mask) const {
+				const NodeBuilder* end = builders + built_in_nodes::COUNT;
+				const NodeBuilder* builder = std::lower_bound(builders, end, key,
+						[] (const NodeBuilder& builder, std::uint64_t key) {
+						return builder.key < key;
+						});
+				if(builder == end || (builder->key & mask) != (key & mask))
+					return nullptr;
+				return builder;
+			}
+
+			/**
+			 * Finds the builders of `node`.
+			 */
+			const NodeBuilder* nodes(NODE_TYPE node, std::size_t& count) const {
+				const NodeBuilder* end = builders + built_in_nodes::COUNT;
+				const NodeBuilder* first = std::lower_bound(builders, end, (std::uint64_t) node << 56,
+						[] (const NodeBuilder& builder, std::uint64_t key) {
+						return builder.key < key;
+						});
+				const NodeBuilder* last = first;
+				while(last != end && (last->key >> 56) == node)
+					last++;
+				count = last - first;
+				return first;
+			}
+	};
+
+	static const Registry& registry() {
+		static const Registry registry;
+		return registry;
+	}
+
+	const NodeBuilder* find_builder(
+			NODE_TYPE node, VALUE_TYPE result,
+			const VALUE_TYPE* arg_types, std::size_t arg_count) {
+		// The result type is stored in the lowest byte of the key
+		std::uint64_t mask = result == UNKNOWN_VALUE ? ~(std::uint64_t) 0xFF : ~(std::uint64_t) 0;
+		if(arg_count <= 4) {
+			const NodeBuilder* builder = registry().find(
+					node_key(node, result, arg_types, arg_count), mask);
+			if(builder != nullptr)
+				return builder;
+		}
+		if(arg_count == 0)
+			return nullptr;
+		for(std::size_t i = 1; i < arg_count; i++)
+			if(arg_types[i] != arg_types[0])
+				return nullptr;
+		return registry().find(node_key(node, result, arg_types, VARIADIC), mask);
+	}
+
+	const NodeBuilder* node_builders(NODE_TYPE node, std::size_t& count) {
+		return registry().nodes(node, count);
+	}
+
+	/**
+	 * Header of a serialized node.
+	 */
+	struct NodeHeader {
+		NODE_TYPE node;
+		VALUE_TYPE result;
+		std::size_t arg_count;
+		const std::uint8_t* arg_types;
+		const std::uint8_t* payload;
+		std::size_t payload_size;
+	};
+
+	/**
+	 * Decodes the value of a CONSTANT_NODE.
+	 */
+	struct ConstantDecoder {
+		const NodeHeader& header;
+		AnyFunction* function;
+
+		template<typename T>
+			bool visit() {
+				if(value_type<T>::SIZE == 0 || header.payload_size != value_type<T>::SIZE)
+					return false;
+				if(function != nullptr)
+					function->set<T>(FctWrapper<T>(value_type<T>::decode(header.payload)));
+				return true;
+			}
+	};
+
+	/**
+	 * Reads the nodes of a serialized graph, in pre-order.
+	 */
+	class GraphReader {
+		private:
+			const std::uint8_t* data;
+			std::size_t size;
+			std::size_t position = 0;
+			unsigned long _nodes = 0;
+
+			bool header(NodeHeader& header) {
+				if(size - position < 4)
+					return false;
+				header.node = (NODE_TYPE) data[position];
+				header.result = (VALUE_TYPE) data[position+1];
+				header.arg_count = (std::size_t) load_le(data + position + 2, 2);
+				position += 4;
+				if(size - position < header.arg_count + 2)
+					return false;
+				header.arg_types = data + position;
+				position += header.arg_count;
+				header.payload_size = (std::size_t) load_le(data + position, 2);
+				position += 2;
+				if(size - position < header.payload_size)
+					return false;
+				header.payload = data + position;
+				position += header.payload_size;
+				_nodes++;
+				return true;
+			}
+
+			const NodeBuilder* builder(const NodeHeader& header) const {
+				VALUE_TYPE arg_types[4];
+				std::size_t arg_count = header.arg_count;
+				for(std::size_t i = 0; i < arg_count && i < 4; i++)
+					arg_types[i] = (VALUE_TYPE) header.arg_types[i];
+				if(arg_count > 4) {
+					// Only variadic nodes, whose arguments all have the
+					// same type, have more than 4 arguments
+					for(std::size_t i = 1; i < arg_count; i++)
+						if(header.arg_types[i] != header.arg_types[0])
+							return nullptr;
+					arg_count = 1;
+				}
+				return find_builder(header.node, header.result, arg_types, arg_count);
+			}
+
+			/**
+			 * Arguments of a node, read from the stream.
+			 */
+			class Arguments : public NodeArguments {
+				private:
+					GraphReader& reader;
+					const NodeHeader& header;
+					unsigned int depth;
+					std::size_t index = 0;
+
+				public:
+					Arguments(GraphReader& reader, const NodeHeader& header, unsigned int depth)
+						: reader(reader), header(header), depth(depth) {}
+
+					bool next(AnyFunction& argument) override {
+						if(index == header.arg_count)
+							return false;
+						std::size_t memory = 0;
+						return reader.read(
+								(VALUE_TYPE) header.arg_types[index++], &argument, memory, depth + 1);
+					}
+
+					bool done() const {
+						return index == header.arg_count;
+					}
+			};
+
+		public:
+			GraphReader(const std::uint8_t* data, std::size_t size)
+				: data(data), size(size) {}
+
+			/**
+			 * Count of nodes read.
+			 */
+			unsigned long nodes() const {
+				return _nodes;
+			}
+
+			/**
+			 * True iff all the nodes have been read.
+			 */
+			bool end() const {
+				return position == size;
+			}
+
+			/**
+			 * Reads the next node, that must return `type`, and its
+			 * arguments.
+			 *
+			 * @param type expected type
+			 * @param function built node, or `nullptr` to only check the
+			 * node and add the memory it requires to `memory`
+			 * @param memory required Arena memory
+			 * @param depth depth of the node in the graph
+			 * @return false if the node is invalid
+			 */
+			bool read(VALUE_TYPE type, AnyFunction* function, std::size_t& memory, unsigned int depth) {
+				NodeHeader header;
+				if(depth > MAX_DEPTH || !this->header(header) || header.result != type)
+					return false;
+				if(header.node == CONSTANT_NODE) {
+					ConstantDecoder decoder {header, function};
+					return header.arg_count == 0 && visit(type, decoder);
+				}
+				const NodeBuilder* builder = this->builder(header);
+				if(builder == nullptr)
+					return false;
+				bool variadic = (builder->key >> 48 & 0xFF) == VARIADIC;
+				if(header.payload_size != builder->payload_size * (variadic ? header.arg_count : 1))
+					return false;
+
+				if(function == nullptr) {
+					memory += (builder->size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+					if(builder->arg_size > 0 && header.arg_count > 0)
+						memory += (builder->arg_size * header.arg_count + ALIGNMENT - 1)
+							/ ALIGNMENT * ALIGNMENT;
+					for(std::size_t i = 0; i < header.arg_count; i++)
+						if(!read((VALUE_TYPE) header.arg_types[i], nullptr, memory, depth + 1))
+							return false;
+					return true;
+				}
+				Arguments arguments(*this, header, depth);
+				return builder->build(arguments, header.arg_count, header.payload, *function)
+					&& arguments.done();
+			}
+	};
+
+	/**
+	 * Checks the header of a serialized graph.
+	 *
+	 * @return reader of the nodes of the graph, or an empty reader if the
+	 * header is invalid
+	 */
+	static GraphReader graph_reader(const std::uint8_t* data, std::size_t size, VALUE_TYPE root) {
+		if(data == nullptr || size < HEADER_SIZE
+				|| std::memcmp(data, "PXFG", 4) != 0
+				|| load_le(data + 4, 2) != VERSION
+				|| data[6] != root
+				|| load_le(data + 12, 4) != size - HEADER_SIZE)
+			return GraphReader(nullptr, 0);
+		return GraphReader(data + HEADER_SIZE, size - HEADER_SIZE);
+	}
+
+	/**
+	 * Reads the graph, and checks that all its nodes have been read.
+	 */
+	static bool read_graph(
+			const std::uint8_t* data, std::size_t size,
+			VALUE_TYPE root, AnyFunction* function, std::size_t& memory) {
+		GraphReader reader = graph_reader(data, size, root);
+		return reader.read(root, function, memory, 0)
+			&& reader.end() && reader.nodes() == load_le(data + 8, 4);
+	}
+
+	bool graph_memory(
+			const std::uint8_t* data, std::size_t size,
+			VALUE_TYPE root, std::size_t& memory) {
+		memory = 0;
+		if(read_graph(data, size, root, nullptr, memory))
+			return true;
+		memory = 0;
+		return false;
+	}
+
+	bool load_graph(
+			const std::uint8_t* data, std::size_t size,
+			VALUE_TYPE root, AnyFunction& function) {
+		std::size_t memory = 0;
+		if(read_graph(data, size, root, &function, memory))
+			return true;
+		function.reset();
+		return false;
+	}
+}}
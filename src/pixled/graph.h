@@ -0,0 +1,556 @@
+#ifndef PIXLED_GRAPH_H
+#define PIXLED_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include "config.h"
+#include "arena.h"
+#include "function.h"
+#include "serialization.h"
+
+#ifndef PIXLED_NO_HEAP
+#include <vector>
+#endif
+
+namespace pixled {
+	namespace detail {
+		/**
+		 * Greatest of the specified sizes.
+		 */
+		constexpr std::size_t max_size(std::size_t size) {
+			return size;
+		}
+
+		/**
+		 * Greatest of the specified sizes.
+		 */
+		template<typename... Sizes>
+			constexpr std::size_t max_size(std::size_t s1, std::size_t s2, Sizes... sizes) {
+				return max_size(s1 > s2 ? s1 : s2, sizes...);
+			}
+
+		/**
+		 * Storage large enough for a FctWrapper of any of the `Types`.
+		 */
+		template<typename Types>
+			struct any_function_storage;
+
+		/**
+		 * Storage large enough for a FctWrapper of any of the `Types`.
+		 */
+		template<typename... Types>
+			struct any_function_storage<serialization::type_list<Types...>> {
+				/**
+				 * Storage type.
+				 */
+				typedef typename std::aligned_storage<
+					max_size(sizeof(FctWrapper<Types>)...),
+					max_size(alignof(FctWrapper<Types>)...)>::type type;
+			};
+
+		/**
+		 * A FctWrapper of any of the serialization::value_types, used to
+		 * build Function graphs whose types are only known at runtime.
+		 */
+		class AnyFunction {
+			private:
+				typename any_function_storage<serialization::value_types>::type storage;
+				serialization::VALUE_TYPE _type = serialization::UNKNOWN_VALUE;
+				void (*destroy)(void* wrapper) = nullptr;
+				void (*move)(void* from, void* to) = nullptr;
+
+				template<typename R>
+					static void destroyWrapper(void* wrapper) {
+						static_cast<FctWrapper<R>*>(wrapper)->~FctWrapper<R>();
+					}
+
+				template<typename R>
+					static void moveWrapper(void* from, void* to) {
+						::new (to) FctWrapper<R>(std::move(*static_cast<FctWrapper<R>*>(from)));
+					}
+
+			public:
+				/**
+				 * Initializes an empty AnyFunction.
+				 */
+				AnyFunction() {}
+
+				AnyFunction(const AnyFunction&) = delete;
+				AnyFunction& operator=(const AnyFunction&) = delete;
+
+				/**
+				 * Takes the function of `other`, that is left empty.
+				 */
+				AnyFunction(AnyFunction&& other) {
+					*this = std::move(other);
+				}
+
+				/**
+				 * Destroys the current function, and takes the function
+				 * of `other`, that is left empty.
+				 */
+				AnyFunction& operator=(AnyFunction&& other) {
+					if(this != &other) {
+						reset();
+						if(other._type != serialization::UNKNOWN_VALUE) {
+							other.move(&other.storage, &storage);
+							_type = other._type;
+							destroy = other.destroy;
+							move = other.move;
+							other.reset();
+						}
+					}
+					return *this;
+				}
+
+				/**
+				 * Replaces the current function by `function`.
+				 *
+				 * @param function function to move in this AnyFunction
+				 */
+				template<typename R>
+					void set(FctWrapper<R>&& function) {
+						static_assert(serialization::value_type<R>::id != serialization::UNKNOWN_VALUE,
+								"R must be a serialization::value_types");
+						reset();
+						::new (&storage) FctWrapper<R>(std::move(function));
+						_type = serialization::value_type<R>::id;
+						destroy = &destroyWrapper<R>;
+						move = &moveWrapper<R>;
+					}
+
+				/**
+				 * Type returned by the function.
+				 *
+				 * @return value type, or serialization::UNKNOWN_VALUE if
+				 * this AnyFunction is empty
+				 */
+				serialization::VALUE_TYPE type() const {
+					return _type;
+				}
+
+				/**
+				 * Gets the function, that must return `R` (see type()).
+				 *
+				 * @return wrapped function
+				 */
+				template<typename R>
+					FctWrapper<R>& get() {
+						return *reinterpret_cast<FctWrapper<R>*>(&storage);
+					}
+
+				/**
+				 * Gets the function, that must return `R` (see type()).
+				 *
+				 * @return wrapped function
+				 */
+				template<typename R>
+					const FctWrapper<R>& get() const {
+						return *reinterpret_cast<const FctWrapper<R>*>(&storage);
+					}
+
+				/**
+				 * Destroys the function, if any.
+				 */
+				void reset() {
+					if(_type != serialization::UNKNOWN_VALUE) {
+						destroy(&storage);
+						_type = serialization::UNKNOWN_VALUE;
+					}
+				}
+
+				~AnyFunction() {
+					reset();
+				}
+		};
+
+		/**
+		 * Source of the functionnal arguments of a node built by a
+		 * NodeBuilder.
+		 */
+		class NodeArguments {
+			public:
+				/**
+				 * Builds the next argument of the node. Arguments are
+				 * requested in order, and always have the types of the
+				 * NodeBuilder key.
+				 *
+				 * @param argument built argument
+				 * @return false if the argument could not be built
+				 */
+				virtual bool next(AnyFunction& argument) = 0;
+
+				virtual ~NodeArguments() {}
+		};
+
+		/**
+		 * Builds a built-in \Function from its arguments.
+		 */
+		struct NodeBuilder {
+			/**
+			 * Identifies the node type, the types of its arguments and
+			 * its return type (see node_key()).
+			 */
+			std::uint64_t key;
+			/**
+			 * Memory allocated by build(), in bytes.
+			 */
+			std::size_t size;
+			/**
+			 * Memory allocated by build() per argument, in bytes, for
+			 * variadic nodes that store their arguments in a separate
+			 * allocation.
+			 */
+			std::size_t arg_size;
+			/**
+			 * Size of the payload of the node, in bytes, per argument
+			 * for variadic nodes.
+			 */
+			std::size_t payload_size;
+			/**
+			 * Builds the node.
+			 *
+			 * @param arguments functionnal arguments of the node
+			 * @param arg_count count of arguments
+			 * @param payload payload of the node
+			 * @param function built node
+			 * @return false if the arguments or the payload are invalid
+			 */
+			bool (*build)(
+					NodeArguments& arguments, std::size_t arg_count,
+					const std::uint8_t* payload, AnyFunction& function);
+
+			/**
+			 * Count of arguments of the node.
+			 *
+			 * @return count of arguments, or VARIADIC
+			 */
+			std::size_t argCount() const {
+				return (key >> 48) & 0xFF;
+			}
+
+			/**
+			 * Type of an argument of the node.
+			 *
+			 * @param i argument index, lower than 4, and 0 for variadic
+			 * nodes
+			 * @return argument type
+			 */
+			serialization::VALUE_TYPE argType(std::size_t i) const {
+				return (serialization::VALUE_TYPE) ((key >> (40 - 8*i)) & 0xFF);
+			}
+
+			/**
+			 * Type returned by the node.
+			 *
+			 * @return result type
+			 */
+			serialization::VALUE_TYPE result() const {
+				return (serialization::VALUE_TYPE) (key & 0xFF);
+			}
+		};
+
+		/**
+		 * Count of arguments of the keys of variadic nodes, i.e.
+		 * animation::Sequence.
+		 */
+		static const std::size_t VARIADIC = 0xFF;
+
+		/**
+		 * Key of a NodeBuilder.
+		 *
+		 * @param node node type
+		 * @param result type returned by the node
+		 * @param arg_types types of the arguments
+		 * @param arg_count count of arguments, at most 4, or VARIADIC if
+		 * all the arguments have the type `arg_types[0]`
+		 * @return key
+		 */
+		std::uint64_t node_key(
+				serialization::NODE_TYPE node, serialization::VALUE_TYPE result,
+				const serialization::VALUE_TYPE* arg_types, std::size_t arg_count);
+
+		/**
+		 * Finds the NodeBuilder of a built-in \Function.
+		 *
+		 * @param node node type
+		 * @param result type returned by the node, or
+		 * serialization::UNKNOWN_VALUE to find the first node that
+		 * accepts the specified arguments
+		 * @param arg_types types of the arguments
+		 * @param arg_count count of arguments
+		 * @return builder, or `nullptr` if no built-in \Function matches
+		 */
+		const NodeBuilder* find_builder(
+				serialization::NODE_TYPE node, serialization::VALUE_TYPE result,
+				const serialization::VALUE_TYPE* arg_types, std::size_t arg_count);
+
+		/**
+		 * All the NodeBuilders of a node type, i.e. of all the
+		 * instantiations of a built-in \Function template.
+		 *
+		 * @param node node type
+		 * @param count set to the count of builders
+		 * @return builders, sorted by key
+		 */
+		const NodeBuilder* node_builders(serialization::NODE_TYPE node, std::size_t& count);
+
+		/**
+		 * Checks a serialized graph, and computes the Arena memory
+		 * required to load it.
+		 *
+		 * @param data serialized graph
+		 * @param size size of `data`
+		 * @param root type returned by the graph
+		 * @param memory required memory, in bytes, if `data` is aligned
+		 * on `alignof(std::max_align_t)`
+		 * @return false if `data` is not a valid graph returning `root`
+		 */
+		bool graph_memory(
+				const std::uint8_t* data, std::size_t size,
+				serialization::VALUE_TYPE root, std::size_t& memory);
+
+		/**
+		 * Builds a serialized graph, allocating its nodes with `new` (see
+		 * ArenaScope).
+		 *
+		 * @param data serialized graph
+		 * @param size size of `data`
+		 * @param root type returned by the graph
+		 * @param function built graph
+		 * @return false if `data` is not a valid graph returning `root`
+		 */
+		bool load_graph(
+				const std::uint8_t* data, std::size_t size,
+				serialization::VALUE_TYPE root, AnyFunction& function);
+	}
+
+	/**
+	 * Serializes the Function graph `f` to `buffer`, in the binary format
+	 * described in serialization.
+	 *
+	 * The graph can then be loaded with a FunctionGraph, e.g. from a file
+	 * or from the network.
+	 *
+	 * ```cpp
+	 * std::size_t size = pixled::serialize(animation, nullptr, 0);
+	 * std::uint8_t* data = new std::uint8_t[size];
+	 * pixled::serialize(animation, data, size);
+	 * ```
+	 *
+	 * @param f root of the graph
+	 * @param buffer output buffer
+	 * @param capacity size of `buffer`
+	 * @return size of the serialized graph, or 0 if the graph contains
+	 * Functions or Constants that can't be serialized (see
+	 * base::Function::serialize()). If `capacity` is lower than the
+	 * returned size, the header of the graph is not written, so that the
+	 * truncated buffer can't be loaded.
+	 */
+	template<typename R>
+		std::size_t serialize(const base::Function<R>& f, std::uint8_t* buffer, std::size_t capacity) {
+			serialization::Writer writer(buffer, capacity);
+			if(!f.serialize(writer))
+				return 0;
+			return writer.finish(serialization::value_type<R>::id);
+		}
+
+#ifndef PIXLED_NO_HEAP
+	/**
+	 * Serializes the Function graph `f` (see serialize(const
+	 * base::Function<R>&, std::uint8_t*, std::size_t)).
+	 *
+	 * Not available in heap-free mode.
+	 *
+	 * @param f root of the graph
+	 * @return serialized graph, or an empty vector if the graph can't be
+	 * serialized
+	 */
+	template<typename R>
+		std::vector<std::uint8_t> serialize(const base::Function<R>& f) {
+			std::vector<std::uint8_t> data(serialize(f, nullptr, 0));
+			if(!data.empty())
+				serialize(f, data.data(), data.size());
+			return data;
+		}
+#endif
+
+	/**
+	 * A \Function loaded from a graph serialized with serialize().
+	 *
+	 * All the nodes of the graph are allocated in a single Arena, sized
+	 * exactly for the graph before it is built: loading a graph only
+	 * requires a single allocation, or none in a user provided Arena, so
+	 * that scenes can be switched between two frames.
+	 *
+	 * A FunctionGraph can be directly passed to a Runtime:
+	 * ```cpp
+	 * pixled::FunctionGraph<pixled::color> scene(data, size);
+	 * if(scene.isValid())
+	 * 	pixled::Runtime runtime(mapping, output, scene);
+	 * ```
+	 *
+	 * Graphs that contain unknown nodes, or that were serialized with
+	 * another format VERSION, can't be loaded: the FunctionGraph then
+	 * returns a default value (e.g. black).
+	 *
+	 * @tparam R type returned by the graph
+	 */
+	template<typename R>
+		class FunctionGraph : public base::Function<R> {
+			private:
+				typename std::aligned_storage<sizeof(Arena), alignof(Arena)>::type arena_storage;
+				Arena* arena = nullptr;
+				bool owned_arena = false;
+				std::size_t _memory = 0;
+				bool valid = false;
+				FctWrapper<R> root;
+
+				static R defaultValue() {
+					static const std::uint8_t zero[16] = {};
+					return serialization::value_type<R>::decode(zero);
+				}
+
+				void load(const std::uint8_t* data, std::size_t size) {
+					detail::AnyFunction function;
+					{
+						ArenaScope scope(*arena);
+						valid = detail::load_graph(data, size, serialization::value_type<R>::id, function);
+					}
+					if(valid)
+						root = std::move(function.template get<R>());
+				}
+
+			public:
+				static_assert(serialization::value_type<R>::id != serialization::UNKNOWN_VALUE,
+						"R must be a serialization::value_types");
+
+#ifndef PIXLED_NO_HEAP
+				/**
+				 * Loads the graph serialized in `data`, in an Arena
+				 * allocated for this graph.
+				 *
+				 * Not available in heap-free mode.
+				 *
+				 * @param data serialized graph
+				 * @param size size of `data`
+				 */
+				FunctionGraph(const std::uint8_t* data, std::size_t size)
+					: root(defaultValue()) {
+						if(!detail::graph_memory(data, size, serialization::value_type<R>::id, _memory))
+							return;
+						arena = ::new (&arena_storage) Arena(_memory);
+						owned_arena = true;
+						load(data, size);
+					}
+
+				/**
+				 * Loads the graph serialized in `data`, in an Arena
+				 * allocated for this graph.
+				 *
+				 * Not available in heap-free mode.
+				 *
+				 * @param data serialized graph
+				 */
+				FunctionGraph(const std::vector<std::uint8_t>& data)
+					: FunctionGraph(data.data(), data.size()) {}
+#endif
+
+				/**
+				 * Loads the graph serialized in `data` in `arena`, that
+				 * must outlive this FunctionGraph.
+				 *
+				 * Nothing is allocated if the space left in `arena` is too
+				 * small for the graph (see memory()).
+				 *
+				 * @param data serialized graph
+				 * @param size size of `data`
+				 * @param arena arena in which nodes are allocated
+				 */
+				FunctionGraph(const std::uint8_t* data, std::size_t size, Arena& arena)
+					: root(defaultValue()) {
+						if(!detail::graph_memory(data, size, serialization::value_type<R>::id, _memory))
+							return;
+						// Accounts for the alignment of the first node
+						if(arena.capacity() - arena.used() < _memory + alignof(std::max_align_t) - 1)
+							return;
+						this->arena = &arena;
+						load(data, size);
+					}
+
+				FunctionGraph(const FunctionGraph&) = delete;
+				FunctionGraph& operator=(const FunctionGraph&) = delete;
+
+				/**
+				 * Returns false if the graph could not be loaded.
+				 *
+				 * @return true iff the graph was loaded
+				 */
+				bool isValid() const {
+					return valid;
+				}
+
+				/**
+				 * Arena memory required by the nodes of the graph.
+				 *
+				 * @return size in bytes, or 0 if the graph is not valid
+				 */
+				std::size_t memory() const {
+					return _memory;
+				}
+
+				/**
+				 * Root of the loaded graph.
+				 *
+				 * @return root function
+				 */
+				const base::Function<R>& get() const {
+					return *root;
+				}
+
+				R operator()(led l, time t) const override {
+					return root(l, t);
+				}
+
+				/**
+				 * Copies the graph, out of its Arena.
+				 */
+				base::Function<R>* copy() const override {
+					return (*root).copy();
+				}
+
+				time periodicity() const override {
+					return (*root).periodicity();
+				}
+
+				bool mayChange(led l, time t) const override {
+					return (*root).mayChange(l, t);
+				}
+
+				bool stateless() const override {
+					return (*root).stateless();
+				}
+
+				const R* constant() const override {
+					return (*root).constant();
+				}
+
+				bool serialize(serialization::Writer& writer) const override {
+					return (*root).serialize(writer);
+				}
+
+				/**
+				 * Destroys the graph, and its Arena if it was allocated
+				 * by this FunctionGraph.
+				 */
+				~FunctionGraph() {
+					// Nodes are destroyed before their Arena
+					root = FctWrapper<R>(defaultValue());
+					if(owned_arena)
+						arena->~Arena();
+				}
+		};
+}
+#endif
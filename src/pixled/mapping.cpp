@@ -1,5 +1,9 @@
 #include "mapping.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
 namespace pixled {
 
 	bool operator==(const led& l1, const led& l2) {
@@ -10,8 +14,184 @@ namespace pixled {
 		return l1 == l2;
 	}
 
+	led grid::operator[](index_t i) const {
+		index_t j = i / line_length;
+		index_t k = i % line_length;
+		if(snake && j % 2 == 1)
+			k = line_length - 1 - k;
+		return {{
+			origin.x + k * step.x + j * line_step.x,
+			origin.y + k * step.y + j * line_step.y,
+			origin.z + k * step.z + j * line_step.z
+			}, i};
+	}
+
+	led_view::const_iterator::const_iterator(const Mapping* mapping, index_t n)
+		: mapping(mapping), n(n) {
+			if(n < mapping->size())
+				current = mapping->at(n);
+		}
+
+	led_view::const_iterator& led_view::const_iterator::operator++() {
+		if(++n < mapping->size())
+			current = mapping->at(n);
+		return *this;
+	}
+
+	led_view::const_iterator led_view::const_iterator::operator++(int) {
+		const_iterator it = *this;
+		++*this;
+		return it;
+	}
+
+	led_view::const_iterator led_view::begin() const {
+		return {&mapping, 0};
+	}
+
+	led_view::const_iterator led_view::end() const {
+		return {&mapping, mapping.size()};
+	}
+
+	index_t led_view::size() const {
+		return mapping.size();
+	}
+
+	led led_view::operator[](index_t n) const {
+		return mapping.at(n);
+	}
+
+	Mapping::Mapping(const grid& layout)
+		: _grid(layout), implicit(true) {
+			if(layout.size() > 0) {
+				// Extreme leds of the first and last lines
+				b_box.stretchTo(layout[0].location);
+				b_box.stretchTo(layout[layout.line_length-1].location);
+				b_box.stretchTo(layout[layout.size()-layout.line_length].location);
+				b_box.stretchTo(layout[layout.size()-1].location);
+			}
+		}
+
+	index_t Mapping::size() const {
+		return implicit ? _grid.size() : _index.size();
+	}
+
+	void Mapping::store(const led& led) {
+		if(led.location.z != 0 && _z.empty())
+			// First 3D led: previous leds are in the z=0 plane
+			_z.resize(_index.size(), 0);
+		_x.push_back(led.location.x);
+		_y.push_back(led.location.y);
+		if(!_z.empty())
+			_z.push_back(led.location.z);
+		_index.push_back(led.index);
+	}
+
 	void Mapping::push(const led& led) {
+		if(implicit) {
+			implicit = false;
+			_grid.forEach([this] (const pixled::led& l) {
+					store(l);
+					});
+		}
 		b_box.stretchTo(led.location);
-		_leds.push_back(led);
+		store(led);
+	}
+
+#ifndef PIXLED_NO_HEAP
+	/*
+	 * Spreads the 16 bits of v so that 1 bit out of `stride` is used.
+	 */
+	static std::uint64_t spread_bits(std::uint64_t v, unsigned int stride) {
+		std::uint64_t result = 0;
+		for(unsigned int i = 0; i < 16; i++)
+			result |= ((v >> i) & 1) << (stride * i);
+		return result;
+	}
+
+	static std::uint64_t morton_key(std::uint64_t x, std::uint64_t y, std::uint64_t z, bool is_3d) {
+		if(is_3d)
+			return spread_bits(x, 3) | (spread_bits(y, 3) << 1) | (spread_bits(z, 3) << 2);
+		return spread_bits(x, 2) | (spread_bits(y, 2) << 1);
+	}
+
+	/*
+	 * Classical conversion of (x, y) to the distance along a Hilbert curve
+	 * filling a 2^16 x 2^16 square.
+	 */
+	static std::uint64_t hilbert_key(std::uint64_t x, std::uint64_t y) {
+		const std::uint64_t n = 1 << 16;
+		std::uint64_t d = 0;
+		for(std::uint64_t s = n / 2; s > 0; s /= 2) {
+			std::uint64_t rx = (x & s) > 0;
+			std::uint64_t ry = (y & s) > 0;
+			d += s * s * ((3 * rx) ^ ry);
+			// Rotates the quadrant
+			if(ry == 0) {
+				if(rx == 1) {
+					x = n-1 - x;
+					y = n-1 - y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return d;
+	}
+
+	template<typename Vector, typename Order>
+		static void apply_permutation(Vector& v, const Order& order) {
+			if(v.empty())
+				return;
+			Vector sorted;
+			sorted.reserve(v.size());
+			for(index_t n : order)
+				sorted.push_back(v[n]);
+			v = std::move(sorted);
+		}
+
+	void Mapping::sort(SPACE_FILLING_CURVE curve) {
+		if(implicit) {
+			implicit = false;
+			_grid.forEach([this] (const pixled::led& l) {
+					store(l);
+					});
+		}
+
+		// Quantizes coordinates on 16 bits in the mapping bounds
+		coordinate min[3] {0, 0, 0};
+		coordinate max[3] {0, 0, 0};
+		const bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY>* coordinates[3] {&_x, &_y, &_z};
+		for(int i = 0; i < 3; i++) {
+			if(!coordinates[i]->empty()) {
+				auto bounds = std::minmax_element(coordinates[i]->begin(), coordinates[i]->end());
+				min[i] = *bounds.first;
+				max[i] = *bounds.second;
+			}
+		}
+		coordinate range = std::max(max[0]-min[0], std::max(max[1]-min[1], max[2]-min[2]));
+		coordinate scale = range > 0 ? 65535 / range : 0;
+
+		bounded_vector<std::uint64_t, PIXLED_MAPPING_CAPACITY> keys(_index.size());
+		for(index_t n = 0; n < _index.size(); n++) {
+			std::uint64_t q[3] {0, 0, 0};
+			for(int i = 0; i < 3; i++)
+				if(!coordinates[i]->empty())
+					q[i] = (std::uint64_t) (((*coordinates[i])[n] - min[i]) * scale);
+			keys[n] = curve == HILBERT_CURVE ?
+				hilbert_key(q[0], q[1]) : morton_key(q[0], q[1], q[2], !_z.empty());
+		}
+
+		bounded_vector<index_t, PIXLED_MAPPING_CAPACITY> order(_index.size());
+		std::iota(order.begin(), order.end(), 0);
+		// Ties are broken by wiring order, as a stable sort would do, but
+		// without any temporary buffer
+		std::sort(order.begin(), order.end(), [&keys] (index_t n1, index_t n2) {
+				return keys[n1] < keys[n2] || (keys[n1] == keys[n2] && n1 < n2);
+				});
+
+		apply_permutation(_x, order);
+		apply_permutation(_y, order);
+		apply_permutation(_z, order);
+		apply_permutation(_index, order);
 	}
+#endif
 }
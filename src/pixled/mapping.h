@@ -2,7 +2,9 @@
 #define PIXLED_MAPPING_API_H
 
 #include <vector>
+#include <iterator>
 #include "geometry.h"
+#include "containers.h"
 
 namespace pixled {
 	/**
@@ -13,8 +15,8 @@ namespace pixled {
 	/**
 	 * Basic structure used to represent an led.
 	 *
-	 * A 2D `location` is associated to the led with the specified `index` on
-	 * the led strip.
+	 * A `location` is associated to the led with the specified `index` on the
+	 * led strip.
 	 */
 	struct led {
 		/**
@@ -56,40 +58,421 @@ namespace pixled {
 		bool operator()(const led& l1, const led& l2) const;
 	};
 
+	/**
+	 * A regular grid layout, from which the location of any led can be
+	 * computed from its index.
+	 *
+	 * Leds are organized in `line_count` lines of `line_length` leds, indexed
+	 * line after line. The led `k` of the line `j` is located at `origin +
+	 * j*line_step + k*step`.
+	 *
+	 * If `snake` is true, odd lines are run in the opposite direction, as it
+	 * is usually the case with zig-zag wired led panels.
+	 */
+	struct grid {
+		/**
+		 * Number of leds in each line.
+		 */
+		index_t line_length;
+		/**
+		 * Number of lines.
+		 */
+		index_t line_count;
+		/**
+		 * Location of the first led of the first line.
+		 */
+		point origin;
+		/**
+		 * Offset between two consecutive leds of a line.
+		 */
+		point step;
+		/**
+		 * Offset between two consecutive lines.
+		 */
+		point line_step;
+		/**
+		 * True iff odd lines are run in the opposite direction.
+		 */
+		bool snake;
+
+		/**
+		 * grid constructor.
+		 *
+		 * @param line_length number of leds in each line
+		 * @param line_count number of lines
+		 * @param origin location of the first led
+		 * @param step offset between two consecutive leds of a line
+		 * @param line_step offset between two consecutive lines
+		 * @param snake true iff odd lines are run in the opposite direction
+		 */
+		grid(index_t line_length, index_t line_count,
+				point origin, point step, point line_step, bool snake = false)
+			: line_length(line_length), line_count(line_count),
+			origin(origin), step(step), line_step(line_step), snake(snake) {}
+
+		/**
+		 * Total number of leds in the grid.
+		 */
+		index_t size() const {
+			return line_length * line_count;
+		}
+
+		/**
+		 * Computes the led at index `i`.
+		 *
+		 * @param i led index
+		 * @return led at index `i`
+		 */
+		led operator[](index_t i) const;
+
+		/**
+		 * Calls `f` on each led of the grid, in index order.
+		 *
+		 * Locations are computed incrementally line by line, so that
+		 * iterating over the grid only costs a few additions per led.
+		 *
+		 * @tparam F automatically deduced function object, callable with a
+		 * led argument
+		 * @param f function object
+		 */
+		template<typename F>
+			void forEach(F&& f) const {
+				index_t index = 0;
+				for(index_t j = 0; j < line_count; j++) {
+					point p {
+						origin.x + j * line_step.x,
+						origin.y + j * line_step.y,
+						origin.z + j * line_step.z
+					};
+					coordinate dx = step.x;
+					coordinate dy = step.y;
+					coordinate dz = step.z;
+					if(snake && j % 2 == 1) {
+						p.x += (line_length-1) * dx;
+						p.y += (line_length-1) * dy;
+						p.z += (line_length-1) * dz;
+						dx = -dx;
+						dy = -dy;
+						dz = -dz;
+					}
+					for(index_t k = 0; k < line_length; k++) {
+						f(led(p, index++));
+						p.x += dx;
+						p.y += dy;
+						p.z += dz;
+					}
+				}
+			}
+	};
+
+	struct Mapping;
+
+	/**
+	 * Space filling curves that can be used to sort the leds of a Mapping,
+	 * see Mapping::sort().
+	 */
+	enum SPACE_FILLING_CURVE {
+		/**
+		 * [Z-order curve](https://en.wikipedia.org/wiki/Z-order_curve), in
+		 * 2D or 3D.
+		 */
+		MORTON_CURVE,
+		/**
+		 * [Hilbert curve](https://en.wikipedia.org/wiki/Hilbert_curve),
+		 * computed in the z=0 plane. Its locality is better than the one of
+		 * the Morton curve, but keys are a bit longer to compute.
+		 */
+		HILBERT_CURVE
+	};
+
+	/**
+	 * A read-only view of the leds contained in a Mapping.
+	 *
+	 * The view can be iterated as a standard container of leds, but each led
+	 * is built on the fly from the Mapping storage, so that leds are never
+	 * stored as such.
+	 */
+	class led_view {
+		private:
+			const Mapping& mapping;
+
+		public:
+			/**
+			 * Type of the values of the view.
+			 */
+			typedef led value_type;
+
+			/**
+			 * Forward iterator over the leds of the view.
+			 *
+			 * The led pointed by the iterator is owned by the iterator
+			 * itself, so references to it are invalidated when the
+			 * iterator is incremented or destroyed.
+			 */
+			class const_iterator {
+				private:
+					const Mapping* mapping;
+					index_t n;
+					led current {{0, 0}, 0};
+
+				public:
+					/**
+					 * Iterator category.
+					 */
+					typedef std::forward_iterator_tag iterator_category;
+					/**
+					 * Iterator value type.
+					 */
+					typedef led value_type;
+					/**
+					 * Iterator difference type.
+					 */
+					typedef std::ptrdiff_t difference_type;
+					/**
+					 * Iterator pointer type.
+					 */
+					typedef const led* pointer;
+					/**
+					 * Iterator reference type.
+					 */
+					typedef const led& reference;
+
+					/**
+					 * Builds an iterator on the `n`-th led of the mapping.
+					 */
+					const_iterator(const Mapping* mapping, index_t n);
+
+					/**
+					 * Current led.
+					 */
+					const led& operator*() const {return current;}
+					/**
+					 * Current led.
+					 */
+					const led* operator->() const {return &current;}
+
+					/**
+					 * Steps to the next led.
+					 */
+					const_iterator& operator++();
+					/**
+					 * Steps to the next led.
+					 */
+					const_iterator operator++(int);
+
+					/**
+					 * Checks if the two iterators point to the same led.
+					 */
+					bool operator==(const const_iterator& other) const {
+						return n == other.n;
+					}
+					/**
+					 * Checks if the two iterators point to different leds.
+					 */
+					bool operator!=(const const_iterator& other) const {
+						return n != other.n;
+					}
+			};
+			/**
+			 * Iterator type (leds can't be modified through the view).
+			 */
+			typedef const_iterator iterator;
+
+			/**
+			 * Builds a view of the leds of `mapping`.
+			 */
+			led_view(const Mapping& mapping) : mapping(mapping) {}
+
+			/**
+			 * Iterator on the first led.
+			 */
+			const_iterator begin() const;
+			/**
+			 * Past the end iterator.
+			 */
+			const_iterator end() const;
+			/**
+			 * Number of leds.
+			 */
+			index_t size() const;
+			/**
+			 * Returns the `n`-th led of the mapping.
+			 */
+			led operator[](index_t n) const;
+	};
+
 	/**
 	 * The Mapping is an essential pixled component.
 	 *
 	 * It is used to described all the leds contained in the current system, so
 	 * that the Runtime can apply an Animation on each led.
 	 *
-	 * A Mapping can be used to define **any** 2D led shape, without any
+	 * A Mapping can be used to define **any** 2D or 3D led shape, without any
 	 * restriction.
 	 *
+	 * Leds are stored as a structure of arrays (one array per coordinate, and
+	 * one for indexes), so that leds can be processed in batch. The z array
+	 * is only allocated once a led with a non null z coordinate is pushed,
+	 * so that 2D mappings don't store z coordinates (in heap-free mode, the
+	 * fixed capacity z array is still reserved). Leds built from a Mapping
+	 * still carry a null z coordinate (see point).
+	 *
+	 * Regular shapes can also be described by an _implicit_ Mapping, built
+	 * from a grid: in this case, leds are not stored but computed on the fly
+	 * from their index, so that the memory used by the Mapping does not
+	 * depend on the led count.
+	 *
 	 * See the \ref mapping namespace for predefined mappings.
 	 */
 	struct Mapping {
 		private:
-			std::vector<led> _leds;
+			bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY> _x;
+			bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY> _y;
+			bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY> _z;
+			bounded_vector<index_t, PIXLED_MAPPING_CAPACITY> _index;
 			bounding_box b_box;
+			grid _grid {0, 0, {0, 0}, {0, 0}, {0, 0}};
+			bool implicit = false;
+
+			void store(const led& led);
+
 		public:
 			/**
-			 * Returns all the leds contained in this mapping.
+			 * Initializes an empty Mapping.
+			 *
+			 * Leds can be added using the push() method.
+			 */
+			Mapping() {}
+
+			/**
+			 * Initializes an implicit Mapping, whose leds are computed from
+			 * the specified `layout` instead of being stored.
+			 *
+			 * @param layout regular grid layout of the leds
+			 */
+			Mapping(const grid& layout);
+
+			/**
+			 * Returns a view of all the leds contained in this mapping.
 			 */
-			const std::vector<led>& leds() const {
-				return _leds;
+			led_view leds() const {
+				return {*this};
 			}
 
+			/**
+			 * Number of leds contained in this mapping.
+			 */
+			index_t size() const;
+
+			/**
+			 * Returns the `n`-th led of this mapping.
+			 *
+			 * Notice that `n` is the position of the led in the mapping, that
+			 * is not necessarily its index on the led strip.
+			 *
+			 * @param n led position
+			 * @return `n`-th led
+			 */
+			led at(index_t n) const {
+				if(implicit)
+					return _grid[n];
+				return {{_x[n], _y[n], _z.empty() ? 0 : _z[n]}, _index[n]};
+			}
+
+			/**
+			 * x coordinates of the stored leds.
+			 */
+			const bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY>& xs() const {return _x;}
+			/**
+			 * y coordinates of the stored leds.
+			 */
+			const bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY>& ys() const {return _y;}
+			/**
+			 * z coordinates of the stored leds, that is empty if all the leds
+			 * are located in the z=0 plane.
+			 */
+			const bounded_vector<coordinate, PIXLED_MAPPING_CAPACITY>& zs() const {return _z;}
+			/**
+			 * Indexes of the stored leds.
+			 */
+			const bounded_vector<index_t, PIXLED_MAPPING_CAPACITY>& indexes() const {return _index;}
+
+			/**
+			 * Returns the grid layout of this Mapping if it is implicit, or
+			 * `nullptr` if leds are explicitly stored.
+			 *
+			 * @return implicit grid layout, or `nullptr`
+			 */
+			const grid* implicitGrid() const {
+				return implicit ? &_grid : nullptr;
+			}
+
+			/**
+			 * Calls `f` on each led of the mapping, in the mapping order.
+			 *
+			 * This is the most efficient way to iterate over the leds of the
+			 * mapping, since the loop is specialized according to the
+			 * storage of the mapping (implicit, 2D or 3D).
+			 *
+			 * @tparam F automatically deduced function object, callable with a
+			 * led argument
+			 * @param f function object
+			 */
+			template<typename F>
+				void forEach(F&& f) const {
+					if(implicit) {
+						_grid.forEach(std::forward<F>(f));
+					} else if(_z.empty()) {
+						for(index_t n = 0; n < _index.size(); n++)
+							f(led({_x[n], _y[n]}, _index[n]));
+					} else {
+						for(index_t n = 0; n < _index.size(); n++)
+							f(led({_x[n], _y[n], _z[n]}, _index[n]));
+					}
+				}
+
 			/**
 			 * Push a new led in the mapping. It is the responsability of the
 			 * user to ensure that the led indexes are consistent.
 			 *
+			 * If the mapping is implicit, its leds are built and it becomes
+			 * an explicit mapping.
+			 *
 			 * @param led led to add to the mapping
 			 */
 			void push(const led& led);
 
+#ifndef PIXLED_NO_HEAP
+			/**
+			 * Sorts the leds of this mapping along the specified space
+			 * filling curve.
+			 *
+			 * By default, leds are iterated in the order they were pushed,
+			 * that follows the wiring of the led strip. With snake or column
+			 * wired panels, consecutive leds might then be far from each
+			 * other in memory for anything spatially indexed (textures,
+			 * spatial caches...). Once sorted, leds that are close in space
+			 * are also close in the iteration order.
+			 *
+			 * Led indexes are left unchanged, so that each color is still
+			 * written at the right position on the led strip.
+			 *
+			 * The sort uses temporary heap buffers: one 64 bits key and one
+			 * index per led, and a copy of each coordinate array while it is
+			 * reordered. They are released once the sort is performed. An
+			 * implicit mapping becomes explicit, since its order is fixed
+			 * by its grid layout.
+			 *
+			 * Not available in heap-free mode.
+			 *
+			 * @param curve space filling curve to follow
+			 */
+			void sort(SPACE_FILLING_CURVE curve);
+#endif
+
 			/**
 			 * Minimalist box around all the leds currently contained in the
-			 * mapping.
+			 * mapping, projected on the z=0 plane.
 			 * 
 			 * The bounding box is updated each time push() is called.
 			 *
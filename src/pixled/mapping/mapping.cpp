@@ -327,4 +327,56 @@ namespace pixled { namespace mapping {
 			down_to_top = !down_to_top;
 		}
 	}
+
+	ImplicitLedStrip::ImplicitLedStrip(index_t length)
+		: Mapping(grid(length, 1, {.5, 0}, {1, 0}, {0, 0})), length(length) {
+	}
+
+	/*
+	 * Builds the grid corresponding to the LedPanel drawn with the specified
+	 * linking.
+	 */
+	static grid panel_grid(index_t width, index_t height, PANEL_LINKING linking) {
+		coordinate w = width;
+		coordinate h = height;
+		switch(linking) {
+			case LEFT_RIGHT_LEFT_RIGHT_FROM_BOTTOM:
+				return {width, height, {.5, 0}, {1, 0}, {0, 1}};
+			case LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM:
+				return {width, height, {.5, 0}, {1, 0}, {0, 1}, true};
+			case RIGHT_LEFT_RIGHT_LEFT_FROM_BOTTOM:
+				return {width, height, {w-.5f, 0}, {-1, 0}, {0, 1}};
+			case RIGHT_LEFT_LEFT_RIGHT_FROM_BOTTOM:
+				return {width, height, {w-.5f, 0}, {-1, 0}, {0, 1}, true};
+			case LEFT_RIGHT_LEFT_RIGHT_FROM_TOP:
+				return {width, height, {.5, h-1}, {1, 0}, {0, -1}};
+			case LEFT_RIGHT_RIGHT_LEFT_FROM_TOP:
+				return {width, height, {.5, h-1}, {1, 0}, {0, -1}, true};
+			case RIGHT_LEFT_RIGHT_LEFT_FROM_TOP:
+				return {width, height, {w-.5f, h-1}, {-1, 0}, {0, -1}};
+			case RIGHT_LEFT_LEFT_RIGHT_FROM_TOP:
+				return {width, height, {w-.5f, h-1}, {-1, 0}, {0, -1}, true};
+			case TOP_DOWN_TOP_DOWN_FROM_LEFT:
+				return {height, width, {0, h-.5f}, {0, -1}, {1, 0}};
+			case TOP_DOWN_DOWN_TOP_FROM_LEFT:
+				return {height, width, {0, h-.5f}, {0, -1}, {1, 0}, true};
+			case DOWN_TOP_DOWN_TOP_FROM_LEFT:
+				return {height, width, {0, .5}, {0, 1}, {1, 0}};
+			case DOWN_TOP_TOP_DOWN_FROM_LEFT:
+				return {height, width, {0, .5}, {0, 1}, {1, 0}, true};
+			case TOP_DOWN_TOP_DOWN_FROM_RIGHT:
+				return {height, width, {w-1, h-.5f}, {0, -1}, {-1, 0}};
+			case TOP_DOWN_DOWN_TOP_FROM_RIGHT:
+				return {height, width, {w-1, h-.5f}, {0, -1}, {-1, 0}, true};
+			case DOWN_TOP_DOWN_TOP_FROM_RIGHT:
+				return {height, width, {w-1, .5}, {0, 1}, {-1, 0}};
+			case DOWN_TOP_TOP_DOWN_FROM_RIGHT:
+			default:
+				return {height, width, {w-1, .5}, {0, 1}, {-1, 0}, true};
+		}
+	}
+
+	ImplicitLedPanel::ImplicitLedPanel(index_t width, index_t height, PANEL_LINKING linking)
+		: Mapping(panel_grid(width, height, linking)), _width(width), _height(height) {
+	}
 }}
@@ -186,6 +186,67 @@ namespace pixled {
 				 */
 				index_t height() const {return _height;}
 		};
+
+		/**
+		 * An implicit version of the LedStrip.
+		 *
+		 * Leds are located exactly as in a LedStrip, but they are computed
+		 * from their index instead of being stored, so that the memory used
+		 * by the mapping does not depend on the strip length.
+		 */
+		class ImplicitLedStrip : public Mapping {
+			private:
+				index_t length;
+			public:
+				/**
+				 * ImplicitLedStrip constructor.
+				 *
+				 * @param length number of leds
+				 */
+				ImplicitLedStrip(index_t length);
+
+				/**
+				 * Returns the number of leds in the strip.
+				 *
+				 * @return number of leds
+				 */
+				index_t getLength() const {
+					return length;
+				}
+		};
+
+		/**
+		 * An implicit version of the LedPanel.
+		 *
+		 * Leds are located exactly as in a LedPanel with the same linking,
+		 * but they are computed from their index instead of being stored,
+		 * so that the memory used by the mapping does not depend on the
+		 * panel size.
+		 */
+		class ImplicitLedPanel : public Mapping {
+			private:
+				index_t _width;
+				index_t _height;
+
+			public:
+				/**
+				 * ImplicitLedPanel constructor.
+				 *
+				 * @param width panel width (led count)
+				 * @param height panel height (led count)
+				 * @param linking panel linking
+				 */
+				ImplicitLedPanel(index_t width, index_t height, PANEL_LINKING linking);
+
+				/**
+				 * Panel width (led count).
+				 */
+				index_t width() const {return _width;}
+				/**
+				 * Panel height (led count).
+				 */
+				index_t height() const {return _height;}
+		};
 	}
 }
 #endif
@@ -0,0 +1,351 @@
+#include "network_output.h"
+
+#ifdef PIXLED_NETWORK_OUTPUT
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <netdb.h>
+#include <unistd.h>
+
+namespace pixled {
+	static const std::uint16_t E131_PORT = 5568;
+	static const std::uint16_t ARTNET_PORT = 6454;
+
+	// E1.31 data packet: root layer, framing layer and DMP layer headers
+	static const std::size_t E131_HEADER_SIZE = 126;
+	static const std::size_t E131_SYNC_SIZE = 49;
+	static const std::uint8_t E131_PACKET_IDENTIFIER[12] = {
+		'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0
+	};
+	static const std::uint32_t VECTOR_ROOT_E131_DATA = 0x00000004;
+	static const std::uint32_t VECTOR_ROOT_E131_EXTENDED = 0x00000008;
+	static const std::uint32_t VECTOR_E131_DATA_PACKET = 0x00000002;
+	static const std::uint32_t VECTOR_E131_EXTENDED_SYNCHRONIZATION = 0x00000001;
+	static const std::uint16_t E131_MAX_UNIVERSE = 63999;
+
+	static const std::size_t ARTNET_HEADER_SIZE = 18;
+	static const std::size_t ARTNET_SYNC_SIZE = 14;
+	static const std::uint8_t ARTNET_ID[8] = {
+		'A', 'r', 't', '-', 'N', 'e', 't', 0
+	};
+	static const std::uint16_t ARTNET_OP_DMX = 0x5000;
+	static const std::uint16_t ARTNET_OP_SYNC = 0x5200;
+	static const std::uint16_t ARTNET_PROTOCOL_VERSION = 14;
+	static const std::uint16_t ARTNET_MAX_UNIVERSE = 0x7fff;
+
+	static const std::size_t DMX_CHANNELS = 512;
+
+	// Maximum count of messages sent by a single sendmmsg() call
+	static const std::size_t BATCH_SIZE = 256;
+
+	/**
+	 * Network byte order (big endian) encoding of the `size` bytes of
+	 * `value` in `buffer`.
+	 */
+	static void store_be(std::uint8_t* buffer, std::uint32_t value, std::size_t size) {
+		for(std::size_t i = 0; i < size; i++)
+			buffer[i] = (std::uint8_t) (value >> (8*(size-1-i)));
+	}
+
+	/**
+	 * E1.31 "flags and length" field of a PDU of `length` bytes.
+	 */
+	static void store_pdu_length(std::uint8_t* buffer, std::size_t length) {
+		store_be(buffer, 0x7000 | (length & 0x0fff), 2);
+	}
+
+	/**
+	 * E1.31 root layer, common to data and synchronization packets.
+	 */
+	static void store_e131_root(
+			std::uint8_t* packet, std::size_t size,
+			std::uint32_t vector, const std::uint8_t* cid) {
+		store_be(&packet[0], 0x0010, 2);
+		store_be(&packet[2], 0x0000, 2);
+		std::memcpy(&packet[4], E131_PACKET_IDENTIFIER, sizeof(E131_PACKET_IDENTIFIER));
+		store_pdu_length(&packet[16], size - 16);
+		store_be(&packet[18], vector, 4);
+		std::memcpy(&packet[22], cid, 16);
+	}
+
+	NetworkOutput::NetworkOutput(
+			NETWORK_PROTOCOL protocol, const char* host, std::uint16_t port)
+		: protocol(protocol),
+		port(port != 0 ? port : (protocol == E131 ? E131_PORT : ARTNET_PORT)) {
+			// Random (version 4) UUID identifying this source
+			std::random_device random;
+			for(std::size_t i = 0; i < sizeof(cid); i++)
+				cid[i] = (std::uint8_t) random();
+			cid[6] = (cid[6] & 0x0f) | 0x40;
+			cid[8] = (cid[8] & 0x3f) | 0x80;
+
+			Destination destination;
+			if(!resolve(host, destination))
+				return;
+			destinations.push_back(destination);
+
+			socket_fd = socket(destination.address.ss_family, SOCK_DGRAM, 0);
+			if(socket_fd < 0)
+				return;
+			int enable = 1;
+			setsockopt(socket_fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+			// Room for the packets of a few hundred universes per frame
+			int buffer_size = 1 << 20;
+			setsockopt(socket_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+		}
+
+	bool NetworkOutput::resolve(const char* host, Destination& destination) const {
+		addrinfo hints {};
+		// Additional destinations must use the family of the socket
+		hints.ai_family = destinations.empty() ?
+			AF_UNSPEC : destinations[0].address.ss_family;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_flags = AI_NUMERICSERV;
+		addrinfo* result;
+		char service[8];
+		std::snprintf(service, sizeof(service), "%u", (unsigned int) port);
+		if(getaddrinfo(host, service, &hints, &result) != 0)
+			return false;
+		std::memcpy(&destination.address, result->ai_addr, result->ai_addrlen);
+		destination.length = result->ai_addrlen;
+		freeaddrinfo(result);
+		return true;
+	}
+
+	bool NetworkOutput::isOpen() const {
+		return socket_fd >= 0;
+	}
+
+	std::size_t NetworkOutput::packetCapacity() const {
+		return (protocol == E131 ? E131_HEADER_SIZE : ARTNET_HEADER_SIZE) + DMX_CHANNELS;
+	}
+
+	std::size_t NetworkOutput::packetSize(const Universe& universe) const {
+		std::size_t channels = 3*universe.led_count;
+		if(protocol == E131)
+			return E131_HEADER_SIZE + channels;
+		// ArtDmx data length must be even, from 2 to 512
+		channels = std::max<std::size_t>(2, channels + channels % 2);
+		return ARTNET_HEADER_SIZE + channels;
+	}
+
+	void NetworkOutput::buildHeader(const Universe& universe, std::uint8_t* packet) const {
+		std::size_t size = packetSize(universe);
+		if(protocol == E131) {
+			store_e131_root(packet, size, VECTOR_ROOT_E131_DATA, cid);
+			// Framing layer
+			store_pdu_length(&packet[38], size - 38);
+			store_be(&packet[40], VECTOR_E131_DATA_PACKET, 4);
+			std::memset(&packet[44], 0, 64);
+			std::strncpy((char*) &packet[44], "pixled", 63);
+			packet[108] = priority;
+			store_be(&packet[109], sync_universe, 2);
+			packet[111] = universe.sequence;
+			packet[112] = 0;
+			store_be(&packet[113], universe.number, 2);
+			// DMP layer
+			store_pdu_length(&packet[115], size - 115);
+			packet[117] = 0x02;
+			packet[118] = 0xa1;
+			store_be(&packet[119], 0x0000, 2);
+			store_be(&packet[121], 0x0001, 2);
+			store_be(&packet[123], 1 + 3*universe.led_count, 2);
+			// DMX start code
+			packet[125] = 0;
+		} else {
+			std::memcpy(packet, ARTNET_ID, sizeof(ARTNET_ID));
+			// The OpCode is the only little endian field
+			packet[8] = ARTNET_OP_DMX & 0xff;
+			packet[9] = ARTNET_OP_DMX >> 8;
+			store_be(&packet[10], ARTNET_PROTOCOL_VERSION, 2);
+			packet[12] = universe.sequence;
+			packet[13] = 0;
+			// Port address: SubUni, then Net
+			packet[14] = universe.number & 0xff;
+			packet[15] = (universe.number >> 8) & 0x7f;
+			store_be(&packet[16], size - ARTNET_HEADER_SIZE, 2);
+		}
+		// Padding channels, if any, stay black
+		std::size_t data = protocol == E131 ? E131_HEADER_SIZE : ARTNET_HEADER_SIZE;
+		std::memset(&packet[data], 0, size - data);
+	}
+
+	void NetworkOutput::buildSyncPacket() {
+		sync_packet.clear();
+		if(sync_universe == 0)
+			return;
+		if(protocol == E131) {
+			sync_packet.assign(E131_SYNC_SIZE, 0);
+			std::uint8_t* packet = sync_packet.data();
+			store_e131_root(packet, E131_SYNC_SIZE, VECTOR_ROOT_E131_EXTENDED, cid);
+			store_pdu_length(&packet[38], E131_SYNC_SIZE - 38);
+			store_be(&packet[40], VECTOR_E131_EXTENDED_SYNCHRONIZATION, 4);
+			packet[44] = sync_sequence;
+			store_be(&packet[45], sync_universe, 2);
+		} else {
+			sync_packet.assign(ARTNET_SYNC_SIZE, 0);
+			std::uint8_t* packet = sync_packet.data();
+			std::memcpy(packet, ARTNET_ID, sizeof(ARTNET_ID));
+			packet[8] = ARTNET_OP_SYNC & 0xff;
+			packet[9] = ARTNET_OP_SYNC >> 8;
+			store_be(&packet[10], ARTNET_PROTOCOL_VERSION, 2);
+		}
+	}
+
+	bool NetworkOutput::addUniverse(
+			std::uint16_t number, std::size_t first_led, std::size_t led_count,
+			const char* host) {
+		if(!isOpen() || led_count == 0 || led_count > MAX_UNIVERSE_LEDS)
+			return false;
+		if(protocol == E131 ? (number == 0 || number > E131_MAX_UNIVERSE)
+				: number > ARTNET_MAX_UNIVERSE)
+			return false;
+
+		Universe universe {number, first_led, led_count, 0,
+			// Art-Net sequence numbers start at 1, 0 disables reordering
+			(std::uint8_t) (protocol == E131 ? 0 : 1)};
+		if(host) {
+			Destination destination;
+			if(!resolve(host, destination))
+				return false;
+			universe.destination = destinations.size();
+			destinations.push_back(destination);
+		}
+		universes.push_back(universe);
+		if(3*(first_led + led_count) > frame.size())
+			frame.resize(3*(first_led + led_count), 0);
+
+		std::size_t capacity = packetCapacity();
+		packet_buffer.resize(universes.size() * capacity);
+		buildHeader(universe, &packet_buffer[(universes.size()-1) * capacity]);
+		return true;
+	}
+
+	bool NetworkOutput::addUniverses(
+			std::uint16_t first_universe, std::size_t led_count,
+			std::size_t leds_per_universe) {
+		if(leds_per_universe == 0)
+			return false;
+		std::uint16_t number = first_universe;
+		for(std::size_t led = 0; led < led_count; led += leds_per_universe)
+			if(!addUniverse(number++, led, std::min(leds_per_universe, led_count - led)))
+				return false;
+		return true;
+	}
+
+	std::size_t NetworkOutput::universeCount() const {
+		return universes.size();
+	}
+
+	void NetworkOutput::setPriority(std::uint8_t priority) {
+		this->priority = std::min<std::uint8_t>(priority, 200);
+		std::size_t capacity = packetCapacity();
+		for(std::size_t i = 0; i < universes.size(); i++)
+			buildHeader(universes[i], &packet_buffer[i * capacity]);
+	}
+
+	void NetworkOutput::setSync(std::uint16_t sync_universe) {
+		this->sync_universe = sync_universe;
+		std::size_t capacity = packetCapacity();
+		for(std::size_t i = 0; i < universes.size(); i++)
+			buildHeader(universes[i], &packet_buffer[i * capacity]);
+		buildSyncPacket();
+	}
+
+	unsigned long NetworkOutput::packets() const {
+		return _packets;
+	}
+
+	unsigned long NetworkOutput::sendErrors() const {
+		return _errors;
+	}
+
+	void NetworkOutput::write(const color& color, std::size_t i) {
+		if(3*i >= frame.size())
+			return;
+		std::uint8_t* rgb = &frame[3*i];
+		rgb[0] = color.red();
+		rgb[1] = color.green();
+		rgb[2] = color.blue();
+	}
+
+	void NetworkOutput::writeFrame(const std::uint8_t* frame, std::size_t led_count) {
+		std::memcpy(this->frame.data(), frame, std::min(3*led_count, this->frame.size()));
+	}
+
+	void NetworkOutput::endFrame() {
+		if(!isOpen())
+			return;
+		messages.clear();
+		std::size_t capacity = packetCapacity();
+		std::size_t data = protocol == E131 ? E131_HEADER_SIZE : ARTNET_HEADER_SIZE;
+		std::size_t sequence = protocol == E131 ? 111 : 12;
+		for(std::size_t i = 0; i < universes.size(); i++) {
+			Universe& universe = universes[i];
+			std::uint8_t* packet = &packet_buffer[i * capacity];
+			packet[sequence] = universe.sequence;
+			if(protocol == E131)
+				universe.sequence++;
+			else
+				// Skips 0
+				universe.sequence = universe.sequence % 255 + 1;
+			std::memcpy(&packet[data], &frame[3*universe.first_led], 3*universe.led_count);
+			messages.push_back({packet, packetSize(universe), universe.destination});
+		}
+		if(!sync_packet.empty()) {
+			if(protocol == E131)
+				sync_packet[44] = sync_sequence++;
+			messages.push_back({sync_packet.data(), sync_packet.size(), 0});
+		}
+		send();
+	}
+
+	void NetworkOutput::send() {
+#ifdef __linux__
+		mmsghdr headers[BATCH_SIZE];
+		iovec vectors[BATCH_SIZE];
+		std::size_t i = 0;
+		while(i < messages.size()) {
+			std::size_t count = std::min(BATCH_SIZE, messages.size() - i);
+			for(std::size_t j = 0; j < count; j++) {
+				const Message& message = messages[i + j];
+				Destination& destination = destinations[message.destination];
+				vectors[j].iov_base = (void*) message.data;
+				vectors[j].iov_len = message.size;
+				headers[j].msg_hdr = msghdr {};
+				headers[j].msg_hdr.msg_name = &destination.address;
+				headers[j].msg_hdr.msg_namelen = destination.length;
+				headers[j].msg_hdr.msg_iov = &vectors[j];
+				headers[j].msg_hdr.msg_iovlen = 1;
+			}
+			int sent = sendmmsg(socket_fd, headers, count, 0);
+			if(sent > 0) {
+				_packets += sent;
+				i += sent;
+			} else {
+				// The first message of the batch failed: it is dropped, and
+				// the next ones are retried
+				_errors++;
+				i++;
+			}
+		}
+#else
+		for(const Message& message : messages) {
+			const Destination& destination = destinations[message.destination];
+			if(sendto(socket_fd, message.data, message.size, 0,
+						(const sockaddr*) &destination.address, destination.length) < 0)
+				_errors++;
+			else
+				_packets++;
+		}
+#endif
+	}
+
+	NetworkOutput::~NetworkOutput() {
+		if(socket_fd >= 0)
+			close(socket_fd);
+	}
+}
+#endif
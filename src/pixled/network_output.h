@@ -0,0 +1,231 @@
+#ifndef PIXLED_NETWORK_OUTPUT_H
+#define PIXLED_NETWORK_OUTPUT_H
+
+#include "config.h"
+
+/**
+ * Defined when NetworkOutput is available, i.e. in heap mode on POSIX
+ * systems.
+ */
+#if !defined(PIXLED_NO_HEAP) && (defined(__unix__) || defined(__APPLE__))
+#define PIXLED_NETWORK_OUTPUT
+#endif
+
+#ifdef PIXLED_NETWORK_OUTPUT
+
+#include <cstdint>
+#include <vector>
+#include <sys/socket.h>
+#include "output.h"
+
+namespace pixled {
+	/**
+	 * DMX over IP protocols supported by NetworkOutput.
+	 */
+	enum NETWORK_PROTOCOL {
+		/**
+		 * ANSI E1.31 (sACN), on UDP port 5568.
+		 */
+		E131,
+		/**
+		 * Art-Net 4 ArtDmx packets, on UDP port 6454.
+		 */
+		ARTNET
+	};
+
+	/**
+	 * An Output that streams frames to DMX over IP receivers, using E1.31
+	 * (sACN) or Art-Net.
+	 *
+	 * Leds are buffered, and packed into DMX universes of at most 512
+	 * channels (170 rgb leds) when the frame ends (see endFrame()). The
+	 * packets of all the universes are then sent at once with `sendmmsg()`
+	 * on Linux, so that a single thread can drive hundreds of universes at
+	 * high frame rates. Packet headers are built once, when universes are
+	 * added: only the sequence number and the channels are updated at each
+	 * frame.
+	 *
+	 * With synchronization enabled (see setSync()), a sync packet is sent
+	 * after the packets of each frame, so that receivers output all the
+	 * universes at once.
+	 *
+	 * ```cpp
+	 * pixled::NetworkOutput output(pixled::E131, "192.168.1.20");
+	 * // Universes 1 to 4 drive leds 0 to 679
+	 * output.addUniverses(1, 680);
+	 * output.setSync(1000);
+	 * pixled::Runtime runtime(mapping, output, animation);
+	 * ```
+	 *
+	 * Only available in heap mode, on POSIX systems (see
+	 * PIXLED_NETWORK_OUTPUT).
+	 */
+	class NetworkOutput : public Output {
+		public:
+			/**
+			 * Maximum count of rgb leds in a universe.
+			 */
+			static const std::size_t MAX_UNIVERSE_LEDS = 170;
+
+		private:
+			struct Destination {
+				sockaddr_storage address;
+				socklen_t length;
+			};
+
+			struct Universe {
+				std::uint16_t number;
+				std::size_t first_led;
+				std::size_t led_count;
+				std::size_t destination;
+				std::uint8_t sequence;
+			};
+
+			struct Message {
+				const std::uint8_t* data;
+				std::size_t size;
+				std::size_t destination;
+			};
+
+			NETWORK_PROTOCOL protocol;
+			std::uint16_t port;
+			int socket_fd = -1;
+			std::uint8_t cid[16];
+			std::uint8_t priority = 100;
+			std::uint16_t sync_universe = 0;
+			std::uint8_t sync_sequence = 0;
+
+			std::vector<Destination> destinations;
+			std::vector<Universe> universes;
+			std::vector<std::uint8_t> frame;
+			// One packet of packetCapacity() bytes per universe
+			std::vector<std::uint8_t> packet_buffer;
+			std::vector<std::uint8_t> sync_packet;
+			std::vector<Message> messages;
+
+			unsigned long _packets = 0;
+			unsigned long _errors = 0;
+
+			std::size_t packetCapacity() const;
+			std::size_t packetSize(const Universe& universe) const;
+			bool resolve(const char* host, Destination& destination) const;
+			void buildHeader(const Universe& universe, std::uint8_t* packet) const;
+			void buildSyncPacket();
+			void send();
+
+		public:
+			/**
+			 * Opens an UDP socket streaming to `host`.
+			 *
+			 * @param protocol DMX over IP protocol
+			 * @param host default destination of the universes, as an
+			 * IPv4 or IPv6 address or a host name. Broadcast addresses are
+			 * allowed.
+			 * @param port destination UDP port, or 0 to use the standard
+			 * port of the protocol
+			 */
+			NetworkOutput(NETWORK_PROTOCOL protocol, const char* host, std::uint16_t port = 0);
+
+			NetworkOutput(const NetworkOutput&) = delete;
+			NetworkOutput& operator=(const NetworkOutput&) = delete;
+
+			/**
+			 * Returns false if the socket could not be opened or the host
+			 * could not be resolved.
+			 *
+			 * @return true iff frames can be sent
+			 */
+			bool isOpen() const;
+
+			/**
+			 * Maps `led_count` consecutive leds, starting from `first_led`,
+			 * to the channels of `universe`. The rgb components of the led
+			 * `first_led + i` are sent on the channels `3*i+1` to `3*i+3`.
+			 *
+			 * @param universe DMX universe number (Art-Net port address, or
+			 * E1.31 universe from 1 to 63999)
+			 * @param first_led index of the first led of the universe
+			 * @param led_count count of leds, at most MAX_UNIVERSE_LEDS
+			 * @param host destination of this universe, or `nullptr` to
+			 * use the default destination
+			 * @return false if the universe could not be added
+			 */
+			bool addUniverse(
+					std::uint16_t universe, std::size_t first_led, std::size_t led_count,
+					const char* host = nullptr);
+
+			/**
+			 * Maps the leds from 0 to `led_count` to consecutive universes
+			 * from `first_universe`, with `leds_per_universe` leds in each
+			 * universe.
+			 *
+			 * @param first_universe first DMX universe number
+			 * @param led_count count of leds
+			 * @param leds_per_universe count of leds in each universe, at
+			 * most MAX_UNIVERSE_LEDS
+			 * @return false if one of the universes could not be added
+			 */
+			bool addUniverses(
+					std::uint16_t first_universe, std::size_t led_count,
+					std::size_t leds_per_universe = MAX_UNIVERSE_LEDS);
+
+			/**
+			 * Count of universes.
+			 *
+			 * @return universe count
+			 */
+			std::size_t universeCount() const;
+
+			/**
+			 * Sets the priority of E1.31 packets, from 0 to 200. The
+			 * default is 100.
+			 *
+			 * @param priority E1.31 priority
+			 */
+			void setPriority(std::uint8_t priority);
+
+			/**
+			 * Enables frame synchronization.
+			 *
+			 * With E1.31, data packets reference the synchronization
+			 * universe `sync_universe`, and an E1.31 synchronization
+			 * packet is sent on this universe after each frame. With
+			 * Art-Net, an ArtSync packet is sent to the default
+			 * destination after each frame.
+			 *
+			 * @param sync_universe synchronization universe, or 0 to
+			 * disable synchronization
+			 */
+			void setSync(std::uint16_t sync_universe);
+
+			/**
+			 * Count of packets sent.
+			 *
+			 * @return count of packets
+			 */
+			unsigned long packets() const;
+
+			/**
+			 * Count of packets that could not be sent.
+			 *
+			 * @return count of errors
+			 */
+			unsigned long sendErrors() const;
+
+			void write(const color& color, std::size_t i) override;
+			void writeFrame(const std::uint8_t* frame, std::size_t led_count) override;
+
+			/**
+			 * Sends the current frame to all the universes, followed by a
+			 * sync packet if enabled.
+			 */
+			void endFrame() override;
+
+			/**
+			 * Closes the socket.
+			 */
+			~NetworkOutput();
+	};
+}
+#endif
+#endif
@@ -0,0 +1,141 @@
+#include "offline_renderer.h"
+
+#ifndef PIXLED_NO_HEAP
+
+namespace pixled {
+	OfflineRenderer::OfflineRenderer(
+			Mapping& mapping, Animation& animation, ThreadPool& pool,
+			std::size_t ring_size)
+		: mapping(mapping), animation(animation), pool(pool), led_count(0) {
+			mapping.forEach([this] (const led& led) {
+					if(led.index >= led_count)
+						led_count = led.index + 1;
+					});
+			if(ring_size == 0)
+				ring_size = 2 * pool.threadCount();
+			ring.resize(ring_size);
+			for(auto& slot : ring)
+				// Leds that are not in the mapping are left black
+				slot.frame.assign(3*led_count, 0);
+		}
+
+	std::size_t OfflineRenderer::ringSize() const {
+		return ring.size();
+	}
+
+	std::size_t OfflineRenderer::ledCount() const {
+		return led_count;
+	}
+
+	void OfflineRenderer::renderFrame(time t, std::uint8_t* frame) const {
+		mapping.forEach([this, t, frame] (const led& led) {
+				color c = animation(led, t);
+				std::uint8_t* rgb = &frame[3*led.index];
+				rgb[0] = c.red();
+				rgb[1] = c.green();
+				rgb[2] = c.blue();
+				});
+	}
+
+	void OfflineRenderer::renderFrames(
+			unsigned long count, const std::function<time(unsigned long)>& frame_time,
+			const Sink& sink) {
+		clock::time_point start = clock::now();
+		_frames = 0;
+		if(!animation.stateless()) {
+			std::uint8_t* frame = ring[0].frame.data();
+			for(unsigned long i = 0; i < count; i++) {
+				time t = frame_time(i);
+				renderFrame(t, frame);
+				sink(t, frame, led_count);
+				_frames++;
+			}
+			duration = clock::now() - start;
+			return;
+		}
+
+		// Frame i is rendered in the slot i % ringSize()
+		unsigned long submitted = 0;
+		auto submit = [this, &submitted, &frame_time] {
+			Slot* slot = &ring[submitted % ring.size()];
+			time t = frame_time(submitted);
+			pool.submit([this, slot, t] {
+					renderFrame(t, slot->frame.data());
+					std::lock_guard<std::mutex> lock(mutex);
+					slot->ready = true;
+					// Notified under the lock, since render() might
+					// return as soon as the last frame is ready
+					frame_ready.notify_one();
+					});
+			submitted++;
+		};
+		while(submitted < count && submitted < ring.size())
+			submit();
+		// Called from a task of the pool, the thread must render frames
+		// itself while it waits, since no other worker might be free
+		bool worker = pool.isWorker();
+		for(unsigned long i = 0; i < count; i++) {
+			Slot& slot = ring[i % ring.size()];
+			if(worker) {
+				while(true) {
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if(slot.ready)
+							break;
+					}
+					if(!pool.runTask())
+						std::this_thread::yield();
+				}
+			}
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				frame_ready.wait(lock, [&slot] {return slot.ready;});
+				slot.ready = false;
+			}
+			sink(frame_time(i), slot.frame.data(), led_count);
+			_frames++;
+			// The slot is free again
+			if(submitted < count)
+				submit();
+		}
+		duration = clock::now() - start;
+	}
+
+	void OfflineRenderer::render(time begin, time end, const Sink& sink, time step) {
+		unsigned long count = end > begin ? (end - begin + step - 1) / step : 0;
+		renderFrames(count, [begin, step] (unsigned long i) {
+				return begin + i * step;
+				}, sink);
+	}
+
+	void OfflineRenderer::render(time begin, time end, Output& output) {
+		render(begin, end, [&output] (time, const std::uint8_t* frame, std::size_t led_count) {
+				output.writeFrame(frame, led_count);
+				output.endFrame();
+				});
+	}
+
+	void OfflineRenderer::fill(FrameCache& cache) {
+		std::vector<time> missing;
+		for(time t = 0; t < cache.period(); t++)
+			if(!cache.contains(t))
+				missing.push_back(t);
+		renderFrames(missing.size(), [&missing] (unsigned long i) {
+				return missing[i];
+				}, [&cache] (time t, const std::uint8_t* frame, std::size_t) {
+				cache.store(t, frame);
+				});
+	}
+
+	unsigned long OfflineRenderer::frames() const {
+		return _frames;
+	}
+
+	float OfflineRenderer::framesPerSecond() const {
+		double seconds = std::chrono::duration<double>(duration).count();
+		if(seconds <= 0)
+			return 0;
+		return _frames / seconds;
+	}
+}
+#endif
@@ -0,0 +1,172 @@
+#ifndef PIXLED_OFFLINE_RENDERER_H
+#define PIXLED_OFFLINE_RENDERER_H
+
+#include "config.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "runtime.h"
+#include "thread_pool.h"
+
+namespace pixled {
+	/**
+	 * Renders a time range of an animation as fast as possible, e.g. to
+	 * export it to a file or to fill a FrameCache.
+	 *
+	 * Frames of stateless animations (see base::Function::stateless()) do not
+	 * depend on each other, so they are rendered in parallel as tasks of a
+	 * ThreadPool, each frame in a buffer of a ring. The calling thread
+	 * delivers rendered frames to a sink in time order, and each delivered
+	 * buffer is reused to render a following frame. At most ringSize()
+	 * frames are so in memory at once.
+	 *
+	 * Frames of stateful animations are rendered in order on the calling
+	 * thread.
+	 *
+	 * render() and fill() can be called from a task of the pool itself
+	 * (e.g. from a PoolScheduler job): the calling worker then executes the
+	 * queued tasks while it waits for the next frame, so that rendering
+	 * can't deadlock, even with a single worker.
+	 *
+	 * ```cpp
+	 * pixled::ThreadPool pool;
+	 * pixled::OfflineRenderer renderer(panel, animation, pool);
+	 * renderer.render(0, 1000, [] (pixled::time t, const std::uint8_t* frame, std::size_t led_count) {
+	 * 	// Frames are delivered from t = 0 to t = 999
+	 * 	});
+	 * float fps = renderer.framesPerSecond();
+	 * ```
+	 *
+	 * Not available in heap-free mode.
+	 */
+	class OfflineRenderer {
+		public:
+			/**
+			 * Clock used to measure the throughput.
+			 */
+			typedef std::chrono::steady_clock clock;
+
+			/**
+			 * Function receiving the rendered frames, in time order.
+			 *
+			 * The frame uses the layout of Output::writeFrame(), and is
+			 * only valid during the call.
+			 */
+			typedef std::function<void(time t, const std::uint8_t* frame, std::size_t led_count)> Sink;
+
+		private:
+			struct Slot {
+				std::vector<std::uint8_t> frame;
+				bool ready = false;
+			};
+
+			Mapping& mapping;
+			Animation& animation;
+			ThreadPool& pool;
+			std::size_t led_count;
+			std::vector<Slot> ring;
+
+			std::mutex mutex;
+			std::condition_variable frame_ready;
+
+			unsigned long _frames = 0;
+			clock::duration duration {0};
+
+			void renderFrame(time t, std::uint8_t* frame) const;
+			void renderFrames(
+					unsigned long count,
+					const std::function<time(unsigned long)>& frame_time,
+					const Sink& sink);
+
+		public:
+			/**
+			 * OfflineRenderer constructor.
+			 *
+			 * @param mapping led mapping, that must not be modified while
+			 * frames are rendered
+			 * @param animation animation to render
+			 * @param pool thread pool rendering the frames, that must
+			 * outlive this OfflineRenderer
+			 * @param ring_size count of frame buffers, by default twice
+			 * the count of workers of `pool`
+			 */
+			OfflineRenderer(
+					Mapping& mapping, Animation& animation, ThreadPool& pool,
+					std::size_t ring_size = 0);
+
+			OfflineRenderer(const OfflineRenderer&) = delete;
+			OfflineRenderer& operator=(const OfflineRenderer&) = delete;
+
+			/**
+			 * Count of frame buffers.
+			 *
+			 * @return ring size
+			 */
+			std::size_t ringSize() const;
+
+			/**
+			 * Count of leds in each frame, according to the highest led
+			 * index of the mapping. Leds that are not in the mapping are
+			 * left black.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+
+			/**
+			 * Renders the frames at times `begin`, `begin+step`,
+			 * `begin+2*step`... until `end` excluded, and delivers them to
+			 * `sink` in time order, on the calling thread.
+			 *
+			 * @param begin time of the first frame
+			 * @param end end of the time range
+			 * @param sink function receiving the frames
+			 * @param step time steps between two frames
+			 */
+			void render(time begin, time end, const Sink& sink, time step = 1);
+
+			/**
+			 * Renders the frames from `begin` to `end` excluded, and
+			 * writes them to `output` with Output::writeFrame(), each
+			 * frame being ended with Output::endFrame().
+			 *
+			 * @param begin time of the first frame
+			 * @param end end of the time range
+			 * @param output output receiving the frames
+			 */
+			void render(time begin, time end, Output& output);
+
+			/**
+			 * Renders and stores all the frames missing from `cache`, so
+			 * that the cache is complete. The cache must have been built
+			 * with ledCount() leds.
+			 *
+			 * @param cache frame cache of the animation
+			 */
+			void fill(FrameCache& cache);
+
+			/**
+			 * Count of frames delivered by the last render() or fill()
+			 * call.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			/**
+			 * Throughput of the last render() or fill() call, including
+			 * the time spent in the sink.
+			 *
+			 * @return rendered frames per second
+			 */
+			float framesPerSecond() const;
+	};
+}
+#endif
+#endif
@@ -29,6 +29,77 @@ namespace pixled {
 			 */
 			virtual void write(const color& color, std::size_t i) = 0;
 
+			/**
+			 * Writes a complete frame.
+			 *
+			 * The frame is a raw buffer of `3*led_count` bytes, where the
+			 * red, green and blue components of the led at index `i` are
+			 * respectively stored at `frame[3*i]`, `frame[3*i+1]` and
+			 * `frame[3*i+2]`.
+			 *
+			 * This method is used by the Runtime to replay cached frames
+			 * (see Runtime::enableFrameCache()). The default implementation
+			 * calls write() for each led, but implementations backed by a
+			 * raw buffer can override it to directly copy the frame.
+			 *
+			 * @param frame rgb frame buffer
+			 * @param led_count count of leds in the frame
+			 */
+			virtual void writeFrame(const std::uint8_t* frame, std::size_t led_count) {
+				for(std::size_t i = 0; i < led_count; i++)
+					write(color::rgb(frame[3*i], frame[3*i+1], frame[3*i+2]), i);
+			}
+
+			/**
+			 * Returns true if this Output keeps the last color written to
+			 * each led, so that only the leds that changed need to be
+			 * written at each frame.
+			 *
+			 * When dirty tracking is enabled (see
+			 * Runtime::enableDirtyTracking()), the Runtime only sends
+			 * changed spans of leds to Outputs that support partial updates
+			 * using writeSpan(), and full frames to other Outputs using
+			 * writeFrame().
+			 *
+			 * The default implementation returns false.
+			 *
+			 * @return true iff partial updates are supported
+			 */
+			virtual bool partialUpdates() const {
+				return false;
+			}
+
+			/**
+			 * Writes a span of consecutive leds, from index `begin` to
+			 * `begin+count` excluded.
+			 *
+			 * The span uses the same layout as writeFrame(), so that the rgb
+			 * components of the led at index `begin+i` are stored at
+			 * `span[3*i]`, `span[3*i+1]` and `span[3*i+2]`.
+			 *
+			 * The default implementation calls write() for each led.
+			 *
+			 * @param span rgb buffer of the span
+			 * @param begin index of the first led of the span
+			 * @param count count of leds in the span
+			 */
+			virtual void writeSpan(const std::uint8_t* span, std::size_t begin, std::size_t count) {
+				for(std::size_t i = 0; i < count; i++)
+					write(color::rgb(span[3*i], span[3*i+1], span[3*i+2]), begin + i);
+			}
+
+			/**
+			 * Called by the Runtime once all the leds of a frame have been
+			 * written, whatever the write methods used.
+			 *
+			 * Outputs that buffer leds, such as a FrameRecorder, can
+			 * override it to commit the frame. The default implementation
+			 * does nothing.
+			 */
+			virtual void endFrame() {
+			}
+
+			virtual ~Output() {}
 	};
 }
 #endif
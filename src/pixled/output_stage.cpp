@@ -0,0 +1,153 @@
+#include "output_stage.h"
+
+#include <cmath>
+
+namespace pixled {
+	OutputStage::OutputStage()
+		: _gamma {1.f, 1.f, 1.f}, _brightness(255), _current_budget(0),
+		_last_sum(0), _limited(false), _dithering(NO_DITHERING) {
+		updateLut();
+	}
+
+	void OutputStage::updateLut() {
+		for(int c = 0; c < 3; c++) {
+			for(int v = 0; v < 256; v++) {
+				float corrected = 255.f * std::pow(v / 255.f, _gamma[c]);
+				lut[c][v] = (std::uint8_t) (corrected * _brightness / 255.f + .5f);
+			}
+			for(int i = 0; i <= 256; i++) {
+				float v = i == 256 ? 1.f : i * 256 / 65535.f;
+				float corrected = 65535.f * std::pow(v, _gamma[c]);
+				lut16[c][i] = (std::uint16_t) (corrected * _brightness / 255.f + .5f);
+			}
+		}
+	}
+
+	void OutputStage::setGamma(float gamma) {
+		setGamma(gamma, gamma, gamma);
+	}
+
+	void OutputStage::setGamma(float red, float green, float blue) {
+		_gamma[RED] = red;
+		_gamma[GREEN] = green;
+		_gamma[BLUE] = blue;
+		updateLut();
+	}
+
+	float OutputStage::gamma(CHANNEL channel) const {
+		return _gamma[channel];
+	}
+
+	void OutputStage::setBrightness(std::uint8_t brightness) {
+		_brightness = brightness;
+		updateLut();
+	}
+
+	std::uint8_t OutputStage::brightness() const {
+		return _brightness;
+	}
+
+	void OutputStage::setCurrentBudget(std::uint32_t budget) {
+		_current_budget = budget;
+	}
+
+	std::uint32_t OutputStage::currentBudget() const {
+		return _current_budget;
+	}
+
+	void OutputStage::apply(std::uint8_t* frame, std::size_t led_count) {
+		const std::uint8_t* lut_r = lut[RED];
+		const std::uint8_t* lut_g = lut[GREEN];
+		const std::uint8_t* lut_b = lut[BLUE];
+		std::uint32_t sum = 0;
+		std::uint8_t* end = frame + 3*led_count;
+		for(std::uint8_t* rgb = frame; rgb < end; rgb += 3) {
+			rgb[0] = lut_r[rgb[0]];
+			rgb[1] = lut_g[rgb[1]];
+			rgb[2] = lut_b[rgb[2]];
+			sum += rgb[0] + rgb[1] + rgb[2];
+		}
+		_last_sum = sum;
+		_limited = _current_budget > 0 && sum > _current_budget;
+		if(!_limited)
+			return;
+
+		// Scale factor on 16 bits, rounded down so that the sum of the
+		// scaled values never exceeds the budget
+		std::uint32_t scale = (std::uint32_t)
+			(((std::uint64_t) _current_budget << 16) / sum);
+		for(std::uint8_t* v = frame; v < end; v++)
+			*v = (std::uint8_t) ((*v * scale) >> 16);
+	}
+
+	void OutputStage::setDithering(DITHERING dithering) {
+		_dithering = dithering;
+		error.clear();
+	}
+
+	OutputStage::DITHERING OutputStage::dithering() const {
+		return _dithering;
+	}
+
+	void OutputStage::apply(std::uint16_t* frame, std::uint8_t* output, std::size_t led_count) {
+		std::size_t size = 3*led_count;
+		std::uint64_t sum = 0;
+		for(std::size_t i = 0; i < size; i += 3) {
+			for(int c = 0; c < 3; c++) {
+				// Linear interpolation between lookup table samples
+				const std::uint16_t* table = lut16[c];
+				std::uint32_t v = frame[i+c];
+				std::uint32_t hi = v >> 8;
+				std::uint32_t lo = v & 0xFF;
+				v = table[hi] + (((table[hi+1] - table[hi]) * lo) >> 8);
+				frame[i+c] = (std::uint16_t) v;
+				sum += v;
+			}
+		}
+		_last_sum = (std::uint32_t) ((sum + 128) / 257);
+		std::uint64_t budget = (std::uint64_t) _current_budget * 257;
+		_limited = _current_budget > 0 && sum > budget;
+		// Scale factor on 16 bits, applied during quantization
+		std::uint32_t scale = _limited ? (std::uint32_t) ((budget << 16) / sum) : 0;
+
+		if(_dithering == NO_DITHERING) {
+			for(std::size_t i = 0; i < size; i++) {
+				std::uint32_t v = frame[i];
+				if(_limited)
+					v = (v * scale) >> 16;
+				output[i] = (std::uint8_t) (v >> 8);
+			}
+			return;
+		}
+
+		if(error.size() != size) {
+			error.assign(size, 0);
+			if(_dithering == TEMPORAL_SPATIAL_DITHERING)
+				// Golden ratio sequence, so that neighbour leds have
+				// distant phases
+				for(std::size_t i = 0; i < size; i++)
+					error[i] = (std::uint8_t) ((i / 3) * 159);
+		}
+		for(std::size_t i = 0; i < size; i++) {
+			std::uint32_t v = frame[i];
+			if(_limited)
+				v = (v * scale) >> 16;
+			v += error[i];
+			if(v > 0xFFFF) {
+				output[i] = 255;
+				error[i] = 0;
+			} else {
+				output[i] = (std::uint8_t) (v >> 8);
+				error[i] = (std::uint8_t) (v & 0xFF);
+			}
+		}
+	}
+
+	std::uint32_t OutputStage::lastSum() const {
+		return _last_sum;
+	}
+
+	bool OutputStage::limited() const {
+		return _limited;
+	}
+}
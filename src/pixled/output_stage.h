@@ -0,0 +1,218 @@
+#ifndef PIXLED_OUTPUT_STAGE_H
+#define PIXLED_OUTPUT_STAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "containers.h"
+
+namespace pixled {
+	/**
+	 * Color correction stage applied to complete frames before they are
+	 * written to an Output.
+	 *
+	 * The stage performs, in order:
+	 * 1. per-channel gamma correction,
+	 * 2. global dimming,
+	 * 3. current limiting: if the sum of all the channel values of the
+	 *    frame exceeds the current budget, all the channels are scaled down
+	 *    so that the sum fits in the budget.
+	 * 4. optionally, when 16 bits frames are processed, dithering down to 8
+	 *    bits (see setDithering()).
+	 *
+	 * Gamma correction and dimming are merged in a single lookup table per
+	 * channel, computed only when the settings change, so that frames are
+	 * processed without any floating point operation.
+	 *
+	 * An OutputStage is usually attached to a Runtime (see
+	 * Runtime::setOutputStage()), but apply() can also be called directly
+	 * on raw frame buffers. Frames use the Output::writeFrame() layout.
+	 */
+	class OutputStage {
+		public:
+			/**
+			 * Channels of an rgb frame.
+			 */
+			enum CHANNEL {
+				RED = 0, GREEN = 1, BLUE = 2
+			};
+
+			/**
+			 * Dithering methods used to quantize 16 bits frames to 8
+			 * bits.
+			 */
+			enum DITHERING {
+				/**
+				 * Values are truncated to 8 bits.
+				 */
+				NO_DITHERING,
+				/**
+				 * The quantization error of each channel is carried to
+				 * the next frame, so that the average intensity of each
+				 * led over time matches its 16 bits value.
+				 */
+				TEMPORAL_DITHERING,
+				/**
+				 * Temporal dithering where the quantization errors of
+				 * neighbour leds start from distant phases, so that the
+				 * leds of a uniform area do not toggle on the same
+				 * frames, what reduces visible flicker at very low
+				 * intensities.
+				 */
+				TEMPORAL_SPATIAL_DITHERING
+			};
+
+		private:
+			float _gamma[3];
+			std::uint8_t _brightness;
+			std::uint32_t _current_budget;
+			std::uint32_t _last_sum;
+			bool _limited;
+			DITHERING _dithering;
+			std::uint8_t lut[3][256];
+			// 16 bits lookup tables, sampled every 256 input values
+			std::uint16_t lut16[3][257];
+			// Quantization error of each channel carried to the next
+			// frame
+			bounded_vector<std::uint8_t, 3*PIXLED_MAPPING_CAPACITY> error;
+
+			void updateLut();
+
+		public:
+			/**
+			 * Builds an OutputStage that leaves frames unchanged, i.e.
+			 * with a gamma of 1, a full brightness and no current budget.
+			 */
+			OutputStage();
+
+			/**
+			 * Sets the gamma of all channels.
+			 *
+			 * Values are corrected as `255 * (v / 255)^gamma`. Usual
+			 * values for WS2812 leds are around 2.2-2.8.
+			 *
+			 * @param gamma gamma exponent
+			 */
+			void setGamma(float gamma);
+
+			/**
+			 * Sets the gamma of each channel.
+			 *
+			 * @param red red gamma exponent
+			 * @param green green gamma exponent
+			 * @param blue blue gamma exponent
+			 */
+			void setGamma(float red, float green, float blue);
+
+			/**
+			 * Gamma of the specified channel.
+			 *
+			 * @param channel channel
+			 * @return gamma exponent
+			 */
+			float gamma(CHANNEL channel) const;
+
+			/**
+			 * Sets the global brightness, applied after gamma correction.
+			 *
+			 * @param brightness brightness, from 0 (black) to 255 (no
+			 * dimming)
+			 */
+			void setBrightness(std::uint8_t brightness);
+
+			/**
+			 * Global brightness.
+			 *
+			 * @return brightness, in [0, 255]
+			 */
+			std::uint8_t brightness() const;
+
+			/**
+			 * Sets the current budget, as the maximum sum of all channel
+			 * values of a frame, after gamma correction and dimming.
+			 *
+			 * For example, for leds that draw 20mA per channel at full
+			 * intensity, a 2A power supply corresponds to a budget of
+			 * `2000 / 20 * 255 = 25500`.
+			 *
+			 * @param budget maximum sum of channel values, or 0 to disable
+			 * current limiting
+			 */
+			void setCurrentBudget(std::uint32_t budget);
+
+			/**
+			 * Current budget.
+			 *
+			 * @return maximum sum of channel values, or 0 if current
+			 * limiting is disabled
+			 */
+			std::uint32_t currentBudget() const;
+
+			/**
+			 * Applies gamma correction, dimming and current limiting to
+			 * the `frame`, in place.
+			 *
+			 * @param frame rgb frame buffer
+			 * @param led_count count of leds in the frame
+			 */
+			void apply(std::uint8_t* frame, std::size_t led_count);
+
+			/**
+			 * Sets the dithering method used when processing 16 bits
+			 * frames.
+			 *
+			 * When dithering is enabled, the Runtime renders 16 bits
+			 * frames (see color::red16()), so that dim colors that are
+			 * quantized to the same 8 bits value do not produce visible
+			 * bands.
+			 *
+			 * @param dithering dithering method
+			 */
+			void setDithering(DITHERING dithering);
+
+			/**
+			 * Current dithering method.
+			 *
+			 * @return dithering method
+			 */
+			DITHERING dithering() const;
+
+			/**
+			 * Applies gamma correction, dimming and current limiting to a
+			 * 16 bits `frame`, and quantizes it to 8 bits in `output`
+			 * according to the dithering method.
+			 *
+			 * The 16 bits frame has the same layout as an 8 bits frame,
+			 * with components in [0, 65535], and is modified in place.
+			 * Gamma correction is interpolated from lookup tables, so
+			 * that no floating point operation is performed.
+			 *
+			 * The quantization error is kept for each channel, so that
+			 * successive calls must process frames of the same leds.
+			 *
+			 * @param frame 16 bits rgb frame buffer
+			 * @param output 8 bits rgb frame buffer, of `3*led_count`
+			 * bytes
+			 * @param led_count count of leds in the frame
+			 */
+			void apply(std::uint16_t* frame, std::uint8_t* output, std::size_t led_count);
+
+			/**
+			 * Sum of the channel values of the last frame processed by
+			 * apply(), after gamma correction and dimming but before
+			 * current limiting. For 16 bits frames, the sum is scaled to
+			 * 8 bits values.
+			 *
+			 * @return sum of channel values
+			 */
+			std::uint32_t lastSum() const;
+
+			/**
+			 * Returns true if the last frame processed by apply() has been
+			 * scaled down to fit in the current budget.
+			 *
+			 * @return true iff the last frame was limited
+			 */
+			bool limited() const;
+	};
+}
+#endif
@@ -0,0 +1,884 @@
+#include "parser.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include "containers.h"
+#include "chroma/chroma.h"
+
+namespace pixled { namespace detail {
+	using namespace serialization;
+
+	/**
+	 * Built-in \Function of the language.
+	 */
+	struct FunctionName {
+		const char* name;
+		NODE_TYPE node;
+		// True iff the node only depends on its arguments, so that it can
+		// be folded when all its arguments are constant
+		bool pure;
+	};
+
+	static const FunctionName FUNCTIONS[] = {
+		{"Cast", CAST_NODE, true},
+		{"If", IF_NODE, true},
+		{"hsb", HSB_NODE, true},
+		{"fixed_hsb", FIXED_HSB_NODE, true},
+		{"rgb", RGB_NODE, true},
+		{"T", T_NODE, false},
+		{"Phase", PHASE_NODE, false},
+		{"FixedPhase", FIXED_PHASE_NODE, false},
+		{"X", X_NODE, false},
+		{"Y", Y_NODE, false},
+		{"Z", Z_NODE, false},
+		{"I", I_NODE, false},
+		{"Distance", DISTANCE_NODE, true},
+		{"LineDistance", LINE_DISTANCE_NODE, true},
+		{"PlaneDistance", PLANE_DISTANCE_NODE, true},
+		{"Point", POINT_NODE, true},
+		{"point", POINT_NODE, true},
+		{"point", POINT_3D_NODE, true},
+		{"Point3D", POINT_3D_NODE, true},
+		{"AngleDeg", ANGLE_DEG_NODE, true},
+		{"AngleRad", ANGLE_RAD_NODE, true},
+		{"Line", LINE_NODE, true},
+		{"XLine", X_LINE_NODE, true},
+		{"YLine", Y_LINE_NODE, true},
+		{"AlphaLine", ALPHA_LINE_NODE, true},
+		{"Plane", PLANE_NODE, true},
+		{"NormalPlane", NORMAL_PLANE_NODE, true},
+		{"PointLine", POINT_LINE_NODE, true},
+		{"Sine", SINE_NODE, true},
+		{"Square", SQUARE_NODE, true},
+		{"Triangle", TRIANGLE_NODE, true},
+		{"Sawtooth", SAWTOOTH_NODE, true},
+		{"FixedSine", FIXED_SINE_NODE, true},
+		{"FixedTriangle", FIXED_TRIANGLE_NODE, true},
+		{"RandomT", RANDOM_T_NODE, false},
+		{"RandomXYT", RANDOM_XYT_NODE, false},
+		{"UniformDistribution", UNIFORM_DISTRIBUTION_NODE, false},
+		{"NormalDistribution", NORMAL_DISTRIBUTION_NODE, false},
+		{"Wave", WAVE_NODE, false},
+		{"LinearUnitWave", LINEAR_UNIT_WAVE_NODE, false},
+		{"RadialUnitWave", RADIAL_UNIT_WAVE_NODE, false},
+		{"Rainbow", RAINBOW_NODE, false},
+		{"RainbowWave", RAINBOW_WAVE_NODE, false},
+		{"RadialRainbowWave", RADIAL_RAINBOW_WAVE_NODE, false},
+		{"Blooming", BLOOMING_NODE, false},
+		{"Blink", BLINK_NODE, false},
+		{"Sequence", SEQUENCE_NODE, false}
+	};
+
+	/**
+	 * Type name of the language.
+	 */
+	struct TypeName {
+		const char* name;
+		VALUE_TYPE type;
+	};
+
+	static const TypeName TYPES[] = {
+		{"bool", BOOL_VALUE},
+		{"uint8_t", UINT8_VALUE},
+		{"int", INT_VALUE},
+		{"unsigned", UNSIGNED_INT_VALUE},
+		{"index_t", value_type<index_t>::id},
+		{"time", value_type<time>::id},
+		{"float", FLOAT_VALUE},
+		{"coordinate", value_type<coordinate>::id},
+		{"fixed", FIXED_VALUE},
+		{"point", POINT_VALUE},
+		{"line", LINE_VALUE},
+		{"plane", PLANE_VALUE},
+		{"angle", ANGLE_VALUE},
+		{"color", COLOR_VALUE}
+	};
+
+	/**
+	 * Named color of the language.
+	 */
+	struct ColorName {
+		const char* name;
+		const color* value;
+	};
+
+	static const ColorName COLORS[] = {
+		{"RED", &chroma::RED},
+		{"GREEN", &chroma::GREEN},
+		{"BLUE", &chroma::BLUE},
+		{"LIGHT_RED", &chroma::LIGHT_RED},
+		{"YELLOW", &chroma::YELLOW},
+		{"LIGHT_GREEN", &chroma::LIGHT_GREEN},
+		{"DARK_BLUE", &chroma::DARK_BLUE},
+		{"MIDNIGHT_BLUE", &chroma::MIDNIGHT_BLUE},
+		{"PINK", &chroma::PINK},
+		{"PURPLE", &chroma::PURPLE}
+	};
+
+	/**
+	 * Greatest magnitude of integer literals, so that operations on
+	 * literals can't overflow.
+	 */
+	static const std::int64_t MAX_INTEGER = 0xFFFFFFFF;
+
+	/**
+	 * Kind of the value of an expression.
+	 */
+	enum OPERAND_KIND {
+		// Built function
+		FUNCTION_OPERAND,
+		// Literals, whose type is only chosen when they are passed to a
+		// function
+		INTEGER_OPERAND,
+		REAL_OPERAND,
+		BOOLEAN_OPERAND
+	};
+
+	/**
+	 * Value of a parsed expression.
+	 */
+	struct Operand {
+		OPERAND_KIND kind = FUNCTION_OPERAND;
+		// Value of INTEGER_OPERAND and BOOLEAN_OPERAND
+		std::int64_t integer = 0;
+		// Value of REAL_OPERAND
+		float real = 0;
+		// True iff the function is a Constant
+		bool constant = false;
+		// Depth of the function graph
+		unsigned int depth = 1;
+		// Start of the expression in the text
+		const char* at = nullptr;
+		AnyFunction function;
+
+		bool literal() const {
+			return kind != FUNCTION_OPERAND;
+		}
+	};
+
+	/**
+	 * Type of a literal when it is not passed to a function.
+	 */
+	static VALUE_TYPE natural_type(const Operand& literal) {
+		switch(literal.kind) {
+			case INTEGER_OPERAND:
+				return INT_VALUE;
+			case REAL_OPERAND:
+				return FLOAT_VALUE;
+			case BOOLEAN_OPERAND:
+				return BOOL_VALUE;
+			default:
+				return UNKNOWN_VALUE;
+		}
+	}
+
+	/**
+	 * Converts an integer literal to `T`, if it is in the range of `T`.
+	 */
+	template<typename T>
+		static bool convert_integer(const Operand& literal, AnyFunction* function) {
+			if(literal.kind != INTEGER_OPERAND)
+				return false;
+			if(std::numeric_limits<T>::is_signed ?
+					literal.integer < (std::int64_t) std::numeric_limits<T>::min() : literal.integer < 0)
+				return false;
+			if(literal.integer > 0
+					&& (std::uint64_t) literal.integer > (std::uint64_t) std::numeric_limits<T>::max())
+				return false;
+			if(function != nullptr)
+				function->set<T>(FctWrapper<T>((T) literal.integer));
+			return true;
+		}
+
+	/**
+	 * Converts a literal to `type`.
+	 *
+	 * @param literal literal operand
+	 * @param type target type
+	 * @param function set to a Constant of type `type`, if not `nullptr`
+	 * @return false if the literal can't be represented by `type`
+	 */
+	static bool convert(const Operand& literal, VALUE_TYPE type, AnyFunction* function) {
+		switch(type) {
+			case BOOL_VALUE:
+				if(literal.kind != BOOLEAN_OPERAND)
+					return false;
+				if(function != nullptr)
+					function->set<bool>(FctWrapper<bool>(literal.integer != 0));
+				return true;
+			case UINT8_VALUE:
+				return convert_integer<std::uint8_t>(literal, function);
+			case INT_VALUE:
+				return convert_integer<int>(literal, function);
+			case UNSIGNED_INT_VALUE:
+				return convert_integer<unsigned int>(literal, function);
+			case UNSIGNED_LONG_VALUE:
+				return convert_integer<unsigned long>(literal, function);
+			case FLOAT_VALUE:
+			case FIXED_VALUE:
+				{
+					if(literal.kind != INTEGER_OPERAND && literal.kind != REAL_OPERAND)
+						return false;
+					float value = literal.kind == INTEGER_OPERAND ? (float) literal.integer : literal.real;
+					if(function != nullptr) {
+						if(type == FLOAT_VALUE)
+							function->set<float>(FctWrapper<float>(value));
+						else
+							function->set<fixed>(FctWrapper<fixed>(fixed(value)));
+					}
+					return true;
+				}
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * Replaces a function whose arguments are all constant by a Constant.
+	 */
+	struct Folder {
+		AnyFunction& function;
+
+		template<typename T>
+			bool visit() {
+				T value = function.get<T>()({point(0, 0), 0}, 0);
+				function.set<T>(FctWrapper<T>(value));
+				return true;
+			}
+	};
+
+	template<typename T>
+		static bool is_zero(const T& value, std::true_type) {
+			return value == T(0);
+		}
+
+	template<typename T>
+		static bool is_zero(const T&, std::false_type) {
+			return false;
+		}
+
+	/**
+	 * Checks if a Constant is a numeric 0.
+	 */
+	struct ZeroCheck {
+		AnyFunction& function;
+
+		template<typename T>
+			bool visit() {
+				return is_zero(function.get<T>()({point(0, 0), 0}, 0),
+						std::integral_constant<bool,
+						std::is_arithmetic<T>::value || std::is_same<T, fixed>::value>());
+			}
+	};
+
+	/**
+	 * Arguments of a node, built by the Parser.
+	 */
+	class OperandArguments : public NodeArguments {
+		private:
+			Operand* operands;
+			std::size_t count;
+			std::size_t index = 0;
+
+		public:
+			OperandArguments(Operand* operands, std::size_t count)
+				: operands(operands), count(count) {}
+
+			bool next(AnyFunction& argument) override {
+				if(index == count)
+					return false;
+				argument = std::move(operands[index++].function);
+				return true;
+			}
+	};
+
+	/**
+	 * Recursive descent parser.
+	 *
+	 * The operands of the function calls being parsed are stored in a
+	 * single stack, so that the memory used by the parser does not depend
+	 * on the count of arguments of the nodes.
+	 */
+	class Parser {
+		private:
+			const char* text;
+			const char* current;
+			ParseError& error;
+			unsigned int depth = 0;
+			bounded_vector<Operand, PIXLED_PARSER_CAPACITY> operands;
+			bounded_vector<std::uint8_t, 8*PIXLED_PARSER_CAPACITY> payload;
+
+			bool fail(const char* at, const char* message) {
+				error.position = at - text;
+				error.message = message;
+				return false;
+			}
+
+			void skipSpaces() {
+				while(*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r')
+					current++;
+			}
+
+			static bool isIdentifierStart(char c) {
+				return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+			}
+
+			static bool isDigit(char c) {
+				return c >= '0' && c <= '9';
+			}
+
+			/**
+			 * Consumes `symbol`, if it is the next token.
+			 */
+			bool accept(const char* symbol) {
+				skipSpaces();
+				std::size_t length = std::strlen(symbol);
+				if(std::strncmp(current, symbol, length) != 0)
+					return false;
+				current += length;
+				return true;
+			}
+
+			bool expect(const char* symbol, const char* message) {
+				if(!accept(symbol))
+					return fail(current, message);
+				return true;
+			}
+
+			/**
+			 * Reads an identifier.
+			 */
+			std::size_t identifier() {
+				std::size_t length = 0;
+				if(isIdentifierStart(current[0]))
+					while(isIdentifierStart(current[length]) || isDigit(current[length]))
+						length++;
+				return length;
+			}
+
+			static bool matches(const char* name, const char* identifier, std::size_t length) {
+				return std::strlen(name) == length && std::strncmp(name, identifier, length) == 0;
+			}
+
+			bool push(Operand&& operand) {
+#ifdef PIXLED_NO_HEAP
+				if(operands.size() == operands.capacity())
+					return fail(operand.at, "too many arguments");
+#endif
+				operands.push_back(std::move(operand));
+				return true;
+			}
+
+			void pop(std::size_t first) {
+				while(operands.size() > first)
+					operands.pop_back();
+			}
+
+			/**
+			 * True iff `node` has an instantiation with `count`
+			 * arguments.
+			 */
+			static bool accepts(NODE_TYPE node, std::size_t count) {
+				std::size_t builder_count;
+				const NodeBuilder* builders = node_builders(node, builder_count);
+				for(std::size_t b = 0; b < builder_count; b++)
+					if(builders[b].argCount() == count || builders[b].argCount() == VARIADIC)
+						return true;
+				return false;
+			}
+
+			bool number(Operand& operand);
+			bool typeName(VALUE_TYPE& type);
+			bool call(const char* name, std::size_t length, Operand& result);
+			bool sequence(std::size_t first, std::size_t count, Operand& result);
+			bool randomEngine(NODE_TYPE node, std::size_t first, std::size_t count, Operand& result);
+			bool build(
+					NODE_TYPE node, VALUE_TYPE type, bool pure,
+					std::size_t first, std::size_t count, Operand& result);
+			bool literalOperation(NODE_TYPE node, Operand& lhs, const Operand& rhs);
+			bool operation(NODE_TYPE node, Operand& lhs, Operand&& rhs);
+
+			bool primary(Operand& result);
+			bool unary(Operand& result);
+			bool multiplicative(Operand& result);
+			bool additive(Operand& result);
+			bool relational(Operand& result);
+			bool equality(Operand& result);
+
+		public:
+			Parser(const char* text, ParseError& error)
+				: text(text), current(text), error(error) {}
+
+			bool parse(VALUE_TYPE root, AnyFunction& function);
+	};
+
+	bool Parser::number(Operand& operand) {
+		const char* begin = current;
+		const char* end = current;
+		bool real = false;
+		while(isDigit(*end))
+			end++;
+		if(*end == '.') {
+			real = true;
+			end++;
+			while(isDigit(*end))
+				end++;
+		}
+		if(*end == 'e' || *end == 'E') {
+			const char* exponent = end + 1;
+			if(*exponent == '+' || *exponent == '-')
+				exponent++;
+			if(isDigit(*exponent)) {
+				real = true;
+				end = exponent;
+				while(isDigit(*end))
+					end++;
+			}
+		}
+		char* parsed;
+		errno = 0;
+		if(real) {
+			operand.kind = REAL_OPERAND;
+			operand.real = std::strtof(begin, &parsed);
+		} else {
+			operand.kind = INTEGER_OPERAND;
+			unsigned long long value = std::strtoull(begin, &parsed, 10);
+			if(value > (unsigned long long) MAX_INTEGER)
+				errno = ERANGE;
+			operand.integer = (std::int64_t) value;
+		}
+		if(parsed != end || errno == ERANGE)
+			return fail(begin, "invalid number");
+		if(*end == 'f' || *end == 'F') {
+			if(!real) {
+				operand.kind = REAL_OPERAND;
+				operand.real = (float) operand.integer;
+			}
+			end++;
+		}
+		if(isIdentifierStart(*end) || isDigit(*end) || *end == '.')
+			return fail(begin, "invalid number");
+		current = end;
+		return true;
+	}
+
+	bool Parser::typeName(VALUE_TYPE& type) {
+		skipSpaces();
+		std::size_t length = identifier();
+		for(const TypeName& name : TYPES) {
+			if(matches(name.name, current, length)) {
+				type = name.type;
+				current += length;
+				return true;
+			}
+		}
+		return fail(current, "unknown type");
+	}
+
+	bool Parser::build(
+			NODE_TYPE node, VALUE_TYPE type, bool pure,
+			std::size_t first, std::size_t count, Operand& result) {
+		// Chooses the instantiation that requires the fewest literal
+		// conversions, preferring the types of the other arguments
+		std::size_t builder_count;
+		const NodeBuilder* builders = node_builders(node, builder_count);
+		const NodeBuilder* best = nullptr;
+		unsigned int best_cost = 0;
+		for(std::size_t b = 0; b < builder_count; b++) {
+			const NodeBuilder& builder = builders[b];
+			bool variadic = builder.argCount() == VARIADIC;
+			if(variadic ? count == 0 : builder.argCount() != count)
+				continue;
+			if(type != UNKNOWN_VALUE && builder.result() != type)
+				continue;
+			unsigned int cost = 0;
+			bool match = true;
+			for(std::size_t i = 0; i < count && match; i++) {
+				VALUE_TYPE arg_type = builder.argType(variadic ? 0 : i);
+				const Operand& operand = operands[first + i];
+				if(!operand.literal()) {
+					match = operand.function.type() == arg_type;
+				} else if(natural_type(operand) != arg_type) {
+					match = convert(operand, arg_type, nullptr);
+					bool shared = false;
+					for(std::size_t j = 0; j < count; j++)
+						shared = shared || (!operands[first + j].literal()
+								&& operands[first + j].function.type() == arg_type);
+					cost += shared ? 1 : 2;
+				}
+			}
+			if(match && (best == nullptr || cost < best_cost)) {
+				best = &builder;
+				best_cost = cost;
+			}
+		}
+		if(best == nullptr)
+			return fail(result.at, "no matching function");
+		bool variadic = best->argCount() == VARIADIC;
+		if(payload.size() != best->payload_size * (variadic ? count : 1))
+			return fail(result.at, "invalid arguments");
+
+		bool constant = true;
+		unsigned int depth = 0;
+		for(std::size_t i = 0; i < count; i++) {
+			Operand& operand = operands[first + i];
+			if(operand.literal()) {
+				convert(operand, best->argType(variadic ? 0 : i), &operand.function);
+				operand.constant = true;
+			}
+			constant = constant && operand.constant;
+			if(operand.depth > depth)
+				depth = operand.depth;
+		}
+		if((node == DIVIDES_NODE || node == MODULUS_NODE) && operands[first + 1].constant) {
+			ZeroCheck zero {operands[first + 1].function};
+			if(visit(operands[first + 1].function.type(), zero))
+				return fail(operands[first + 1].at, "division by zero");
+		}
+
+		OperandArguments arguments(operands.data() + first, count);
+		bool built = best->build(arguments, count, payload.data(), result.function);
+		pop(first);
+		payload.clear();
+		if(!built)
+			return fail(result.at, "invalid arguments");
+		result.kind = FUNCTION_OPERAND;
+		result.constant = false;
+		result.depth = depth + 1;
+		if(pure && constant && count > 0) {
+			Folder folder {result.function};
+			visit(result.function.type(), folder);
+			result.constant = true;
+			result.depth = 1;
+		}
+		if(result.depth > MAX_DEPTH)
+			return fail(result.at, "expression too deep");
+		return true;
+	}
+
+	bool Parser::randomEngine(NODE_TYPE node, std::size_t first, std::size_t count, Operand& result) {
+		// RandomT(period, seed)
+		if(count != 2
+				|| operands[first].kind != INTEGER_OPERAND || operands[first].integer <= 0
+				|| operands[first + 1].kind != INTEGER_OPERAND || operands[first + 1].integer < 0)
+			return fail(result.at, "invalid arguments");
+		payload.resize(16);
+		store_le(payload.data(), (std::uint64_t) operands[first].integer, 8);
+		store_le(payload.data() + 8, (std::uint64_t) operands[first + 1].integer, 8);
+		pop(first);
+		return build(node, RANDOM_ENGINE_VALUE, false, first, 0, result);
+	}
+
+	bool Parser::sequence(std::size_t first, std::size_t count, Operand& result) {
+		// Sequence(animation, duration, ...)
+		if(count == 0 || count % 2 != 0)
+			return fail(result.at, "invalid arguments");
+		for(std::size_t i = 0; i < count; i += 2) {
+			const Operand& duration = operands[first + i + 1];
+			if(duration.kind != INTEGER_OPERAND || duration.integer <= 0)
+				return fail(duration.at, "invalid duration");
+			payload.resize(payload.size() + 8);
+			store_le(payload.data() + 8*(i/2), (std::uint64_t) duration.integer, 8);
+			if(i > 0)
+				operands[first + i/2] = std::move(operands[first + i]);
+		}
+		pop(first + count/2);
+		return build(SEQUENCE_NODE, COLOR_VALUE, false, first, count/2, result);
+	}
+
+	bool Parser::call(const char* name, std::size_t length, Operand& result) {
+		VALUE_TYPE type = UNKNOWN_VALUE;
+		if(accept("<")) {
+			if(!typeName(type) || !expect(">", "expected '>'"))
+				return false;
+		}
+		if(!expect("(", "expected '('"))
+			return false;
+
+		std::size_t first = operands.size();
+		if(!accept(")")) {
+			do {
+				Operand argument;
+				if(!equality(argument) || !push(std::move(argument)))
+					return false;
+			} while(accept(","));
+			if(!expect(")", "expected ')'"))
+				return false;
+		}
+		std::size_t count = operands.size() - first;
+
+		// Overloaded names, e.g. point(x, y) and point(x, y, z), are
+		// resolved from the count of arguments
+		const FunctionName* function = nullptr;
+		for(const FunctionName& candidate : FUNCTIONS) {
+			if(!matches(candidate.name, name, length))
+				continue;
+			if(function == nullptr)
+				function = &candidate;
+			if(accepts(candidate.node, count)) {
+				function = &candidate;
+				break;
+			}
+		}
+
+		switch(function->node) {
+			case RANDOM_T_NODE:
+			case RANDOM_XYT_NODE:
+				return randomEngine(function->node, first, count, result);
+			case SEQUENCE_NODE:
+				return sequence(first, count, result);
+			default:
+				return build(function->node, type, function->pure, first, count, result);
+		}
+	}
+
+	bool Parser::primary(Operand& result) {
+		skipSpaces();
+		result.at = current;
+		if(isDigit(*current) || (*current == '.' && isDigit(current[1])))
+			return number(result);
+		if(accept("(")) {
+			if(!equality(result) || !expect(")", "expected ')'"))
+				return false;
+			return true;
+		}
+
+		std::size_t length = identifier();
+		if(length == 0)
+			return fail(current, "expected expression");
+		const char* name = current;
+		current += length;
+		if(matches("true", name, length) || matches("false", name, length)) {
+			result.kind = BOOLEAN_OPERAND;
+			result.integer = matches("true", name, length);
+			return true;
+		}
+		for(const ColorName& color : COLORS) {
+			if(matches(color.name, name, length)) {
+				result.function.set<pixled::color>(FctWrapper<pixled::color>(*color.value));
+				result.constant = true;
+				return true;
+			}
+		}
+		for(const FunctionName& function : FUNCTIONS)
+			if(matches(function.name, name, length))
+				return call(name, length, result);
+		return fail(name, "unknown identifier");
+	}
+
+	bool Parser::unary(Operand& result) {
+		if(++depth > MAX_DEPTH)
+			return fail(current, "expression too deep");
+		skipSpaces();
+		const char* at = current;
+		bool ok;
+		if(accept("-")) {
+			Operand operand;
+			if(!unary(operand))
+				return false;
+			if(operand.kind == INTEGER_OPERAND) {
+				operand.integer = -operand.integer;
+				result = std::move(operand);
+			} else if(operand.kind == REAL_OPERAND) {
+				operand.real = -operand.real;
+				result = std::move(operand);
+			} else {
+				// -f is 0 - f
+				result.kind = INTEGER_OPERAND;
+				result.integer = 0;
+				result.at = at;
+				if(!operation(MINUS_NODE, result, std::move(operand)))
+					return false;
+			}
+			result.at = at;
+			ok = true;
+		} else if(accept("+")) {
+			ok = unary(result);
+			result.at = at;
+		} else {
+			ok = primary(result);
+		}
+		depth--;
+		return ok;
+	}
+
+	bool Parser::literalOperation(NODE_TYPE node, Operand& lhs, const Operand& rhs) {
+		if(lhs.kind == BOOLEAN_OPERAND || rhs.kind == BOOLEAN_OPERAND)
+			return fail(lhs.at, "invalid operands");
+		bool integer = lhs.kind == INTEGER_OPERAND && rhs.kind == INTEGER_OPERAND;
+		float x = lhs.kind == INTEGER_OPERAND ? (float) lhs.integer : lhs.real;
+		float y = rhs.kind == INTEGER_OPERAND ? (float) rhs.integer : rhs.real;
+		std::int64_t i = lhs.integer;
+		std::int64_t j = rhs.integer;
+		switch(node) {
+			case PLUS_NODE:
+			case MINUS_NODE:
+			case MULTIPLIES_NODE:
+			case DIVIDES_NODE:
+			case MODULUS_NODE:
+				if(integer) {
+					if((node == DIVIDES_NODE || node == MODULUS_NODE) && j == 0)
+						return fail(rhs.at, "division by zero");
+					// Operands are lower than 2^32, so only products can
+					// overflow
+					double product = (double) i * j;
+					if(node == MULTIPLIES_NODE && (product > MAX_INTEGER || product < -MAX_INTEGER))
+						return fail(lhs.at, "integer overflow");
+					std::int64_t value =
+						node == PLUS_NODE ? i + j :
+						node == MINUS_NODE ? i - j :
+						node == MULTIPLIES_NODE ? i * j :
+						node == DIVIDES_NODE ? i / j :
+						i % j;
+					if(value > MAX_INTEGER || value < -MAX_INTEGER)
+						return fail(lhs.at, "integer overflow");
+					lhs.integer = value;
+				} else {
+					if(node == MODULUS_NODE)
+						return fail(lhs.at, "invalid operands");
+					lhs.kind = REAL_OPERAND;
+					lhs.real =
+						node == PLUS_NODE ? x + y :
+						node == MINUS_NODE ? x - y :
+						node == MULTIPLIES_NODE ? x * y :
+						x / y;
+				}
+				return true;
+			default:
+				{
+					bool value;
+					if(integer) {
+						value =
+							node == EQUAL_NODE ? i == j :
+							node == NOT_EQUAL_NODE ? i != j :
+							node == LESS_THAN_NODE ? i < j :
+							node == LESS_THAN_OR_EQUAL_NODE ? i <= j :
+							node == GREATER_THAN_NODE ? i > j :
+							i >= j;
+					} else {
+						value =
+							node == EQUAL_NODE ? x == y :
+							node == NOT_EQUAL_NODE ? x != y :
+							node == LESS_THAN_NODE ? x < y :
+							node == LESS_THAN_OR_EQUAL_NODE ? x <= y :
+							node == GREATER_THAN_NODE ? x > y :
+							x >= y;
+					}
+					lhs.kind = BOOLEAN_OPERAND;
+					lhs.integer = value;
+					return true;
+				}
+		}
+	}
+
+	bool Parser::operation(NODE_TYPE node, Operand& lhs, Operand&& rhs) {
+		if(lhs.literal() && rhs.literal())
+			return literalOperation(node, lhs, rhs);
+		const char* at = lhs.at;
+		std::size_t first = operands.size();
+		if(!push(std::move(lhs)) || !push(std::move(rhs)))
+			return false;
+		lhs = Operand();
+		lhs.at = at;
+		return build(node, UNKNOWN_VALUE, true, first, 2, lhs);
+	}
+
+	bool Parser::multiplicative(Operand& result) {
+		if(!unary(result))
+			return false;
+		while(true) {
+			NODE_TYPE node;
+			if(accept("*"))
+				node = MULTIPLIES_NODE;
+			else if(accept("/"))
+				node = DIVIDES_NODE;
+			else if(accept("%"))
+				node = MODULUS_NODE;
+			else
+				return true;
+			Operand rhs;
+			if(!unary(rhs) || !operation(node, result, std::move(rhs)))
+				return false;
+		}
+	}
+
+	bool Parser::additive(Operand& result) {
+		if(!multiplicative(result))
+			return false;
+		while(true) {
+			NODE_TYPE node;
+			if(accept("+"))
+				node = PLUS_NODE;
+			else if(accept("-"))
+				node = MINUS_NODE;
+			else
+				return true;
+			Operand rhs;
+			if(!multiplicative(rhs) || !operation(node, result, std::move(rhs)))
+				return false;
+		}
+	}
+
+	bool Parser::relational(Operand& result) {
+		if(!additive(result))
+			return false;
+		while(true) {
+			NODE_TYPE node;
+			if(accept("<="))
+				node = LESS_THAN_OR_EQUAL_NODE;
+			else if(accept(">="))
+				node = GREATER_THAN_OR_EQUAL_NODE;
+			else if(accept("<"))
+				node = LESS_THAN_NODE;
+			else if(accept(">"))
+				node = GREATER_THAN_NODE;
+			else
+				return true;
+			Operand rhs;
+			if(!additive(rhs) || !operation(node, result, std::move(rhs)))
+				return false;
+		}
+	}
+
+	bool Parser::equality(Operand& result) {
+		if(!relational(result))
+			return false;
+		while(true) {
+			NODE_TYPE node;
+			if(accept("=="))
+				node = EQUAL_NODE;
+			else if(accept("!="))
+				node = NOT_EQUAL_NODE;
+			else
+				return true;
+			Operand rhs;
+			if(!relational(rhs) || !operation(node, result, std::move(rhs)))
+				return false;
+		}
+	}
+
+	bool Parser::parse(VALUE_TYPE root, AnyFunction& function) {
+		Operand result;
+		if(!equality(result))
+			return false;
+		skipSpaces();
+		if(*current != '\0')
+			return fail(current, "unexpected character");
+		if(result.literal()) {
+			if(!convert(result, root, &result.function))
+				return fail(result.at, "type mismatch");
+		} else if(result.function.type() != root) {
+			return fail(result.at, "type mismatch");
+		}
+		function = std::move(result.function);
+		return true;
+	}
+
+	bool parse_function(const char* text, VALUE_TYPE root, AnyFunction& function, ParseError& error) {
+		error = ParseError();
+		Parser parser(text, error);
+		return parser.parse(root, function);
+	}
+}}
@@ -0,0 +1,138 @@
+#ifndef PIXLED_PARSER_H
+#define PIXLED_PARSER_H
+
+#include <cstddef>
+#include "config.h"
+#include "function.h"
+#include "graph.h"
+
+#ifndef PIXLED_NO_HEAP
+#include <vector>
+#endif
+
+namespace pixled {
+	/**
+	 * Location and cause of a parsing error (see parse()).
+	 */
+	struct ParseError {
+		/**
+		 * Offset of the error in the parsed text.
+		 */
+		std::size_t position = 0;
+		/**
+		 * Description of the error, or `nullptr` if no error occured.
+		 */
+		const char* message = nullptr;
+	};
+
+	namespace detail {
+		/**
+		 * Parses the expression `text` (see parse()).
+		 *
+		 * @param text null terminated expression
+		 * @param root type returned by the expression
+		 * @param function built function
+		 * @param error parsing error, if any
+		 * @return false if `text` is not a valid expression returning
+		 * `root`
+		 */
+		bool parse_function(
+				const char* text, serialization::VALUE_TYPE root,
+				AnyFunction& function, ParseError& error);
+	}
+
+	/**
+	 * Parses a textual animation, and builds the corresponding Function
+	 * graph.
+	 *
+	 * The expression language mirrors the C++ API: built-in \Functions are
+	 * called by their name, with the same arguments, and can be combined
+	 * with the arithmetic and comparison operators:
+	 * ```
+	 * hsb(Rainbow(20), 1, 0.5 + 0.5*Sine(X()/8 - T()/40))
+	 * ```
+	 * The parsed graph is built from the same base::Function nodes as the
+	 * C++ expression, so it runs exactly as fast.
+	 *
+	 * As in C++:
+	 * - integer literals are `int`, and real literals (e.g. `0.5` or
+	 *   `0.5f`) are `float`. Literals passed to a \Function are converted
+	 *   to the type of its argument, if they can be represented by this
+	 *   type.
+	 * - operators return the common type of their operands, e.g. `T()/40`
+	 *   is an integer division.
+	 * - the type of template \Functions is specified between angle
+	 *   brackets: `Cast<uint8_t>(...)`, `If<color>(...)`,
+	 *   `Wave<float>(...)`, `UniformDistribution<int>(...)`. Type names are
+	 *   `bool`, `uint8_t`, `int`, `unsigned`, `index_t`, `time`, `float`,
+	 *   `coordinate`, `fixed`, `point`, `line`, `plane`, `angle` and
+	 *   `color`.
+	 * - the named colors of the chroma namespace (e.g. `RED`) and `true`
+	 *   and `false` can be used as constants, and `point(x, y)` is a
+	 *   Point.
+	 *
+	 * The constructors that don't take \Functions use plain literals:
+	 * `RandomT(period, seed)`, `RandomXYT(period, seed)`, and
+	 * `Sequence(animation, duration, ...)`.
+	 *
+	 * Constant subexpressions are folded while parsing: `rgb(255, 0, 0)` is
+	 * a single Constant, and `Sine(0.25) * X()` does not evaluate the Sine
+	 * on each call.
+	 *
+	 * Parsed nodes are allocated with `new` (see ArenaScope). Use compile()
+	 * and a FunctionGraph to load a parsed animation in a single
+	 * allocation.
+	 *
+	 * @param text null terminated expression
+	 * @param function parsed function, unchanged if `text` is invalid
+	 * @param error if not `nullptr`, set to the position and the cause of
+	 * the error
+	 * @return false if `text` is not a valid expression returning `R`
+	 */
+	template<typename R>
+		bool parse(const char* text, FctWrapper<R>& function, ParseError* error = nullptr) {
+			static_assert(serialization::value_type<R>::id != serialization::UNKNOWN_VALUE,
+					"R must be a serialization::value_types");
+			ParseError ignored;
+			detail::AnyFunction parsed;
+			if(!detail::parse_function(
+						text, serialization::value_type<R>::id, parsed,
+						error != nullptr ? *error : ignored))
+				return false;
+			function = std::move(parsed.template get<R>());
+			return true;
+		}
+
+#ifndef PIXLED_NO_HEAP
+	/**
+	 * Parses a textual animation (see parse()), and serializes the
+	 * resulting graph, that can then be stored, sent, and loaded in a
+	 * single allocation with a FunctionGraph:
+	 * ```cpp
+	 * pixled::FunctionGraph<pixled::color> scene(
+	 * 	pixled::compile<pixled::color>("hsb(Rainbow(20), 1, 1)"));
+	 * ```
+	 *
+	 * Not available in heap-free mode.
+	 *
+	 * @param text null terminated expression
+	 * @param error if not `nullptr`, set to the position and the cause of
+	 * the error
+	 * @return serialized graph, or an empty vector if `text` is not a
+	 * valid expression returning `R`
+	 */
+	template<typename R>
+		std::vector<std::uint8_t> compile(const char* text, ParseError* error = nullptr) {
+			static_assert(serialization::value_type<R>::id != serialization::UNKNOWN_VALUE,
+					"R must be a serialization::value_types");
+			ParseError ignored;
+			detail::AnyFunction parsed;
+			if(!detail::parse_function(
+						text, serialization::value_type<R>::id, parsed,
+						error != nullptr ? *error : ignored))
+				return {};
+			return serialize(*parsed.template get<R>());
+		}
+#endif
+}
+#endif
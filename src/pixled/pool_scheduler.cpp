@@ -0,0 +1,167 @@
+#include "pool_scheduler.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace pixled {
+	PoolScheduler::PoolScheduler(ThreadPool& pool, CATCH_UP_POLICY policy)
+		: pool(pool), _policy(policy) {
+	}
+
+	void PoolScheduler::add(Runtime& runtime, float fps, int priority) {
+		clock::duration period = std::chrono::duration_cast<clock::duration>(
+				std::chrono::duration<double>(1. / fps));
+		std::lock_guard<std::mutex> lock(mutex);
+		clock::time_point now = this->now();
+		entries.emplace_back(new Entry {
+				&runtime, period, priority, now, false, 0, 0,
+				now, runtime.current_time()
+				});
+		frame_done.notify_one();
+	}
+
+	CATCH_UP_POLICY PoolScheduler::policy() const {
+		return _policy;
+	}
+
+	void PoolScheduler::setTimeResolution(unsigned long steps_per_second) {
+		time_resolution = steps_per_second;
+	}
+
+	unsigned long PoolScheduler::timeResolution() const {
+		return time_resolution;
+	}
+
+	void PoolScheduler::setClock(ClockFunction now) {
+		this->now = now;
+	}
+
+	const PoolScheduler::Entry& PoolScheduler::entry(const Runtime& runtime) const {
+		for(auto& entry : entries)
+			if(entry->runtime == &runtime)
+				return *entry;
+		// The runtime was not added to this scheduler
+		std::abort();
+	}
+
+	void PoolScheduler::dispatch(Entry& entry) {
+		entry.busy = true;
+		in_flight++;
+		Entry* e = &entry;
+		unsigned long resolution = time_resolution;
+		pool.submit([this, e, resolution] {
+				if(resolution > 0)
+					e->runtime->seek(e->runtime_origin + (time) (
+							std::chrono::duration<double>(now() - e->time_origin).count()
+							* resolution));
+				e->runtime->next();
+				finish(*e);
+				});
+	}
+
+	void PoolScheduler::finish(Entry& entry) {
+		std::lock_guard<std::mutex> lock(mutex);
+		entry.frames++;
+		entry.deadline += entry.period;
+		clock::time_point now = this->now();
+		if(now > entry.deadline) {
+			switch(_policy) {
+				case SKIP_FRAMES:
+					{
+						// Periods elapsed since the next deadline
+						unsigned long skipped = (now - entry.deadline) / entry.period;
+						entry.deadline += entry.period * skipped;
+						if(time_resolution == 0)
+							entry.runtime->seek(entry.runtime->current_time()
+									+ skipped * entry.runtime->timeStep());
+						entry.skipped_frames += skipped;
+					}
+					break;
+				case SLOW_DOWN:
+					entry.deadline = now;
+					break;
+			}
+		}
+		entry.busy = false;
+		in_flight--;
+		frame_done.notify_all();
+	}
+
+	PoolScheduler::clock::time_point PoolScheduler::dispatchDue() {
+		clock::time_point now = this->now();
+		clock::time_point wake = clock::time_point::max();
+		due.clear();
+		for(auto& entry : entries) {
+			if(entry->busy)
+				continue;
+			if(entry->deadline <= now)
+				due.push_back(entry.get());
+			else
+				wake = std::min(wake, entry->deadline);
+		}
+		std::sort(due.begin(), due.end(), [] (const Entry* e1, const Entry* e2) {
+				if(e1->priority != e2->priority)
+					return e1->priority > e2->priority;
+				return e1->deadline < e2->deadline;
+				});
+		for(Entry* entry : due) {
+			if(in_flight >= pool.threadCount())
+				break;
+			dispatch(*entry);
+		}
+		return wake;
+	}
+
+	PoolScheduler::clock::time_point PoolScheduler::poll() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return dispatchDue();
+	}
+
+	void PoolScheduler::wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		frame_done.wait(lock, [this] {return in_flight == 0;});
+	}
+
+	void PoolScheduler::run(bool bounded, clock::time_point end) {
+		std::unique_lock<std::mutex> lock(mutex);
+		// The stop request is consumed, so that the scheduler can be run
+		// again
+		while(!stop_requested.exchange(false)) {
+			if(bounded && now() >= end)
+				break;
+			clock::time_point wake = std::min(
+					dispatchDue(), bounded ? end : now() + std::chrono::seconds(1));
+			// Woken up when a frame is done, when a runtime is added, or
+			// at the next deadline
+			frame_done.wait_until(lock, wake);
+		}
+		frame_done.wait(lock, [this] {return in_flight == 0;});
+	}
+
+	void PoolScheduler::run() {
+		run(false, clock::time_point());
+	}
+
+	void PoolScheduler::run(clock::duration duration) {
+		run(true, now() + duration);
+	}
+
+	void PoolScheduler::stop() {
+		std::lock_guard<std::mutex> lock(mutex);
+		stop_requested = true;
+		frame_done.notify_all();
+	}
+
+	unsigned long PoolScheduler::frames(const Runtime& runtime) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return entry(runtime).frames;
+	}
+
+	unsigned long PoolScheduler::skippedFrames(const Runtime& runtime) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return entry(runtime).skipped_frames;
+	}
+}
+#endif
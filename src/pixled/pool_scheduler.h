@@ -0,0 +1,227 @@
+#ifndef PIXLED_POOL_SCHEDULER_H
+#define PIXLED_POOL_SCHEDULER_H
+
+#include "config.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "runtime.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+
+namespace pixled {
+	/**
+	 * Drives many independent Runtimes, each at its own frame rate, on a
+	 * shared ThreadPool.
+	 *
+	 * Instead of using one thread per Runtime, the frames of all the
+	 * Runtimes are executed as tasks of the pool, so that the CPU usage
+	 * scales with the count of cores. Each Runtime has at most one frame in
+	 * progress at a time.
+	 *
+	 * The run() loop dispatches the frames which deadline is passed. At most
+	 * ThreadPool::threadCount() frames are in progress at once: when more
+	 * frames are due, frames of Runtimes with a higher priority are
+	 * dispatched first, and then the frames which deadline is the oldest.
+	 *
+	 * Large frames can additionally be split in tasks with
+	 * Runtime::setThreadPool(), using the same pool.
+	 *
+	 * Late frames are handled according to the CATCH_UP_POLICY of the
+	 * scheduler, as with Scheduler.
+	 *
+	 * Not available in heap-free mode.
+	 *
+	 * ```cpp
+	 * pixled::ThreadPool pool;
+	 * pixled::PoolScheduler scheduler(pool);
+	 * scheduler.add(runtime1, 60);
+	 * scheduler.add(runtime2, 30, 1);
+	 * scheduler.run();
+	 * ```
+	 */
+	class PoolScheduler {
+		public:
+			/**
+			 * Clock used to schedule frames.
+			 */
+			typedef std::chrono::steady_clock clock;
+			/**
+			 * Function returning the current time of the clock.
+			 */
+			typedef clock::time_point (*ClockFunction)();
+
+		private:
+			struct Entry {
+				Runtime* runtime;
+				clock::duration period;
+				int priority;
+				clock::time_point deadline;
+				bool busy;
+				unsigned long frames;
+				unsigned long skipped_frames;
+				clock::time_point time_origin;
+				time runtime_origin;
+			};
+
+			ThreadPool& pool;
+			CATCH_UP_POLICY _policy;
+			unsigned long time_resolution = 0;
+			ClockFunction now = &clock::now;
+			std::vector<std::unique_ptr<Entry>> entries;
+
+			// Protects entries, due and in_flight
+			mutable std::mutex mutex;
+			std::condition_variable frame_done;
+			std::size_t in_flight = 0;
+			std::vector<Entry*> due;
+			std::atomic<bool> stop_requested {false};
+
+			const Entry& entry(const Runtime& runtime) const;
+			void dispatch(Entry& entry);
+			void finish(Entry& entry);
+			// Implementation of poll(), called with the mutex held
+			clock::time_point dispatchDue();
+			void run(bool bounded, clock::time_point end);
+
+		public:
+			/**
+			 * PoolScheduler constructor.
+			 *
+			 * @param pool thread pool executing the frames, that must
+			 * outlive this PoolScheduler
+			 * @param policy policy applied when frames overrun
+			 */
+			PoolScheduler(ThreadPool& pool, CATCH_UP_POLICY policy = SKIP_FRAMES);
+
+			PoolScheduler(const PoolScheduler&) = delete;
+			PoolScheduler& operator=(const PoolScheduler&) = delete;
+
+			/**
+			 * Adds a Runtime driven by this PoolScheduler. Its first frame
+			 * is due immediately.
+			 *
+			 * Runtimes can be added while the scheduler is running.
+			 *
+			 * @param runtime runtime, that must outlive this
+			 * PoolScheduler
+			 * @param fps frame rate of the runtime, in frames per second
+			 * @param priority priority of the runtime: when more frames
+			 * are due than the count of workers, frames of runtimes with
+			 * a higher priority are dispatched first
+			 */
+			void add(Runtime& runtime, float fps, int priority = 0);
+
+			/**
+			 * Current catch-up policy.
+			 *
+			 * @return catch-up policy
+			 */
+			CATCH_UP_POLICY policy() const;
+
+			/**
+			 * Drives the time of the Runtimes from the clock, with
+			 * `steps_per_second` time steps per second elapsed since each
+			 * Runtime was added (see Scheduler::setTimeResolution()).
+			 *
+			 * Must be called before run().
+			 *
+			 * @param steps_per_second time steps per second, or 0 to step
+			 * Runtimes by Runtime::timeStep() at each frame
+			 */
+			void setTimeResolution(unsigned long steps_per_second);
+
+			/**
+			 * Current time resolution.
+			 *
+			 * @return time steps per second, or 0 if the time of the
+			 * Runtimes is not driven by the clock
+			 */
+			unsigned long timeResolution() const;
+
+			/**
+			 * Sets the function used to read the current time, instead of
+			 * `clock::now()`, e.g. to drive the scheduler with a simulated
+			 * clock.
+			 *
+			 * run() still sleeps on the real clock until the next
+			 * deadline: a simulated clock should be driven with poll() and
+			 * wait() instead.
+			 *
+			 * Must be called before any Runtime is added.
+			 *
+			 * @param now function returning the current time
+			 */
+			void setClock(ClockFunction now);
+
+			/**
+			 * Dispatches the frames which deadline is passed, in priority
+			 * order, within the limit of ThreadPool::threadCount() frames
+			 * in progress, and returns immediately.
+			 *
+			 * This is one iteration of the run() loop.
+			 *
+			 * @return next deadline of the Runtimes which frame is not in
+			 * progress, or `clock::time_point::max()` if there is none
+			 */
+			clock::time_point poll();
+
+			/**
+			 * Waits until no frame is in progress.
+			 */
+			void wait();
+
+			/**
+			 * Dispatches frames until stop() is called, and waits for the
+			 * frames in progress.
+			 *
+			 * Returns immediately if stop() was called before.
+			 */
+			void run();
+
+			/**
+			 * Dispatches frames during `duration`, or until stop() is
+			 * called, and waits for the frames in progress.
+			 *
+			 * Returns immediately if stop() was called before.
+			 *
+			 * @param duration run duration
+			 */
+			void run(clock::duration duration);
+
+			/**
+			 * Stops the current run() loop. Can be called from any
+			 * thread.
+			 *
+			 * As with Scheduler::stop(), a stop requested while no run()
+			 * loop is active makes the next run() loop return
+			 * immediately.
+			 */
+			void stop();
+
+			/**
+			 * Count of frames rendered for `runtime`.
+			 *
+			 * @param runtime runtime added to this scheduler
+			 * @return count of frames
+			 */
+			unsigned long frames(const Runtime& runtime) const;
+
+			/**
+			 * Count of frames of `runtime` skipped with the SKIP_FRAMES
+			 * policy.
+			 *
+			 * @param runtime runtime added to this scheduler
+			 * @return count of skipped frames
+			 */
+			unsigned long skippedFrames(const Runtime& runtime) const;
+	};
+}
+#endif
+#endif
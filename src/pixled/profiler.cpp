@@ -0,0 +1,146 @@
+#include "profiler.h"
+
+#ifdef PIXLED_PROFILING
+
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace pixled {
+	thread_local Profiler* Profiler::active_profiler = nullptr;
+
+	/**
+	 * Human readable name of `type`, without the `pixled::` namespace.
+	 */
+	static std::string type_name(const std::type_info& type) {
+		std::string name = type.name();
+#ifdef __GNUG__
+		int status;
+		char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+		if(status == 0)
+			name = demangled;
+		std::free(demangled);
+#endif
+		const std::string prefix = "pixled::";
+		std::size_t i;
+		while((i = name.find(prefix)) != std::string::npos)
+			name.erase(i, prefix.size());
+		return name;
+	}
+
+	Profiler::Frame::Frame(Profiler* profiler) : profiler(profiler) {
+		if(profiler)
+			profiler->activate();
+	}
+
+	Profiler::Frame::~Frame() {
+		if(profiler) {
+			profiler->_frames++;
+			profiler->deactivate();
+		}
+	}
+
+	Profiler::Profiler() {
+		reset();
+	}
+
+	Profiler* Profiler::active() {
+		return active_profiler;
+	}
+
+	void Profiler::activate() {
+		active_profiler = this;
+	}
+
+	void Profiler::deactivate() {
+		if(active_profiler == this)
+			active_profiler = nullptr;
+	}
+
+	void Profiler::enter(const void* function, const std::type_info& type) {
+		std::size_t parent = stack.back();
+		for(std::size_t child : _nodes[parent].children) {
+			if(_nodes[child].function == function) {
+				stack.push_back(child);
+				return;
+			}
+		}
+		std::size_t child = _nodes.size();
+		_nodes.push_back({function, &type, parent, {}, 0, clock::duration::zero()});
+		_nodes[parent].children.push_back(child);
+		stack.push_back(child);
+	}
+
+	void Profiler::exit(clock::duration duration) {
+		Node& node = _nodes[stack.back()];
+		node.calls++;
+		node.time += duration;
+		stack.pop_back();
+	}
+
+	unsigned long Profiler::frames() const {
+		return _frames;
+	}
+
+	const std::vector<Profiler::Node>& Profiler::nodes() const {
+		return _nodes;
+	}
+
+	Profiler::clock::duration Profiler::totalTime() const {
+		clock::duration total = clock::duration::zero();
+		for(std::size_t child : _nodes[0].children)
+			total += _nodes[child].time;
+		return total;
+	}
+
+	void Profiler::reset() {
+		_nodes.clear();
+		_nodes.push_back({nullptr, nullptr, 0, {}, 0, clock::duration::zero()});
+		stack.assign(1, 0);
+		_frames = 0;
+	}
+
+	void Profiler::report(std::ostream& o) const {
+		o << "frames: " << _frames << std::endl;
+		o << std::left << std::setw(48) << "function"
+			<< std::right << std::setw(12) << "calls"
+			<< std::setw(14) << "time (us)"
+			<< std::setw(9) << "total"
+			<< std::setw(9) << "self" << std::endl;
+		clock::duration total = totalTime();
+		for(std::size_t child : _nodes[0].children)
+			report(o, child, 0, total);
+	}
+
+	void Profiler::report(
+			std::ostream& o, std::size_t index, int depth, clock::duration total) const {
+		const Node& node = _nodes[index];
+		clock::duration self = node.time;
+		for(std::size_t child : node.children)
+			self -= _nodes[child].time;
+
+		// Values per frame
+		double frames = _frames > 0 ? _frames : 1;
+		double time = std::chrono::duration<double, std::micro>(node.time).count();
+		double percent = total.count() > 0 ? 100. * node.time.count() / total.count() : 0;
+		double self_percent = total.count() > 0 ? 100. * self.count() / total.count() : 0;
+
+		std::string name = std::string(2*depth, ' ') + type_name(*node.type);
+		std::ios::fmtflags flags = o.flags();
+		o << std::left << std::setw(48) << name
+			<< std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << node.calls / frames
+			<< std::setw(14) << time / frames
+			<< std::setw(8) << percent << "%"
+			<< std::setw(8) << self_percent << "%" << std::endl;
+		o.flags(flags);
+
+		for(std::size_t child : node.children)
+			report(o, child, depth+1, total);
+	}
+}
+#endif
@@ -0,0 +1,245 @@
+#ifndef PIXLED_PROFILER_H
+#define PIXLED_PROFILER_H
+
+#include "config.h"
+
+#ifdef PIXLED_PROFILING
+
+#ifdef PIXLED_NO_HEAP
+#error "PIXLED_PROFILING is not available in heap-free mode"
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <typeinfo>
+#include <vector>
+
+namespace pixled {
+	/**
+	 * Records call counts and evaluation times of base::Function nodes.
+	 *
+	 * Only available when the library is built with PIXLED_PROFILING.
+	 *
+	 * While a Profiler is active, each base::Function call performed through
+	 * a FctWrapper, and each root Animation call performed by a Runtime, is
+	 * recorded in a call tree: a node of the tree corresponds to a Function
+	 * instance called from a given path, so that the cost of each subtree of
+	 * an animation can be identified. Inline Constants are not recorded.
+	 *
+	 * A Profiler is usually attached to a Runtime (see
+	 * Runtime::setProfiler()), that activates it during each frame. Results
+	 * are then aggregated per frame:
+	 *
+	 * ```cpp
+	 * pixled::Profiler profiler;
+	 * runtime.setProfiler(&profiler);
+	 * for(int i = 0; i < 100; i++)
+	 * 	runtime.next();
+	 * profiler.report(std::cout);
+	 * ```
+	 *
+	 * A Profiler is only active on the thread that activated it, and only
+	 * one Profiler can be active per thread: Functions evaluated by other
+	 * threads, e.g. by ThreadPool workers, are not recorded. A Runtime with
+	 * a Profiler so renders its frames on the calling thread, even if it
+	 * has a ThreadPool. A Profiler itself is not synchronized, and must not
+	 * be attached to Runtimes rendered concurrently, e.g. by a
+	 * PoolScheduler.
+	 */
+	class Profiler {
+		public:
+			/**
+			 * Clock used to measure evaluation times.
+			 */
+			typedef std::chrono::steady_clock clock;
+
+			/**
+			 * A node of the call tree.
+			 */
+			struct Node {
+				/**
+				 * Address of the called Function.
+				 */
+				const void* function;
+				/**
+				 * Dynamic type of the called Function, or `nullptr` for
+				 * the root node.
+				 */
+				const std::type_info* type;
+				/**
+				 * Index of the parent node.
+				 */
+				std::size_t parent;
+				/**
+				 * Indexes of the Functions called by this node.
+				 */
+				std::vector<std::size_t> children;
+				/**
+				 * Count of calls.
+				 */
+				unsigned long calls;
+				/**
+				 * Cumulative evaluation time, including the time spent in
+				 * children.
+				 */
+				clock::duration time;
+			};
+
+			/**
+			 * Records a Function call for the lifetime of this object,
+			 * if a Profiler is active.
+			 *
+			 * Instances are built by the PIXLED_PROFILE_CALL() macro.
+			 */
+			class Call {
+				private:
+					Profiler* profiler;
+					clock::time_point start;
+
+				public:
+					/**
+					 * Starts recording a call to `function`.
+					 *
+					 * @param function called Function
+					 * @param type dynamic type of the called Function
+					 */
+					Call(const void* function, const std::type_info& type)
+						: profiler(Profiler::active()) {
+						if(profiler) {
+							profiler->enter(function, type);
+							start = clock::now();
+						}
+					}
+					Call(const Call&) = delete;
+					Call& operator=(const Call&) = delete;
+
+					/**
+					 * Stops recording the call.
+					 */
+					~Call() {
+						if(profiler)
+							profiler->exit(clock::now() - start);
+					}
+			};
+
+			/**
+			 * Activates a Profiler and counts a frame for the lifetime of
+			 * this object.
+			 */
+			class Frame {
+				private:
+					Profiler* profiler;
+
+				public:
+					/**
+					 * Starts a frame.
+					 *
+					 * @param profiler profiler to activate, or `nullptr`
+					 * to do nothing
+					 */
+					Frame(Profiler* profiler);
+					Frame(const Frame&) = delete;
+					Frame& operator=(const Frame&) = delete;
+
+					/**
+					 * Ends the frame.
+					 */
+					~Frame();
+			};
+
+		private:
+			static thread_local Profiler* active_profiler;
+
+			std::vector<Node> _nodes;
+			// Path of the Function currently evaluated
+			std::vector<std::size_t> stack;
+			unsigned long _frames;
+
+			void enter(const void* function, const std::type_info& type);
+			void exit(clock::duration duration);
+			void report(std::ostream& o, std::size_t node, int depth, clock::duration total) const;
+
+		public:
+			/**
+			 * Builds an empty Profiler.
+			 */
+			Profiler();
+
+			/**
+			 * Profiler currently active on the calling thread.
+			 *
+			 * @return active profiler, or `nullptr`
+			 */
+			static Profiler* active();
+
+			/**
+			 * Activates this Profiler on the calling thread: all the
+			 * Function calls of this thread are recorded until
+			 * deactivate() is called.
+			 */
+			void activate();
+
+			/**
+			 * Deactivates this Profiler, if it is active.
+			 */
+			void deactivate();
+
+			/**
+			 * Count of profiled frames, i.e. frames rendered by a Runtime
+			 * while this Profiler was attached to it.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			/**
+			 * Nodes of the call tree. The first node is a virtual root,
+			 * which children are the Functions called while no other
+			 * Function was evaluated.
+			 *
+			 * @return call tree nodes
+			 */
+			const std::vector<Node>& nodes() const;
+
+			/**
+			 * Total time spent in the root Functions.
+			 *
+			 * @return cumulative evaluation time
+			 */
+			clock::duration totalTime() const;
+
+			/**
+			 * Clears all recorded calls and frames.
+			 */
+			void reset();
+
+			/**
+			 * Writes the call tree to `o`, one node per line, indented
+			 * according to the depth of the node. For each node, the
+			 * number of calls and the evaluation time per frame (or in
+			 * total if no frame was counted), and the percentages of the
+			 * total time spent in the node and in the node itself
+			 * (excluding children) are reported.
+			 *
+			 * @param o output stream
+			 */
+			void report(std::ostream& o) const;
+	};
+}
+
+/**
+ * Records the evaluation of the Function `f` in the active Profiler, until
+ * the end of the current scope.
+ *
+ * Expands to nothing unless PIXLED_PROFILING is defined.
+ */
+#define PIXLED_PROFILE_CALL(f) \
+	::pixled::Profiler::Call pixled_profiler_call(&(f), typeid(f))
+
+#else
+
+#define PIXLED_PROFILE_CALL(f)
+
+#endif
+#endif
@@ -1,39 +1,57 @@
 #include "random.h"
 
+#include <cstdint>
+
 namespace pixled { namespace random {
+	/**
+	 * 64 bits finalizer of the SplitMix64 generator, used to hash engine
+	 * coordinates.
+	 */
+	static std::uint64_t mix(std::uint64_t x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return x;
+	}
+
+	/**
+	 * Random engine seeded from the hash of `seed`, `stream` and the period
+	 * index `index`.
+	 */
+	static random_engine engine(unsigned long seed, std::uint64_t stream, time index) {
+		std::uint64_t hash = mix(mix(mix(seed) ^ stream) ^ index);
+		// A null seed modulo 2^31-1 is replaced by 1 by the engine
+		return random_engine((random_engine::result_type) (hash % random_engine::modulus));
+	}
 
-	std::minstd_rand RandomT::operator()(led l, time t) const {
-		time _current_period = t / period;
-		if(_current_period != current_period) {
-			current_period = _current_period;
-			rd.discard(1);
-		}
-		return rd;
+	random_engine RandomT::operator()(led l, time t) const {
+		return engine(seed, 0, t / period);
 	}
 
-	std::minstd_rand RandomXYT::operator()(led l, time t) const {
-		std::minstd_rand* rd;
+	bool RandomT::mayChange(led l, time t) const {
+		return t / period != (t+1) / period;
+	}
 
-		auto result = rds.find(l.index);
-		if(result == rds.end()) {
-			unsigned long _s = rd_seed(rd_seeder);
-			// Inserts only if no entry exists yet for p
-			auto inserted_item = rds.insert({l.index, std::minstd_rand(_s)});
-			rd = &inserted_item.first->second;
-		} else {
-			rd = &result->second;
-		}
+	bool RandomT::serialize(serialization::Writer& writer) const {
+		return writer.node(
+				NODE, serialization::RANDOM_ENGINE_VALUE, nullptr, 0, 16)
+			&& writer.value(period) && writer.value(seed);
+	}
 
-		time _current_period = t / period;
-		if(_current_period != current_period) {
-			current_period = _current_period;
-			for(auto& _rd : rds) {
-				// Advances
-				_rd.second.discard(1);
-			}
-		}
-		return *rd;
+	random_engine RandomXYT::operator()(led l, time t) const {
+		// Stream 0 is used by RandomT
+		return engine(seed, (std::uint64_t) l.index + 1, t / period);
 	}
 
+	bool RandomXYT::mayChange(led l, time t) const {
+		return t / period != (t+1) / period;
+	}
 
+	bool RandomXYT::serialize(serialization::Writer& writer) const {
+		return writer.node(
+				NODE, serialization::RANDOM_ENGINE_VALUE, nullptr, 0, 16)
+			&& writer.value(period) && writer.value(seed);
+	}
 }}
@@ -2,7 +2,6 @@
 #define PIXLED_FUNCTIONNAL_RANDOM_H
 
 #include <random>
-#include <unordered_map>
 
 #include "../function.h"
 
@@ -71,12 +70,15 @@ namespace pixled { namespace random {
 	 *
 	 * The sequence of generated values varies in time, but is the same for any
 	 * point.
+	 *
+	 * The engine returned at time `t` is seeded from a hash of the seed and of
+	 * the period index `t / period`, so that it only depends on `t`: frames
+	 * can be rendered in any order.
 	 */
 	class RandomT : public base::Function<random_engine>, RandomEngineConfig {
-		private:
-			mutable time current_period = 0;
-			mutable random_engine rd {this->seed};
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::RANDOM_T_NODE;
+
 			using RandomEngineConfig::RandomEngineConfig;
 
 			random_engine operator()(led l, time t) const override;
@@ -84,6 +86,16 @@ namespace pixled { namespace random {
 			RandomT* copy() const override {
 				return new RandomT(period, seed);
 			}
+
+			/**
+			 * Writes the period and the seed of the engine.
+			 */
+			bool serialize(serialization::Writer& writer) const override;
+
+			/**
+			 * The engine only changes when a new period starts.
+			 */
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -91,14 +103,15 @@ namespace pixled { namespace random {
 	 *
 	 * The sequence of values not only varies in time, but is also unique on
 	 * each point of the 2D environment.
+	 *
+	 * The engine returned on the led `l` at time `t` is seeded from a hash of
+	 * the seed, of the led index and of the period index `t / period`, so
+	 * that it only depends on `l` and `t`.
 	 */
 	class RandomXYT : public base::Function<random_engine>, RandomEngineConfig {
-		private:
-			mutable time current_period = 0;
-			mutable random_engine rd_seeder {this->seed};
-			mutable std::uniform_int_distribution<unsigned long> rd_seed;
-			mutable std::unordered_map<index_t, random_engine> rds;
 		public:
+			static constexpr serialization::NODE_TYPE NODE = serialization::RANDOM_XYT_NODE;
+
 			using RandomEngineConfig::RandomEngineConfig;
 
 			/*
@@ -109,6 +122,16 @@ namespace pixled { namespace random {
 			RandomXYT* copy() const override {
 				return new RandomXYT(period, seed);
 			}
+
+			/**
+			 * Writes the period and the seed of the engine.
+			 */
+			bool serialize(serialization::Writer& writer) const override;
+
+			/**
+			 * The engine only changes when a new period starts.
+			 */
+			bool mayChange(led l, time t) const override;
 	};
 
 	/**
@@ -126,6 +149,7 @@ namespace pixled { namespace random {
 			public Function<UniformDistribution<R>, R, R, R, random_engine> {
 				public:
 					using Function<UniformDistribution<R>, R, R, R, random_engine>::Function;
+					static constexpr serialization::NODE_TYPE NODE = serialization::UNIFORM_DISTRIBUTION_NODE;
 
 					/*
 					 * f1 = min
@@ -153,6 +177,7 @@ namespace pixled { namespace random {
 	class NormalDistribution : public Function<NormalDistribution<R>, R, float, float, random_engine> {
 		public:
 			using Function<NormalDistribution<R>, R, float, float, std::minstd_rand>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::NORMAL_DISTRIBUTION_NODE;
 
 			/*
 			 * f1 = min
@@ -1,18 +1,303 @@
 #include "runtime.h"
 
+#include <algorithm>
+
 namespace pixled {
+	/**
+	 * Converts `duration` to microseconds.
+	 */
+	static std::uint32_t microseconds(FrameStats::clock::duration duration) {
+		return (std::uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(
+				duration).count();
+	}
+
 	void Runtime::frame(time t) {
-		for(auto led : mapping.leds()) {
-			output.write(animation(led, t), led.index);
+#ifdef PIXLED_PROFILING
+		Profiler::Frame profiled_frame(_profiler);
+#endif
+		if(!frame_stats) {
+			drawFrame(t);
+			output.endFrame();
+			return;
+		}
+		FrameStats::clock::time_point start = FrameStats::clock::now();
+		drawFrame(t);
+		output.endFrame();
+		FrameStats::clock::time_point end = FrameStats::clock::now();
+		frame_stats->record(
+				microseconds(rendered_at - start), microseconds(end - rendered_at),
+				mapping.size());
+	}
+	void Runtime::drawFrame(time t) {
+#ifndef PIXLED_NO_HEAP
+		if(frame_cache) {
+			if(!frame_cache->contains(t)) {
+				render(t, frame_buffer.data());
+				frame_cache->store(t, frame_buffer.data());
+			}
+			writeFrame(frame_cache->load(t), frame_cache->ledCount());
+			return;
+		}
+		if(dirty_tracking) {
+			trackedFrame(t);
+			return;
+		}
+		if(output_stage && dithering()) {
+			render(t, stage_buffer16.data());
+			output_stage->apply(stage_buffer16.data(), stage_buffer.data(), stage_buffer.size() / 3);
+			rendered();
+			output.writeFrame(stage_buffer.data(), stage_buffer.size() / 3);
+			return;
 		}
+		if(output_stage || thread_pool) {
+			// Leds that are not in the mapping are left black
+			render(t, stage_buffer.data());
+			if(output_stage)
+				output_stage->apply(stage_buffer.data(), stage_buffer.size() / 3);
+			rendered();
+			output.writeFrame(stage_buffer.data(), stage_buffer.size() / 3);
+			return;
+		}
+#endif
+		mapping.forEach([this, t] (const led& led) {
+				output.write(evaluate(led, t), led.index);
+				});
+		// Writes are interleaved with rendering
+		rendered();
 	}
 	void Runtime::prev() {
-		frame(_time--);
+		frame(_time);
+		_time -= _time_step;
 	}
 	void Runtime::next() {
-		frame(_time++);
+		frame(_time);
+		_time += _time_step;
 	}
 	time Runtime::current_time() const {
 		return _time;
 	}
+	void Runtime::seek(time t) {
+		_time = t;
+	}
+	void Runtime::setTimeStep(time step) {
+		_time_step = step;
+	}
+	time Runtime::timeStep() const {
+		return _time_step;
+	}
+
+	void Runtime::setFrameStats(FrameStats* stats) {
+		frame_stats = stats;
+	}
+	FrameStats* Runtime::frameStats() const {
+		return frame_stats;
+	}
+
+#ifdef PIXLED_PROFILING
+	void Runtime::setProfiler(Profiler* profiler) {
+		_profiler = profiler;
+	}
+	Profiler* Runtime::profiler() const {
+		return _profiler;
+	}
+#endif
+
+#ifndef PIXLED_NO_HEAP
+	template<typename F>
+		void Runtime::renderEach(F&& f) {
+			bool serial = !thread_pool || !animation.stateless();
+#ifdef PIXLED_PROFILING
+			// The Profiler only records the calls of the calling thread
+			serial = serial || _profiler;
+#endif
+			if(serial) {
+				mapping.forEach(f);
+				return;
+			}
+			std::size_t led_count = mapping.size();
+			std::size_t task_count = (led_count + leds_per_task - 1) / leds_per_task;
+			thread_pool->parallelFor(task_count, [this, &f, led_count] (std::size_t task) {
+					std::size_t end = std::min(led_count, (task + 1) * leds_per_task);
+					for(std::size_t n = task * leds_per_task; n < end; n++)
+						f(mapping.at(n));
+					});
+		}
+	void Runtime::render(time t, std::uint8_t* buffer) {
+		renderEach([this, t, buffer] (const led& led) {
+				color c = evaluate(led, t);
+				std::uint8_t* rgb = &buffer[3*led.index];
+				rgb[0] = c.red();
+				rgb[1] = c.green();
+				rgb[2] = c.blue();
+				});
+	}
+	void Runtime::render(time t, std::uint16_t* buffer) {
+		renderEach([this, t, buffer] (const led& led) {
+				color c = evaluate(led, t);
+				std::uint16_t* rgb = &buffer[3*led.index];
+				rgb[0] = c.red16();
+				rgb[1] = c.green16();
+				rgb[2] = c.blue16();
+				});
+	}
+	bool Runtime::dithering() {
+		if(output_stage->dithering() == OutputStage::NO_DITHERING)
+			return false;
+		if(stage_buffer16.size() != stage_buffer.size())
+			// Leds that are not in the mapping are left black
+			stage_buffer16.assign(stage_buffer.size(), 0);
+		return true;
+	}
+	void Runtime::writeFrame(const std::uint8_t* frame, std::size_t led_count) {
+		if(!output_stage) {
+			rendered();
+			output.writeFrame(frame, led_count);
+			return;
+		}
+		if(dithering()) {
+			// Expands 8 bits values to 16 bits
+			for(std::size_t i = 0; i < 3*led_count; i++)
+				stage_buffer16[i] = frame[i] * 257;
+			output_stage->apply(stage_buffer16.data(), stage_buffer.data(), led_count);
+			rendered();
+			output.writeFrame(stage_buffer.data(), led_count);
+			return;
+		}
+		std::copy(frame, frame + 3*led_count, stage_buffer.begin());
+		output_stage->apply(stage_buffer.data(), led_count);
+		rendered();
+		output.writeFrame(stage_buffer.data(), led_count);
+	}
+	void Runtime::trackedFrame(time t) {
+		// Consecutive frames in any direction
+		bool incremental = has_frame && (t == last_frame + 1 || t + 1 == last_frame);
+		time from = t < last_frame ? t : last_frame;
+		std::uint8_t* buffer = frame_buffer.data();
+		_evaluated_leds = 0;
+		mapping.forEach([this, t, incremental, from, buffer] (const led& led) {
+				if(incremental && !animation.mayChange(led, from))
+					return;
+				_evaluated_leds++;
+				color c = evaluate(led, t);
+				std::uint8_t* rgb = &buffer[3*led.index];
+				if(!incremental || rgb[0] != c.red() || rgb[1] != c.green() || rgb[2] != c.blue()) {
+					rgb[0] = c.red();
+					rgb[1] = c.green();
+					rgb[2] = c.blue();
+					dirty[led.index] = true;
+				}
+				});
+		has_frame = true;
+		last_frame = t;
+
+		if(output_stage || !output.partialUpdates()) {
+			writeFrame(buffer, dirty.size());
+			dirty.assign(dirty.size(), false);
+			return;
+		}
+		rendered();
+		std::size_t i = 0;
+		while(i < dirty.size()) {
+			if(!dirty[i]) {
+				i++;
+				continue;
+			}
+			std::size_t begin = i;
+			while(i < dirty.size() && dirty[i])
+				dirty[i++] = false;
+			output.writeSpan(&buffer[3*begin], begin, i - begin);
+		}
+	}
+
+	std::size_t Runtime::frameLedCount() const {
+		std::size_t led_count = 0;
+		mapping.forEach([&led_count] (const led& led) {
+				if(led.index >= led_count)
+					led_count = led.index + 1;
+				});
+		return led_count;
+	}
+
+	bool Runtime::enableFrameCache(FRAME_ENCODING encoding) {
+		return enableFrameCache(animation.periodicity(), encoding);
+	}
+
+	bool Runtime::enableFrameCache(time period, FRAME_ENCODING encoding) {
+		if(period == 0)
+			return false;
+		std::size_t led_count = frameLedCount();
+		switch(encoding) {
+			case RAW_FRAMES:
+				frame_cache.reset(new RawFrameCache(period, led_count));
+				break;
+			case DELTA_FRAMES:
+				frame_cache.reset(new DeltaFrameCache(period, led_count));
+				break;
+		}
+		// Leds that are not in the mapping are left black
+		frame_buffer.assign(frame_cache->frameSize(), 0);
+		// The frame buffer is shared with dirty tracking
+		has_frame = false;
+		return true;
+	}
+
+	void Runtime::disableFrameCache() {
+		frame_cache.reset();
+		has_frame = false;
+		if(!dirty_tracking)
+			std::vector<std::uint8_t>().swap(frame_buffer);
+	}
+
+	const FrameCache* Runtime::frameCache() const {
+		return frame_cache.get();
+	}
+
+	void Runtime::enableDirtyTracking() {
+		std::size_t led_count = frameLedCount();
+		dirty_tracking = true;
+		has_frame = false;
+		dirty.assign(led_count, false);
+		frame_buffer.assign(3*led_count, 0);
+	}
+
+	void Runtime::disableDirtyTracking() {
+		dirty_tracking = false;
+		std::vector<bool>().swap(dirty);
+		if(!frame_cache)
+			std::vector<std::uint8_t>().swap(frame_buffer);
+	}
+
+	std::size_t Runtime::evaluatedLeds() const {
+		return _evaluated_leds;
+	}
+
+	void Runtime::updateStageBuffer() {
+		if(output_stage || thread_pool)
+			stage_buffer.assign(3*frameLedCount(), 0);
+		else
+			std::vector<std::uint8_t>().swap(stage_buffer);
+		std::vector<std::uint16_t>().swap(stage_buffer16);
+	}
+
+	void Runtime::setOutputStage(OutputStage* stage) {
+		output_stage = stage;
+		// The output must be completely rewritten
+		has_frame = false;
+		updateStageBuffer();
+	}
+
+	OutputStage* Runtime::outputStage() const {
+		return output_stage;
+	}
+
+	void Runtime::setThreadPool(ThreadPool* pool, std::size_t leds_per_task) {
+		thread_pool = pool;
+		this->leds_per_task = leds_per_task > 0 ? leds_per_task : 1;
+		updateStageBuffer();
+	}
+
+	ThreadPool* Runtime::threadPool() const {
+		return thread_pool;
+	}
+#endif
 }
@@ -1,8 +1,14 @@
 #ifndef PIXLED_RUNTIME_H
 #define PIXLED_RUNTIME_H
 
+#include <memory>
 #include "output.h"
 #include "function.h"
+#include "frame_cache.h"
+#include "output_stage.h"
+#include "frame_stats.h"
+#include "profiler.h"
+#include "thread_pool.h"
 #include "mapping/mapping.h"
 
 namespace pixled {
@@ -21,17 +27,80 @@ namespace pixled {
 	 * Since the Output interface is generic, the Runtime can be used on any
 	 * device.
 	 *
+	 * Leds are iterated using Mapping::forEach(): implicit mappings (see
+	 * Mapping::implicitGrid()) are iterated directly from their grid layout,
+	 * so that their leds are never stored.
+	 *
+	 * Unless the library is built in heap-free mode (see PIXLED_NO_HEAP),
+	 * frames of periodic animations can be cached with enableFrameCache(): the
+	 * animation is then only evaluated during its first period, and
+	 * following frames are replayed with Output::writeFrame().
+	 *
+	 * When most leds are static, enableDirtyTracking() can be used to only
+	 * evaluate the leds that may change from the previous frame (see
+	 * base::Function::mayChange()), and only write changed leds to Outputs
+	 * that support partial updates.
+	 *
+	 * Gamma correction, dimming, current limiting and dithering can be applied
+	 * to each frame before it is written, using setOutputStage().
+	 *
 	 * However, there is no notion of `fps` in this class, since this concept
 	 * is highly dependent on the device (and so on the Output) on which
-	 * pixled is used.
+	 * pixled is used. The time spent in each frame can however be measured
+	 * with setFrameStats(), to check it against the frame budget of the
+	 * device.
 	 */
 	class Runtime {
 		private:
 			unsigned long _time = 0;
+			time _time_step = 1;
 			Mapping& mapping;
 			Output& output;
 			Animation& animation;
 
+#ifndef PIXLED_NO_HEAP
+			std::unique_ptr<FrameCache> frame_cache;
+			std::vector<std::uint8_t> frame_buffer;
+
+			bool dirty_tracking = false;
+			bool has_frame = false;
+			time last_frame = 0;
+			std::vector<bool> dirty;
+			std::size_t _evaluated_leds = 0;
+
+			OutputStage* output_stage = nullptr;
+			std::vector<std::uint8_t> stage_buffer;
+			// 16 bits frame, only allocated when the stage dithers
+			std::vector<std::uint16_t> stage_buffer16;
+
+			ThreadPool* thread_pool = nullptr;
+			std::size_t leds_per_task = 0;
+#endif
+			FrameStats* frame_stats = nullptr;
+			// End of the rendering of the current frame
+			FrameStats::clock::time_point rendered_at;
+
+#ifdef PIXLED_PROFILING
+			Profiler* _profiler = nullptr;
+#endif
+
+			/**
+			 * Marks the end of the rendering of the current frame, before
+			 * it is written to `output`.
+			 */
+			void rendered() {
+				if(frame_stats)
+					rendered_at = FrameStats::clock::now();
+			}
+
+			/**
+			 * Evaluates `animation` on led `l` at time `t`.
+			 */
+			color evaluate(const led& l, time t) {
+				PIXLED_PROFILE_CALL(animation);
+				return animation(l, t);
+			}
+
 			/**
 			 * Builds the frame correspondind to `animation` at time `t` and
 			 * write each color to each led defined by `mapping` using
@@ -39,6 +108,62 @@ namespace pixled {
 			 */
 			void frame(time t);
 
+			/**
+			 * Implements frame(), without recording frame statistics.
+			 */
+			void drawFrame(time t);
+
+#ifndef PIXLED_NO_HEAP
+			/**
+			 * Calls `f` on each led of the mapping, in parallel on the
+			 * thread pool if any.
+			 */
+			template<typename F>
+				void renderEach(F&& f);
+
+			/**
+			 * Renders the frame corresponding to `animation` at time `t` in
+			 * `buffer`.
+			 */
+			void render(time t, std::uint8_t* buffer);
+
+			/**
+			 * Renders the frame corresponding to `animation` at time `t` in
+			 * the 16 bits `buffer`.
+			 */
+			void render(time t, std::uint16_t* buffer);
+
+			/**
+			 * True if the output stage renders 16 bits frames, in which
+			 * case stage_buffer16 is allocated.
+			 */
+			bool dithering();
+
+			/**
+			 * Allocates stage_buffer if frames are rendered at once, i.e.
+			 * with an output stage or a thread pool, or frees it.
+			 */
+			void updateStageBuffer();
+
+			/**
+			 * Writes a complete `frame` to `output`, through the output
+			 * stage if any.
+			 */
+			void writeFrame(const std::uint8_t* frame, std::size_t led_count);
+
+			/**
+			 * Only evaluates leds that may have changed since the last
+			 * frame, and writes changed leds to `output`.
+			 */
+			void trackedFrame(time t);
+
+			/**
+			 * Size of frames, in leds, according to the highest led index
+			 * of the mapping.
+			 */
+			std::size_t frameLedCount() const;
+#endif
+
 
 		public:
 			/**
@@ -71,6 +196,217 @@ namespace pixled {
 			 * @return current time
 			 */
 			time current_time() const;
+
+			/**
+			 * Sets the current time step of the Runtime, so that the next
+			 * call to next() builds the frame at time `t`.
+			 *
+			 * @param t new current time
+			 */
+			void seek(time t);
+
+			/**
+			 * Sets the count of time steps the Runtime moves forward (or
+			 * backward) at each call to next() (or prev()). The default
+			 * is 1.
+			 *
+			 * Using more than one time step per frame provides a finer
+			 * time resolution to animations: for example, with periods
+			 * expressed in milliseconds, a Runtime rendered at 50 fps
+			 * should use a time step of 20. The time resolution can also
+			 * be driven by a clock with Scheduler::setTimeResolution(), so
+			 * that the animation speed does not depend on the frame rate.
+			 *
+			 * @param step count of time steps per frame
+			 */
+			void setTimeStep(time step);
+
+			/**
+			 * Count of time steps per frame.
+			 *
+			 * @return time step
+			 */
+			time timeStep() const;
+
+#ifndef PIXLED_NO_HEAP
+			/**
+			 * Enables the frame cache, using the periodicity of the
+			 * animation (see base::Function::periodicity()).
+			 *
+			 * Nothing is done if the period of the animation is unknown.
+			 *
+			 * @param encoding frame storage format
+			 * @return true iff the frame cache has been enabled
+			 */
+			bool enableFrameCache(FRAME_ENCODING encoding = RAW_FRAMES);
+
+			/**
+			 * Enables the frame cache, assuming that the animation is
+			 * periodic with the specified `period`.
+			 *
+			 * Memory for `period` frames is allocated, and each frame is
+			 * stored the first time it is rendered. Frames are then replayed
+			 * from the cache, without evaluating the animation.
+			 *
+			 * The mapping must not be modified while the cache is enabled.
+			 *
+			 * With DELTA_FRAMES, frames are compressed in a DeltaFrameCache,
+			 * what trades some decoding time for a much lower memory usage
+			 * on animations with static or uniform regions.
+			 *
+			 * Nothing is done if `period` is 0.
+			 *
+			 * @param period animation period, in time steps
+			 * @param encoding frame storage format
+			 * @return true iff the frame cache has been enabled
+			 */
+			bool enableFrameCache(time period, FRAME_ENCODING encoding = RAW_FRAMES);
+
+			/**
+			 * Disables the frame cache, and frees its memory.
+			 */
+			void disableFrameCache();
+
+			/**
+			 * Current frame cache.
+			 *
+			 * @return frame cache, or `nullptr` if the frame cache is
+			 * disabled
+			 */
+			const FrameCache* frameCache() const;
+
+			/**
+			 * Enables dirty tracking.
+			 *
+			 * The colors of the last frame are kept in memory, and when
+			 * consecutive frames are rendered, only leds that may change
+			 * between the two frames are evaluated (see
+			 * base::Function::mayChange()). Only the leds whose color
+			 * actually changed are then written to Outputs that support
+			 * partial updates (see Output::partialUpdates()), while other
+			 * Outputs receive complete frames.
+			 *
+			 * The mapping must not be modified while dirty tracking is
+			 * enabled. The frame cache, if enabled, takes precedence.
+			 */
+			void enableDirtyTracking();
+
+			/**
+			 * Disables dirty tracking, and frees its memory.
+			 */
+			void disableDirtyTracking();
+
+			/**
+			 * Count of leds evaluated during the last frame rendered with
+			 * dirty tracking enabled.
+			 *
+			 * @return count of evaluated leds
+			 */
+			std::size_t evaluatedLeds() const;
+
+			/**
+			 * Sets the OutputStage applied to each frame before it is
+			 * written to the output.
+			 *
+			 * Since the stage processes complete frames, frames are then
+			 * always written with Output::writeFrame(), even when dirty
+			 * tracking is enabled. The frame cache stores frames before
+			 * they are processed, so that stage settings can be changed
+			 * at any time.
+			 *
+			 * When the stage dithers (see OutputStage::setDithering()),
+			 * frames are rendered with 16 bits per channel. Cached and
+			 * tracked frames are however stored on 8 bits, so that only
+			 * the temporal dithering of the output stage applies to them.
+			 *
+			 * The mapping must not be modified while an output stage is
+			 * set.
+			 *
+			 * @param stage output stage, that must outlive this Runtime,
+			 * or `nullptr` to write frames unchanged
+			 */
+			void setOutputStage(OutputStage* stage);
+
+			/**
+			 * Current output stage.
+			 *
+			 * @return output stage, or `nullptr` if none is set
+			 */
+			OutputStage* outputStage() const;
+
+			/**
+			 * Splits the rendering of each frame in tasks executed in
+			 * parallel on `pool`.
+			 *
+			 * Frames are rendered in a buffer by tasks of `leds_per_task`
+			 * leds, and then written at once with Output::writeFrame().
+			 * Frames of animations that are not stateless (see
+			 * base::Function::stateless()), frames replayed from the frame
+			 * cache, frames rendered with dirty tracking and frames
+			 * recorded by a Profiler (see setProfiler()) are not split.
+			 *
+			 * The mapping must not be modified while a thread pool is
+			 * set.
+			 *
+			 * @param pool thread pool, that must outlive this Runtime, or
+			 * `nullptr` to render frames on the calling thread
+			 * @param leds_per_task count of leds evaluated by each task
+			 */
+			void setThreadPool(ThreadPool* pool, std::size_t leds_per_task = 1024);
+
+			/**
+			 * Current thread pool.
+			 *
+			 * @return thread pool, or `nullptr` if none is set
+			 */
+			ThreadPool* threadPool() const;
+#endif
+
+			/**
+			 * Sets the FrameStats in which the render and output times of
+			 * each frame are recorded.
+			 *
+			 * The output time is the time spent in Output::writeFrame()
+			 * or Output::writeSpan(). When leds are written one by one
+			 * with Output::write(), writes are interleaved with the
+			 * evaluation of the animation and are so included in the
+			 * render time.
+			 *
+			 * When no FrameStats is set, frames are not timed at all.
+			 *
+			 * @param stats frame statistics, that must outlive this
+			 * Runtime, or `nullptr` to disable frame timing
+			 */
+			void setFrameStats(FrameStats* stats);
+
+			/**
+			 * Current frame statistics.
+			 *
+			 * @return frame statistics, or `nullptr` if none is set
+			 */
+			FrameStats* frameStats() const;
+
+#ifdef PIXLED_PROFILING
+			/**
+			 * Sets the Profiler activated during each frame, that records
+			 * the evaluation of each node of the animation.
+			 *
+			 * Only available when the library is built with
+			 * PIXLED_PROFILING. Frames are then rendered on the calling
+			 * thread, even if a ThreadPool is set.
+			 *
+			 * @param profiler profiler, that must outlive this Runtime, or
+			 * `nullptr` to disable profiling
+			 */
+			void setProfiler(Profiler* profiler);
+
+			/**
+			 * Current profiler.
+			 *
+			 * @return profiler, or `nullptr` if none is set
+			 */
+			Profiler* profiler() const;
+#endif
 	};
 }
 #endif
@@ -0,0 +1,150 @@
+#include "scheduler.h"
+
+#include <thread>
+
+namespace pixled {
+	/**
+	 * Duration of a frame at `fps` frames per second.
+	 */
+	static Scheduler::clock::duration frame_period(float fps) {
+		return std::chrono::duration_cast<Scheduler::clock::duration>(
+				std::chrono::duration<double>(1. / fps));
+	}
+
+	Scheduler::Scheduler(float fps, CATCH_UP_POLICY policy)
+		: period(frame_period(fps)), _policy(policy),
+		spin_time(std::chrono::milliseconds(1)) {
+	}
+
+	void Scheduler::add(Runtime& runtime) {
+		runtimes.push_back(&runtime);
+	}
+
+	void Scheduler::setFps(float fps) {
+		if(started) {
+			// The next deadline is kept, following ones use the new
+			// period
+			start = deadline(frame_index);
+			frame_index = 0;
+		}
+		period = frame_period(fps);
+	}
+
+	float Scheduler::fps() const {
+		return 1. / std::chrono::duration<double>(period).count();
+	}
+
+	void Scheduler::setPolicy(CATCH_UP_POLICY policy) {
+		_policy = policy;
+	}
+
+	CATCH_UP_POLICY Scheduler::policy() const {
+		return _policy;
+	}
+
+	void Scheduler::setSpinTime(clock::duration spin_time) {
+		this->spin_time = spin_time;
+	}
+
+	void Scheduler::setTimeResolution(unsigned long steps_per_second) {
+		time_resolution = steps_per_second;
+	}
+
+	unsigned long Scheduler::timeResolution() const {
+		return time_resolution;
+	}
+
+	Scheduler::clock::time_point Scheduler::deadline(unsigned long frame) const {
+		return start + period * frame;
+	}
+
+	void Scheduler::waitUntil(clock::time_point deadline) const {
+		clock::time_point wake = deadline - spin_time;
+		if(clock::now() < wake)
+			std::this_thread::sleep_until(wake);
+		while(clock::now() < deadline) {
+		}
+	}
+
+	void Scheduler::step() {
+		if(!started) {
+			started = true;
+			start = clock::now();
+			time_origin = start;
+			time_origins.clear();
+			for(Runtime* runtime : runtimes)
+				time_origins.push_back(runtime->current_time());
+			frame_index = 0;
+		} else {
+			waitUntil(deadline(frame_index));
+		}
+		if(time_resolution > 0) {
+			time elapsed = (time) (
+					std::chrono::duration<double>(clock::now() - time_origin).count()
+					* time_resolution);
+			for(std::size_t i = 0; i < runtimes.size(); i++) {
+				// Runtimes added after the start of the schedule
+				if(i == time_origins.size())
+					time_origins.push_back(runtimes[i]->current_time() - elapsed);
+				runtimes[i]->seek(time_origins[i] + elapsed);
+			}
+		}
+		for(Runtime* runtime : runtimes)
+			runtime->next();
+		_frames++;
+		frame_index++;
+
+		clock::time_point now = clock::now();
+		if(now <= deadline(frame_index))
+			return;
+		switch(_policy) {
+			case SKIP_FRAMES:
+				{
+					// Last frame which deadline is passed
+					unsigned long late_frame = (now - start) / period;
+					unsigned long skipped = late_frame - frame_index;
+					if(time_resolution == 0)
+						for(Runtime* runtime : runtimes)
+							runtime->seek(runtime->current_time()
+									+ skipped * runtime->timeStep());
+					_skipped_frames += skipped;
+					frame_index = late_frame;
+				}
+				break;
+			case SLOW_DOWN:
+				start = now - period * frame_index;
+				break;
+		}
+	}
+
+	void Scheduler::run() {
+		// The stop request is consumed, so that the Scheduler can be run
+		// again
+		while(!stop_requested.exchange(false))
+			step();
+	}
+
+	void Scheduler::run(unsigned long frame_count) {
+		for(unsigned long i = 0; i < frame_count; i++) {
+			if(stop_requested.exchange(false))
+				return;
+			step();
+		}
+	}
+
+	void Scheduler::stop() {
+		stop_requested = true;
+	}
+
+	void Scheduler::restart() {
+		started = false;
+	}
+
+	unsigned long Scheduler::frames() const {
+		return _frames;
+	}
+
+	unsigned long Scheduler::skippedFrames() const {
+		return _skipped_frames;
+	}
+}
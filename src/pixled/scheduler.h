@@ -0,0 +1,230 @@
+#ifndef PIXLED_SCHEDULER_H
+#define PIXLED_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include "containers.h"
+#include "runtime.h"
+
+namespace pixled {
+	/**
+	 * Policies applied by a Scheduler when frames take longer than the
+	 * frame period.
+	 */
+	enum CATCH_UP_POLICY {
+		/**
+		 * Late frames are skipped: the time of the Runtimes jumps forward
+		 * so that the animation speed stays synchronized with the wall
+		 * clock.
+		 */
+		SKIP_FRAMES,
+		/**
+		 * All frames are rendered: the following frames are scheduled from
+		 * the end of the late frame, so that the animation slows down.
+		 */
+		SLOW_DOWN
+	};
+
+	/**
+	 * Drives one or more Runtimes at a fixed frame rate, using a monotonic
+	 * clock.
+	 *
+	 * Frame `n` is scheduled at `start + n / fps`, where `start` is the
+	 * time of the first frame, so that errors do not accumulate from a
+	 * frame to another. Between two frames, the Scheduler sleeps until the
+	 * spin time before the next deadline, and then busy waits until the
+	 * deadline, since sleeps are usually not precise enough for high frame
+	 * rates.
+	 *
+	 * When a frame overruns the next deadlines, the catch-up policy
+	 * determines how the following frames are scheduled (see
+	 * CATCH_UP_POLICY).
+	 *
+	 * By default, Runtimes move forward by Runtime::timeStep() at each
+	 * frame, so that the animation speed depends on the frame rate. With
+	 * setTimeResolution(), the time of the Runtimes is instead computed from
+	 * the clock, so that the animation speed is kept whatever the frame
+	 * rate actually sustained.
+	 *
+	 * ```cpp
+	 * pixled::Scheduler scheduler(60);
+	 * scheduler.add(runtime);
+	 * scheduler.run();
+	 * ```
+	 */
+	class Scheduler {
+		public:
+			/**
+			 * Clock used to schedule frames.
+			 */
+			typedef std::chrono::steady_clock clock;
+
+		private:
+			bounded_vector<Runtime*, PIXLED_SCHEDULER_CAPACITY> runtimes;
+			clock::duration period;
+			CATCH_UP_POLICY _policy;
+			clock::duration spin_time;
+			unsigned long time_resolution = 0;
+
+			bool started = false;
+			clock::time_point start;
+			// Start of the schedule, not moved by the SLOW_DOWN policy
+			clock::time_point time_origin;
+			// Time of each Runtime at the start of the schedule
+			bounded_vector<time, PIXLED_SCHEDULER_CAPACITY> time_origins;
+			unsigned long frame_index = 0;
+			unsigned long _frames = 0;
+			unsigned long _skipped_frames = 0;
+			std::atomic<bool> stop_requested {false};
+
+			clock::time_point deadline(unsigned long frame) const;
+			void waitUntil(clock::time_point deadline) const;
+
+		public:
+			/**
+			 * Scheduler constructor.
+			 *
+			 * @param fps target frame rate, in frames per second
+			 * @param policy policy applied when frames overrun
+			 */
+			Scheduler(float fps, CATCH_UP_POLICY policy = SKIP_FRAMES);
+
+			Scheduler(const Scheduler&) = delete;
+			Scheduler& operator=(const Scheduler&) = delete;
+
+			/**
+			 * Adds a Runtime driven by this Scheduler. All the Runtimes
+			 * are stepped at each frame, in the order they were added.
+			 *
+			 * @param runtime runtime, that must outlive this Scheduler
+			 */
+			void add(Runtime& runtime);
+
+			/**
+			 * Sets the target frame rate. Frames are then scheduled from
+			 * the next frame.
+			 *
+			 * @param fps frame rate, in frames per second
+			 */
+			void setFps(float fps);
+
+			/**
+			 * Target frame rate.
+			 *
+			 * @return frame rate, in frames per second
+			 */
+			float fps() const;
+
+			/**
+			 * Sets the catch-up policy.
+			 *
+			 * @param policy policy applied when frames overrun
+			 */
+			void setPolicy(CATCH_UP_POLICY policy);
+
+			/**
+			 * Current catch-up policy.
+			 *
+			 * @return catch-up policy
+			 */
+			CATCH_UP_POLICY policy() const;
+
+			/**
+			 * Sets the time spent busy waiting before each deadline,
+			 * instead of sleeping. The default is 1 ms.
+			 *
+			 * Higher values improve the precision of frame times, at the
+			 * cost of CPU usage. A spin time of 0 only relies on
+			 * `std::this_thread::sleep_until()`.
+			 *
+			 * @param spin_time busy wait duration
+			 */
+			void setSpinTime(clock::duration spin_time);
+
+			/**
+			 * Drives the time of the Runtimes from the clock, with
+			 * `steps_per_second` time steps per second: at each frame,
+			 * Runtimes are seeked to the time elapsed since the start of
+			 * the schedule before being stepped.
+			 *
+			 * Animation periods are then expressed in clock units
+			 * (e.g. milliseconds for a resolution of 1000) whatever the
+			 * frame rate, and late frames do not slow down animations:
+			 * the catch-up policy only determines when the following
+			 * frames are rendered.
+			 *
+			 * A resolution of 0, the default, steps Runtimes by
+			 * Runtime::timeStep() at each frame.
+			 *
+			 * @param steps_per_second time steps per second
+			 */
+			void setTimeResolution(unsigned long steps_per_second);
+
+			/**
+			 * Current time resolution.
+			 *
+			 * @return time steps per second, or 0 if the time of the
+			 * Runtimes is not driven by the clock
+			 */
+			unsigned long timeResolution() const;
+
+			/**
+			 * Waits until the next frame deadline, and steps all the
+			 * Runtimes with Runtime::next().
+			 *
+			 * The first call starts the schedule and renders the first
+			 * frame immediately.
+			 */
+			void step();
+
+			/**
+			 * Calls step() until stop() is called.
+			 *
+			 * Returns immediately if stop() was called before.
+			 */
+			void run();
+
+			/**
+			 * Calls step() `frame_count` times, or until stop() is called.
+			 *
+			 * Returns immediately if stop() was called before.
+			 *
+			 * @param frame_count count of frames to render
+			 */
+			void run(unsigned long frame_count);
+
+			/**
+			 * Stops the current run() loop after the current frame. Can be
+			 * called from any thread.
+			 *
+			 * If no run() loop is active, e.g. when stop() is called by
+			 * another thread right after the loop was launched, the next
+			 * run() loop returns without rendering any frame. The stop
+			 * request is then cleared, so that the Scheduler can be run
+			 * again.
+			 */
+			void stop();
+
+			/**
+			 * Restarts the schedule: the next call to step() renders a
+			 * frame immediately, and following frames are scheduled from
+			 * it.
+			 */
+			void restart();
+
+			/**
+			 * Count of frames rendered by this Scheduler.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			/**
+			 * Count of frames skipped with the SKIP_FRAMES policy.
+			 *
+			 * @return count of skipped frames
+			 */
+			unsigned long skippedFrames() const;
+	};
+}
+#endif
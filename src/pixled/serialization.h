@@ -0,0 +1,656 @@
+#ifndef PIXLED_SERIALIZATION_H
+#define PIXLED_SERIALIZATION_H
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include "color.h"
+#include "fixed.h"
+#include "geometry.h"
+#include "time.h"
+
+namespace pixled {
+	/**
+	 * Function graph binary format, written by serialize() and loaded by
+	 * FunctionGraph.
+	 *
+	 * A serialized graph is a header followed by the nodes of the graph.
+	 * All the integers are stored in little endian.
+	 *
+	 * The 16 bytes header contains:
+	 * | offset | size | content                                      |
+	 * |--------|------|----------------------------------------------|
+	 * | 0      | 4    | magic `PXFG`                                 |
+	 * | 4      | 2    | format VERSION                               |
+	 * | 6      | 1    | VALUE_TYPE returned by the graph             |
+	 * | 7      | 1    | reserved                                     |
+	 * | 8      | 4    | count of nodes                               |
+	 * | 12     | 4    | size of the nodes, in bytes                  |
+	 *
+	 * Nodes are stored in pre-order: each node is followed by the nodes of
+	 * its functionnal arguments, in the order of the arguments. A node
+	 * starts with:
+	 * | size | content                                              |
+	 * |------|------------------------------------------------------|
+	 * | 1    | NODE_TYPE                                            |
+	 * | 1    | VALUE_TYPE returned by the node                      |
+	 * | 2    | count of arguments `n`                               |
+	 * | n    | VALUE_TYPE of each argument                          |
+	 * | 2    | payload size `s`                                     |
+	 * | s    | payload                                              |
+	 *
+	 * The payload of a CONSTANT_NODE is its value, and the payload of a
+	 * SEQUENCE_NODE contains the 8 bytes duration of each animation.
+	 * RANDOM_T_NODE and RANDOM_XYT_NODE payloads contain the 8 bytes
+	 * period and seed of the engine. Other nodes have an empty payload.
+	 *
+	 * Values are encoded as follows (see value_type):
+	 * - `bool`, `uint8_t`: 1 byte
+	 * - `int`, `unsigned int`: 4 bytes
+	 * - `unsigned long`: 8 bytes
+	 * - `float`: 4 bytes, IEEE 754
+	 * - `fixed`: 4 bytes, raw value
+	 * - `point`, `line`, `plane`: 3, 3 and 4 floats
+	 * - `angle`: 1 float, in radian
+	 * - `color`: 1 byte COLOR_FORMAT, followed by 3 bytes rgb components or
+	 *   3 hsb floats, padded to 12 bytes
+	 *
+	 * Node and value identifiers are stable: new ones are only added, and
+	 * the VERSION is incremented when the encoding of existing ones
+	 * changes.
+	 */
+	namespace serialization {
+		/**
+		 * Current version of the format.
+		 */
+		static const std::uint16_t VERSION = 1;
+		/**
+		 * Size of the header.
+		 */
+		static const std::size_t HEADER_SIZE = 16;
+		/**
+		 * Maximum depth of a graph that can be loaded, to bound the stack
+		 * used by the loader.
+		 */
+		static const unsigned int MAX_DEPTH = 64;
+
+		/**
+		 * Types of values returned by serializable \Functions.
+		 */
+		enum VALUE_TYPE : std::uint8_t {
+			/**
+			 * Type that can't be serialized.
+			 */
+			UNKNOWN_VALUE = 0,
+			BOOL_VALUE = 1,
+			UINT8_VALUE = 2,
+			INT_VALUE = 3,
+			UNSIGNED_INT_VALUE = 4,
+			UNSIGNED_LONG_VALUE = 5,
+			FLOAT_VALUE = 6,
+			FIXED_VALUE = 7,
+			POINT_VALUE = 8,
+			LINE_VALUE = 9,
+			PLANE_VALUE = 10,
+			ANGLE_VALUE = 11,
+			COLOR_VALUE = 12,
+			/**
+			 * Random engines can't be stored as Constants.
+			 */
+			RANDOM_ENGINE_VALUE = 13
+		};
+
+		/**
+		 * Built-in \Functions, grouped by namespace.
+		 */
+		enum NODE_TYPE : std::uint8_t {
+			/**
+			 * A \Function that can't be serialized.
+			 */
+			UNKNOWN_NODE = 0,
+			CONSTANT_NODE = 1,
+			CAST_NODE = 2,
+
+			PLUS_NODE = 10,
+			MINUS_NODE = 11,
+			MULTIPLIES_NODE = 12,
+			DIVIDES_NODE = 13,
+			MODULUS_NODE = 14,
+
+			IF_NODE = 20,
+			EQUAL_NODE = 21,
+			NOT_EQUAL_NODE = 22,
+			LESS_THAN_NODE = 23,
+			LESS_THAN_OR_EQUAL_NODE = 24,
+			GREATER_THAN_NODE = 25,
+			GREATER_THAN_OR_EQUAL_NODE = 26,
+
+			HSB_NODE = 30,
+			FIXED_HSB_NODE = 31,
+			RGB_NODE = 32,
+
+			T_NODE = 40,
+			PHASE_NODE = 41,
+			FIXED_PHASE_NODE = 42,
+
+			X_NODE = 50,
+			Y_NODE = 51,
+			Z_NODE = 52,
+			I_NODE = 53,
+			DISTANCE_NODE = 54,
+			LINE_DISTANCE_NODE = 55,
+			PLANE_DISTANCE_NODE = 56,
+			POINT_NODE = 57,
+			POINT_3D_NODE = 58,
+			ANGLE_DEG_NODE = 59,
+			ANGLE_RAD_NODE = 60,
+			LINE_NODE = 61,
+			X_LINE_NODE = 62,
+			Y_LINE_NODE = 63,
+			ALPHA_LINE_NODE = 64,
+			PLANE_NODE = 65,
+			NORMAL_PLANE_NODE = 66,
+			POINT_LINE_NODE = 67,
+
+			SINE_NODE = 80,
+			SQUARE_NODE = 81,
+			TRIANGLE_NODE = 82,
+			SAWTOOTH_NODE = 83,
+			FIXED_SINE_NODE = 84,
+			FIXED_TRIANGLE_NODE = 85,
+
+			RANDOM_T_NODE = 90,
+			RANDOM_XYT_NODE = 91,
+			UNIFORM_DISTRIBUTION_NODE = 92,
+			NORMAL_DISTRIBUTION_NODE = 93,
+
+			WAVE_NODE = 100,
+			LINEAR_UNIT_WAVE_NODE = 101,
+			RADIAL_UNIT_WAVE_NODE = 102,
+			RAINBOW_NODE = 103,
+			RAINBOW_WAVE_NODE = 104,
+			RADIAL_RAINBOW_WAVE_NODE = 105,
+			BLOOMING_NODE = 106,
+			BLINK_NODE = 107,
+			SEQUENCE_NODE = 108
+		};
+
+		/**
+		 * Encodings of colors, chosen so that the decoded color is equal
+		 * to the encoded one, including its 16 bits components.
+		 */
+		enum COLOR_FORMAT : std::uint8_t {
+			/**
+			 * Built with color::rgb(): 3 bytes.
+			 */
+			RGB_COLOR = 0,
+			/**
+			 * Built with color::hsb(float, float, float): 3 floats.
+			 */
+			HSB_COLOR = 1,
+			/**
+			 * Built with color::hsb(fixed, fixed, fixed): 3 floats.
+			 */
+			FIXED_HSB_COLOR = 2
+		};
+
+		/**
+		 * Stores the `size` lowest bytes of `value` in little endian.
+		 */
+		inline void store_le(std::uint8_t* buffer, std::uint64_t value, std::size_t size) {
+			for(std::size_t i = 0; i < size; i++)
+				buffer[i] = (std::uint8_t) (value >> (8*i));
+		}
+
+		/**
+		 * Loads a little endian integer of `size` bytes.
+		 */
+		inline std::uint64_t load_le(const std::uint8_t* buffer, std::size_t size) {
+			std::uint64_t value = 0;
+			for(std::size_t i = 0; i < size; i++)
+				value |= (std::uint64_t) buffer[i] << (8*i);
+			return value;
+		}
+
+		/**
+		 * Stores the IEEE 754 representation of `value` in little endian.
+		 */
+		inline void store_float(std::uint8_t* buffer, float value) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			store_le(buffer, bits, 4);
+		}
+
+		/**
+		 * Loads a float stored with store_float().
+		 */
+		inline float load_float(const std::uint8_t* buffer) {
+			std::uint32_t bits = (std::uint32_t) load_le(buffer, 4);
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		/**
+		 * Serialization traits of the type `T`.
+		 *
+		 * Specializations define the VALUE_TYPE `id` of `T`, the `SIZE` of
+		 * its encoding, and `encode()` / `decode()` functions. Decoding
+		 * `SIZE` null bytes returns a default value of `T`.
+		 *
+		 * This default implementation is used for types that can't be
+		 * serialized.
+		 *
+		 * @tparam T value type
+		 */
+		template<typename T>
+			struct value_type {
+				/**
+				 * Type identifier.
+				 */
+				static constexpr VALUE_TYPE id = UNKNOWN_VALUE;
+				/**
+				 * Size of encoded values, in bytes.
+				 */
+				static constexpr std::size_t SIZE = 0;
+			};
+
+		/**
+		 * Integral values, stored on `Size` bytes.
+		 */
+		template<typename T, VALUE_TYPE Id, std::size_t Size>
+			struct integral_value_type {
+				static constexpr VALUE_TYPE id = Id;
+				static constexpr std::size_t SIZE = Size;
+
+				static void encode(const T& value, std::uint8_t* buffer) {
+					store_le(buffer, (std::uint64_t) value, SIZE);
+				}
+
+				static T decode(const std::uint8_t* buffer) {
+					return (T) load_le(buffer, SIZE);
+				}
+			};
+
+		template<> struct value_type<bool> {
+			static constexpr VALUE_TYPE id = BOOL_VALUE;
+			static constexpr std::size_t SIZE = 1;
+
+			static void encode(const bool& value, std::uint8_t* buffer) {
+				buffer[0] = value ? 1 : 0;
+			}
+
+			static bool decode(const std::uint8_t* buffer) {
+				return buffer[0] != 0;
+			}
+		};
+
+		template<> struct value_type<std::uint8_t>
+			: integral_value_type<std::uint8_t, UINT8_VALUE, 1> {};
+
+		template<> struct value_type<int>
+			: integral_value_type<int, INT_VALUE, 4> {
+				static int decode(const std::uint8_t* buffer) {
+					return (int) (std::int32_t) (std::uint32_t) load_le(buffer, 4);
+				}
+			};
+
+		template<> struct value_type<unsigned int>
+			: integral_value_type<unsigned int, UNSIGNED_INT_VALUE, 4> {};
+
+		template<> struct value_type<unsigned long>
+			: integral_value_type<unsigned long, UNSIGNED_LONG_VALUE, 8> {};
+
+		template<> struct value_type<float> {
+			static constexpr VALUE_TYPE id = FLOAT_VALUE;
+			static constexpr std::size_t SIZE = 4;
+
+			static void encode(const float& value, std::uint8_t* buffer) {
+				store_float(buffer, value);
+			}
+
+			static float decode(const std::uint8_t* buffer) {
+				return load_float(buffer);
+			}
+		};
+
+		template<> struct value_type<fixed> {
+			static constexpr VALUE_TYPE id = FIXED_VALUE;
+			static constexpr std::size_t SIZE = 4;
+
+			static void encode(const fixed& value, std::uint8_t* buffer) {
+				store_le(buffer, (std::uint32_t) value.raw(), 4);
+			}
+
+			static fixed decode(const std::uint8_t* buffer) {
+				return fixed::fromRaw((std::int32_t) (std::uint32_t) load_le(buffer, 4));
+			}
+		};
+
+		template<> struct value_type<point> {
+			static constexpr VALUE_TYPE id = POINT_VALUE;
+			static constexpr std::size_t SIZE = 12;
+
+			static void encode(const point& value, std::uint8_t* buffer) {
+				store_float(buffer, value.x);
+				store_float(buffer + 4, value.y);
+				store_float(buffer + 8, value.z);
+			}
+
+			static point decode(const std::uint8_t* buffer) {
+				return point(load_float(buffer), load_float(buffer + 4), load_float(buffer + 8));
+			}
+		};
+
+		template<> struct value_type<line> {
+			static constexpr VALUE_TYPE id = LINE_VALUE;
+			static constexpr std::size_t SIZE = 12;
+
+			static void encode(const line& value, std::uint8_t* buffer) {
+				store_float(buffer, value.a);
+				store_float(buffer + 4, value.b);
+				store_float(buffer + 8, value.c);
+			}
+
+			static line decode(const std::uint8_t* buffer) {
+				return line(load_float(buffer), load_float(buffer + 4), load_float(buffer + 8));
+			}
+		};
+
+		template<> struct value_type<plane> {
+			static constexpr VALUE_TYPE id = PLANE_VALUE;
+			static constexpr std::size_t SIZE = 16;
+
+			static void encode(const plane& value, std::uint8_t* buffer) {
+				store_float(buffer, value.a);
+				store_float(buffer + 4, value.b);
+				store_float(buffer + 8, value.c);
+				store_float(buffer + 12, value.d);
+			}
+
+			static plane decode(const std::uint8_t* buffer) {
+				return plane(
+						load_float(buffer), load_float(buffer + 4),
+						load_float(buffer + 8), load_float(buffer + 12));
+			}
+		};
+
+		template<> struct value_type<angle> {
+			static constexpr VALUE_TYPE id = ANGLE_VALUE;
+			static constexpr std::size_t SIZE = 4;
+
+			static void encode(const angle& value, std::uint8_t* buffer) {
+				store_float(buffer, value.toRad());
+			}
+
+			static angle decode(const std::uint8_t* buffer) {
+				return angle::fromRad(load_float(buffer));
+			}
+		};
+
+		template<> struct value_type<color> {
+			static constexpr VALUE_TYPE id = COLOR_VALUE;
+			static constexpr std::size_t SIZE = 13;
+
+			/**
+			 * True iff all the components of `c1` and `c2` are equal.
+			 */
+			static bool same(const color& c1, const color& c2) {
+				return c1.red() == c2.red() && c1.green() == c2.green() && c1.blue() == c2.blue()
+					&& c1.red16() == c2.red16() && c1.green16() == c2.green16()
+					&& c1.blue16() == c2.blue16()
+					&& c1.hue() == c2.hue() && c1.saturation() == c2.saturation()
+					&& c1.brightness() == c2.brightness();
+			}
+
+			static void encode(const color& value, std::uint8_t* buffer) {
+				std::memset(buffer, 0, SIZE);
+				if(same(value, color::rgb(value.red(), value.green(), value.blue()))) {
+					buffer[0] = RGB_COLOR;
+					buffer[1] = value.red();
+					buffer[2] = value.green();
+					buffer[3] = value.blue();
+					return;
+				}
+				buffer[0] = same(value, color::hsb(
+							fixed(value.hue()), fixed(value.saturation()), fixed(value.brightness())))
+					&& !same(value, color::hsb(value.hue(), value.saturation(), value.brightness()))
+					? FIXED_HSB_COLOR : HSB_COLOR;
+				store_float(buffer + 1, value.hue());
+				store_float(buffer + 5, value.saturation());
+				store_float(buffer + 9, value.brightness());
+			}
+
+			static color decode(const std::uint8_t* buffer) {
+				switch(buffer[0]) {
+					case HSB_COLOR:
+						return color::hsb(
+								load_float(buffer + 1), load_float(buffer + 5), load_float(buffer + 9));
+					case FIXED_HSB_COLOR:
+						return color::hsb(
+								fixed(load_float(buffer + 1)), fixed(load_float(buffer + 5)),
+								fixed(load_float(buffer + 9)));
+					default:
+						return color::rgb(buffer[1], buffer[2], buffer[3]);
+				}
+			}
+		};
+
+		template<> struct value_type<std::minstd_rand> {
+			static constexpr VALUE_TYPE id = RANDOM_ENGINE_VALUE;
+			static constexpr std::size_t SIZE = 0;
+
+			static std::minstd_rand decode(const std::uint8_t*) {
+				return std::minstd_rand();
+			}
+		};
+
+		/**
+		 * A list of types.
+		 */
+		template<typename... T>
+			struct type_list {};
+
+		/**
+		 * All the types that have a VALUE_TYPE.
+		 */
+		typedef type_list<
+			bool, std::uint8_t, int, unsigned int, unsigned long, float, fixed,
+			point, line, plane, angle, color, std::minstd_rand> value_types;
+
+		/**
+		 * visit() implementation: no type left.
+		 */
+		template<typename Visitor>
+			bool visit(VALUE_TYPE, Visitor&, type_list<>) {
+				return false;
+			}
+
+		/**
+		 * visit() implementation: checks `T`, then the `Types` left.
+		 */
+		template<typename Visitor, typename T, typename... Types>
+			bool visit(VALUE_TYPE type, Visitor& visitor, type_list<T, Types...>) {
+				if(type == value_type<T>::id)
+					return visitor.template visit<T>();
+				return visit(type, visitor, type_list<Types...>());
+			}
+
+		/**
+		 * Calls `visitor.visit<T>()`, where `T` is the type identified by
+		 * `type`.
+		 *
+		 * @param type value type
+		 * @param visitor object with a `template<typename T> bool visit()`
+		 * method
+		 * @return result of the visitor, or false if `type` is unknown
+		 */
+		template<typename Visitor>
+			bool visit(VALUE_TYPE type, Visitor& visitor) {
+				return visit(type, visitor, value_types());
+			}
+
+		/**
+		 * Writes serialized nodes to a buffer (see
+		 * base::Function::serialize()).
+		 *
+		 * Once the buffer is full, the Writer keeps counting the size of
+		 * the nodes written, so that the required buffer size can be
+		 * computed without any allocation.
+		 */
+		class Writer {
+			private:
+				std::uint8_t* buffer;
+				std::size_t capacity;
+				std::size_t _size = HEADER_SIZE;
+				unsigned long _nodes = 0;
+
+				template<typename T>
+					bool writeValue(const T&, std::false_type) {
+						return false;
+					}
+
+				template<typename T>
+					bool writeValue(const T& value, std::true_type) {
+						if(_size + value_type<T>::SIZE <= capacity)
+							value_type<T>::encode(value, buffer + _size);
+						_size += value_type<T>::SIZE;
+						return true;
+					}
+
+				bool header(NODE_TYPE node, VALUE_TYPE result, std::size_t arg_count) {
+					if(node == UNKNOWN_NODE || result == UNKNOWN_VALUE || arg_count > 0xFFFF)
+						return false;
+					if(_size + 4 <= capacity) {
+						buffer[_size] = node;
+						buffer[_size+1] = result;
+						store_le(buffer + _size + 2, arg_count, 2);
+					}
+					_size += 4;
+					_nodes++;
+					return true;
+				}
+
+				bool payload(std::size_t size) {
+					if(size > 0xFFFF)
+						return false;
+					if(_size + 2 <= capacity)
+						store_le(buffer + _size, size, 2);
+					_size += 2;
+					return true;
+				}
+
+				void argument(VALUE_TYPE type) {
+					if(_size < capacity)
+						buffer[_size] = type;
+					_size++;
+				}
+
+			public:
+				/**
+				 * Initializes a Writer that writes nodes after the header of
+				 * `buffer`.
+				 *
+				 * @param buffer output buffer, can be `nullptr` if
+				 * `capacity` is 0
+				 * @param capacity size of `buffer`
+				 */
+				Writer(std::uint8_t* buffer, std::size_t capacity)
+					: buffer(buffer), capacity(capacity) {}
+
+				/**
+				 * Writes the header of a node. Exactly `payload_size` bytes
+				 * of payload must then be written, followed by the
+				 * arguments of the node.
+				 *
+				 * @param node node type
+				 * @param result type returned by the node
+				 * @param arg_types types of the `arg_count` arguments
+				 * @param arg_count count of arguments
+				 * @param payload_size size of the payload
+				 * @return false if one of the types is unknown
+				 */
+				bool node(
+						NODE_TYPE node, VALUE_TYPE result,
+						const VALUE_TYPE* arg_types, std::size_t arg_count,
+						std::size_t payload_size) {
+					for(std::size_t i = 0; i < arg_count; i++)
+						if(arg_types[i] == UNKNOWN_VALUE)
+							return false;
+					if(!header(node, result, arg_count))
+						return false;
+					for(std::size_t i = 0; i < arg_count; i++)
+						argument(arg_types[i]);
+					return payload(payload_size);
+				}
+
+				/**
+				 * Writes the header of a node with `arg_count` arguments
+				 * of the same type.
+				 *
+				 * @param node node type
+				 * @param result type returned by the node
+				 * @param arg_type type of all the arguments
+				 * @param arg_count count of arguments
+				 * @param payload_size size of the payload
+				 * @return false if one of the types is unknown
+				 */
+				bool node(
+						NODE_TYPE node, VALUE_TYPE result,
+						VALUE_TYPE arg_type, std::size_t arg_count,
+						std::size_t payload_size) {
+					if(arg_type == UNKNOWN_VALUE || !header(node, result, arg_count))
+						return false;
+					for(std::size_t i = 0; i < arg_count; i++)
+						argument(arg_type);
+					return payload(payload_size);
+				}
+
+				/**
+				 * Writes a value to the payload of the current node.
+				 *
+				 * @param value value to encode
+				 * @return false if `T` can't be serialized
+				 */
+				template<typename T>
+					bool value(const T& value) {
+						return writeValue(value, std::integral_constant<bool, (value_type<T>::SIZE > 0)>());
+					}
+
+				/**
+				 * Writes a CONSTANT_NODE.
+				 *
+				 * @param value constant value
+				 * @return false if `T` can't be serialized
+				 */
+				template<typename T>
+					bool constant(const T& value) {
+						return value_type<T>::SIZE > 0
+							&& node(CONSTANT_NODE, value_type<T>::id, nullptr, 0, value_type<T>::SIZE)
+							&& this->value(value);
+					}
+
+				/**
+				 * Writes the header of the graph, once all its nodes have
+				 * been written.
+				 *
+				 * @param root type returned by the graph
+				 * @return size of the serialized graph: the header is not
+				 * written if it exceeds the capacity of the buffer
+				 */
+				std::size_t finish(VALUE_TYPE root) {
+					if(_size <= capacity) {
+						std::memcpy(buffer, "PXFG", 4);
+						store_le(buffer + 4, VERSION, 2);
+						buffer[6] = root;
+						buffer[7] = 0;
+						store_le(buffer + 8, _nodes, 4);
+						store_le(buffer + 12, _size - HEADER_SIZE, 4);
+					}
+					return _size;
+				}
+		};
+	}
+}
+#endif
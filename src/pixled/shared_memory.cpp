@@ -0,0 +1,283 @@
+#include "shared_memory.h"
+
+#ifdef PIXLED_SHARED_MEMORY
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace pixled {
+	static_assert(ATOMIC_INT_LOCK_FREE == 2,
+			"Shared memory atomics must be lock free");
+	static_assert(sizeof(std::atomic<std::uint32_t>) == 4,
+			"Shared memory atomics must have the size of their value");
+
+	static const std::uint32_t MAGIC = 0x4d535850; // "PXSM" in little endian
+	static const std::size_t ALIGNMENT = 64;
+
+	static const std::size_t MAGIC_OFFSET = 0;
+	static const std::size_t VERSION_OFFSET = 4;
+	static const std::size_t LED_COUNT_OFFSET = 8;
+	static const std::size_t SLOT_COUNT_OFFSET = 12;
+	static const std::size_t SLOT_SIZE_OFFSET = 16;
+	static const std::size_t PUBLISHED_OFFSET = 20;
+	static const std::size_t WAITERS_OFFSET = 24;
+
+	/**
+	 * Atomic 4 bytes integer stored at `offset` in `data`.
+	 */
+	static std::atomic<std::uint32_t>& atomic_at(std::uint8_t* data, std::size_t offset) {
+		return *reinterpret_cast<std::atomic<std::uint32_t>*>(data + offset);
+	}
+
+	static std::uint32_t load(const std::uint8_t* data, std::size_t offset) {
+		std::uint32_t value;
+		std::memcpy(&value, data + offset, sizeof(value));
+		return value;
+	}
+
+	static void store(std::uint8_t* data, std::size_t offset, std::uint32_t value) {
+		std::memcpy(data + offset, &value, sizeof(value));
+	}
+
+	SharedMemoryOutput::SharedMemoryOutput(
+			const char* name, std::size_t led_count, std::size_t slot_count)
+		: name(name), led_count(led_count), slot_count(slot_count),
+		slot_size((shared_memory::SLOT_HEADER_SIZE + 3*led_count + ALIGNMENT - 1)
+				/ ALIGNMENT * ALIGNMENT) {
+			if(slot_count < 2)
+				return;
+			int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+			if(fd < 0)
+				return;
+			std::size_t size = shared_memory::HEADER_SIZE + slot_count * slot_size;
+			// Truncating to 0 first resets an existing object
+			if(ftruncate(fd, 0) == 0 && ftruncate(fd, size) == 0) {
+				void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if(mapping != MAP_FAILED) {
+					data = (std::uint8_t*) mapping;
+					this->size = size;
+				}
+			}
+			::close(fd);
+			if(!data) {
+				shm_unlink(name);
+				return;
+			}
+
+			store(data, VERSION_OFFSET, shared_memory::VERSION);
+			store(data, LED_COUNT_OFFSET, led_count);
+			store(data, SLOT_COUNT_OFFSET, slot_count);
+			store(data, SLOT_SIZE_OFFSET, slot_size);
+			new (data + PUBLISHED_OFFSET) std::atomic<std::uint32_t>(0);
+			new (data + WAITERS_OFFSET) std::atomic<std::uint32_t>(0);
+			for(std::size_t i = 0; i < slot_count; i++)
+				new (data + shared_memory::HEADER_SIZE + i * slot_size)
+					std::atomic<std::uint32_t>(0);
+			// Readers only use the header once the magic is visible
+			new (data + MAGIC_OFFSET) std::atomic<std::uint32_t>(0);
+			atomic_at(data, MAGIC_OFFSET).store(MAGIC, std::memory_order_release);
+		}
+
+	bool SharedMemoryOutput::isOpen() const {
+		return data != nullptr;
+	}
+
+	std::size_t SharedMemoryOutput::ledCount() const {
+		return led_count;
+	}
+
+	unsigned long SharedMemoryOutput::frames() const {
+		return _frames;
+	}
+
+	std::uint8_t* SharedMemoryOutput::slot() const {
+		return data + shared_memory::HEADER_SIZE + (_frames % slot_count) * slot_size;
+	}
+
+	void SharedMemoryOutput::beginFrame() {
+		if(writing)
+			return;
+		std::atomic<std::uint32_t>& sequence = atomic_at(slot(), 0);
+		// Odd while the slot is written
+		sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		writing = true;
+	}
+
+	void SharedMemoryOutput::write(const color& color, std::size_t i) {
+		if(!data || i >= led_count)
+			return;
+		beginFrame();
+		std::uint8_t* rgb = slot() + shared_memory::SLOT_HEADER_SIZE + 3*i;
+		rgb[0] = color.red();
+		rgb[1] = color.green();
+		rgb[2] = color.blue();
+	}
+
+	void SharedMemoryOutput::writeFrame(const std::uint8_t* frame, std::size_t led_count) {
+		if(!data)
+			return;
+		beginFrame();
+		std::memcpy(slot() + shared_memory::SLOT_HEADER_SIZE, frame,
+				3*std::min(led_count, this->led_count));
+	}
+
+	void SharedMemoryOutput::endFrame() {
+		if(!data)
+			return;
+		beginFrame();
+		std::atomic<std::uint32_t>& sequence = atomic_at(slot(), 0);
+		sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		writing = false;
+
+		std::atomic<std::uint32_t>& published = atomic_at(data, PUBLISHED_OFFSET);
+		published.store(++_frames);
+		// Orders with the increment of waiters in SharedMemoryReader::wait(),
+		// so that a reader is either woken up or sees the new frame
+		if(atomic_at(data, WAITERS_OFFSET).load() > 0) {
+#ifdef __linux__
+			syscall(SYS_futex, &published, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+		}
+	}
+
+	SharedMemoryOutput::~SharedMemoryOutput() {
+		if(data) {
+			munmap(data, size);
+			shm_unlink(name.c_str());
+		}
+	}
+
+	SharedMemoryReader::SharedMemoryReader(const char* name) {
+		int fd = shm_open(name, O_RDWR, 0);
+		if(fd < 0)
+			return;
+		struct stat st;
+		if(fstat(fd, &st) == 0 && (std::size_t) st.st_size >= shared_memory::HEADER_SIZE) {
+			void* mapping = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if(mapping != MAP_FAILED) {
+				data = (std::uint8_t*) mapping;
+				size = st.st_size;
+			}
+		}
+		::close(fd);
+		if(!data)
+			return;
+
+		bool valid = atomic_at(data, MAGIC_OFFSET).load(std::memory_order_acquire) == MAGIC
+			&& load(data, VERSION_OFFSET) == shared_memory::VERSION;
+		if(valid) {
+			led_count = load(data, LED_COUNT_OFFSET);
+			slot_count = load(data, SLOT_COUNT_OFFSET);
+			slot_size = load(data, SLOT_SIZE_OFFSET);
+			valid = slot_count > 0
+				&& slot_size >= shared_memory::SLOT_HEADER_SIZE + 3*led_count
+				&& slot_size % ALIGNMENT == 0
+				&& size >= shared_memory::HEADER_SIZE + slot_count * slot_size;
+		}
+		if(!valid) {
+			munmap(data, size);
+			data = nullptr;
+			return;
+		}
+		frame.resize(3*led_count);
+	}
+
+	bool SharedMemoryReader::isOpen() const {
+		return data != nullptr;
+	}
+
+	std::size_t SharedMemoryReader::ledCount() const {
+		return led_count;
+	}
+
+	unsigned long SharedMemoryReader::frames() const {
+		if(!data)
+			return 0;
+		return atomic_at(data, PUBLISHED_OFFSET).load(std::memory_order_acquire);
+	}
+
+	unsigned long SharedMemoryReader::pending() const {
+		return (std::uint32_t) (frames() - last_frame);
+	}
+
+	bool SharedMemoryReader::wait(unsigned long timeout_ms) {
+		if(!data)
+			return false;
+		std::atomic<std::uint32_t>& published = atomic_at(data, PUBLISHED_OFFSET);
+		auto deadline = std::chrono::steady_clock::now()
+			+ std::chrono::milliseconds(timeout_ms);
+#ifdef __linux__
+		std::atomic<std::uint32_t>& waiters = atomic_at(data, WAITERS_OFFSET);
+		waiters++;
+		std::uint32_t frame;
+		while((frame = published.load()) == last_frame) {
+			auto remaining = deadline - std::chrono::steady_clock::now();
+			if(remaining <= std::chrono::steady_clock::duration::zero())
+				break;
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+			timespec timeout {(time_t) (ns / 1000000000), (long) (ns % 1000000000)};
+			// Returns immediately if a frame was published since the load
+			syscall(SYS_futex, &published, FUTEX_WAIT, frame, &timeout, nullptr, 0);
+		}
+		waiters--;
+#else
+		while(published.load() == last_frame
+				&& std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+#endif
+		return pending() > 0;
+	}
+
+	bool SharedMemoryReader::read(std::uint8_t* frame) {
+		if(!data)
+			return false;
+		std::atomic<std::uint32_t>& published = atomic_at(data, PUBLISHED_OFFSET);
+		while(true) {
+			std::uint32_t published_frame = published.load(std::memory_order_acquire);
+			if(published_frame == last_frame)
+				return false;
+			std::uint8_t* slot = data + shared_memory::HEADER_SIZE
+				+ ((std::uint32_t) (published_frame - 1) % slot_count) * slot_size;
+			std::atomic<std::uint32_t>& sequence = atomic_at(slot, 0);
+			std::uint32_t before = sequence.load(std::memory_order_acquire);
+			if(before % 2 == 0) {
+				std::memcpy(frame, slot + shared_memory::SLOT_HEADER_SIZE, 3*led_count);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if(sequence.load(std::memory_order_relaxed) == before) {
+					last_frame = published_frame;
+					return true;
+				}
+			}
+			// The slot was overwritten by a newer frame
+		}
+	}
+
+	bool SharedMemoryReader::read(Output& output) {
+		if(!read(frame.data()))
+			return false;
+		output.writeFrame(frame.data(), led_count);
+		output.endFrame();
+		return true;
+	}
+
+	SharedMemoryReader::~SharedMemoryReader() {
+		if(data)
+			munmap(data, size);
+	}
+}
+#endif
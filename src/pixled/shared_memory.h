@@ -0,0 +1,264 @@
+#ifndef PIXLED_SHARED_MEMORY_H
+#define PIXLED_SHARED_MEMORY_H
+
+#include "config.h"
+
+/**
+ * Defined when SharedMemoryOutput and SharedMemoryReader are available, i.e.
+ * in heap mode on POSIX systems that support `shm_open()`.
+ */
+#if !defined(PIXLED_NO_HEAP) && (defined(__unix__) || defined(__APPLE__))
+#define PIXLED_SHARED_MEMORY
+#endif
+
+#ifdef PIXLED_SHARED_MEMORY
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "output.h"
+
+namespace pixled {
+	/**
+	 * Shared memory frame ring layout.
+	 *
+	 * The shared memory object starts with a header of HEADER_SIZE bytes:
+	 * | offset | size | content                                         |
+	 * |--------|------|-------------------------------------------------|
+	 * | 0      | 4    | magic `PXSM`, written last by the writer        |
+	 * | 4      | 4    | layout VERSION                                  |
+	 * | 8      | 4    | led count of each frame                         |
+	 * | 12     | 4    | count of slots of the ring                      |
+	 * | 16     | 4    | size of each slot, in bytes                     |
+	 * | 20     | 4    | atomic count of published frames                |
+	 * | 24     | 4    | atomic count of readers waiting for a frame     |
+	 *
+	 * It is followed by the slots of the ring. Each slot starts with a
+	 * SLOT_HEADER_SIZE bytes header, that contains the atomic 4 bytes
+	 * sequence counter of the slot, followed by the rgb frame buffer (see
+	 * Output::writeFrame()). Slots are aligned on 64 bytes.
+	 *
+	 * Frame `n` (counting from 0) is written to the slot `n % slot_count`.
+	 * The sequence counter of the slot is odd while the frame is being
+	 * written (seqlock), so that readers can detect frames overwritten while
+	 * they were reading them. The count of published frames is incremented
+	 * once a frame is complete, and readers blocked on it are woken up with a
+	 * futex on Linux.
+	 *
+	 * Integers are stored in the native byte order, since the memory is only
+	 * shared by processes of the same host.
+	 */
+	namespace shared_memory {
+		/**
+		 * Current version of the layout.
+		 */
+		static const std::uint32_t VERSION = 1;
+		/**
+		 * Size of the header of the shared memory object.
+		 */
+		static const std::size_t HEADER_SIZE = 64;
+		/**
+		 * Size of the header of each slot.
+		 */
+		static const std::size_t SLOT_HEADER_SIZE = 64;
+	}
+
+	/**
+	 * An Output that publishes frames to other processes of the same host,
+	 * through a ring of frame buffers in a POSIX shared memory object.
+	 *
+	 * Leds are written by the Runtime directly into the current slot of the
+	 * ring, without any intermediate buffer, and the frame is published when
+	 * the Runtime calls endFrame(). A driver process then reads the frames
+	 * with a SharedMemoryReader.
+	 *
+	 * The writer never waits for readers: a reader that is more than
+	 * `slot_count - 1` frames late misses frames, and always reads the
+	 * latest one. Since each frame is written to a slot that contains an
+	 * older frame, all the leds must be written at each frame, as a Runtime
+	 * does.
+	 *
+	 * ```cpp
+	 * pixled::SharedMemoryOutput output("/pixled", 1024);
+	 * pixled::Runtime runtime(panel, output, animation);
+	 * ```
+	 *
+	 * Only available in heap mode, on POSIX systems (see
+	 * PIXLED_SHARED_MEMORY).
+	 */
+	class SharedMemoryOutput : public Output {
+		private:
+			std::string name;
+			std::uint8_t* data = nullptr;
+			std::size_t size = 0;
+			std::size_t led_count;
+			std::size_t slot_count;
+			std::size_t slot_size;
+			std::uint32_t _frames = 0;
+			bool writing = false;
+
+			std::uint8_t* slot() const;
+			void beginFrame();
+
+		public:
+			/**
+			 * Creates, or replaces, the shared memory object `name`.
+			 *
+			 * @param name name of the shared memory object, starting with
+			 * a `/` (see `shm_open()`)
+			 * @param led_count count of leds of each frame
+			 * @param slot_count count of frames in the ring, at least 2
+			 */
+			SharedMemoryOutput(const char* name, std::size_t led_count, std::size_t slot_count = 4);
+
+			SharedMemoryOutput(const SharedMemoryOutput&) = delete;
+			SharedMemoryOutput& operator=(const SharedMemoryOutput&) = delete;
+
+			/**
+			 * Returns false if the shared memory object could not be
+			 * created or mapped.
+			 *
+			 * @return true iff frames are published
+			 */
+			bool isOpen() const;
+
+			/**
+			 * Count of leds of each frame.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+
+			/**
+			 * Count of frames published.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			void write(const color& color, std::size_t i) override;
+			void writeFrame(const std::uint8_t* frame, std::size_t led_count) override;
+
+			/**
+			 * Publishes the current frame, and wakes up the waiting
+			 * readers.
+			 */
+			void endFrame() override;
+
+			/**
+			 * Unmaps and unlinks the shared memory object. Readers that
+			 * already mapped it can still read the last frames.
+			 */
+			~SharedMemoryOutput();
+	};
+
+	/**
+	 * Reads the frames published by a SharedMemoryOutput of another process.
+	 *
+	 * ```cpp
+	 * pixled::SharedMemoryReader reader("/pixled");
+	 * while(reader.isOpen()) {
+	 * 	if(reader.wait(100))
+	 * 		reader.read(driver_output);
+	 * }
+	 * ```
+	 *
+	 * Only available in heap mode, on POSIX systems (see
+	 * PIXLED_SHARED_MEMORY).
+	 */
+	class SharedMemoryReader {
+		private:
+			std::uint8_t* data = nullptr;
+			std::size_t size = 0;
+			std::size_t led_count = 0;
+			std::size_t slot_count = 0;
+			std::size_t slot_size = 0;
+			std::uint32_t last_frame = 0;
+			// Copy of the last frame read by read(Output&)
+			std::vector<std::uint8_t> frame;
+
+		public:
+			/**
+			 * Maps the shared memory object `name`. Only the count of
+			 * waiting readers is written to the mapping.
+			 *
+			 * @param name name of the shared memory object written by a
+			 * SharedMemoryOutput
+			 */
+			SharedMemoryReader(const char* name);
+
+			SharedMemoryReader(const SharedMemoryReader&) = delete;
+			SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+
+			/**
+			 * Returns false if the shared memory object could not be
+			 * mapped, or has not been initialized by a SharedMemoryOutput.
+			 *
+			 * @return true iff frames can be read
+			 */
+			bool isOpen() const;
+
+			/**
+			 * Count of leds of each frame.
+			 *
+			 * @return led count
+			 */
+			std::size_t ledCount() const;
+
+			/**
+			 * Count of frames published by the writer.
+			 *
+			 * @return count of frames
+			 */
+			unsigned long frames() const;
+
+			/**
+			 * Count of frames published by the writer since the last
+			 * frame read. Frames that were overwritten in the ring are
+			 * skipped by read().
+			 *
+			 * @return count of new frames
+			 */
+			unsigned long pending() const;
+
+			/**
+			 * Blocks until a frame that has not been read yet is
+			 * published, or until `timeout_ms` milliseconds elapsed.
+			 *
+			 * @param timeout_ms timeout in milliseconds
+			 * @return true iff a new frame is available
+			 */
+			bool wait(unsigned long timeout_ms);
+
+			/**
+			 * Copies the latest published frame to `frame`.
+			 *
+			 * @param frame buffer of `3*ledCount()` bytes
+			 * @return false, and does nothing, if no frame was published
+			 * since the last frame read
+			 */
+			bool read(std::uint8_t* frame);
+
+			/**
+			 * Copies the latest published frame, and writes it to
+			 * `output` with Output::writeFrame() and Output::endFrame().
+			 *
+			 * The frame is first copied to a buffer of the reader, and
+			 * only written once the copy is known to be consistent, so
+			 * that `output` never receives a torn frame, and receives each
+			 * frame exactly once.
+			 *
+			 * @param output output receiving the frame
+			 * @return false, and does nothing, if no frame was published
+			 * since the last frame read
+			 */
+			bool read(Output& output);
+
+			/**
+			 * Unmaps the shared memory object.
+			 */
+			~SharedMemoryReader();
+	};
+}
+#endif
+#endif
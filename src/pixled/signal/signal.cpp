@@ -2,6 +2,40 @@
 
 namespace pixled { namespace signal {
 
+	/**
+	 * Raw fixed values of sin(i/64 * PI/2), for i in [0, 64].
+	 */
+	static const std::int32_t QUARTER_SINE[65] = {
+		0, 1608, 3216, 4821, 6424, 8022, 9616, 11204,
+		12785, 14359, 15924, 17479, 19024, 20557, 22078, 23586,
+		25080, 26558, 28020, 29466, 30893, 32303, 33692, 35062,
+		36410, 37736, 39040, 40320, 41576, 42806, 44011, 45190,
+		46341, 47464, 48559, 49624, 50660, 51665, 52639, 53581,
+		54491, 55368, 56212, 57022, 57798, 58538, 59244, 59914,
+		60547, 61145, 61705, 62228, 62714, 63162, 63572, 63944,
+		64277, 64571, 64827, 65043, 65220, 65358, 65457, 65516,
+		65536
+	};
+
+	/**
+	 * Fractional part of `x`, in turns on 16 bits.
+	 */
+	static std::int32_t phase(fixed x) {
+		return x.raw() & 0xFFFF;
+	}
+
+	/**
+	 * Sine of a position in the first quarter of a turn, where `0x4000` is
+	 * a quarter turn.
+	 */
+	static std::int32_t quarter_sine(std::int32_t position) {
+		std::int32_t i = position >> 8;
+		if(i >= 64)
+			return QUARTER_SINE[64];
+		std::int32_t ff = position & 0xFF;
+		return QUARTER_SINE[i] + (((QUARTER_SINE[i+1] - QUARTER_SINE[i]) * ff) >> 8);
+	}
+
 	float Sine::operator()(led l, time t) const {
 		return std::sin(2*PI * this->call<0>(l, t));
 	}
@@ -21,4 +55,28 @@ namespace pixled { namespace signal {
 					2*PI * this->call<0>(l, t)
 					));
 	}
+
+	fixed FixedSine::operator()(led l, time t) const {
+		std::int32_t p = phase(this->call<0>(l, t));
+		std::int32_t position = p & 0x3FFF;
+		switch(p >> 14) {
+			case 0:
+				return fixed::fromRaw(quarter_sine(position));
+			case 1:
+				return fixed::fromRaw(quarter_sine(0x4000 - position));
+			case 2:
+				return fixed::fromRaw(-quarter_sine(position));
+			default:
+				return fixed::fromRaw(-quarter_sine(0x4000 - position));
+		}
+	}
+
+	fixed FixedTriangle::operator()(led l, time t) const {
+		std::int32_t p = phase(this->call<0>(l, t));
+		if(p < 0x4000)
+			return fixed::fromRaw(4 * p);
+		if(p < 0xC000)
+			return fixed::fromRaw(2 * fixed::ONE - 4 * p);
+		return fixed::fromRaw(4 * p - 4 * fixed::ONE);
+	}
 }}
@@ -2,6 +2,7 @@
 #define PIXLED_FUNCTIONNAL_SIGNALS_H
 
 #include "../function.h"
+#include "../fixed.h"
 
 namespace pixled { namespace signal {
 	/**
@@ -53,6 +54,7 @@ namespace pixled { namespace signal {
 	class Sine : public Function<Sine, float, float> {
 		public:
 			using Function<Sine, float, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::SINE_NODE;
 
 			/*
 			 * f1 : period
@@ -90,6 +92,7 @@ namespace pixled { namespace signal {
 	class Square : public Function<Square, float, float> {
 		public:
 			using Function<Square, float, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::SQUARE_NODE;
 
 			float operator()(led l, time t) const override;
 	};
@@ -123,6 +126,7 @@ namespace pixled { namespace signal {
 	class Triangle : public Function<Triangle, float, float> {
 		public:
 			using Function<Triangle, float, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::TRIANGLE_NODE;
 
 			float operator()(led l, time t) const override;
 	};
@@ -156,8 +160,48 @@ namespace pixled { namespace signal {
 	class Sawtooth : public Function<Sawtooth, float, float> {
 		public:
 			using Function<Sawtooth, float, float>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::SAWTOOTH_NODE;
 
 			float operator()(led l, time t) const override;
 	};
+
+	/**
+	 * Fixed-point Sine wave function.
+	 *
+	 * Same as Sine, but computed with integer arithmetic only, from a
+	 * quarter wave lookup table with linear interpolation. The absolute
+	 * error is lower than `1e-4`.
+	 *
+	 * Only the fractional part of the parameter is relevant, so that waves
+	 * such as `FixedSine(Cast<fixed>(T() % period) / period)` do not
+	 * overflow.
+	 *
+	 * @param fixed sin parameter
+	 * @retval fixed `sin(2*PI * this->call<0>(p, t))`, in `[-1, 1]`
+	 */
+	class FixedSine : public Function<FixedSine, fixed, fixed> {
+		public:
+			using Function<FixedSine, fixed, fixed>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::FIXED_SINE_NODE;
+
+			fixed operator()(led l, time t) const override;
+	};
+
+	/**
+	 * Fixed-point Triangle wave function.
+	 *
+	 * Same as Triangle, but computed with integer arithmetic only.
+	 *
+	 * @param fixed triangle function parameter
+	 * @retval fixed `2/PI * asin(sin(2*PI * this->call<0>(p, t)))`, in
+	 * `[-1, 1]`
+	 */
+	class FixedTriangle : public Function<FixedTriangle, fixed, fixed> {
+		public:
+			using Function<FixedTriangle, fixed, fixed>::Function;
+			static constexpr serialization::NODE_TYPE NODE = serialization::FIXED_TRIANGLE_NODE;
+
+			fixed operator()(led l, time t) const override;
+	};
 }}
 #endif
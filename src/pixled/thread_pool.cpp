@@ -0,0 +1,153 @@
+#include "thread_pool.h"
+
+#ifndef PIXLED_NO_HEAP
+
+namespace pixled {
+	/**
+	 * Pool and index of the worker running on the current thread.
+	 */
+	static thread_local const ThreadPool* current_pool = nullptr;
+	static thread_local int current_worker = -1;
+
+	ThreadPool::ThreadPool(std::size_t thread_count) {
+		if(thread_count == 0)
+			thread_count = 1;
+		for(std::size_t i = 0; i < thread_count; i++)
+			queues.emplace_back(new Queue);
+		for(std::size_t i = 0; i < thread_count; i++)
+			workers.emplace_back(&ThreadPool::work, this, (int) i);
+	}
+
+	std::size_t ThreadPool::threadCount() const {
+		return workers.size();
+	}
+
+	int ThreadPool::workerIndex() const {
+		return current_pool == this ? current_worker : -1;
+	}
+
+	void ThreadPool::push(Queue& queue, Task&& task) {
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		pending++;
+		{
+			// Ensures a worker checking `pending` is either not yet
+			// checking or already waiting
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		wake_up.notify_one();
+	}
+
+	bool ThreadPool::pop(Queue& queue, Task& task, bool back) {
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.tasks.empty())
+			return false;
+		if(back) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		} else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		pending--;
+		return true;
+	}
+
+	bool ThreadPool::take(int worker, Task& task, bool shared_queue) {
+		if(worker >= 0 && pop(*queues[worker], task, true))
+			return true;
+		if(shared_queue && pop(shared, task, false))
+			return true;
+		// Steals the oldest task of another worker
+		std::size_t first = worker >= 0 ? worker + 1 : 0;
+		for(std::size_t i = 0; i < queues.size(); i++) {
+			std::size_t victim = (first + i) % queues.size();
+			if((int) victim != worker && pop(*queues[victim], task, false))
+				return true;
+		}
+		return false;
+	}
+
+	void ThreadPool::work(int worker) {
+		current_pool = this;
+		current_worker = worker;
+		while(true) {
+			Task task;
+			if(take(worker, task, true)) {
+				task();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			wake_up.wait(lock, [this] {return stopping || pending > 0;});
+			if(stopping && pending == 0)
+				return;
+		}
+	}
+
+	void ThreadPool::submit(Task task) {
+		int worker = workerIndex();
+		push(worker >= 0 ? *queues[worker] : shared, std::move(task));
+	}
+
+	bool ThreadPool::isWorker() const {
+		return workerIndex() >= 0;
+	}
+
+	bool ThreadPool::runTask() {
+		Task task;
+		if(!take(workerIndex(), task, true))
+			return false;
+		task();
+		return true;
+	}
+
+	void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& f) {
+		if(count == 0)
+			return;
+		if(count == 1) {
+			f(0);
+			return;
+		}
+		// Shared by all the tasks, so that each task only captures a
+		// pointer and an index and fits in the std::function inline
+		// storage
+		struct Loop {
+			const std::function<void(std::size_t)>& f;
+			std::atomic<std::size_t> remaining;
+		} loop {f, {count}};
+
+		int worker = workerIndex();
+		Queue& queue = worker >= 0 ? *queues[worker] : shared;
+		// The last index is executed by the calling thread
+		for(std::size_t i = 0; i < count - 1; i++) {
+			Loop* l = &loop;
+			push(queue, [l, i] {
+					l->f(i);
+					l->remaining--;
+					});
+		}
+		f(count - 1);
+		loop.remaining--;
+
+		while(loop.remaining > 0) {
+			Task task;
+			if(take(worker, task, worker < 0))
+				task();
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stopping = true;
+		}
+		wake_up.notify_all();
+		for(auto& worker : workers)
+			worker.join();
+	}
+}
+#endif
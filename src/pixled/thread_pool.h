@@ -0,0 +1,128 @@
+#ifndef PIXLED_THREAD_POOL_H
+#define PIXLED_THREAD_POOL_H
+
+#include "config.h"
+
+#ifndef PIXLED_NO_HEAP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pixled {
+	/**
+	 * A work-stealing thread pool.
+	 *
+	 * Each worker thread owns a task queue. Tasks submitted from a worker
+	 * (e.g. the chunks of a parallelFor() called from a task) are pushed to
+	 * its own queue and executed in LIFO order, what keeps the data of a
+	 * frame in the cache of the worker. Tasks submitted from other threads
+	 * are pushed to a shared FIFO queue. Idle workers take tasks from their
+	 * own queue, then from the shared queue, and finally steal the oldest
+	 * tasks of other workers.
+	 *
+	 * Not available in heap-free mode.
+	 */
+	class ThreadPool {
+		public:
+			/**
+			 * Task executed by a worker.
+			 */
+			typedef std::function<void()> Task;
+
+		private:
+			struct Queue {
+				std::mutex mutex;
+				std::deque<Task> tasks;
+			};
+
+			std::vector<std::unique_ptr<Queue>> queues;
+			Queue shared;
+			std::vector<std::thread> workers;
+
+			// Count of queued tasks, used to put idle workers to sleep
+			std::atomic<std::size_t> pending {0};
+			std::mutex sleep_mutex;
+			std::condition_variable wake_up;
+			bool stopping = false;
+
+			int workerIndex() const;
+			void push(Queue& queue, Task&& task);
+			bool pop(Queue& queue, Task& task, bool back);
+			bool take(int worker, Task& task, bool shared_queue);
+			void work(int worker);
+
+		public:
+			/**
+			 * Starts a ThreadPool.
+			 *
+			 * @param thread_count count of worker threads, by default
+			 * the count of hardware threads
+			 */
+			ThreadPool(std::size_t thread_count = std::thread::hardware_concurrency());
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			/**
+			 * Count of worker threads.
+			 *
+			 * @return count of workers
+			 */
+			std::size_t threadCount() const;
+
+			/**
+			 * Submits a task, executed asynchronously by a worker.
+			 *
+			 * @param task task to execute
+			 */
+			void submit(Task task);
+
+			/**
+			 * Returns true if and only if the calling thread is a worker of
+			 * this pool.
+			 *
+			 * @return true iff called from a task of this pool
+			 */
+			bool isWorker() const;
+
+			/**
+			 * Executes one queued task on the calling thread, if any.
+			 *
+			 * A worker waiting for other tasks of the pool must execute
+			 * tasks while it waits, as parallelFor() does, since the tasks
+			 * it waits for might otherwise never be executed (e.g. with a
+			 * single worker).
+			 *
+			 * @return false if no task was queued
+			 */
+			bool runTask();
+
+			/**
+			 * Calls `f(i)` for each `i` in `[0, count)`, in parallel, and
+			 * returns once all the calls are completed.
+			 *
+			 * The calling thread executes tasks while it waits, so that
+			 * parallelFor() can be called from a task without blocking a
+			 * worker.
+			 *
+			 * @param count count of calls
+			 * @param f function called for each index
+			 */
+			void parallelFor(std::size_t count, const std::function<void(std::size_t)>& f);
+
+			/**
+			 * Waits for all the queued tasks to be executed, and stops the
+			 * workers.
+			 */
+			~ThreadPool();
+	};
+}
+#endif
+#endif
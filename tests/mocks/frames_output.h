@@ -0,0 +1,25 @@
+#include "pixled/output.h"
+
+#include <vector>
+
+namespace pixled {
+	/*
+	 * Output that keeps all the written frames.
+	 */
+	class FramesOutput : public Output {
+		public:
+			std::vector<std::vector<std::uint8_t>> frames;
+			std::size_t ended_frames = 0;
+
+			void write(const color&, std::size_t) override {
+			}
+
+			void writeFrame(const std::uint8_t* frame, std::size_t led_count) override {
+				frames.emplace_back(frame, frame + 3*led_count);
+			}
+
+			void endFrame() override {
+				ended_frames++;
+			}
+	};
+}
@@ -0,0 +1,9 @@
+#include "pixled/output.h"
+#include "gmock/gmock.h"
+
+namespace pixled {
+	class MockOutput : public Output {
+		public:
+			MOCK_METHOD(void, write, (const color&, std::size_t), (override));
+	};
+}
@@ -38,6 +38,39 @@ TEST(RainbowTest, test) {
 	ASSERT_FLOAT_EQ(color.brightness(), 0.4f);
 }
 
+TEST(RainbowTest, periodicity) {
+	pixled::animation::Rainbow h {12};
+	pixled::animation::Wave<float> b {8, .5f, .2f};
+
+	ASSERT_EQ(h.periodicity(), 12);
+	ASSERT_EQ(pixled::chroma::hsb(h, 1.f, b).periodicity(), 24);
+
+	pixled::animation::Rainbow h_t {pixled::chrono::T()};
+	ASSERT_EQ(h_t.periodicity(), 0);
+}
+
+TEST(WaveTest, periodicity) {
+	pixled::animation::RadialRainbowWave wave {10.f, 30, pixled::point(2, 3)};
+	ASSERT_EQ(wave.periodicity(), 30);
+
+	pixled::animation::LinearUnitWave unit_wave {
+		10.f, 6, pixled::line({0, 0}, {1, 1})
+	};
+	ASSERT_EQ(unit_wave.periodicity(), 6);
+}
+
+TEST(WaveTest, large_time) {
+	pixled::animation::Wave<float> wave {1000, 1.f, 1.f};
+	pixled::animation::RadialRainbowWave rainbow_wave {10.f, 1000, pixled::point(0, 0)};
+	pixled::led l {{2, 3}, 0};
+
+	// Times are reduced modulo the period before any float conversion
+	for(pixled::time t : {0ul, 250ul, 700ul}) {
+		ASSERT_FLOAT_EQ(wave(l, t + 4000000000ul), wave(l, t));
+		ASSERT_FLOAT_EQ(rainbow_wave(l, t + 4000000000ul), rainbow_wave(l, t));
+	}
+}
+
 class SequenceTest : public ::testing::Test {
 	protected:
 		NiceMock<pixled::MockFunction<pixled::color>> f1;
@@ -80,6 +113,48 @@ TEST_F(SequenceTest, sequence_test) {
 	}
 }
 
+TEST_F(SequenceTest, periodicity) {
+	// Periods of the mock animations are unknown
+	ASSERT_EQ(seq.periodicity(), 0);
+
+	pixled::animation::Sequence constant_seq {
+		{
+			{pixled::chroma::rgb(255, 0, 0), 10},
+			{pixled::chroma::rgb(0, 255, 0), 5},
+			{pixled::animation::Blink(pixled::chroma::rgb(0, 0, 255), 4), 13}
+		}
+	};
+	ASSERT_EQ(constant_seq.periodicity(), 28);
+}
+
+TEST_F(SequenceTest, may_change) {
+	pixled::animation::Sequence constant_seq {
+		{
+			{pixled::chroma::rgb(255, 0, 0), 10},
+			{pixled::chroma::rgb(0, 255, 0), 5}
+		}
+	};
+	for(pixled::time t = 0; t < 30; t++)
+		ASSERT_EQ(constant_seq.mayChange(fake_led, t), t % 15 == 9 || t % 15 == 14);
+}
+
+TEST_F(SequenceTest, out_of_order) {
+	for(pixled::time t : {27ul, 3ul, 12ul, 56ul + 16, 10ul, 28ul * 1000 + 14}) {
+		switch(t % 28 < 10 ? 0 : t % 28 < 15 ? 1 : 2) {
+			case 0:
+				EXPECT_CALL(*f1.last_copy, call(fake_led, t));
+				break;
+			case 1:
+				EXPECT_CALL(*f2.last_copy, call(fake_led, t));
+				break;
+			default:
+				EXPECT_CALL(*f3.last_copy, call(fake_led, t));
+		}
+		seq(fake_led, t);
+	}
+	ASSERT_TRUE(seq.stateless());
+}
+
 TEST_F(SequenceTest, copy_test) {
 	pixled::FctWrapper<pixled::color> copy(seq); 
 
@@ -128,3 +203,33 @@ TEST(BlinkTest, test) {
 		}
 	}
 }
+
+TEST(BlinkTest, may_change) {
+	NiceMock<pixled::MockFunction<pixled::color>> anim;
+	pixled::led l ({6, -4}, 2);
+	pixled::animation::Blink blink(anim, 12);
+	pixled::animation::Blink constant_blink(pixled::chroma::rgb(255, 0, 0), 12);
+
+	ON_CALL(*anim.last_copy, call)
+		.WillByDefault(Return(pixled::color::rgb(255, 0, 0)));
+
+	for(pixled::time t = 0; t < 12; t++) {
+		bool on = blink(l, t).red() > 0;
+		bool next_on = blink(l, t+1).red() > 0;
+		// The mock animation always may change
+		ASSERT_EQ(blink.mayChange(l, t), on || next_on);
+		ASSERT_EQ(constant_blink.mayChange(l, t), on != next_on);
+	}
+}
+
+TEST(BloomingTest, may_change) {
+	pixled::animation::Blooming blooming(
+			pixled::chroma::hsb(pixled::animation::Rainbow(20), 1.f, 1.f),
+			pixled::point(0, 0), 2.f
+			);
+
+	// Rainbow changes in the blooming radius
+	ASSERT_TRUE(blooming.mayChange({{1, 1}, 0}, 4));
+	// Black out of the radius
+	ASSERT_FALSE(blooming.mayChange({{10, 1}, 0}, 4));
+}
@@ -0,0 +1,127 @@
+#include "pixled/arena.h"
+#include "pixled/animation/animation.h"
+#include "pixled/chroma/chroma.h"
+#include "gmock/gmock.h"
+
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+class ArenaTest : public Test {
+	protected:
+		pixled::animation::Rainbow rainbow {20};
+		pixled::chroma::hsb anim {rainbow, 1.f, pixled::animation::Wave<float>(10, .5f, .2f)};
+		// hsb, Rainbow and Wave. Constants and T are stored inline.
+		const std::size_t node_count = 3;
+
+		void SetUp() override {
+			pixled::resetAllocationStats();
+		}
+};
+
+TEST_F(ArenaTest, heap) {
+	{
+		pixled::FctWrapper<pixled::color> copy(anim);
+		ASSERT_EQ(pixled::allocationStats().heap_allocations, node_count);
+		ASSERT_EQ(pixled::allocationStats().arena_allocations, 0);
+	}
+	ASSERT_EQ(pixled::allocationStats().heap_deallocations, node_count);
+}
+
+TEST_F(ArenaTest, arena) {
+	pixled::Arena arena(1024);
+	{
+		pixled::ArenaScope scope(arena);
+		pixled::FctWrapper<pixled::color> copy(anim);
+
+		ASSERT_EQ(pixled::allocationStats().heap_allocations, 0);
+		ASSERT_EQ(pixled::allocationStats().arena_allocations, node_count);
+		ASSERT_EQ(arena.allocations(), node_count);
+		ASSERT_EQ(pixled::allocationStats().arena_bytes, arena.used());
+
+		// Topological order: functions are allocated before their arguments
+		auto& hsb = dynamic_cast<const pixled::chroma::hsb&>(*copy);
+		ASSERT_TRUE(arena.contains(&hsb));
+		ASSERT_TRUE(arena.contains(&hsb.arg<0>()));
+		ASSERT_LT((void*) &hsb, (void*) &hsb.arg<0>());
+		ASSERT_LT((void*) &hsb, (void*) &hsb.arg<2>());
+
+		for(pixled::time t = 0; t < 20; t++) {
+			pixled::color c = (*copy)({{0, 0}, 0}, t);
+			pixled::color expected = anim({{0, 0}, 0}, t);
+			ASSERT_EQ(c.red(), expected.red());
+			ASSERT_EQ(c.green(), expected.green());
+			ASSERT_EQ(c.blue(), expected.blue());
+		}
+	}
+	ASSERT_EQ(pixled::allocationStats().heap_deallocations, 0);
+
+	arena.clear();
+	ASSERT_EQ(arena.used(), 0);
+}
+
+TEST_F(ArenaTest, user_buffer) {
+	alignas(std::max_align_t) static std::uint8_t buffer[1024];
+	pixled::Arena arena(buffer, sizeof(buffer));
+	pixled::ArenaScope scope(arena);
+	pixled::FctWrapper<pixled::color> copy(anim);
+
+	ASSERT_EQ(pixled::allocationStats().heap_allocations, 0);
+	ASSERT_TRUE(arena.contains(&*copy));
+	ASSERT_EQ(pixled::Arena::find(&*copy), &arena);
+}
+
+TEST_F(ArenaTest, overflow) {
+	pixled::Arena arena(sizeof(pixled::chroma::hsb) + sizeof(pixled::animation::Rainbow));
+	{
+		pixled::ArenaScope scope(arena);
+		pixled::FctWrapper<pixled::color> copy(anim);
+
+		ASSERT_EQ(pixled::allocationStats().arena_allocations, 2);
+		ASSERT_EQ(pixled::allocationStats().heap_allocations, node_count - 2);
+	}
+	ASSERT_EQ(pixled::allocationStats().heap_deallocations, node_count - 2);
+}
+
+TEST_F(ArenaTest, nested_scopes) {
+	pixled::Arena arena1(1024);
+	pixled::Arena arena2(1024);
+	pixled::ArenaScope scope1(arena1);
+	{
+		pixled::ArenaScope scope2(arena2);
+		pixled::FctWrapper<float> f(rainbow);
+		ASSERT_TRUE(arena2.contains(&*f));
+	}
+	pixled::FctWrapper<float> f(rainbow);
+	ASSERT_TRUE(arena1.contains(&*f));
+}
+
+TEST_F(ArenaTest, threads) {
+	pixled::Arena arena(1024);
+	pixled::ArenaScope scope(arena);
+
+	// Each thread copies and destroys Functions, while another Arena is
+	// created and destroyed on each thread
+	const std::size_t THREADS = 4;
+	const std::size_t COPIES = 200;
+	std::vector<std::thread> threads;
+	std::vector<char> in_arena(THREADS, false);
+	for(std::size_t i = 0; i < THREADS; i++)
+		threads.emplace_back([this, i, &arena, &in_arena] {
+				for(std::size_t n = 0; n < COPIES; n++) {
+					pixled::Arena local(1024);
+					pixled::FctWrapper<pixled::color> copy(anim);
+					in_arena[i] = in_arena[i] || arena.contains(&*copy);
+				}
+				});
+	for(auto& thread : threads)
+		thread.join();
+
+	// The ArenaScope is only active on the main thread
+	for(char b : in_arena)
+		ASSERT_FALSE(b);
+	ASSERT_EQ(arena.allocations(), 0);
+	ASSERT_EQ(pixled::allocationStats().heap_allocations, THREADS * COPIES * node_count);
+	ASSERT_EQ(pixled::allocationStats().heap_deallocations, THREADS * COPIES * node_count);
+}
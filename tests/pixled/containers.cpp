@@ -0,0 +1,67 @@
+#include "pixled/containers.h"
+#include "gmock/gmock.h"
+
+#include <memory>
+
+using namespace testing;
+
+TEST(StaticVector, push_back) {
+	pixled::static_vector<int, 8> v;
+	ASSERT_TRUE(v.empty());
+	ASSERT_EQ(v.capacity(), 8);
+
+	for(int i = 0; i < 8; i++)
+		v.push_back(i);
+	ASSERT_EQ(v.size(), 8);
+	ASSERT_THAT(v, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+	ASSERT_EQ(v.front(), 0);
+	ASSERT_EQ(v.back(), 7);
+}
+
+TEST(StaticVector, resize) {
+	pixled::static_vector<int, 8> v(3, 4);
+	ASSERT_THAT(v, ElementsAre(4, 4, 4));
+
+	v.resize(5, 1);
+	ASSERT_THAT(v, ElementsAre(4, 4, 4, 1, 1));
+	v.resize(2);
+	ASSERT_THAT(v, ElementsAre(4, 4));
+	v.assign(3, 2);
+	ASSERT_THAT(v, ElementsAre(2, 2, 2));
+}
+
+TEST(StaticVector, copy_move) {
+	pixled::static_vector<std::shared_ptr<int>, 4> v;
+	auto item = std::make_shared<int>(4);
+	v.push_back(item);
+	v.emplace_back(item);
+
+	pixled::static_vector<std::shared_ptr<int>, 4> copy(v);
+	ASSERT_EQ(item.use_count(), 5);
+
+	pixled::static_vector<std::shared_ptr<int>, 4> moved(std::move(copy));
+	ASSERT_TRUE(copy.empty());
+	ASSERT_EQ(item.use_count(), 5);
+
+	moved = v;
+	ASSERT_EQ(item.use_count(), 5);
+	moved.clear();
+	v.pop_back();
+	ASSERT_EQ(item.use_count(), 2);
+}
+
+TEST(StaticVector, destructor) {
+	auto item = std::make_shared<int>(4);
+	{
+		pixled::static_vector<std::shared_ptr<int>, 4> v(3, item);
+		ASSERT_EQ(item.use_count(), 4);
+	}
+	ASSERT_EQ(item.use_count(), 1);
+}
+
+TEST(StaticVector, overflow) {
+	pixled::static_vector<int, 2> v;
+	v.push_back(1);
+	v.push_back(2);
+	ASSERT_DEATH(v.push_back(3), "");
+}
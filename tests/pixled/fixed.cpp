@@ -0,0 +1,85 @@
+#include "pixled/fixed.h"
+#include "pixled/color.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/arithmetic/arithmetic.h"
+#include "pixled/chrono/chrono.h"
+#include "gmock/gmock.h"
+
+#include <random>
+
+using namespace testing;
+
+using pixled::fixed;
+
+TEST(Fixed, build) {
+	ASSERT_EQ(fixed().raw(), 0);
+	ASSERT_EQ(fixed(3).raw(), 3 * fixed::ONE);
+	ASSERT_EQ(fixed(-2).raw(), -2 * fixed::ONE);
+	ASSERT_EQ(fixed(.5f).raw(), fixed::ONE / 2);
+	ASSERT_EQ(fixed(-.25).raw(), -fixed::ONE / 4);
+	ASSERT_EQ(fixed::fromRaw(12).raw(), 12);
+	ASSERT_FLOAT_EQ(static_cast<float>(fixed(1.75f)), 1.75f);
+}
+
+TEST(Fixed, arithmetic) {
+	ASSERT_EQ(fixed(1.5f) + fixed(2), fixed(3.5f));
+	ASSERT_EQ(fixed(1.5f) - fixed(2), fixed(-.5f));
+	ASSERT_EQ(-fixed(1.5f), fixed(-1.5f));
+	ASSERT_EQ(fixed(1.5f) * fixed(-2), fixed(-3));
+	ASSERT_EQ(fixed(3) / fixed(4), fixed(.75f));
+	ASSERT_EQ(fixed(-3) / fixed(4), fixed(-.75f));
+	ASSERT_EQ(fixed(7.5f) % fixed(2), fixed(1.5f));
+	ASSERT_EQ(fixed(-7.5f) % fixed(2), fixed(-1.5f));
+
+	std::mt19937 rd;
+	std::uniform_real_distribution<float> rd_value(-100, 100);
+	for(int i = 0; i < 100; i++) {
+		float a = rd_value(rd);
+		float b = rd_value(rd);
+		ASSERT_NEAR(static_cast<float>(fixed(a) * fixed(b)), a * b, 1e-2);
+		ASSERT_NEAR(static_cast<float>(fixed(a) / fixed(b)), a / b, 1e-2);
+	}
+}
+
+TEST(Fixed, comparison) {
+	ASSERT_TRUE(fixed(1) < fixed(1.5f));
+	ASSERT_TRUE(fixed(1) <= fixed(1));
+	ASSERT_TRUE(fixed(-1) > fixed(-1.5f));
+	ASSERT_TRUE(fixed(2) >= fixed(2));
+	ASSERT_TRUE(fixed(2) != fixed(2.5f));
+	ASSERT_TRUE(fixed(2) == 2);
+}
+
+TEST(Fixed, functions) {
+	using namespace pixled;
+
+	// Common type between fixed and float is fixed
+	auto f = fixed(2) * Cast<fixed>(chrono::T()) + .5f;
+	static_assert(std::is_same<decltype(f)::Type, fixed>::value,
+			"fixed Functions must return fixed");
+	ASSERT_EQ(f({{0, 0}, 0}, 3), fixed(6.5f));
+
+	auto to_float = Cast<float>(f);
+	ASSERT_FLOAT_EQ(to_float({{0, 0}, 0}, 3), 6.5f);
+}
+
+TEST(Fixed, hsb) {
+	for(float h = -60; h <= 720; h += 7.5f) {
+		for(float s = 0; s <= 1; s += .125f) {
+			for(float b = 0; b <= 1; b += .125f) {
+				pixled::color expected = pixled::color::hsb(h, s, b);
+				pixled::color c = pixled::color::hsb(fixed(h), fixed(s), fixed(b));
+				ASSERT_NEAR(c.red(), expected.red(), 1);
+				ASSERT_NEAR(c.green(), expected.green(), 1);
+				ASSERT_NEAR(c.blue(), expected.blue(), 1);
+				ASSERT_FLOAT_EQ(c.hue(), h);
+			}
+		}
+	}
+
+	pixled::chroma::fixed_hsb hsb(fixed(120), 1, fixed(.5f));
+	pixled::color c = hsb({{0, 0}, 0}, 0);
+	ASSERT_EQ(c.red(), 0);
+	ASSERT_EQ(c.green(), 127);
+	ASSERT_EQ(c.blue(), 0);
+}
@@ -0,0 +1,130 @@
+#include "pixled/frame_cache.h"
+#include "gmock/gmock.h"
+
+#include <memory>
+#include <random>
+
+using namespace testing;
+
+class FrameCacheTest : public TestWithParam<pixled::FRAME_ENCODING> {
+	protected:
+		static const pixled::time PERIOD = 40;
+		static const std::size_t LED_COUNT = 500;
+
+		std::mt19937 rd;
+		std::vector<std::vector<std::uint8_t>> frames;
+		std::unique_ptr<pixled::FrameCache> cache;
+
+		void SetUp() override {
+			std::uniform_int_distribution<int> rd_byte(0, 255);
+			// A random background
+			std::vector<std::uint8_t> frame(3*LED_COUNT);
+			for(auto& c : frame)
+				c = rd_byte(rd);
+			for(pixled::time t = 0; t < PERIOD; t++) {
+				// A uniform region that moves
+				for(std::size_t i = 10*t; i < 10*t + 100; i++) {
+					frame[3*i] = t;
+					frame[3*i+1] = 0;
+					frame[3*i+2] = 255;
+				}
+				// A few random leds
+				for(std::size_t i = 0; i < 20; i++)
+					frame[3*(rd() % LED_COUNT) + rd() % 3] = rd_byte(rd);
+				frames.push_back(frame);
+			}
+
+			switch(GetParam()) {
+				case pixled::RAW_FRAMES:
+					cache.reset(new pixled::RawFrameCache(PERIOD, LED_COUNT));
+					break;
+				case pixled::DELTA_FRAMES:
+					cache.reset(new pixled::DeltaFrameCache(PERIOD, LED_COUNT, 16));
+					break;
+			}
+		}
+
+		void checkFrame(pixled::time t) {
+			const std::uint8_t* frame = cache->load(t);
+			ASSERT_THAT(
+					std::vector<std::uint8_t>(frame, frame + cache->frameSize()),
+					ElementsAreArray(frames[t % PERIOD])
+					);
+		}
+};
+
+TEST_P(FrameCacheTest, sequential) {
+	for(pixled::time t = 0; t < PERIOD; t++) {
+		ASSERT_FALSE(cache->contains(t));
+		cache->store(t, frames[t].data());
+		ASSERT_TRUE(cache->contains(t + PERIOD));
+		checkFrame(t);
+	}
+	ASSERT_TRUE(cache->complete());
+
+	for(pixled::time t = PERIOD; t < 3*PERIOD; t++)
+		checkFrame(t);
+	for(pixled::time t = 3*PERIOD; t > 0; t--)
+		checkFrame(t-1);
+	for(int i = 0; i < 100; i++)
+		checkFrame(rd() % PERIOD);
+}
+
+TEST_P(FrameCacheTest, random_order) {
+	std::vector<pixled::time> slots;
+	for(pixled::time t = 0; t < PERIOD; t++)
+		slots.push_back(t);
+	std::shuffle(slots.begin(), slots.end(), rd);
+
+	for(auto t : slots) {
+		ASSERT_FALSE(cache->complete());
+		cache->store(t, frames[t].data());
+	}
+	ASSERT_TRUE(cache->complete());
+
+	for(int i = 0; i < 100; i++)
+		checkFrame(rd() % PERIOD);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameCache, FrameCacheTest, Values(
+			pixled::RAW_FRAMES, pixled::DELTA_FRAMES
+			));
+
+TEST(DeltaFrameCache, compression) {
+	const std::size_t led_count = 10000;
+	pixled::RawFrameCache raw_cache(8, led_count);
+	pixled::DeltaFrameCache delta_cache(8, led_count);
+
+	std::vector<std::uint8_t> frame(3*led_count);
+	for(pixled::time t = 0; t < 8; t++) {
+		// A single moving led, over a uniform background
+		frame[3*t] = 0;
+		frame[3*(t+1)] = 255;
+		raw_cache.store(t, frame.data());
+		delta_cache.store(t, frame.data());
+	}
+	for(pixled::time t = 0; t < 8; t++) {
+		const std::uint8_t* raw_frame = raw_cache.load(t);
+		const std::uint8_t* delta_frame = delta_cache.load(t);
+		ASSERT_THAT(
+				std::vector<std::uint8_t>(delta_frame, delta_frame + delta_cache.frameSize()),
+				ElementsAreArray(raw_frame, raw_cache.frameSize())
+				);
+	}
+	ASSERT_EQ(raw_cache.memory(), 8*3*led_count);
+	// Only the decoding buffer is significant
+	ASSERT_LT(delta_cache.memory(), 3*led_count + 1000);
+}
+
+TEST(DeltaFrameCache, zero_keyframe_interval) {
+	pixled::DeltaFrameCache cache(4, 10, 0);
+
+	std::vector<std::uint8_t> frame(3*10);
+	for(pixled::time t = 0; t < 4; t++) {
+		frame[3*t] = 255;
+		cache.store(t, frame.data());
+	}
+	ASSERT_TRUE(cache.complete());
+	const std::uint8_t* last = cache.load(3);
+	ASSERT_THAT(std::vector<std::uint8_t>(last, last + cache.frameSize()), ElementsAreArray(frame));
+}
@@ -0,0 +1,68 @@
+#include "pixled/frame_stats.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+TEST(FrameStats, empty) {
+	pixled::FrameStats stats;
+	ASSERT_EQ(stats.frames(), 0);
+	ASSERT_EQ(stats.frameTimes().max, 0);
+	ASSERT_EQ(stats.ledsPerSecond(), 0);
+}
+
+TEST(FrameStats, percentiles) {
+	pixled::FrameStats stats(1000);
+	ASSERT_EQ(stats.frameBudget(), 1000);
+
+	// Frame times from 1 to 100 microseconds, then a dropped frame
+	for(std::uint32_t i = 1; i <= 100; i++)
+		stats.record(i, 0, 10);
+	stats.record(900, 200, 10);
+	ASSERT_EQ(stats.frames(), 101);
+	ASSERT_EQ(stats.droppedFrames(), 1);
+
+	pixled::FrameStats::Percentiles render = stats.renderTimes();
+	ASSERT_EQ(render.p50, 51);
+	ASSERT_EQ(render.p99, 100);
+	ASSERT_EQ(render.max, 900);
+	ASSERT_EQ(stats.outputTimes().p50, 0);
+	ASSERT_EQ(stats.outputTimes().max, 200);
+	ASSERT_EQ(stats.frameTimes().max, 1100);
+
+	// 1010 leds in 6150 us
+	ASSERT_NEAR(stats.ledsPerSecond(), 1010 * 1e6 / 6150, 1e-3);
+
+	stats.reset();
+	ASSERT_EQ(stats.frames(), 0);
+	ASSERT_EQ(stats.droppedFrames(), 0);
+}
+
+TEST(FrameStats, rolling_window) {
+	pixled::FrameStats stats;
+	stats.record(5000, 0, 1);
+	for(std::size_t i = 0; i < pixled::FrameStats::WINDOW; i++)
+		stats.record(10, 0, 1);
+	// The slow frame is out of the window
+	ASSERT_EQ(stats.renderTimes().max, 10);
+	// Dropped frames are not counted without budget
+	ASSERT_EQ(stats.droppedFrames(), 0);
+}
+
+static void count_calls(const pixled::FrameStats& stats, void* user_data) {
+	std::vector<unsigned long>& calls = *static_cast<std::vector<unsigned long>*>(user_data);
+	calls.push_back(stats.frames());
+}
+
+TEST(FrameStats, callback) {
+	std::vector<unsigned long> calls;
+	pixled::FrameStats stats;
+	stats.setCallback(count_calls, &calls, 4);
+	for(int i = 0; i < 10; i++)
+		stats.record(1, 1, 1);
+	ASSERT_THAT(calls, ElementsAre(4, 8));
+
+	stats.setCallback(nullptr, nullptr, 0);
+	for(int i = 0; i < 10; i++)
+		stats.record(1, 1, 1);
+	ASSERT_THAT(calls, SizeIs(2));
+}
@@ -0,0 +1,170 @@
+#include "pixled/frame_stream.h"
+#include "pixled/runtime.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/chrono/chrono.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/arithmetic/arithmetic.h"
+#include "pixled/conditional/conditional.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+#include "../mocks/frames_output.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace testing;
+using namespace pixled;
+
+class FrameStreamTest : public TestWithParam<FRAME_STREAM_ENCODING> {
+	protected:
+		const char* path = "frame_stream_test.pxfs";
+		mapping::LedStrip strip {40};
+		// Large runs of a single color, and a moving gradient
+		chroma::rgb animation {
+			conditional::If<std::uint8_t>(geometry::X() < 20.f,
+					Cast<std::uint8_t>(chrono::T()),
+					Cast<std::uint8_t>(geometry::X() + chrono::T())),
+			0,
+			255
+		};
+
+		void TearDown() override {
+			std::remove(path);
+		}
+
+		void record(FRAME_STREAM_ENCODING encoding, std::size_t frames) {
+			FrameRecorder recorder(path, strip, 30, encoding);
+			ASSERT_TRUE(recorder.isOpen());
+			ASSERT_EQ(recorder.ledCount(), 40);
+			Runtime runtime(strip, recorder, animation);
+			for(std::size_t i = 0; i < frames; i++)
+				runtime.next();
+			ASSERT_EQ(recorder.frames(), frames);
+		}
+
+		void checkFrame(pixled::time t, const std::vector<std::uint8_t>& frame) {
+			ASSERT_EQ(frame.size(), 3*40);
+			for(auto l : strip.leds()) {
+				color c = animation(l, t);
+				ASSERT_EQ(frame[3*l.index], c.red());
+				ASSERT_EQ(frame[3*l.index+1], c.green());
+				ASSERT_EQ(frame[3*l.index+2], c.blue());
+			}
+		}
+
+		std::size_t fileSize() {
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			return file.tellg();
+		}
+};
+
+TEST_P(FrameStreamTest, record_play) {
+	record(GetParam(), 20);
+
+	FramePlayer player(path);
+	ASSERT_TRUE(player.isOpen());
+	ASSERT_EQ(player.ledCount(), 40);
+	ASSERT_FLOAT_EQ(player.fps(), 30);
+	ASSERT_EQ(player.mappingHash(), mappingHash(strip));
+	ASSERT_EQ(player.frameCount(), 20);
+
+	FramesOutput output;
+	while(player.next(output));
+	ASSERT_EQ(output.frames.size(), 20);
+	ASSERT_EQ(output.ended_frames, 20);
+	for(pixled::time t = 0; t < 20; t++)
+		checkFrame(t, output.frames[t]);
+
+	// Random access
+	player.seek(7);
+	ASSERT_TRUE(player.next(output));
+	checkFrame(7, output.frames.back());
+	player.play(3, output);
+	checkFrame(3, output.frames.back());
+	ASSERT_EQ(player.position(), 8);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameStream, FrameStreamTest, Values(RAW_STREAM, RLE_STREAM));
+
+TEST_F(FrameStreamTest, replay) {
+	record(RLE_STREAM, 12);
+	const char* copy_path = "frame_stream_test_copy.pxfs";
+	{
+		// Frames played to a FrameRecorder are recorded again
+		FramePlayer player(path);
+		FrameRecorder recorder(copy_path, strip, player.fps(), RAW_STREAM);
+		while(player.next(recorder));
+		ASSERT_EQ(recorder.frames(), 12);
+	}
+	FramePlayer copy(copy_path);
+	ASSERT_EQ(copy.frameCount(), 12);
+	FramesOutput output;
+	while(copy.next(output));
+	for(pixled::time t = 0; t < 12; t++)
+		checkFrame(t, output.frames[t]);
+	std::remove(copy_path);
+}
+
+TEST_F(FrameStreamTest, rle_size) {
+	record(RAW_STREAM, 10);
+	std::size_t raw_size = fileSize();
+	ASSERT_EQ(raw_size, frame_stream::HEADER_SIZE + 10 * (frame_stream::CHUNK_HEADER_SIZE + 3*40));
+
+	record(RLE_STREAM, 10);
+	// The first 20 leds are stored in a single run, and each of the 20
+	// leds of the gradient in its own run
+	ASSERT_EQ(fileSize(), frame_stream::HEADER_SIZE + 10 * (frame_stream::CHUNK_HEADER_SIZE + 4*21));
+}
+
+TEST_F(FrameStreamTest, zero_copy) {
+	record(RAW_STREAM, 2);
+	FramePlayer player(path);
+
+	class PointerOutput : public Output {
+		public:
+			const std::uint8_t* frame = nullptr;
+			void write(const color&, std::size_t) override {
+			}
+			void writeFrame(const std::uint8_t* frame, std::size_t) override {
+				this->frame = frame;
+			}
+	} output;
+	player.play(0, output);
+	const std::uint8_t* first = output.frame;
+	player.play(1, output);
+	// Frames are read from the file mapping
+	ASSERT_EQ(output.frame, first + frame_stream::CHUNK_HEADER_SIZE + 3*40);
+}
+
+TEST_F(FrameStreamTest, truncated) {
+	record(RAW_STREAM, 5);
+	std::size_t size = fileSize();
+	ASSERT_EQ(truncate(path, size - 10), 0);
+
+	FramePlayer player(path);
+	ASSERT_TRUE(player.isOpen());
+	ASSERT_EQ(player.frameCount(), 4);
+}
+
+TEST_F(FrameStreamTest, invalid) {
+	FramePlayer missing("missing.pxfs");
+	ASSERT_FALSE(missing.isOpen());
+
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << "not a frame stream, but long enough for a header";
+	}
+	FramePlayer invalid(path);
+	ASSERT_FALSE(invalid.isOpen());
+}
+
+TEST(FrameStream, mapping_hash) {
+	mapping::LedStrip strip1 {40};
+	mapping::LedStrip strip2 {40};
+	mapping::LedStrip strip3 {41};
+	mapping::LedPanel panel {5, 8, mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM};
+
+	ASSERT_EQ(mappingHash(strip1), mappingHash(strip2));
+	ASSERT_NE(mappingHash(strip1), mappingHash(strip3));
+	ASSERT_NE(mappingHash(strip1), mappingHash(panel));
+}
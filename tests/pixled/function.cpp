@@ -1,6 +1,7 @@
 #include "../mocks/mock_function.h"
 #include "pixled/chrono/chrono.h"
 #include "pixled/geometry/geometry.h"
+#include "pixled/arithmetic/arithmetic.h"
 
 using namespace testing;
 
@@ -28,6 +29,14 @@ TEST(Constant, copy) {
 	delete copy;
 }
 
+TEST(Constant, periodicity) {
+	Constant<double> constant {3.45};
+
+	ASSERT_EQ(constant.periodicity(), 1);
+	ASSERT_THAT(constant.constant(), Pointee(3.45));
+	ASSERT_FALSE(constant.mayChange({{0, 0}, 1}, 8));
+}
+
 class FctWrapperTest : public Test {
 	protected:
 	pixled::MockFunction<float> fct;
@@ -117,6 +126,46 @@ TEST_F(FctWrapperTest, move_assignment) {
 	ASSERT_EQ(&*w2, copy);
 }
 
+TEST(FctWrapperInlineTest, constant) {
+	pixled::resetAllocationStats();
+	FctWrapper<float> w1 {2.35f};
+	FctWrapper<float> w2 {Constant<float>(1.2f)};
+	FctWrapper<float> w3 {w1};
+	FctWrapper<float> w4 {std::move(w2)};
+	w2 = w3;
+
+	ASSERT_EQ(pixled::allocationStats().heap_allocations, 0);
+	ASSERT_THAT(&*w1, WhenDynamicCastTo<const Constant<float>*>(Not(IsNull())));
+	ASSERT_FLOAT_EQ(w1({{2, 6}, 1}, 24), 2.35f);
+	ASSERT_FLOAT_EQ(w2({{2, 6}, 1}, 24), 2.35f);
+	ASSERT_FLOAT_EQ(w3({{2, 6}, 1}, 24), 2.35f);
+	ASSERT_FLOAT_EQ(w4({{2, 6}, 1}, 24), 1.2f);
+	ASSERT_THAT((*w4).constant(), Pointee(1.2f));
+}
+
+TEST(FctWrapperInlineTest, leaves) {
+	pixled::resetAllocationStats();
+	FctWrapper<pixled::time> t {pixled::chrono::T()};
+	FctWrapper<pixled::coordinate> x {pixled::geometry::X()};
+	FctWrapper<pixled::index_t> i {pixled::geometry::I()};
+
+	ASSERT_EQ(pixled::allocationStats().heap_allocations, 0);
+	ASSERT_EQ(t({{2, 6}, 1}, 24), 24);
+	ASSERT_FLOAT_EQ(x({{2, 6}, 1}, 24), 2);
+	ASSERT_EQ(i({{2, 6}, 1}, 24), 1);
+}
+
+TEST(FctWrapperInlineTest, move) {
+	FctWrapper<float> w1 {3.f};
+	FctWrapper<float> w2 {std::move(w1)};
+	FctWrapper<float> w3 {4.f};
+	w3 = std::move(w2);
+
+	// Inline functions are copied, and destroyed once and exactly once
+	ASSERT_FLOAT_EQ(w3({{2, 6}, 1}, 24), 3.f);
+	ASSERT_THAT((*w3).constant(), Pointee(3.f));
+}
+
 /**
  * Tests basic pixled::Function features with a single parameter.
  *
@@ -307,3 +356,51 @@ TEST(Cast, rvalue) {
 
 	ASSERT_FLOAT_EQ(function({{14.5, 0}, 7}, 10), 14);
 }
+
+TEST(Cast, periodicity) {
+	ASSERT_EQ(pixled::Cast<float>(pixled::chrono::T()).periodicity(), 0);
+	ASSERT_EQ(pixled::Cast<int>(pixled::geometry::X()).periodicity(), 1);
+}
+
+TEST(Cast, may_change) {
+	pixled::led l {{2, 4}, 3};
+	ASSERT_TRUE(pixled::Cast<float>(pixled::chrono::T()).mayChange(l, 10));
+	ASSERT_FALSE(pixled::Cast<int>(pixled::geometry::X()).mayChange(l, 10));
+}
+
+/*
+ * Function that counts its calls.
+ */
+class StatefulFunction : public pixled::base::Function<float> {
+	public:
+		mutable float count = 0;
+
+		float operator()(pixled::led, pixled::time) const override {
+			return count++;
+		}
+
+		StatefulFunction* copy() const override {
+			return new StatefulFunction;
+		}
+
+		bool stateless() const override {
+			return false;
+		}
+};
+
+TEST(Stateless, propagation) {
+	using namespace pixled;
+	ASSERT_TRUE(Cast<float>(chrono::T()).stateless());
+	ASSERT_TRUE((2.f * Cast<float>(chrono::T()) + geometry::X()).stateless());
+
+	StatefulFunction stateful;
+	ASSERT_FALSE(Cast<int>(stateful).stateless());
+	ASSERT_FALSE((2.f * Cast<float>(chrono::T()) + stateful).stateless());
+}
+
+TEST(Periodicity, lcm) {
+	ASSERT_EQ(pixled::detail::periodicity_lcm(4, 6), 12);
+	ASSERT_EQ(pixled::detail::periodicity_lcm(1, 7), 7);
+	ASSERT_EQ(pixled::detail::periodicity_lcm(0, 7), 0);
+	ASSERT_EQ(pixled::detail::periodicity_lcm(5, 0), 0);
+}
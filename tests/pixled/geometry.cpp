@@ -1,6 +1,8 @@
 #include "pixled/geometry.h"
 #include "gtest/gtest.h"
 
+#include <sstream>
+
 using namespace pixled;
 
 TEST(line, line_definition) {
@@ -113,3 +115,40 @@ TEST(bounding_box, include) {
 	ASSERT_FLOAT_EQ(bbox.width(), 15.-(-2.9));
 	ASSERT_FLOAT_EQ(bbox.height(), 12-(-4));
 }
+
+TEST(point, distance_3d) {
+	ASSERT_FLOAT_EQ(distance(point(1, 2), point(4, 6)), 5);
+	ASSERT_FLOAT_EQ(distance(point(1, 2, 3), point(3, 5, 9)), 7);
+}
+
+TEST(point, output) {
+	std::ostringstream o2;
+	o2 << point(1, 2);
+	ASSERT_EQ(o2.str(), "(1,2)");
+
+	std::ostringstream o3;
+	o3 << point(1, 2, 3);
+	ASSERT_EQ(o3.str(), "(1,2,3)");
+}
+
+TEST(plane, plane_definition) {
+	point p0(1, 2, 3);
+	point p1(-2, 0, 4);
+	point p2(5, 1, -1);
+
+	plane pl1(p0, p1, p2);
+	plane pl2(p0, point(pl1.a, pl1.b, pl1.c));
+
+	for(auto p : {p0, p1, p2}) {
+		ASSERT_NEAR(pl1.a * p.x + pl1.b * p.y + pl1.c * p.z + pl1.d, 0, 1e-4);
+		ASSERT_NEAR(pl2.a * p.x + pl2.b * p.y + pl2.c * p.z + pl2.d, 0, 1e-4);
+	}
+}
+
+TEST(plane, distance) {
+	plane pl(point(0, 0, 2), point(0, 0, 3));
+
+	ASSERT_FLOAT_EQ(distance(point(4, -7, 5), pl), 3);
+	ASSERT_FLOAT_EQ(distance(point(4, -7, -1), pl), 3);
+	ASSERT_FLOAT_EQ(distance(point(4, -7, 2), pl), 0);
+}
@@ -14,3 +14,28 @@ TEST(Y, test) {
 TEST(I, test) {
 	ASSERT_EQ(I()({{2, 4}, 3}, 18), 3);
 }
+
+TEST(Z, test) {
+	ASSERT_EQ(Z()({{2, 4}, 3}, 18), 0);
+	ASSERT_EQ(Z()({{2, 4, 7}, 3}, 18), 7);
+}
+
+TEST(Distance, test_3d) {
+	Distance d {Point3D(X(), Y(), Z()), pixled::point(3, 5, 9)};
+
+	ASSERT_FLOAT_EQ(d({{1, 2, 3}, 0}, 0), 7);
+	ASSERT_FLOAT_EQ(d({{0, 1}, 0}, 0), std::sqrt(3*3 + 4*4 + 9*9));
+}
+
+TEST(PlaneDistance, test) {
+	PlaneDistance d {
+		NormalPlane(pixled::point(0, 0, 2), pixled::point(0, 0, 1)),
+		Point3D(X(), Y(), Z())
+	};
+
+	ASSERT_FLOAT_EQ(d({{1, 2, 3}, 0}, 0), 1);
+	ASSERT_FLOAT_EQ(d({{1, 2}, 0}, 0), 2);
+
+	PlaneDistance d2 {Plane(1, 0, 0, -4), Point3D(X(), Y(), Z())};
+	ASSERT_FLOAT_EQ(d2({{1, 2, 3}, 0}, 0), 3);
+}
@@ -0,0 +1,319 @@
+#include "pixled.h"
+#include "gmock/gmock.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+/*
+ * Golden frame regression harness.
+ *
+ * The animations of the examples (examples/pixled) are rendered on standard
+ * mappings, and a checksum of each frame is compared to the golden checksums
+ * of tests/golden/frames.golden. Random engines use fixed seeds.
+ *
+ * Each golden line contains, for a frame of a scene on a mapping:
+ * - the 64 bits FNV-1a hash of the raw rgb frame, compared in exact mode;
+ * - each rgb component of each led, quantized on 4 bits (one hexadecimal
+ *   digit per component), compared in tolerance mode.
+ *
+ * Environment variables:
+ * - PIXLED_GOLDEN_TOLERANCE=n compares each component of each led to its
+ *   quantized golden value instead of the hashes, with a maximum difference
+ *   of n plus the quantization error (QUANTIZATION_ERROR). This is the mode
+ *   to use for changes that are expected to slightly change colors (e.g.
+ *   fast trigonometric approximations), or on platforms with a different
+ *   libm.
+ * - PIXLED_UPDATE_GOLDEN=1 rewrites the golden file from the current
+ *   output, once a change of the output is reviewed.
+ */
+
+using namespace testing;
+using namespace pixled;
+
+typedef std::function<Animation*()> AnimationBuilder;
+
+/*
+ * Builds a copy of an animation, so that the scene table can hold
+ * animations of any type.
+ */
+#define SCENE(name, ...) {name, [] () -> Animation* {\
+	return static_cast<const Animation&>(__VA_ARGS__).copy();}}
+
+static const std::size_t FRAMES = 20;
+static const pixled::time TIME_STEP = 3;
+static const unsigned long SEED = 42;
+
+/*
+ * A component c is stored as round(c / 17), on 4 bits, and restored as
+ * 17 times this value, with an error of at most 8.
+ */
+static const int QUANTIZATION_STEP = 17;
+static const int QUANTIZATION_ERROR = QUANTIZATION_STEP / 2;
+
+/*
+ * Checksums of a frame.
+ */
+struct Checksum {
+	std::uint64_t hash;
+	// Quantized rgb components of each led
+	std::vector<std::uint8_t> components;
+};
+
+static Checksum checksum(const std::vector<std::uint8_t>& frame) {
+	Checksum checksum;
+	checksum.hash = 0xcbf29ce484222325ull;
+	for(std::uint8_t byte : frame) {
+		checksum.hash ^= byte;
+		checksum.hash *= 0x100000001b3ull;
+		checksum.components.push_back((byte + QUANTIZATION_ERROR) / QUANTIZATION_STEP);
+	}
+	return checksum;
+}
+
+static std::string format(const Checksum& checksum) {
+	std::ostringstream line;
+	line << std::hex << std::setfill('0') << std::setw(16) << checksum.hash << ' ';
+	for(std::uint8_t component : checksum.components)
+		line << std::setw(1) << (unsigned int) component;
+	return line.str();
+}
+
+static bool parse(const std::string& text, Checksum& checksum) {
+	std::istringstream line(text);
+	std::string components;
+	if(!(line >> std::hex >> checksum.hash >> components) || components.size() % 3 != 0)
+		return false;
+	checksum.components.clear();
+	for(char digit : components) {
+		if(!std::isxdigit(digit))
+			return false;
+		checksum.components.push_back(std::stoul(std::string(1, digit), nullptr, 16));
+	}
+	return true;
+}
+
+/*
+ * Checks that each component of `frame` is within `tolerance` of its
+ * quantized golden value, in addition to the quantization error.
+ *
+ * @return index of the first component out of bounds, or -1
+ */
+static long compare(const std::vector<std::uint8_t>& frame, const Checksum& expected, int tolerance) {
+	if(frame.size() != expected.components.size())
+		return 0;
+	for(std::size_t i = 0; i < frame.size(); i++)
+		if(std::abs(frame[i] - QUANTIZATION_STEP * expected.components[i])
+				> tolerance + QUANTIZATION_ERROR)
+			return i;
+	return -1;
+}
+
+/*
+ * Output that keeps the last written frame.
+ */
+class FrameOutput : public Output {
+	public:
+		std::vector<std::uint8_t> frame;
+
+		FrameOutput(std::size_t led_count) : frame(3*led_count) {}
+
+		void write(const color& c, std::size_t i) override {
+			frame[3*i] = c.red();
+			frame[3*i+1] = c.green();
+			frame[3*i+2] = c.blue();
+		}
+};
+
+static const std::vector<std::pair<std::string, AnimationBuilder>>& scenes() {
+	static const std::vector<std::pair<std::string, AnimationBuilder>> scenes {
+		// animation
+		SCENE("blink_color", Blink(PURPLE, 4)),
+		SCENE("blink_rainbow", Blink(hsb(RadialRainbowWave(16, 20, point(8, 8)), 1.f, 1.f), 4)),
+		SCENE("blooming_rainbow", Blooming(hsb(Rainbow(20), 1.f, 1.f), point(8, 8), 10)),
+		SCENE("dynamic_blooming_rainbow", Blooming(
+					hsb(Rainbow(20), 1.f, 1.f),
+					Point(Wave<coordinate>(40, 8, 4), 9),
+					Wave<coordinate>(20, 10, 5))),
+		SCENE("basic_linear_unit_wave", rgb(
+					Cast<std::uint8_t>(255 * LinearUnitWave(8, 20, XLine(8))),
+					(std::uint8_t) 0, (std::uint8_t) 0)),
+		SCENE("rainbow_linear_unit_wave", hsb(Rainbow(20), 1.f, LinearUnitWave(8, 20, XLine(8)))),
+		SCENE("basic_radial_unit_wave", rgb(
+					Cast<std::uint8_t>(255 * RadialUnitWave(8, 20, point(8, 8))),
+					(std::uint8_t) 0, (std::uint8_t) 0)),
+		SCENE("rainbow_radial_unit_wave", hsb(Rainbow(20), 1.f, RadialUnitWave(8, 20, point(8, 8)))),
+		SCENE("rainbow", hsb(Rainbow(40), 1.f, 1.f)),
+		SCENE("rainbow_dyn_b", hsb(Rainbow(40), 1.f, Wave<float>(20, .5f, 1.f))),
+		{"sequence", [] () -> Animation* {
+			Blink anim1(PURPLE, 4);
+			hsb anim2(RadialRainbowWave(32, 40, point(8, 8)), 1.f, 1.f);
+			animation::Sequence anim3({{RED, 10}, {GREEN, 10}, {BLUE, 10}});
+			return animation::Sequence({{anim1, 20}, {anim2, 20}, {anim3, 40}, {anim2, 40}}).copy();
+		}},
+		// conditional
+		SCENE("conditional_eq", If<color>(
+					Cast<int>(X() + Y()) % 2 == 0,
+					rgb(0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, SEED)), 0),
+					rgb(0, 0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, SEED + 1))))),
+		SCENE("conditional_less_greater", If<color>(
+					X() > 10,
+					Blink(RED, 10),
+					If<color>(X() <= 6, Blink(BLUE, 10), Blink(GREEN, 5)))),
+		// geometry
+		SCENE("index", If<color>(
+					I() % 2 == (index_t) 0,
+					rgb(Cast<std::uint8_t>(255 * T() / 20), 0, 0),
+					rgb(0, 0, Cast<std::uint8_t>(255 - 255 * T() / 20)))),
+		// random
+		SCENE("random_normal_t", rgb(NormalDistribution<std::uint8_t>(200, 20, RandomT(10, SEED)), 50, 50)),
+		SCENE("random_normal_xy_t", rgb(NormalDistribution<std::uint8_t>(200, 20, RandomXYT(10, SEED)), 50, 50)),
+		SCENE("random_normal_xy_t_hue", hsb(NormalDistribution<float>(Rainbow(50), 20, RandomXYT(10, SEED)), 1.f, 1.f)),
+		SCENE("random_uniform_t", rgb(UniformDistribution<std::uint8_t>(30, 200, RandomT(10, SEED)), 30, 30)),
+		SCENE("random_uniform_xy_t", rgb(UniformDistribution<std::uint8_t>(30, 200, RandomXYT(10, SEED)), 30, 30)),
+		SCENE("random_uniform_xy_t_hue", hsb(UniformDistribution<float>(0, 360, RandomXYT(10, SEED)), 1.f, 1.f)),
+		// signal
+		SCENE("sawtooth_t", rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(Cast<float>(T()) / 10.f))))),
+		SCENE("sawtooth_x", rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(Cast<float>(X()) / 8.f))))),
+		SCENE("sawtooth_x_t", rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(X() / 8.f - T() / 10.f))))),
+		SCENE("sawtooth_radial_t", rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(
+								Distance(Point(X(), Y()), Point(8, 8)) / 8.f - T() / 10.f))))),
+		SCENE("sine_t", hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(Cast<float>(T()) / 10.f)))),
+		SCENE("sine_x", hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(X() / 8.f)))),
+		SCENE("sine_x_t", hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(X() / 8.f - T() / 10.f)))),
+		SCENE("sine_radial_t", hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(
+							Distance(Point(X(), Y()), point(8, 8)) / 8.f - T() / 10.f)))),
+		SCENE("square_t", rgb(0, 0, Cast<std::uint8_t>(122 + (25 * Square(Cast<float>(T()) / 10.f))))),
+		SCENE("square_x", rgb(0, 0, Cast<std::uint8_t>(122 + (25 * Square(Cast<float>(X()) / 8.f))))),
+		SCENE("square_x_t", rgb(0, 0, Cast<std::uint8_t>(122 + (25 * Square(X() / 8.f - T() / 10.f))))),
+		SCENE("square_radial_t", rgb(0, 0, Cast<std::uint8_t>(122 + (25 * Square(
+								Distance(Point(X(), Y()), Point(8, 8)) / 8.f - T() / 10.f))))),
+		SCENE("insane_triangle_radial_t", hsb(Rainbow(20), 1.f, .5f * (1.f + Sine(
+							Distance(
+								Point(X(), Y()),
+								Point(
+									Cast<coordinate>(8.f * (1.f + Sine(T() / 30.f))),
+									8.f + 3.f * Triangle(8.f * (1.f + Sine(T() / 30.f)) / 8.f)))
+							/ 8.f - T() / 10.f))))
+	};
+	return scenes;
+}
+
+static std::map<std::string, Checksum> load_golden(const char* path) {
+	std::map<std::string, Checksum> golden;
+	std::ifstream file(path);
+	std::string line;
+	while(std::getline(file, line)) {
+		if(line.empty() || line[0] == '#')
+			continue;
+		// scene mapping frame checksum
+		std::istringstream fields(line);
+		std::string scene, mapping, frame;
+		fields >> scene >> mapping >> frame;
+		std::string rest;
+		std::getline(fields, rest);
+		Checksum checksum;
+		if(parse(rest, checksum))
+			golden[scene + " " + mapping + " " + frame] = checksum;
+	}
+	return golden;
+}
+
+TEST(Golden, frames) {
+	LedStrip strip(64);
+	LedPanel panel(16, 16, LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	std::vector<std::pair<std::string, Mapping*>> mappings {
+		{"strip", &strip}, {"panel", &panel}
+	};
+
+	const char* tolerance_env = std::getenv("PIXLED_GOLDEN_TOLERANCE");
+	int tolerance = tolerance_env ? std::atoi(tolerance_env) : -1;
+	const char* update_env = std::getenv("PIXLED_UPDATE_GOLDEN");
+	bool update = update_env && std::string(update_env) == "1";
+
+	std::map<std::string, Checksum> golden = load_golden(PIXLED_GOLDEN_FILE);
+	std::ostringstream updated;
+	updated << "# Golden frame checksums, see tests/pixled/golden.cpp" << std::endl
+		<< "# scene mapping frame hash components" << std::endl;
+
+	for(auto& scene : scenes()) {
+		for(auto& mapping : mappings) {
+			SCOPED_TRACE(scene.first + " on " + mapping.first);
+			std::unique_ptr<Animation> animation(scene.second());
+			FrameOutput output(mapping.second->size());
+			Runtime runtime(*mapping.second, output, *animation);
+			runtime.setTimeStep(TIME_STEP);
+
+			for(std::size_t frame = 0; frame < FRAMES; frame++) {
+				runtime.next();
+				Checksum actual = checksum(output.frame);
+				std::string key = scene.first + " " + mapping.first + " " + std::to_string(frame);
+				updated << key << " " << format(actual) << std::endl;
+				if(update)
+					continue;
+
+				auto expected = golden.find(key);
+				ASSERT_NE(expected, golden.end())
+					<< "no golden checksum, run with PIXLED_UPDATE_GOLDEN=1";
+				if(tolerance < 0) {
+					ASSERT_EQ(format(actual), format(expected->second))
+						<< "frame " << frame << " differs from the golden frame";
+				} else {
+					long component = compare(output.frame, expected->second, tolerance);
+					ASSERT_EQ(component, -1)
+						<< "frame " << frame << ", led " << component / 3;
+				}
+			}
+		}
+	}
+
+	if(update) {
+		std::ofstream file(PIXLED_GOLDEN_FILE);
+		file << updated.str();
+	}
+}
+
+TEST(Golden, checksum) {
+	std::vector<std::uint8_t> frame {
+		10, 20, 30, 12, 22, 32, 0, 0, 0, 255, 255, 255
+	};
+	Checksum sum = checksum(frame);
+	ASSERT_THAT(sum.components, ElementsAre(1, 1, 2, 1, 1, 2, 0, 0, 0, 15, 15, 15));
+
+	Checksum parsed;
+	ASSERT_TRUE(parse(format(sum), parsed));
+	ASSERT_EQ(parsed.hash, sum.hash);
+	ASSERT_THAT(parsed.components, ElementsAreArray(sum.components));
+
+	frame[0]++;
+	ASSERT_NE(checksum(frame).hash, sum.hash);
+}
+
+TEST(Golden, tolerance) {
+	// A red wave along the strip, and the same wave shifted by a quarter of
+	// its period: both frames have the same average color
+	std::vector<std::uint8_t> wave;
+	std::vector<std::uint8_t> shifted;
+	for(std::size_t i = 0; i < 64; i++) {
+		for(std::size_t shift : {0, 4}) {
+			std::vector<std::uint8_t>& frame = shift == 0 ? wave : shifted;
+			frame.push_back((std::uint8_t) (127.5f + 127.5f * std::sin(2 * PI * (i + shift) / 16)));
+			frame.push_back(0);
+			frame.push_back(0);
+		}
+	}
+	Checksum golden = checksum(wave);
+	ASSERT_EQ(compare(wave, golden, 0), -1);
+	ASSERT_NE(compare(shifted, golden, 2), -1);
+
+	// Small deviations are tolerated
+	std::vector<std::uint8_t> noisy = wave;
+	for(std::size_t i = 0; i < noisy.size(); i += 3)
+		noisy[i] = noisy[i] < 253 ? noisy[i] + 2 : noisy[i] - 2;
+	ASSERT_EQ(compare(noisy, golden, 2), -1);
+}
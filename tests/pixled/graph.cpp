@@ -0,0 +1,243 @@
+#include "pixled.h"
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace testing;
+using namespace pixled;
+
+typedef std::function<Animation*()> GraphBuilder;
+
+#define GRAPH(...) [] () -> Animation* {\
+	return static_cast<const Animation&>(__VA_ARGS__).copy();}
+
+static const unsigned long SEED = 42;
+
+static std::vector<GraphBuilder> graphs() {
+	return {
+		GRAPH(Blink(PURPLE, 4)),
+		GRAPH(Blooming(
+					hsb(Rainbow(20), 1.f, 1.f),
+					Point(Wave<coordinate>(40, 8, 4), 9),
+					Wave<coordinate>(20, 10, 5))),
+		GRAPH(rgb(
+					Cast<std::uint8_t>(255 * LinearUnitWave(8, 20, XLine(8))),
+					(std::uint8_t) 0, (std::uint8_t) 0)),
+		GRAPH(hsb(Rainbow(20), 1.f, RadialUnitWave(8, 20, point(8, 8)))),
+		GRAPH(hsb(RadialRainbowWave(32, 40, point(8, 8)), 1.f, 1.f)),
+		GRAPH(If<color>(
+					Cast<int>(X() + Y()) % 2 == 0,
+					rgb(0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, SEED)), 0),
+					rgb(0, 0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, SEED + 1))))),
+		GRAPH(If<color>(
+					I() % 2 == (index_t) 0,
+					rgb(Cast<std::uint8_t>(255 * T() / 20), 0, 0),
+					rgb(0, 0, Cast<std::uint8_t>(255 - 255 * T() / 20)))),
+		GRAPH(hsb(NormalDistribution<float>(Rainbow(50), 20, RandomXYT(10, SEED)), 1.f, 1.f)),
+		GRAPH(rgb(UniformDistribution<std::uint8_t>(30, 200, RandomT(10, SEED)), 30, 30)),
+		GRAPH(rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(
+								Distance(Point(X(), Y()), Point(8, 8)) / 8.f - T() / 10.f))))),
+		GRAPH(rgb(0, 0, Cast<std::uint8_t>(122 + (25 * Square(Cast<float>(T()) / 10.f))))),
+		GRAPH(hsb(Rainbow(20), 1.f, .5f * (1.f + Triangle(8.f * (1.f + Sine(T() / 30.f)) / 8.f)))),
+		GRAPH(hsb(
+					Cast<float>(FixedSine(Cast<fixed>(X()) / fixed(8)) * fixed(180)) + 180.f,
+					1.f, .5f)),
+		[] () -> Animation* {
+			Blink anim1(PURPLE, 4);
+			hsb anim2(RadialRainbowWave(32, 40, point(8, 8)), 1.f, 1.f);
+			animation::Sequence anim3({{RED, 10}, {GREEN, 10}, {BLUE, 10}});
+			return animation::Sequence({{anim1, 20}, {anim2, 20}, {anim3, 40}, {anim2, 40}}).copy();
+		}
+	};
+}
+
+static void expect_same_frames(const Animation& expected, const Animation& actual) {
+	LedPanel panel(16, 16, LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	for(pixled::time t = 0; t < 100; t += 3) {
+		for(auto l : panel.leds()) {
+			color c1 = expected(l, t);
+			color c2 = actual(l, t);
+			ASSERT_EQ(c1.red(), c2.red()) << "led " << l.index << ", t=" << t;
+			ASSERT_EQ(c1.green(), c2.green()) << "led " << l.index << ", t=" << t;
+			ASSERT_EQ(c1.blue(), c2.blue()) << "led " << l.index << ", t=" << t;
+		}
+	}
+}
+
+TEST(Graph, round_trip) {
+	std::size_t i = 0;
+	for(auto& builder : graphs()) {
+		SCOPED_TRACE("graph " + std::to_string(i++));
+		std::unique_ptr<Animation> animation(builder());
+		std::vector<std::uint8_t> data = serialize(*animation);
+		ASSERT_FALSE(data.empty());
+
+		FunctionGraph<color> graph(data);
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(graph.periodicity(), animation->periodicity());
+		expect_same_frames(*animation, graph);
+
+		// The format is canonical
+		ASSERT_EQ(serialize(graph), data);
+	}
+}
+
+TEST(Graph, size) {
+	hsb animation(Rainbow(20), 1.f, Wave<float>(10, .5f, .2f));
+	std::size_t size = serialize(animation, nullptr, 0);
+	ASSERT_GT(size, serialization::HEADER_SIZE);
+
+	std::vector<std::uint8_t> data(size, 0xAA);
+	ASSERT_EQ(serialize(animation, data.data(), size - 1), size);
+	ASSERT_THAT(std::vector<std::uint8_t>(data.begin(), data.begin() + serialization::HEADER_SIZE), Each(0xAA));
+	ASSERT_FALSE(FunctionGraph<color>(data).isValid());
+	ASSERT_EQ(serialize(animation, data.data(), size), size);
+	ASSERT_THAT(std::vector<std::uint8_t>(data.begin(), data.begin() + 4), ElementsAre('P', 'X', 'F', 'G'));
+}
+
+TEST(Graph, single_allocation) {
+	hsb animation(Rainbow(20), 1.f, .5f * (1.f + Sine(X() / 8.f - T() / 10.f)));
+	std::vector<std::uint8_t> data = serialize(animation);
+
+	resetAllocationStats();
+	{
+		FunctionGraph<color> graph(data);
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(allocationStats().heap_allocations, 0);
+		ASSERT_GT(allocationStats().arena_allocations, 0);
+		ASSERT_LE(allocationStats().arena_bytes, graph.memory());
+	}
+	ASSERT_EQ(allocationStats().heap_deallocations, 0);
+
+	// The items of a Sequence are allocated in the Arena, after the
+	// Sequence (constants are stored in the items)
+	animation::Sequence sequence({{RED, 10}, {GREEN, 10}, {BLUE, 10}});
+	data = serialize(sequence);
+	resetAllocationStats();
+	{
+		FunctionGraph<color> graph(data);
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(allocationStats().heap_allocations, 0);
+		ASSERT_EQ(allocationStats().arena_allocations, 2);
+		ASSERT_LE(allocationStats().arena_bytes, graph.memory());
+		expect_same_frames(sequence, graph);
+	}
+	ASSERT_EQ(allocationStats().heap_deallocations, 0);
+}
+
+TEST(Graph, user_arena) {
+	hsb animation(Rainbow(20), 1.f, .5f * (1.f + Sine(X() / 8.f - T() / 10.f)));
+	std::vector<std::uint8_t> data = serialize(animation);
+
+	alignas(std::max_align_t) static std::uint8_t buffer[1024];
+	Arena arena(buffer, sizeof(buffer));
+	resetAllocationStats();
+	{
+		FunctionGraph<color> graph(data.data(), data.size(), arena);
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(allocationStats().heap_allocations, 0);
+		ASSERT_TRUE(arena.contains(&graph.get()));
+		ASSERT_LE(arena.used(), graph.memory());
+		expect_same_frames(animation, graph);
+	}
+
+	Arena small(buffer, 16);
+	FunctionGraph<color> graph(data.data(), data.size(), small);
+	ASSERT_FALSE(graph.isValid());
+	ASSERT_EQ(small.used(), 0);
+	color c = graph({{0, 0}, 0}, 0);
+	ASSERT_EQ(c.red(), 0);
+	ASSERT_EQ(c.green(), 0);
+	ASSERT_EQ(c.blue(), 0);
+}
+
+TEST(Graph, constants) {
+	{
+		FunctionGraph<point> graph(serialize(Constant<point>(point(1.5f, -2.f, 3.f))));
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_NE(graph.constant(), nullptr);
+		ASSERT_FLOAT_EQ(graph.constant()->x, 1.5f);
+		ASSERT_FLOAT_EQ(graph.constant()->y, -2.f);
+		ASSERT_FLOAT_EQ(graph.constant()->z, 3.f);
+	}
+	{
+		FunctionGraph<int> graph(serialize(Constant<int>(-12)));
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(*graph.constant(), -12);
+	}
+	{
+		FunctionGraph<fixed> graph(serialize(Constant<fixed>(fixed(-1.25f))));
+		ASSERT_TRUE(graph.isValid());
+		ASSERT_EQ(graph.constant()->raw(), fixed(-1.25f).raw());
+	}
+	for(color c : {PURPLE, color::hsb(120.f, .5f, .25f), color::hsb(fixed(200), fixed(.75f), fixed(1))}) {
+		FunctionGraph<color> graph(serialize(Constant<color>(c)));
+		ASSERT_TRUE(graph.isValid());
+		const color& loaded = *graph.constant();
+		ASSERT_EQ(loaded.red(), c.red());
+		ASSERT_EQ(loaded.green(), c.green());
+		ASSERT_EQ(loaded.blue(), c.blue());
+		ASSERT_FLOAT_EQ(loaded.hue(), c.hue());
+		ASSERT_FLOAT_EQ(loaded.saturation(), c.saturation());
+		ASSERT_FLOAT_EQ(loaded.brightness(), c.brightness());
+	}
+}
+
+class CustomColor : public base::Function<color> {
+	public:
+		color operator()(led, pixled::time) const override {return RED;}
+		CustomColor* copy() const override {return new CustomColor;}
+};
+
+TEST(Graph, invalid) {
+	hsb animation(Rainbow(20), 1.f, Wave<float>(10, .5f, .2f));
+	std::vector<std::uint8_t> data = serialize(animation);
+
+	// Unserializable user Function
+	ASSERT_EQ(serialize(CustomColor(), nullptr, 0), 0);
+	ASSERT_TRUE(serialize(Blink(CustomColor(), 4)).empty());
+
+	// Truncated data
+	for(std::size_t size = 0; size < data.size(); size++)
+		ASSERT_FALSE(FunctionGraph<color>(data.data(), size).isValid()) << size;
+
+	// Trailing data
+	std::vector<std::uint8_t> trailing = data;
+	trailing.push_back(0);
+	ASSERT_FALSE(FunctionGraph<color>(trailing).isValid());
+
+	// Other version
+	std::vector<std::uint8_t> version = data;
+	version[4]++;
+	ASSERT_FALSE(FunctionGraph<color>(version).isValid());
+
+	// Wrong root type
+	ASSERT_FALSE(FunctionGraph<float>(data).isValid());
+
+	// Unknown node
+	std::vector<std::uint8_t> unknown = data;
+	unknown[serialization::HEADER_SIZE] = 0xFE;
+	ASSERT_FALSE(FunctionGraph<color>(unknown).isValid());
+
+	// Zero period random engine
+	std::vector<std::uint8_t> random = serialize(
+			rgb(UniformDistribution<std::uint8_t>(30, 200, RandomT(10, SEED)), 30, 30));
+	std::vector<std::uint8_t> zero(8, 0);
+	std::vector<std::uint8_t> period(8, 0);
+	serialization::store_le(period.data(), 10, 8);
+	auto it = std::search(random.begin(), random.end(), period.begin(), period.end());
+	ASSERT_NE(it, random.end());
+	std::copy(zero.begin(), zero.end(), it);
+	ASSERT_FALSE(FunctionGraph<color>(random).isValid());
+
+	// Zero duration Sequence item
+	std::vector<std::uint8_t> sequence = serialize(animation::Sequence({{rgb(255, 0, 0), 10}}));
+	std::vector<std::uint8_t> duration(8, 0);
+	serialization::store_le(duration.data(), 10, 8);
+	it = std::search(sequence.begin(), sequence.end(), duration.begin(), duration.end());
+	ASSERT_NE(it, sequence.end());
+	ASSERT_TRUE(FunctionGraph<color>(sequence).isValid());
+	std::copy(zero.begin(), zero.end(), it);
+	ASSERT_FALSE(FunctionGraph<color>(sequence).isValid());
+}
@@ -13,7 +13,8 @@ using pixled::mapping::PANEL_LINKING;
 
 MATCHER_P(PointEq, p, "") {
 	return Matches(FloatNear(p.x, .10e-5))(arg.x)
-		&& Matches(FloatNear(p.y, .10e-5))(arg.y);
+		&& Matches(FloatNear(p.y, .10e-5))(arg.y)
+		&& Matches(FloatNear(p.z, .10e-5))(arg.z);
 }
 MATCHER_P2(LedEq, location, index, "") {
 	return Matches(PointEq(location))(arg.location) && (pixled::index_t) index == arg.index;
@@ -361,3 +362,168 @@ TEST(LedPanel, DTTDR) {
 		LedEq(point(0, 1.5), 5)
 		));
 }
+
+TEST(ImplicitLedStrip, test) {
+	pixled::mapping::LedStrip led_strip(20);
+	pixled::mapping::ImplicitLedStrip implicit_strip(20);
+	ASSERT_EQ(implicit_strip.getLength(), 20);
+	ASSERT_EQ(implicit_strip.size(), 20);
+	ASSERT_THAT(implicit_strip.implicitGrid(), NotNull());
+
+	for(auto led : led_strip.leds())
+		ASSERT_THAT((*implicit_strip.implicitGrid())[led.index], LedEq(led.location, led.index));
+}
+
+class ImplicitLedPanelTest : public TestWithParam<PANEL_LINKING> {
+};
+
+TEST_P(ImplicitLedPanelTest, same_as_led_panel) {
+	pixled::mapping::LedPanel panel(5, 4, GetParam());
+	pixled::mapping::ImplicitLedPanel implicit_panel(5, 4, GetParam());
+
+	ASSERT_EQ(implicit_panel.width(), 5);
+	ASSERT_EQ(implicit_panel.height(), 4);
+	ASSERT_EQ(implicit_panel.size(), 20);
+	const pixled::grid* layout = implicit_panel.implicitGrid();
+	ASSERT_THAT(layout, NotNull());
+
+	// Random access
+	for(auto led : panel.leds())
+		ASSERT_THAT((*layout)[led.index], LedEq(led.location, led.index));
+
+	// Incremental iteration
+	pixled::index_t i = 0;
+	layout->forEach([&] (const pixled::led& l) {
+			ASSERT_EQ(l.index, i);
+			ASSERT_THAT(l, LedEq(panel.leds()[i].location, i));
+			i++;
+			});
+	ASSERT_EQ(i, 20);
+
+	// Bounding box
+	ASSERT_THAT(implicit_panel.boundingBox().position(), PointEq(panel.boundingBox().position()));
+	ASSERT_FLOAT_EQ(implicit_panel.boundingBox().width(), panel.boundingBox().width());
+	ASSERT_FLOAT_EQ(implicit_panel.boundingBox().height(), panel.boundingBox().height());
+}
+
+INSTANTIATE_TEST_SUITE_P(LedPanel, ImplicitLedPanelTest, Values(
+		PANEL_LINKING::LEFT_RIGHT_LEFT_RIGHT_FROM_BOTTOM,
+		PANEL_LINKING::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM,
+		PANEL_LINKING::RIGHT_LEFT_RIGHT_LEFT_FROM_BOTTOM,
+		PANEL_LINKING::RIGHT_LEFT_LEFT_RIGHT_FROM_BOTTOM,
+		PANEL_LINKING::LEFT_RIGHT_LEFT_RIGHT_FROM_TOP,
+		PANEL_LINKING::LEFT_RIGHT_RIGHT_LEFT_FROM_TOP,
+		PANEL_LINKING::RIGHT_LEFT_RIGHT_LEFT_FROM_TOP,
+		PANEL_LINKING::RIGHT_LEFT_LEFT_RIGHT_FROM_TOP,
+		PANEL_LINKING::TOP_DOWN_TOP_DOWN_FROM_LEFT,
+		PANEL_LINKING::TOP_DOWN_DOWN_TOP_FROM_LEFT,
+		PANEL_LINKING::DOWN_TOP_DOWN_TOP_FROM_LEFT,
+		PANEL_LINKING::DOWN_TOP_TOP_DOWN_FROM_LEFT,
+		PANEL_LINKING::TOP_DOWN_TOP_DOWN_FROM_RIGHT,
+		PANEL_LINKING::TOP_DOWN_DOWN_TOP_FROM_RIGHT,
+		PANEL_LINKING::DOWN_TOP_DOWN_TOP_FROM_RIGHT,
+		PANEL_LINKING::DOWN_TOP_TOP_DOWN_FROM_RIGHT
+		));
+
+TEST(ImplicitMapping, leds) {
+	pixled::mapping::ImplicitLedPanel implicit_panel(3, 2, PANEL_LINKING::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+
+	ASSERT_THAT(implicit_panel.leds(), ElementsAre(
+		LedEq(point(0.5, 0), 0),
+		LedEq(point(1.5, 0), 1),
+		LedEq(point(2.5, 0), 2),
+		LedEq(point(2.5, 1), 3),
+		LedEq(point(1.5, 1), 4),
+		LedEq(point(0.5, 1), 5)
+		));
+}
+
+TEST(ImplicitMapping, push) {
+	pixled::mapping::ImplicitLedStrip implicit_strip(3);
+	implicit_strip.push({point(10, 10), 3});
+
+	ASSERT_THAT(implicit_strip.implicitGrid(), IsNull());
+	ASSERT_EQ(implicit_strip.size(), 4);
+	ASSERT_THAT(implicit_strip.leds(), ElementsAre(
+		LedEq(point(0.5, 0), 0),
+		LedEq(point(1.5, 0), 1),
+		LedEq(point(2.5, 0), 2),
+		LedEq(point(10, 10), 3)
+		));
+}
+
+TEST_F(MappingTest, soa_2d) {
+	ASSERT_THAT(mapping.xs(), ElementsAre(2, 6, 4, 10, 6));
+	ASSERT_THAT(mapping.ys(), ElementsAre(3, FloatEq(1.9), 5, 4, 7.5));
+	ASSERT_THAT(mapping.zs(), IsEmpty());
+	ASSERT_THAT(mapping.indexes(), ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST_F(MappingTest, soa_3d) {
+	mapping.push({point(1, 2, 3), 5});
+
+	ASSERT_THAT(mapping.zs(), ElementsAre(0, 0, 0, 0, 0, 3));
+	ASSERT_THAT(mapping.at(5), LedEq(point(1, 2, 3), 5));
+
+	std::vector<pixled::led> leds;
+	mapping.forEach([&leds] (const pixled::led& l) {leds.push_back(l);});
+	ASSERT_THAT(leds, ElementsAre(
+				LedEq(point(2, 3), 0),
+				LedEq(point(6, 1.9), 1),
+				LedEq(point(4, 5), 2),
+				LedEq(point(10, 4), 3),
+				LedEq(point(6, 7.5), 4),
+				LedEq(point(1, 2, 3), 5)
+				));
+}
+
+class MappingSortTest : public TestWithParam<pixled::SPACE_FILLING_CURVE> {
+};
+
+TEST_P(MappingSortTest, sort) {
+	pixled::mapping::LedPanel panel(16, 16, PANEL_LINKING::TOP_DOWN_DOWN_TOP_FROM_LEFT);
+	std::vector<pixled::led> leds(panel.leds().begin(), panel.leds().end());
+
+	panel.sort(GetParam());
+
+	// Same leds, with the same indexes
+	ASSERT_THAT(panel.leds(), SizeIs(leds.size()));
+	std::vector<Matcher<pixled::led>> matchers;
+	for(auto led : leds)
+		matchers.push_back(LedEq(led.location, led.index));
+	ASSERT_THAT(panel.leds(), UnorderedElementsAreArray(matchers));
+
+	// The 4 first leds form the bottom left 2x2 square
+	ASSERT_THAT(std::vector<pixled::led>(panel.leds().begin(), std::next(panel.leds().begin(), 4)),
+			UnorderedElementsAre(
+				LedEq(point(0, 0.5), 15),
+				LedEq(point(0, 1.5), 14),
+				LedEq(point(1, 1.5), 17),
+				LedEq(point(1, 0.5), 16)
+				));
+
+	// Consecutive leds are close
+	float total_distance = 0;
+	for(pixled::index_t n = 1; n < panel.size(); n++)
+		total_distance += distance(panel.at(n-1).location, panel.at(n).location);
+	ASSERT_LT(total_distance, 2 * panel.size());
+	if(GetParam() == pixled::HILBERT_CURVE) {
+		// Each step of the Hilbert curve moves to an adjacent led
+		ASSERT_FLOAT_EQ(total_distance, panel.size()-1);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Mapping, MappingSortTest, Values(
+			pixled::MORTON_CURVE, pixled::HILBERT_CURVE
+			));
+
+TEST(MappingSort, implicit) {
+	pixled::mapping::ImplicitLedPanel panel(4, 4, PANEL_LINKING::LEFT_RIGHT_LEFT_RIGHT_FROM_BOTTOM);
+
+	panel.sort(pixled::MORTON_CURVE);
+
+	ASSERT_THAT(panel.implicitGrid(), IsNull());
+	ASSERT_THAT(panel.indexes(), ElementsAre(
+				0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15
+				));
+}
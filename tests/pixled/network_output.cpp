@@ -0,0 +1,182 @@
+#include "pixled/network_output.h"
+#include "pixled/runtime.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/chrono/chrono.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace testing;
+using namespace pixled;
+
+/*
+ * UDP receiver bound to an ephemeral localhost port.
+ */
+class NetworkOutputTest : public Test {
+	protected:
+		int receiver;
+		std::uint16_t port;
+		mapping::LedStrip strip {400};
+		chroma::rgb animation {
+			Cast<std::uint8_t>(geometry::X()),
+			Cast<std::uint8_t>(chrono::T()),
+			7
+		};
+
+		void SetUp() override {
+			receiver = socket(AF_INET, SOCK_DGRAM, 0);
+			ASSERT_GE(receiver, 0);
+			int buffer_size = 1 << 20;
+			setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+			timeval timeout {1, 0};
+			setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+			sockaddr_in address {};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			address.sin_port = 0;
+			ASSERT_EQ(bind(receiver, (sockaddr*) &address, sizeof(address)), 0);
+			socklen_t length = sizeof(address);
+			getsockname(receiver, (sockaddr*) &address, &length);
+			port = ntohs(address.sin_port);
+		}
+
+		void TearDown() override {
+			close(receiver);
+		}
+
+		std::vector<std::uint8_t> receive() {
+			std::vector<std::uint8_t> packet(1024);
+			ssize_t size = recv(receiver, packet.data(), packet.size(), 0);
+			packet.resize(size < 0 ? 0 : size);
+			return packet;
+		}
+
+		static std::uint16_t load_be(const std::vector<std::uint8_t>& packet, std::size_t i) {
+			return (packet[i] << 8) | packet[i+1];
+		}
+};
+
+TEST_F(NetworkOutputTest, e131) {
+	NetworkOutput output(E131, "127.0.0.1", port);
+	ASSERT_TRUE(output.isOpen());
+	// 170 + 170 + 60 leds
+	ASSERT_TRUE(output.addUniverses(1, 400));
+	ASSERT_EQ(output.universeCount(), 3);
+	output.setSync(1000);
+	Runtime runtime(strip, output, animation);
+
+	for(std::uint8_t frame = 0; frame < 2; frame++) {
+		runtime.next();
+		const std::size_t leds[3] = {170, 170, 60};
+		std::vector<std::uint8_t> cid;
+		for(std::size_t universe = 0; universe < 3; universe++) {
+			std::vector<std::uint8_t> packet = receive();
+			ASSERT_EQ(packet.size(), 126 + 3*leds[universe]);
+			ASSERT_EQ(std::string((const char*) &packet[4], 9), "ASC-E1.17");
+			ASSERT_EQ(load_be(packet, 16), 0x7000 | (packet.size() - 16));
+			ASSERT_EQ(packet[21], 0x04);
+			cid.assign(&packet[22], &packet[38]);
+			ASSERT_EQ(load_be(packet, 38), 0x7000 | (packet.size() - 38));
+			ASSERT_EQ(packet[43], 0x02);
+			ASSERT_EQ(packet[108], 100);
+			// Sync address
+			ASSERT_EQ(load_be(packet, 109), 1000);
+			ASSERT_EQ(packet[111], frame);
+			ASSERT_EQ(load_be(packet, 113), universe + 1);
+			ASSERT_EQ(load_be(packet, 123), 1 + 3*leds[universe]);
+			ASSERT_EQ(packet[125], 0);
+			for(std::size_t i = 0; i < leds[universe]; i++) {
+				std::size_t led = 170*universe + i;
+				ASSERT_EQ(packet[126 + 3*i], (std::uint8_t) led);
+				ASSERT_EQ(packet[126 + 3*i + 1], frame);
+				ASSERT_EQ(packet[126 + 3*i + 2], 7);
+			}
+		}
+		std::vector<std::uint8_t> sync = receive();
+		ASSERT_EQ(sync.size(), 49);
+		ASSERT_EQ(sync[21], 0x08);
+		ASSERT_EQ(sync[43], 0x01);
+		ASSERT_EQ(sync[44], frame);
+		ASSERT_EQ(load_be(sync, 45), 1000);
+		// Same source
+		ASSERT_EQ(std::vector<std::uint8_t>(&sync[22], &sync[38]), cid);
+	}
+	ASSERT_EQ(output.packets(), 8);
+	ASSERT_EQ(output.sendErrors(), 0);
+}
+
+TEST_F(NetworkOutputTest, artnet) {
+	NetworkOutput output(ARTNET, "127.0.0.1", port);
+	ASSERT_TRUE(output.isOpen());
+	// Net 1, SubUni 0x23
+	ASSERT_TRUE(output.addUniverse(0x123, 10, 5));
+	output.setSync(1);
+	Runtime runtime(strip, output, animation);
+
+	for(std::uint8_t frame = 0; frame < 2; frame++) {
+		runtime.next();
+		std::vector<std::uint8_t> packet = receive();
+		// 15 channels, padded to an even length
+		ASSERT_EQ(packet.size(), 18 + 16);
+		ASSERT_EQ(std::string((const char*) &packet[0]), "Art-Net");
+		ASSERT_EQ(packet[8], 0x00);
+		ASSERT_EQ(packet[9], 0x50);
+		ASSERT_EQ(load_be(packet, 10), 14);
+		// Sequence numbers start at 1
+		ASSERT_EQ(packet[12], frame + 1);
+		ASSERT_EQ(packet[14], 0x23);
+		ASSERT_EQ(packet[15], 0x01);
+		ASSERT_EQ(load_be(packet, 16), 16);
+		for(std::size_t i = 0; i < 5; i++) {
+			ASSERT_EQ(packet[18 + 3*i], 10 + i);
+			ASSERT_EQ(packet[18 + 3*i + 1], frame);
+			ASSERT_EQ(packet[18 + 3*i + 2], 7);
+		}
+		ASSERT_EQ(packet[18 + 15], 0);
+
+		std::vector<std::uint8_t> sync = receive();
+		ASSERT_EQ(sync.size(), 14);
+		ASSERT_EQ(sync[8], 0x00);
+		ASSERT_EQ(sync[9], 0x52);
+	}
+}
+
+TEST_F(NetworkOutputTest, many_universes) {
+	NetworkOutput output(E131, "127.0.0.1", port);
+	mapping::LedStrip strip {170*200};
+	ASSERT_TRUE(output.addUniverses(1, 170*200));
+	ASSERT_EQ(output.universeCount(), 200);
+	Runtime runtime(strip, output, animation);
+	runtime.next();
+	ASSERT_EQ(output.packets(), 200);
+
+	std::vector<bool> received(200, false);
+	for(std::size_t i = 0; i < 200; i++) {
+		std::vector<std::uint8_t> packet = receive();
+		ASSERT_EQ(packet.size(), 126 + 510);
+		received[load_be(packet, 113) - 1] = true;
+	}
+	ASSERT_THAT(received, Each(true));
+}
+
+TEST_F(NetworkOutputTest, invalid) {
+	NetworkOutput output(E131, "127.0.0.1", port);
+	// E1.31 universes start at 1
+	ASSERT_FALSE(output.addUniverse(0, 0, 10));
+	ASSERT_FALSE(output.addUniverse(64000, 0, 10));
+	ASSERT_FALSE(output.addUniverse(1, 0, 171));
+	ASSERT_FALSE(output.addUniverse(1, 0, 10, "invalid host name"));
+	ASSERT_EQ(output.universeCount(), 0);
+
+	NetworkOutput closed(ARTNET, "invalid host name");
+	ASSERT_FALSE(closed.isOpen());
+	ASSERT_FALSE(closed.addUniverse(0, 0, 10));
+	// Does nothing
+	closed.endFrame();
+	ASSERT_EQ(closed.packets(), 0);
+}
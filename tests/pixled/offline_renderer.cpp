@@ -0,0 +1,152 @@
+#include "pixled/offline_renderer.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/chrono/chrono.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/arithmetic/arithmetic.h"
+#include "pixled/animation/animation.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+#include "../mocks/frames_output.h"
+
+#include <future>
+
+using namespace testing;
+using namespace pixled;
+
+/*
+ * Animation that counts its calls, and so depends on call history.
+ */
+class StatefulAnimation : public base::Function<color> {
+	public:
+		mutable std::uint8_t count = 0;
+
+		color operator()(led, pixled::time) const override {
+			return color::rgb(count++, 0, 0);
+		}
+
+		StatefulAnimation* copy() const override {
+			return new StatefulAnimation;
+		}
+
+		bool stateless() const override {
+			return false;
+		}
+};
+
+class OfflineRendererTest : public Test {
+	protected:
+		mapping::LedStrip strip {50};
+		chroma::rgb animation {
+			Cast<std::uint8_t>(geometry::I()),
+			Cast<std::uint8_t>(chrono::T()),
+			Cast<std::uint8_t>(chrono::T() * geometry::I())
+		};
+		ThreadPool pool {4};
+
+		void checkFrame(pixled::time t, const std::uint8_t* frame) {
+			for(auto l : strip.leds()) {
+				color c = animation(l, t);
+				ASSERT_EQ(frame[3*l.index], c.red());
+				ASSERT_EQ(frame[3*l.index+1], c.green());
+				ASSERT_EQ(frame[3*l.index+2], c.blue());
+			}
+		}
+};
+
+TEST_F(OfflineRendererTest, in_order) {
+	OfflineRenderer renderer(strip, animation, pool);
+	ASSERT_EQ(renderer.ringSize(), 8);
+	ASSERT_EQ(renderer.ledCount(), 50);
+
+	pixled::time expected = 0;
+	renderer.render(0, 200, [this, &expected] (pixled::time t, const std::uint8_t* frame, std::size_t led_count) {
+			ASSERT_EQ(t, expected);
+			ASSERT_EQ(led_count, 50);
+			checkFrame(t, frame);
+			expected++;
+			});
+	ASSERT_EQ(expected, 200);
+	ASSERT_EQ(renderer.frames(), 200);
+	ASSERT_GT(renderer.framesPerSecond(), 0);
+}
+
+TEST_F(OfflineRendererTest, time_step) {
+	OfflineRenderer renderer(strip, animation, pool, 3);
+
+	std::vector<pixled::time> times;
+	renderer.render(10, 31, [this, &times] (pixled::time t, const std::uint8_t* frame, std::size_t) {
+			times.push_back(t);
+			checkFrame(t, frame);
+			}, 5);
+	ASSERT_THAT(times, ElementsAre(10, 15, 20, 25, 30));
+
+	renderer.render(10, 10, [] (pixled::time, const std::uint8_t*, std::size_t) {
+			FAIL();
+			});
+	ASSERT_EQ(renderer.frames(), 0);
+}
+
+TEST_F(OfflineRendererTest, output) {
+	OfflineRenderer renderer(strip, animation, pool);
+	FramesOutput output;
+
+	renderer.render(5, 25, output);
+	ASSERT_EQ(output.frames.size(), 20);
+	ASSERT_EQ(output.ended_frames, 20);
+	for(pixled::time t = 5; t < 25; t++)
+		checkFrame(t, output.frames[t-5].data());
+}
+
+TEST_F(OfflineRendererTest, from_worker) {
+	// The only worker renders frames while it waits for them
+	ThreadPool single(1);
+	OfflineRenderer renderer(strip, animation, single);
+
+	std::promise<unsigned long> frames;
+	single.submit([&renderer, &frames] {
+			renderer.render(0, 50, [] (pixled::time, const std::uint8_t*, std::size_t) {
+					});
+			frames.set_value(renderer.frames());
+			});
+	std::future<unsigned long> result = frames.get_future();
+	ASSERT_EQ(result.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+	ASSERT_EQ(result.get(), 50);
+}
+
+TEST_F(OfflineRendererTest, stateful) {
+	StatefulAnimation stateful;
+	ASSERT_FALSE(stateful.stateless());
+	OfflineRenderer renderer(strip, stateful, pool);
+
+	// Frames are rendered in order, on the calling thread
+	std::uint8_t expected = 0;
+	renderer.render(0, 4, [&expected] (pixled::time, const std::uint8_t* frame, std::size_t led_count) {
+			for(std::size_t i = 0; i < led_count; i++)
+				ASSERT_EQ(frame[3*i], expected++);
+			});
+	ASSERT_EQ(renderer.frames(), 4);
+}
+
+TEST_F(OfflineRendererTest, fill) {
+	animation::Rainbow rainbow {12};
+	chroma::hsb periodic {rainbow, 1.f, 1.f};
+	OfflineRenderer renderer(strip, periodic, pool);
+	RawFrameCache cache(periodic.periodicity(), renderer.ledCount());
+
+	renderer.fill(cache);
+	ASSERT_TRUE(cache.complete());
+	ASSERT_EQ(renderer.frames(), 12);
+	for(pixled::time t = 0; t < 12; t++) {
+		const std::uint8_t* frame = cache.load(t);
+		for(auto l : strip.leds()) {
+			color c = periodic(l, t);
+			ASSERT_EQ(frame[3*l.index], c.red());
+			ASSERT_EQ(frame[3*l.index+1], c.green());
+			ASSERT_EQ(frame[3*l.index+2], c.blue());
+		}
+	}
+
+	// Nothing left to render
+	renderer.fill(cache);
+	ASSERT_EQ(renderer.frames(), 0);
+}
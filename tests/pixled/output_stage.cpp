@@ -0,0 +1,126 @@
+#include "pixled/output_stage.h"
+#include "gmock/gmock.h"
+
+#include <cmath>
+
+using namespace testing;
+
+TEST(OutputStage, identity) {
+	pixled::OutputStage stage;
+	std::vector<std::uint8_t> frame(3*256);
+	for(std::size_t i = 0; i < frame.size(); i++)
+		frame[i] = i / 3;
+	std::vector<std::uint8_t> expected = frame;
+
+	stage.apply(frame.data(), 256);
+	ASSERT_THAT(frame, ElementsAreArray(expected));
+	ASSERT_FALSE(stage.limited());
+}
+
+TEST(OutputStage, gamma_and_brightness) {
+	pixled::OutputStage stage;
+	stage.setGamma(2.f, 1.f, .5f);
+	stage.setBrightness(128);
+	ASSERT_FLOAT_EQ(stage.gamma(pixled::OutputStage::RED), 2.f);
+	ASSERT_FLOAT_EQ(stage.gamma(pixled::OutputStage::BLUE), .5f);
+	ASSERT_EQ(stage.brightness(), 128);
+
+	for(int v = 0; v < 256; v++) {
+		std::uint8_t rgb[3] = {(std::uint8_t) v, (std::uint8_t) v, (std::uint8_t) v};
+		stage.apply(rgb, 1);
+		ASSERT_NEAR(rgb[0], 255.f * std::pow(v / 255.f, 2.f) * 128 / 255, 1);
+		ASSERT_NEAR(rgb[1], v * 128.f / 255, 1);
+		ASSERT_NEAR(rgb[2], 255.f * std::pow(v / 255.f, .5f) * 128 / 255, 1);
+	}
+}
+
+TEST(OutputStage, current_budget) {
+	pixled::OutputStage stage;
+	stage.setCurrentBudget(3000);
+	ASSERT_EQ(stage.currentBudget(), 3000);
+
+	// 20 white leds, sum = 15300
+	std::vector<std::uint8_t> frame(3*20, 255);
+	stage.apply(frame.data(), 20);
+	ASSERT_TRUE(stage.limited());
+	ASSERT_EQ(stage.lastSum(), 15300);
+
+	std::uint32_t sum = 0;
+	for(auto v : frame)
+		sum += v;
+	ASSERT_LE(sum, 3000);
+	ASSERT_GE(sum, 3000 - frame.size());
+	// Colors are scaled uniformly
+	ASSERT_THAT(frame, Each(frame[0]));
+
+	// Under the budget
+	std::vector<std::uint8_t> dark(3*20, 10);
+	stage.apply(dark.data(), 20);
+	ASSERT_FALSE(stage.limited());
+	ASSERT_THAT(dark, Each(10));
+}
+
+TEST(OutputStage, no_dithering) {
+	pixled::OutputStage stage;
+	ASSERT_EQ(stage.dithering(), pixled::OutputStage::NO_DITHERING);
+	std::vector<std::uint16_t> frame(3*256);
+	for(std::size_t i = 0; i < frame.size(); i++)
+		frame[i] = (i / 3) * 257;
+	std::vector<std::uint8_t> output(frame.size());
+	std::vector<std::uint8_t> expected(frame.size());
+	for(std::size_t i = 0; i < frame.size(); i++)
+		expected[i] = i / 3;
+
+	stage.apply(frame.data(), output.data(), 256);
+	ASSERT_THAT(output, ElementsAreArray(expected));
+	ASSERT_EQ(stage.lastSum(), 3 * 255 * 256 / 2);
+}
+
+class OutputStageDitheringTest : public TestWithParam<pixled::OutputStage::DITHERING> {
+};
+
+TEST_P(OutputStageDitheringTest, average) {
+	pixled::OutputStage stage;
+	stage.setDithering(GetParam());
+	ASSERT_EQ(stage.dithering(), GetParam());
+
+	// Values between two 8 bits steps
+	const std::size_t led_count = 16;
+	std::vector<std::uint16_t> values(3*led_count);
+	for(std::size_t i = 0; i < values.size(); i++)
+		values[i] = 3 * 257 + 11 * i;
+	std::vector<std::uint32_t> sums(values.size(), 0);
+	std::vector<std::uint8_t> output(values.size());
+
+	const int frames = 256;
+	for(int f = 0; f < frames; f++) {
+		std::vector<std::uint16_t> frame = values;
+		stage.apply(frame.data(), output.data(), led_count);
+		for(std::size_t i = 0; i < output.size(); i++) {
+			// Output values only oscillate between neighbour steps
+			ASSERT_GE(output[i], values[i] / 257 - 1);
+			ASSERT_LE(output[i], values[i] / 257 + 1);
+			sums[i] += output[i];
+		}
+	}
+	for(std::size_t i = 0; i < values.size(); i++)
+		ASSERT_NEAR((float) sums[i] / frames, values[i] / 257.f, .05f);
+}
+
+INSTANTIATE_TEST_SUITE_P(OutputStage, OutputStageDitheringTest, Values(
+			pixled::OutputStage::TEMPORAL_DITHERING,
+			pixled::OutputStage::TEMPORAL_SPATIAL_DITHERING
+			));
+
+TEST(OutputStage, spatial_dithering) {
+	pixled::OutputStage stage;
+	stage.setDithering(pixled::OutputStage::TEMPORAL_SPATIAL_DITHERING);
+
+	// Uniform area, half way between two 8 bits steps
+	std::vector<std::uint16_t> frame(3*16, 3 * 257 + 128);
+	std::vector<std::uint8_t> output(frame.size());
+	stage.apply(frame.data(), output.data(), 16);
+	// Leds do not toggle all at once
+	ASSERT_THAT(output, Contains(3));
+	ASSERT_THAT(output, Contains(4));
+}
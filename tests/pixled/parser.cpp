@@ -0,0 +1,194 @@
+#include "pixled.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+using namespace pixled;
+
+static const color OFF = color::rgb(0, 0, 0);
+
+/*
+ * Checks that the parsed animation renders exactly as the C++ animation.
+ */
+static void expect_same_animation(const char* text, const Animation& expected) {
+	SCOPED_TRACE(text);
+	ParseError error;
+	FctWrapper<color> parsed(OFF);
+	ASSERT_TRUE(parse(text, parsed, &error)) << "error at " << error.position;
+	ASSERT_EQ(error.message, nullptr);
+
+	LedPanel panel(16, 16, LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	for(pixled::time t = 0; t < 100; t += 3) {
+		for(auto l : panel.leds()) {
+			color c1 = expected(l, t);
+			color c2 = parsed(l, t);
+			ASSERT_EQ(c1.red(), c2.red()) << "led " << l.index << ", t=" << t;
+			ASSERT_EQ(c1.green(), c2.green()) << "led " << l.index << ", t=" << t;
+			ASSERT_EQ(c1.blue(), c2.blue()) << "led " << l.index << ", t=" << t;
+		}
+	}
+}
+
+/*
+ * Checks that `text` is parsed to the same graph as `expected`.
+ */
+template<typename R>
+static void expect_same_graph(const char* text, const base::Function<R>& expected) {
+	SCOPED_TRACE(text);
+	ParseError error;
+	std::vector<std::uint8_t> parsed = compile<R>(text, &error);
+	ASSERT_FALSE(parsed.empty()) << "error at " << error.position;
+	ASSERT_EQ(parsed, serialize(expected));
+}
+
+static void expect_error(const char* text, std::size_t position, const char* message) {
+	SCOPED_TRACE(text);
+	ParseError error;
+	FctWrapper<color> parsed(OFF);
+	ASSERT_FALSE(parse(text, parsed, &error));
+	ASSERT_EQ(error.position, position);
+	ASSERT_STREQ(error.message, message);
+	ASSERT_EQ(parsed({{0, 0}, 0}, 0), OFF);
+}
+
+TEST(Parser, operators) {
+	expect_same_graph("hsb(Rainbow(20), 1, 0.5 + 0.5*Sine(X()/8 - T()/40))",
+			hsb(Rainbow(20), 1.f, .5f + .5f * Sine(X() / 8 - T() / 40)));
+	expect_same_graph("I() % 2 == 0", I() % 2 == (index_t) 0);
+	expect_same_graph("X() <= 3", X() <= 3);
+	expect_same_graph("Y() > 2.5f", Y() > 2.5f);
+	expect_same_graph("-X() * 2", (0 - X()) * 2);
+	expect_same_graph("T() - 10 / 4 * 3", T() - 6);
+	expect_same_graph("If<color>(X() > 8, RED, Blink(BLUE, 10))",
+			If<color>(X() > 8, RED, Blink(BLUE, 10)));
+}
+
+TEST(Parser, scenes) {
+	expect_same_animation("Blink(PURPLE, 4)", Blink(PURPLE, 4));
+	expect_same_animation(
+			"Blooming(hsb(Rainbow(20), 1, 1), Point(Wave<coordinate>(40, 8, 4), 9), Wave<coordinate>(20, 10, 5))",
+			Blooming(
+				hsb(Rainbow(20), 1.f, 1.f),
+				Point(Wave<coordinate>(40, 8, 4), 9),
+				Wave<coordinate>(20, 10, 5)));
+	expect_same_animation(
+			"rgb(Cast<uint8_t>(255 * LinearUnitWave(8, 20, XLine(8))), 0, 0)",
+			rgb(Cast<std::uint8_t>(255 * LinearUnitWave(8, 20, XLine(8))), (std::uint8_t) 0, (std::uint8_t) 0));
+	expect_same_animation(
+			"hsb(RadialRainbowWave(32, 40, point(8, 8)), 1, 1)",
+			hsb(RadialRainbowWave(32, 40, point(8, 8)), 1.f, 1.f));
+	expect_same_animation(
+			"If<color>(Cast<int>(X() + Y()) % 2 == 0,"
+			" rgb(0, UniformDistribution<uint8_t>(50, 200, RandomXYT(10, 42)), 0),"
+			" rgb(0, 0, UniformDistribution<uint8_t>(50, 200, RandomXYT(10, 43))))",
+			If<color>(
+				Cast<int>(X() + Y()) % 2 == 0,
+				rgb(0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, 42)), 0),
+				rgb(0, 0, UniformDistribution<std::uint8_t>(50, 200, RandomXYT(10, 43)))));
+	expect_same_animation(
+			"hsb(NormalDistribution<float>(Rainbow(50), 20, RandomT(10, 42)), 1, 1)",
+			hsb(NormalDistribution<float>(Rainbow(50), 20, RandomT(10, 42)), 1.f, 1.f));
+	expect_same_animation(
+			"rgb(0, 0, Cast<uint8_t>(122 + 50 * Sawtooth(Distance(Point(X(), Y()), point(8, 8)) / 8.f - T() / 10.f)))",
+			rgb(0, 0, Cast<std::uint8_t>(122 + (50 * Sawtooth(
+							Distance(Point(X(), Y()), point(8, 8)) / 8.f - T() / 10.f)))));
+	expect_same_animation(
+			"hsb(Cast<float>(FixedSine(Cast<fixed>(X()) / 8) * 180) + 180, 1, .5)",
+			hsb(Cast<float>(FixedSine(Cast<fixed>(X()) / fixed(8)) * fixed(180)) + 180.f, 1.f, .5f));
+
+	Blink anim1(PURPLE, 4);
+	hsb anim2(RadialRainbowWave(32, 40, point(8, 8)), 1.f, 1.f);
+	animation::Sequence anim3({{RED, 10}, {GREEN, 10}, {BLUE, 10}});
+	expect_same_animation(
+			"Sequence("
+			" Blink(PURPLE, 4), 20,"
+			" hsb(RadialRainbowWave(32, 40, point(8, 8)), 1, 1), 20,"
+			" Sequence(RED, 10, GREEN, 10, BLUE, 10), 40)",
+			animation::Sequence({{anim1, 20}, {anim2, 20}, {anim3, 40}}));
+}
+
+TEST(Parser, folding) {
+	FctWrapper<color> c(OFF);
+	ASSERT_TRUE(parse("hsb(120 + 2*30, 1, 0.5)", c));
+	ASSERT_NE((*c).constant(), nullptr);
+	ASSERT_EQ(*(*c).constant(), color::hsb(180.f, 1.f, .5f));
+
+	ASSERT_TRUE(parse("rgb(255, 0, 0)", c));
+	ASSERT_NE((*c).constant(), nullptr);
+	ASSERT_EQ(*(*c).constant(), RED);
+
+	// Only the constant subexpression is folded
+	float sine = Sine(.1f)({{0, 0}, 0}, 0);
+	expect_same_graph("Sine(0.1) * X()", sine * X());
+	expect_same_graph("Distance(point(0, 0), point(3, 4)) + X()", 5.f + X());
+
+	// Functions of the time are never folded
+	FctWrapper<float> f(0.f);
+	ASSERT_TRUE(parse("Wave<float>(20, 0, 1)", f));
+	ASSERT_EQ((*f).constant(), nullptr);
+}
+
+TEST(Parser, literals) {
+	FctWrapper<float> f(0.f);
+	ASSERT_TRUE(parse("1.5e1 + .5f", f));
+	ASSERT_FLOAT_EQ(f({{0, 0}, 0}, 0), 15.5f);
+	ASSERT_TRUE(parse("7 / 2", f));
+	ASSERT_FLOAT_EQ(f({{0, 0}, 0}, 0), 3.f);
+	ASSERT_TRUE(parse("-(7 / 2.)", f));
+	ASSERT_FLOAT_EQ(f({{0, 0}, 0}, 0), -3.5f);
+
+	FctWrapper<bool> b(false);
+	ASSERT_TRUE(parse("3 >= 2", b));
+	ASSERT_TRUE(b({{0, 0}, 0}, 0));
+	ASSERT_TRUE(parse("false", b));
+	ASSERT_FALSE(b({{0, 0}, 0}, 0));
+
+	FctWrapper<std::uint8_t> u(0);
+	ASSERT_TRUE(parse("255", u));
+	ASSERT_EQ(u({{0, 0}, 0}, 0), 255);
+	ASSERT_FALSE(parse("256", u));
+	ASSERT_FALSE(parse("-1", u));
+}
+
+TEST(Parser, errors) {
+	expect_error("", 0, "expected expression");
+	expect_error("hsb(Rainbow(20), 1)", 0, "no matching function");
+	expect_error("hsb(Foo(20), 1, 1)", 4, "unknown identifier");
+	expect_error("rgb(256, 0, 0)", 0, "no matching function");
+	expect_error("rgb(X(), 0, 0)", 0, "no matching function");
+	expect_error("hsb(1, 1, 1", 11, "expected ')'");
+	expect_error("hsb(1, 1, 1))", 12, "unexpected character");
+	expect_error("hsb(1, 1 +, 1)", 10, "expected expression");
+	expect_error("hsb", 3, "expected '('");
+	expect_error("Cast<double>(X())", 5, "unknown type");
+	expect_error("X()", 0, "type mismatch");
+	expect_error("1", 0, "type mismatch");
+	expect_error("hsb(X() / 0, 1, 1)", 10, "division by zero");
+	expect_error("hsb(1 % 0, 1, 1)", 8, "division by zero");
+	expect_error("hsb(1.5 % 2, 1, 1)", 4, "invalid operands");
+	expect_error("hsb(1.5.2, 1, 1)", 4, "invalid number");
+	expect_error("hsb(99999999999, 1, 1)", 4, "invalid number");
+	expect_error("rgb(UniformDistribution<uint8_t>(0, 255, RandomT(0, 1)), 0, 0)", 41, "invalid arguments");
+	expect_error("Sequence(RED, 10, BLUE)", 0, "invalid arguments");
+	expect_error("Sequence(RED, 0)", 14, "invalid duration");
+
+	std::string deep;
+	for(int i = 0; i < 100; i++)
+		deep += "(";
+	expect_error(deep.c_str(), 64, "expression too deep");
+}
+
+TEST(Parser, compile) {
+	const char* text = "hsb(Rainbow(20), 1, 0.5 + 0.5*Sine(X()/8 - T()/40))";
+	std::vector<std::uint8_t> data = compile<color>(text);
+	ASSERT_FALSE(data.empty());
+
+	resetAllocationStats();
+	FunctionGraph<color> graph(data);
+	ASSERT_TRUE(graph.isValid());
+	ASSERT_EQ(allocationStats().heap_allocations, 0);
+	expect_same_animation(text, graph);
+
+	ParseError error;
+	ASSERT_TRUE(compile<color>("hsb(", &error).empty());
+	ASSERT_STREQ(error.message, "expected expression");
+}
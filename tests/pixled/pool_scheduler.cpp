@@ -0,0 +1,136 @@
+#include "pixled/pool_scheduler.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+
+#include <atomic>
+
+using namespace testing;
+
+/*
+ * Simulated clock, in milliseconds, shared by the worker threads.
+ */
+static std::atomic<long> fake_time {0};
+
+static pixled::PoolScheduler::clock::time_point fake_now() {
+	return pixled::PoolScheduler::clock::time_point(std::chrono::milliseconds(fake_time.load()));
+}
+
+/*
+ * Output that moves the simulated clock forward by `delay` ms for each led.
+ */
+class FakeClockOutput : public pixled::Output {
+	public:
+		long delay;
+
+		FakeClockOutput(long delay) : delay(delay) {}
+
+		void write(const pixled::color&, std::size_t) override {
+			fake_time += delay;
+		}
+};
+
+class PoolSchedulerTest : public Test {
+	protected:
+		pixled::mapping::LedStrip strip {1};
+		pixled::chroma::rgb animation {10, 20, 30};
+
+		void SetUp() override {
+			fake_time = 0;
+		}
+
+		/*
+		 * Polls the scheduler every ms of simulated time, until `duration`
+		 * ms have elapsed, waiting for dispatched frames to complete.
+		 */
+		void run(pixled::PoolScheduler& scheduler, long duration) {
+			long end = fake_time + duration;
+			while(fake_time < end) {
+				scheduler.poll();
+				scheduler.wait();
+				fake_time++;
+			}
+		}
+};
+
+TEST_F(PoolSchedulerTest, fps) {
+	FakeClockOutput output(0);
+	pixled::Runtime fast(strip, output, animation);
+	pixled::Runtime slow(strip, output, animation);
+	pixled::ThreadPool pool(2);
+	pixled::PoolScheduler scheduler(pool);
+	scheduler.setClock(&fake_now);
+	scheduler.add(fast, 100);
+	scheduler.add(slow, 25);
+
+	run(scheduler, 200);
+	ASSERT_EQ(scheduler.frames(fast), 20);
+	ASSERT_EQ(scheduler.frames(slow), 5);
+	ASSERT_EQ(fast.current_time(), scheduler.frames(fast));
+	ASSERT_EQ(scheduler.skippedFrames(fast), 0);
+}
+
+TEST_F(PoolSchedulerTest, skip_frames) {
+	// Each frame takes 12 ms, for a period of 5 ms
+	FakeClockOutput output(12);
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::ThreadPool pool(1);
+	pixled::PoolScheduler scheduler(pool, pixled::SKIP_FRAMES);
+	scheduler.setClock(&fake_now);
+	scheduler.add(runtime, 200);
+
+	run(scheduler, 100);
+	ASSERT_GT(scheduler.frames(runtime), 0);
+	ASSERT_GT(scheduler.skippedFrames(runtime), 0);
+	ASSERT_EQ(runtime.current_time(),
+			scheduler.frames(runtime) + scheduler.skippedFrames(runtime));
+}
+
+TEST_F(PoolSchedulerTest, priority) {
+	// Frames are always late, and only one frame can be in progress
+	FakeClockOutput output(2);
+	pixled::Runtime low(strip, output, animation);
+	pixled::Runtime high(strip, output, animation);
+	pixled::ThreadPool pool(1);
+	pixled::PoolScheduler scheduler(pool, pixled::SLOW_DOWN);
+	scheduler.setClock(&fake_now);
+	scheduler.add(low, 1000, 0);
+	scheduler.add(high, 1000, 1);
+
+	run(scheduler, 50);
+	ASSERT_GT(scheduler.frames(high), 0);
+	ASSERT_EQ(scheduler.frames(low), 0);
+}
+
+TEST_F(PoolSchedulerTest, deadline_order) {
+	// With the same priority, the oldest deadline is dispatched first
+	FakeClockOutput output(2);
+	pixled::Runtime r1(strip, output, animation);
+	pixled::Runtime r2(strip, output, animation);
+	pixled::ThreadPool pool(1);
+	pixled::PoolScheduler scheduler(pool, pixled::SLOW_DOWN);
+	scheduler.setClock(&fake_now);
+	scheduler.add(r1, 1000);
+	scheduler.add(r2, 1000);
+
+	run(scheduler, 50);
+	ASSERT_GT(scheduler.frames(r1), 0);
+	ASSERT_NEAR(scheduler.frames(r1), scheduler.frames(r2), 1);
+}
+
+TEST_F(PoolSchedulerTest, run) {
+	FakeClockOutput output(0);
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::ThreadPool pool(1);
+	pixled::PoolScheduler scheduler(pool);
+	scheduler.add(runtime, 1000);
+
+	// A stop requested before the loop starts is not lost
+	scheduler.stop();
+	scheduler.run();
+	ASSERT_EQ(scheduler.frames(runtime), 0);
+
+	// Only checks that frames are rendered, whatever the load of the host
+	scheduler.run(std::chrono::milliseconds(20));
+	ASSERT_GT(scheduler.frames(runtime), 0);
+}
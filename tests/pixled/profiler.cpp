@@ -0,0 +1,110 @@
+#include "pixled/profiler.h"
+#include "pixled/runtime.h"
+#include "pixled/thread_pool.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/signal/signal.h"
+#include "pixled/arithmetic/arithmetic.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace testing;
+using namespace pixled;
+
+class NullOutput : public pixled::Output {
+	public:
+		void write(const pixled::color&, std::size_t) override {
+		}
+};
+
+TEST(Profiler, call_tree) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	pixled::chroma::hsb animation {
+		20.f * pixled::geometry::X(),
+		1.f,
+		pixled::signal::Sine(pixled::geometry::Y())
+	};
+	pixled::Profiler profiler;
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setProfiler(&profiler);
+	ASSERT_EQ(runtime.profiler(), &profiler);
+
+	for(int i = 0; i < 3; i++)
+		runtime.next();
+	ASSERT_EQ(profiler.frames(), 3);
+	ASSERT_EQ(pixled::Profiler::active(), nullptr);
+
+	// root, hsb, Multiply, X, Sine, Y: inline constants are not recorded
+	const auto& nodes = profiler.nodes();
+	ASSERT_THAT(nodes, SizeIs(6));
+	ASSERT_THAT(nodes[0].children, SizeIs(1));
+	const auto& root = nodes[nodes[0].children[0]];
+	ASSERT_EQ(root.function, &animation);
+	ASSERT_EQ(*root.type, typeid(pixled::chroma::hsb));
+	ASSERT_THAT(root.children, SizeIs(2));
+	for(std::size_t i = 1; i < nodes.size(); i++) {
+		ASSERT_EQ(nodes[i].calls, 3 * 12);
+		if(nodes[i].parent != 0) {
+			ASSERT_LE(nodes[i].time, nodes[nodes[i].parent].time);
+		}
+	}
+	for(const auto& node : nodes) {
+		if(node.type && *node.type == typeid(pixled::geometry::Y)) {
+			ASSERT_EQ(*nodes[node.parent].type, typeid(pixled::signal::Sine));
+		}
+	}
+	ASSERT_EQ(profiler.totalTime(), root.time);
+
+	std::ostringstream report;
+	profiler.report(report);
+	ASSERT_THAT(report.str(), HasSubstr("frames: 3"));
+	ASSERT_THAT(report.str(), HasSubstr("\nchroma::hsb "));
+	ASSERT_THAT(report.str(), HasSubstr("\n    geometry::Y "));
+
+	// Calls outside of frames are not recorded
+	runtime.setProfiler(nullptr);
+	runtime.next();
+	ASSERT_EQ(root.calls, 3 * 12);
+
+	profiler.reset();
+	ASSERT_THAT(profiler.nodes(), SizeIs(1));
+	ASSERT_EQ(profiler.frames(), 0);
+}
+
+TEST(Profiler, thread_pool) {
+	pixled::mapping::LedPanel panel(16, 16, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	NullOutput output;
+	pixled::chroma::hsb animation {
+		20.f * pixled::geometry::X(),
+		1.f,
+		pixled::signal::Sine(pixled::geometry::Y())
+	};
+	pixled::ThreadPool pool(4);
+	pixled::Profiler profiler;
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setThreadPool(&pool, 16);
+	runtime.setProfiler(&profiler);
+
+	// Frames are not split, so that all the calls are recorded
+	for(int i = 0; i < 3; i++)
+		runtime.next();
+	const auto& nodes = profiler.nodes();
+	ASSERT_THAT(nodes, SizeIs(6));
+	for(std::size_t i = 1; i < nodes.size(); i++)
+		ASSERT_EQ(nodes[i].calls, 3 * 256);
+
+	// The Profiler is only active on the calling thread
+	profiler.activate();
+	pixled::Profiler* other_thread_profiler = &profiler;
+	std::thread thread([&other_thread_profiler] {
+			other_thread_profiler = pixled::Profiler::active();
+			});
+	thread.join();
+	ASSERT_EQ(pixled::Profiler::active(), &profiler);
+	ASSERT_EQ(other_thread_profiler, nullptr);
+	profiler.deactivate();
+}
@@ -1,5 +1,6 @@
 #include "pixled/random/random.h"
 #include "gmock/gmock.h"
+#include <array>
 
 #define NUM_PERIOD 50000
 
@@ -228,3 +229,48 @@ TEST(RandomXYT, auto_seed) {
 
 	ASSERT_THAT(values_1, Not(ElementsAreArray(values_2)));
 }
+
+TEST(RandomT, may_change) {
+	pixled::random::RandomT engine (10);
+	pixled::random::UniformDistribution<int> rd(1, 25, engine);
+	pixled::led l {{2, 3}, 4};
+
+	for(pixled::time t = 0; t < 100; t++)
+		ASSERT_EQ(rd.mayChange(l, t), t % 10 == 9);
+}
+
+TEST(RandomT, out_of_order) {
+	pixled::random::RandomT engine (10, 42);
+	pixled::random::UniformDistribution<int> rd(0, 255, engine);
+	pixled::led l {{2, 3}, 4};
+
+	std::array<int, 100> values;
+	for(pixled::time t = 0; t < 100; t++)
+		values[t] = rd(l, 10 * t);
+
+	// Same values backward, from a copy, or when jumping to a frame
+	pixled::random::UniformDistribution<int> copy(rd);
+	for(pixled::time t = 100; t > 0; t--) {
+		ASSERT_EQ(rd(l, 10 * (t-1)), values[t-1]);
+		ASSERT_EQ(copy(l, 10 * (t-1)), values[t-1]);
+	}
+	ASSERT_EQ(pixled::random::UniformDistribution<int>(0, 255, pixled::random::RandomT(10, 42))(l, 500), values[50]);
+	ASSERT_TRUE(rd.stateless());
+}
+
+TEST(RandomXYT, out_of_order) {
+	pixled::random::RandomXYT engine (10, 42);
+	pixled::random::UniformDistribution<int> rd(0, 255, engine);
+	// Led indexes are not bounded
+	std::array<pixled::led, 3> leds {{{{0, 0}, 0}, {{1, 0}, 1}, {{2, 0}, 100000}}};
+
+	std::array<std::array<int, 3>, 100> values;
+	for(pixled::time t = 0; t < 100; t++)
+		for(std::size_t i = 0; i < leds.size(); i++)
+			values[t][i] = rd(leds[i], 10 * t);
+
+	for(pixled::time t = 100; t > 0; t--)
+		for(std::size_t i = leds.size(); i > 0; i--)
+			ASSERT_EQ(rd(leds[i-1], 10 * (t-1)), values[t-1][i-1]);
+	ASSERT_TRUE(rd.stateless());
+}
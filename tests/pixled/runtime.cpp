@@ -0,0 +1,366 @@
+#include "pixled/runtime.h"
+#include "pixled/mapping/mapping.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/arithmetic/arithmetic.h"
+#include "pixled/chrono/chrono.h"
+#include "pixled/signal/signal.h"
+#include "pixled/animation/animation.h"
+#include "../mocks/mock_output.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace testing;
+using namespace pixled;
+
+/*
+ * Periodic animation that counts its evaluations.
+ */
+class CountingAnimation : public pixled::base::Function<pixled::color> {
+	public:
+		mutable std::size_t count = 0;
+
+		pixled::color operator()(pixled::led l, pixled::time t) const override {
+			count++;
+			return pixled::color::rgb(l.index, t % 3, 0);
+		}
+
+		CountingAnimation* copy() const override {
+			return new CountingAnimation;
+		}
+
+		pixled::time periodicity() const override {
+			return 3;
+		}
+};
+
+/*
+ * Output that keeps the last written frame.
+ */
+class BufferOutput : public pixled::Output {
+	public:
+		bool partial;
+		std::vector<std::uint8_t> buffer;
+		std::size_t written_leds = 0;
+
+		BufferOutput(std::size_t size, bool partial)
+			: partial(partial), buffer(3*size) {}
+
+		void write(const pixled::color& c, std::size_t i) override {
+			written_leds++;
+			buffer[3*i] = c.red();
+			buffer[3*i+1] = c.green();
+			buffer[3*i+2] = c.blue();
+		}
+
+		bool partialUpdates() const override {
+			return partial;
+		}
+};
+
+class RuntimeTest : public Test {
+	protected:
+		NiceMock<pixled::MockOutput> output;
+		// Red on x, green on y
+		pixled::chroma::rgb animation {
+			pixled::Cast<uint8_t>(10.f * pixled::geometry::X() + .5f),
+			pixled::Cast<uint8_t>(10.f * pixled::geometry::Y() + .5f),
+			pixled::Cast<uint8_t>(pixled::chrono::T())
+		};
+
+		void checkFrames(pixled::Mapping& mapping, pixled::Mapping& expected) {
+			pixled::Runtime runtime(mapping, output, animation);
+			for(pixled::time t = 0; t < 3; t++) {
+				for(auto led : expected.leds())
+					EXPECT_CALL(output, write(animation(led, t), led.index));
+				runtime.next();
+				Mock::VerifyAndClearExpectations(&output);
+			}
+		}
+};
+
+TEST_F(RuntimeTest, explicit_mapping) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+
+	checkFrames(panel, panel);
+}
+
+TEST_F(RuntimeTest, implicit_mapping) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	pixled::mapping::ImplicitLedPanel implicit_panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+
+	checkFrames(implicit_panel, panel);
+}
+
+class RuntimeFrameCacheTest : public RuntimeTest, public WithParamInterface<pixled::FRAME_ENCODING> {
+};
+
+TEST_P(RuntimeFrameCacheTest, frame_cache) {
+	pixled::mapping::ImplicitLedStrip strip(10);
+	CountingAnimation counting_animation;
+	pixled::Runtime runtime(strip, output, counting_animation);
+
+	ASSERT_EQ(runtime.frameCache(), nullptr);
+	ASSERT_TRUE(runtime.enableFrameCache(GetParam()));
+	ASSERT_EQ(runtime.frameCache()->period(), 3);
+	ASSERT_EQ(runtime.frameCache()->ledCount(), 10);
+
+	for(pixled::time t = 0; t < 9; t++) {
+		for(auto led : strip.leds())
+			EXPECT_CALL(output, write(counting_animation(led, t), led.index));
+		runtime.next();
+		Mock::VerifyAndClearExpectations(&output);
+	}
+	// 9 frames rendered by the test itself, and only 3 by the runtime
+	ASSERT_EQ(counting_animation.count, 12*10);
+	ASSERT_TRUE(runtime.frameCache()->complete());
+
+	runtime.disableFrameCache();
+	ASSERT_EQ(runtime.frameCache(), nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(Runtime, RuntimeFrameCacheTest, Values(
+			pixled::RAW_FRAMES, pixled::DELTA_FRAMES
+			));
+
+TEST_F(RuntimeTest, frame_cache_unknown_period) {
+	pixled::mapping::ImplicitLedStrip strip(10);
+	pixled::Runtime runtime(strip, output, animation);
+
+	ASSERT_FALSE(runtime.enableFrameCache());
+	ASSERT_EQ(runtime.frameCache(), nullptr);
+	ASSERT_FALSE(runtime.enableFrameCache(0));
+	ASSERT_EQ(runtime.frameCache(), nullptr);
+}
+
+class RuntimeDirtyTrackingTest : public TestWithParam<bool> {
+};
+
+TEST_P(RuntimeDirtyTrackingTest, moving_blooming) {
+	pixled::mapping::ImplicitLedStrip strip(100);
+	BufferOutput output(100, GetParam());
+	// A red spot that moves along the strip
+	pixled::animation::Blooming animation(
+			pixled::chroma::rgb(255, 0, 0),
+			pixled::geometry::Point(pixled::Cast<pixled::coordinate>(pixled::chrono::T()), 0.f),
+			1.5f
+			);
+	pixled::Runtime runtime(strip, output, animation);
+	runtime.enableDirtyTracking();
+
+	for(pixled::time t = 0; t < 90; t++) {
+		output.written_leds = 0;
+		runtime.next();
+
+		if(t == 0) {
+			ASSERT_EQ(runtime.evaluatedLeds(), 100);
+		} else {
+			ASSERT_LT(runtime.evaluatedLeds(), 10);
+		}
+		if(GetParam() && t > 0) {
+			ASSERT_LT(output.written_leds, 10);
+		} else {
+			ASSERT_EQ(output.written_leds, 100);
+		}
+		for(auto led : strip.leds()) {
+			pixled::color c = animation(led, t);
+			ASSERT_EQ(output.buffer[3*led.index], c.red());
+			ASSERT_EQ(output.buffer[3*led.index+1], c.green());
+			ASSERT_EQ(output.buffer[3*led.index+2], c.blue());
+		}
+	}
+
+	// Tracking restarts from a complete frame
+	runtime.enableDirtyTracking();
+	runtime.next();
+	ASSERT_EQ(runtime.evaluatedLeds(), 100);
+}
+
+TEST_P(RuntimeDirtyTrackingTest, phase) {
+	pixled::mapping::ImplicitLedStrip strip(10);
+	BufferOutput output(10, GetParam());
+	pixled::chroma::hsb animation(
+			0.f, 1.f,
+			.5f * (1.f + pixled::signal::Sine(pixled::chrono::Phase(40)))
+			);
+	pixled::Runtime runtime(strip, output, animation);
+	runtime.enableDirtyTracking();
+
+	for(pixled::time t = 0; t < 80; t++) {
+		runtime.next();
+		ASSERT_EQ(runtime.evaluatedLeds(), 10);
+		for(auto led : strip.leds()) {
+			pixled::color c = animation(led, t);
+			ASSERT_EQ(output.buffer[3*led.index], c.red());
+			ASSERT_EQ(output.buffer[3*led.index+1], c.green());
+			ASSERT_EQ(output.buffer[3*led.index+2], c.blue());
+		}
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Runtime, RuntimeDirtyTrackingTest, Bool());
+
+class RuntimeOutputStageTest : public TestWithParam<int> {
+};
+
+TEST_P(RuntimeOutputStageTest, output_stage) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	BufferOutput output(12, true);
+	pixled::chroma::rgb animation {
+		pixled::Cast<uint8_t>(20.f * pixled::geometry::X() + .5f),
+		pixled::Cast<uint8_t>(20.f * pixled::geometry::Y() + .5f),
+		200
+	};
+	pixled::OutputStage stage;
+	stage.setGamma(2.2f);
+	stage.setBrightness(128);
+
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setOutputStage(&stage);
+	ASSERT_EQ(runtime.outputStage(), &stage);
+	switch(GetParam()) {
+		case 1:
+			runtime.enableDirtyTracking();
+			break;
+		case 2:
+			runtime.enableFrameCache(1);
+			break;
+	}
+
+	std::vector<std::uint8_t> expected(3*12);
+	for(auto led : panel.leds()) {
+		pixled::color c = animation(led, 0);
+		expected[3*led.index] = c.red();
+		expected[3*led.index+1] = c.green();
+		expected[3*led.index+2] = c.blue();
+	}
+	pixled::OutputStage expected_stage;
+	expected_stage.setGamma(2.2f);
+	expected_stage.setBrightness(128);
+	expected_stage.apply(expected.data(), 12);
+
+	for(pixled::time t = 0; t < 3; t++) {
+		output.written_leds = 0;
+		runtime.next();
+		// Complete frames are written, even with dirty tracking
+		ASSERT_EQ(output.written_leds, 12);
+		ASSERT_THAT(output.buffer, ElementsAreArray(expected));
+	}
+	ASSERT_EQ(stage.lastSum(), expected_stage.lastSum());
+
+	runtime.setOutputStage(nullptr);
+	runtime.next();
+	ASSERT_EQ(output.buffer[3*11+2], 200);
+}
+
+INSTANTIATE_TEST_SUITE_P(Runtime, RuntimeOutputStageTest, Values(0, 1, 2));
+
+TEST_F(RuntimeTest, time_step) {
+	pixled::mapping::LedStrip strip {1};
+	pixled::Runtime runtime(strip, output, animation);
+	ASSERT_EQ(runtime.timeStep(), 1);
+
+	runtime.setTimeStep(20);
+	for(pixled::time t = 0; t < 100; t += 20) {
+		EXPECT_CALL(output, write(animation(strip.leds()[0], t), 0));
+		runtime.next();
+		Mock::VerifyAndClearExpectations(&output);
+	}
+	ASSERT_EQ(runtime.current_time(), 100);
+
+	EXPECT_CALL(output, write(animation(strip.leds()[0], 100), 0));
+	runtime.prev();
+	ASSERT_EQ(runtime.current_time(), 80);
+}
+
+TEST(Runtime, dithering) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	BufferOutput output(12, true);
+	// Dim red, between two 8 bits steps
+	pixled::chroma::hsb animation {0.f, 1.f, .01f};
+	pixled::OutputStage stage;
+	stage.setDithering(pixled::OutputStage::TEMPORAL_DITHERING);
+
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setOutputStage(&stage);
+
+	pixled::color c = animation({{0, 0}, 0}, 0);
+	ASSERT_EQ(c.red(), 2);
+	std::uint32_t sum = 0;
+	const int frames = 100;
+	for(int t = 0; t < frames; t++) {
+		runtime.next();
+		ASSERT_THAT(output.buffer[0], AnyOf(2, 3));
+		ASSERT_EQ(output.buffer[1], 0);
+		sum += output.buffer[0];
+	}
+	ASSERT_NEAR((float) sum / frames, c.red16() / 257.f, .05f);
+}
+
+/*
+ * Output that takes some time to write frames.
+ */
+class SlowOutput : public pixled::Output {
+	public:
+		void write(const pixled::color&, std::size_t) override {
+		}
+
+		void writeFrame(const std::uint8_t*, std::size_t) override {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+};
+
+TEST(Runtime, frame_stats) {
+	pixled::mapping::LedPanel panel(4, 3, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	SlowOutput output;
+	pixled::chroma::rgb animation {10, 20, 30};
+	pixled::FrameStats stats(1000);
+	pixled::OutputStage stage;
+
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setFrameStats(&stats);
+	ASSERT_EQ(runtime.frameStats(), &stats);
+	// Frames are written at once through the output stage
+	runtime.setOutputStage(&stage);
+	for(int i = 0; i < 5; i++)
+		runtime.next();
+
+	ASSERT_EQ(stats.frames(), 5);
+	ASSERT_GE(stats.outputTimes().p50, 2000);
+	ASSERT_LT(stats.renderTimes().p50, 2000);
+	// Output times exceed the budget
+	ASSERT_EQ(stats.droppedFrames(), 5);
+	ASSERT_GT(stats.ledsPerSecond(), 0);
+
+	runtime.setFrameStats(nullptr);
+	runtime.next();
+	ASSERT_EQ(stats.frames(), 5);
+}
+
+TEST(Runtime, thread_pool) {
+	pixled::mapping::LedPanel panel(16, 16, pixled::mapping::LEFT_RIGHT_RIGHT_LEFT_FROM_BOTTOM);
+	pixled::chroma::rgb animation {
+		pixled::Cast<uint8_t>(10.f * pixled::geometry::X() + .5f),
+		pixled::Cast<uint8_t>(10.f * pixled::geometry::Y() + .5f),
+		pixled::Cast<uint8_t>(pixled::chrono::T())
+	};
+	BufferOutput expected(256, false);
+	BufferOutput output(256, false);
+	pixled::ThreadPool pool(4);
+
+	pixled::Runtime reference(panel, expected, animation);
+	pixled::Runtime runtime(panel, output, animation);
+	runtime.setThreadPool(&pool, 10);
+	ASSERT_EQ(runtime.threadPool(), &pool);
+	for(int i = 0; i < 3; i++) {
+		reference.next();
+		runtime.next();
+		ASSERT_THAT(output.buffer, ElementsAreArray(expected.buffer));
+	}
+
+	runtime.setThreadPool(nullptr);
+	reference.next();
+	runtime.next();
+	ASSERT_THAT(output.buffer, ElementsAreArray(expected.buffer));
+}
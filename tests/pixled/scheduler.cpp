@@ -0,0 +1,162 @@
+#include "pixled/scheduler.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+
+#include <thread>
+
+using namespace testing;
+
+/*
+ * Output that takes `delay` to write each led.
+ */
+class DelayOutput : public pixled::Output {
+	public:
+		std::chrono::milliseconds delay;
+
+		DelayOutput(std::chrono::milliseconds delay) : delay(delay) {}
+
+		void write(const pixled::color&, std::size_t) override {
+			std::this_thread::sleep_for(delay);
+		}
+};
+
+class SchedulerTest : public Test {
+	protected:
+		pixled::mapping::LedStrip strip {1};
+		pixled::chroma::rgb animation {10, 20, 30};
+};
+
+TEST_F(SchedulerTest, settings) {
+	pixled::Scheduler scheduler(50);
+	ASSERT_FLOAT_EQ(scheduler.fps(), 50);
+	ASSERT_EQ(scheduler.policy(), pixled::SKIP_FRAMES);
+
+	scheduler.setFps(25);
+	scheduler.setPolicy(pixled::SLOW_DOWN);
+	ASSERT_FLOAT_EQ(scheduler.fps(), 25);
+	ASSERT_EQ(scheduler.policy(), pixled::SLOW_DOWN);
+}
+
+TEST_F(SchedulerTest, fixed_fps) {
+	DelayOutput output(std::chrono::milliseconds(0));
+	pixled::Runtime runtime1(strip, output, animation);
+	pixled::Runtime runtime2(strip, output, animation);
+	pixled::Scheduler scheduler(200);
+	scheduler.add(runtime1);
+	scheduler.add(runtime2);
+
+	auto start = std::chrono::steady_clock::now();
+	scheduler.run(20);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	// The first frame is rendered immediately, then one frame every 5ms
+	ASSERT_GE(elapsed, std::chrono::microseconds(95000));
+	ASSERT_LT(elapsed, std::chrono::microseconds(150000));
+	ASSERT_EQ(scheduler.frames(), 20);
+	ASSERT_EQ(scheduler.skippedFrames(), 0);
+	ASSERT_EQ(runtime1.current_time(), 20);
+	ASSERT_EQ(runtime2.current_time(), 20);
+}
+
+TEST_F(SchedulerTest, skip_frames) {
+	// Frames take more than 2 periods
+	DelayOutput output(std::chrono::milliseconds(12));
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::Scheduler scheduler(200, pixled::SKIP_FRAMES);
+	scheduler.add(runtime);
+
+	auto start = std::chrono::steady_clock::now();
+	scheduler.run(5);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	ASSERT_EQ(scheduler.frames(), 5);
+	ASSERT_GT(scheduler.skippedFrames(), 0);
+	// Time keeps up with the wall clock
+	ASSERT_EQ(runtime.current_time(), scheduler.frames() + scheduler.skippedFrames());
+	ASSERT_NEAR(runtime.current_time(), elapsed / std::chrono::milliseconds(5), 2);
+}
+
+TEST_F(SchedulerTest, slow_down) {
+	DelayOutput output(std::chrono::milliseconds(12));
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::Scheduler scheduler(200, pixled::SLOW_DOWN);
+	scheduler.add(runtime);
+
+	auto start = std::chrono::steady_clock::now();
+	scheduler.run(5);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	// All frames are rendered, without waiting between late frames
+	ASSERT_EQ(scheduler.frames(), 5);
+	ASSERT_EQ(scheduler.skippedFrames(), 0);
+	ASSERT_EQ(runtime.current_time(), 5);
+	ASSERT_GE(elapsed, std::chrono::milliseconds(60));
+	ASSERT_LT(elapsed, std::chrono::milliseconds(100));
+}
+
+TEST_F(SchedulerTest, time_resolution) {
+	DelayOutput output(std::chrono::milliseconds(0));
+	pixled::Runtime runtime(strip, output, animation);
+	runtime.seek(1000);
+	pixled::Scheduler scheduler(100);
+	scheduler.setTimeResolution(1000);
+	ASSERT_EQ(scheduler.timeResolution(), 1000);
+	scheduler.add(runtime);
+
+	// Frames are rendered at 0, 10, 20, 30 and 40 ms
+	scheduler.run(5);
+	ASSERT_NEAR(runtime.current_time(), 1000 + 40 + 1, 5);
+}
+
+TEST_F(SchedulerTest, time_resolution_slow_down) {
+	// Frames take 12 ms instead of 5 ms
+	DelayOutput output(std::chrono::milliseconds(12));
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::Scheduler scheduler(200, pixled::SLOW_DOWN);
+	scheduler.setTimeResolution(1000);
+	scheduler.add(runtime);
+
+	auto start = std::chrono::steady_clock::now();
+	scheduler.run(5);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	// The frame rate is lower, but time still follows the clock
+	ASSERT_EQ(scheduler.skippedFrames(), 0);
+	ASSERT_NEAR(runtime.current_time(),
+			std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() - 12 + 1, 4);
+}
+
+TEST_F(SchedulerTest, stop) {
+	DelayOutput output(std::chrono::milliseconds(0));
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::Scheduler scheduler(1000);
+	scheduler.add(runtime);
+
+	std::thread stopper([&scheduler] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			scheduler.stop();
+			});
+	scheduler.run();
+	stopper.join();
+	ASSERT_GT(scheduler.frames(), 0);
+}
+
+TEST_F(SchedulerTest, stop_before_run) {
+	DelayOutput output(std::chrono::milliseconds(0));
+	pixled::Runtime runtime(strip, output, animation);
+	pixled::Scheduler scheduler(1000);
+	scheduler.add(runtime);
+
+	// A stop requested before the loop starts is not lost
+	scheduler.stop();
+	scheduler.run();
+	ASSERT_EQ(scheduler.frames(), 0);
+
+	// The request is consumed
+	scheduler.run(3);
+	ASSERT_EQ(scheduler.frames(), 3);
+	scheduler.stop();
+	scheduler.run(3);
+	ASSERT_EQ(scheduler.frames(), 3);
+}
@@ -0,0 +1,224 @@
+#include "pixled/shared_memory.h"
+#include "pixled/runtime.h"
+#include "pixled/chroma/chroma.h"
+#include "pixled/chrono/chrono.h"
+#include "pixled/geometry/geometry.h"
+#include "pixled/mapping/mapping.h"
+#include "gmock/gmock.h"
+
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace testing;
+using namespace pixled;
+
+class SharedMemoryTest : public Test {
+	protected:
+		std::string name = "/pixled_test_" + std::to_string(getpid());
+		mapping::LedStrip strip {40};
+		chroma::rgb animation {
+			Cast<std::uint8_t>(geometry::X()),
+			Cast<std::uint8_t>(chrono::T()),
+			7
+		};
+
+		void checkFrame(pixled::time t, const std::uint8_t* frame) {
+			for(std::size_t i = 0; i < 40; i++) {
+				ASSERT_EQ(frame[3*i], i);
+				ASSERT_EQ(frame[3*i+1], t);
+				ASSERT_EQ(frame[3*i+2], 7);
+			}
+		}
+};
+
+/*
+ * Output that checks the frames written by a SharedMemoryReader.
+ */
+class ReaderOutput : public Output {
+	public:
+		std::vector<std::uint8_t> frame;
+		std::size_t written_frames = 0;
+		std::size_t ended_frames = 0;
+
+		void write(const color&, std::size_t) override {
+		}
+
+		void writeFrame(const std::uint8_t* frame, std::size_t led_count) override {
+			this->frame.assign(frame, frame + 3*led_count);
+			written_frames++;
+		}
+
+		void endFrame() override {
+			ended_frames++;
+		}
+};
+
+TEST_F(SharedMemoryTest, read) {
+	SharedMemoryOutput output(name.c_str(), 40, 3);
+	ASSERT_TRUE(output.isOpen());
+	SharedMemoryReader reader(name.c_str());
+	ASSERT_TRUE(reader.isOpen());
+	ASSERT_EQ(reader.ledCount(), 40);
+	ASSERT_EQ(reader.pending(), 0);
+
+	std::uint8_t frame[3*40];
+	ASSERT_FALSE(reader.read(frame));
+
+	Runtime runtime(strip, output, animation);
+	for(pixled::time t = 0; t < 5; t++) {
+		runtime.next();
+		ASSERT_EQ(output.frames(), t+1);
+		ASSERT_EQ(reader.pending(), 1);
+		ASSERT_TRUE(reader.read(frame));
+		checkFrame(t, frame);
+		ASSERT_EQ(reader.pending(), 0);
+		ASSERT_FALSE(reader.read(frame));
+	}
+}
+
+TEST_F(SharedMemoryTest, read_output) {
+	SharedMemoryOutput output(name.c_str(), 40);
+	SharedMemoryReader reader(name.c_str());
+	Runtime runtime(strip, output, animation);
+	runtime.next();
+
+	ReaderOutput frame;
+	ASSERT_TRUE(reader.read(frame));
+	ASSERT_EQ(frame.frame.size(), 3*40);
+	checkFrame(0, frame.frame.data());
+	ASSERT_FALSE(reader.read(frame));
+	ASSERT_EQ(frame.written_frames, 1);
+	ASSERT_EQ(frame.ended_frames, 1);
+}
+
+TEST_F(SharedMemoryTest, late_reader) {
+	SharedMemoryOutput output(name.c_str(), 40, 3);
+	SharedMemoryReader reader(name.c_str());
+	Runtime runtime(strip, output, animation);
+	for(int i = 0; i < 10; i++)
+		runtime.next();
+
+	ASSERT_EQ(reader.frames(), 10);
+	ASSERT_EQ(reader.pending(), 10);
+	std::uint8_t frame[3*40];
+	// Only the latest frame is read
+	ASSERT_TRUE(reader.read(frame));
+	checkFrame(9, frame);
+	ASSERT_EQ(reader.pending(), 0);
+}
+
+TEST_F(SharedMemoryTest, wait) {
+	SharedMemoryOutput output(name.c_str(), 40);
+	SharedMemoryReader reader(name.c_str());
+	ASSERT_FALSE(reader.wait(10));
+
+	Runtime runtime(strip, output, animation);
+	std::thread writer([&runtime] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			runtime.next();
+			});
+	ASSERT_TRUE(reader.wait(5000));
+	writer.join();
+	std::uint8_t frame[3*40];
+	ASSERT_TRUE(reader.read(frame));
+	checkFrame(0, frame);
+	ASSERT_FALSE(reader.wait(0));
+}
+
+/*
+ * Frames are never torn, even when the writer laps the reader.
+ */
+TEST_F(SharedMemoryTest, concurrent) {
+	const std::size_t leds = 1000;
+	const int frames = 5000;
+	SharedMemoryOutput output(name.c_str(), leds, 2);
+	SharedMemoryReader reader(name.c_str());
+
+	std::thread writer([&output, leds, frames] {
+			std::vector<std::uint8_t> frame(3*leds);
+			for(int i = 0; i < frames; i++) {
+				std::fill(frame.begin(), frame.end(), (std::uint8_t) i);
+				output.writeFrame(frame.data(), leds);
+				output.endFrame();
+			}
+			});
+	std::vector<std::uint8_t> frame(3*leds);
+	while(reader.frames() < (unsigned long) frames) {
+		if(reader.read(frame.data())) {
+			ASSERT_THAT(frame, Each(frame[0]));
+		}
+	}
+	writer.join();
+	// The writer might have finished before any read
+	if(reader.read(frame.data())) {
+		ASSERT_THAT(frame, Each((std::uint8_t) (frames-1)));
+	}
+	ASSERT_EQ(reader.pending(), 0);
+}
+
+/*
+ * An Output only receives consistent frames, once each.
+ */
+TEST_F(SharedMemoryTest, concurrent_output) {
+	const std::size_t leds = 1000;
+	const int frames = 5000;
+	SharedMemoryOutput output(name.c_str(), leds, 2);
+	SharedMemoryReader reader(name.c_str());
+
+	std::thread writer([&output, leds, frames] {
+			std::vector<std::uint8_t> frame(3*leds);
+			for(int i = 0; i < frames; i++) {
+				std::fill(frame.begin(), frame.end(), (std::uint8_t) i);
+				output.writeFrame(frame.data(), leds);
+				output.endFrame();
+			}
+			});
+	ReaderOutput received;
+	std::size_t reads = 0;
+	while(reader.frames() < (unsigned long) frames) {
+		if(reader.read(received)) {
+			reads++;
+			ASSERT_THAT(received.frame, Each(received.frame[0]));
+		}
+	}
+	writer.join();
+	ASSERT_EQ(received.written_frames, reads);
+	ASSERT_EQ(received.ended_frames, reads);
+}
+
+TEST_F(SharedMemoryTest, other_process) {
+	SharedMemoryOutput output(name.c_str(), 40);
+	Runtime runtime(strip, output, animation);
+
+	pid_t child = fork();
+	ASSERT_GE(child, 0);
+	if(child == 0) {
+		SharedMemoryReader reader(name.c_str());
+		std::uint8_t frame[3*40];
+		bool valid = reader.isOpen() && reader.wait(5000) && reader.read(frame)
+			&& frame[3*10] == 10 && frame[3*10+1] == 0 && frame[3*10+2] == 7;
+		_exit(valid ? 0 : 1);
+	}
+	// Published while or before the child waits
+	runtime.next();
+	int status;
+	ASSERT_EQ(waitpid(child, &status, 0), child);
+	ASSERT_TRUE(WIFEXITED(status));
+	ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST_F(SharedMemoryTest, invalid) {
+	SharedMemoryReader missing(name.c_str());
+	ASSERT_FALSE(missing.isOpen());
+	ASSERT_FALSE(missing.wait(0));
+	std::uint8_t frame[3];
+	ASSERT_FALSE(missing.read(frame));
+
+	// At least 2 slots
+	SharedMemoryOutput output(name.c_str(), 40, 1);
+	ASSERT_FALSE(output.isOpen());
+	// Does nothing
+	output.endFrame();
+}
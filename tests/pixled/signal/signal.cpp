@@ -91,3 +91,53 @@ TEST_F(SignalTest, sawtooth) {
 
 	ASSERT_NEAR(sawtooth(random_led(), 12), 0, .10e-4);
 }
+
+TEST_F(SignalTest, fixed_sine) {
+	pixled::signal::FixedSine sine(Cast<pixled::fixed>(pixled::chrono::T()) / 1000);
+	pixled::signal::FixedSine negative_sine((pixled::fixed(0) - Cast<pixled::fixed>(pixled::chrono::T())) / 1000);
+
+	for(pixled::time t = 0; t < 3000; t++) {
+		// Exact fixed parameter
+		float x = static_cast<float>(pixled::fixed(t) / 1000);
+		ASSERT_NEAR(
+				static_cast<float>(sine(random_led(), t)),
+				std::sin(2*PI*x), 1e-4);
+		ASSERT_NEAR(
+				static_cast<float>(negative_sine(random_led(), t)),
+				-std::sin(2*PI*x), 1e-4);
+	}
+}
+
+TEST_F(SignalTest, phase) {
+	pixled::signal::Sine sine(pixled::chrono::Phase(1000));
+	pixled::signal::FixedSine fixed_sine(pixled::chrono::FixedPhase(1000));
+	ASSERT_EQ(sine.periodicity(), 1000);
+	ASSERT_EQ(fixed_sine.periodicity(), 1000);
+
+	// The phase is exact at any time, what is not the case of T() / period
+	// as a float
+	for(pixled::time t : {0ul, 250ul, 999ul, 4000000250ul, 4000000999ul}) {
+		float x = (t % 1000) / 1000.f;
+		ASSERT_NEAR(sine(random_led(), t), std::sin(2*PI*x), 1e-5);
+		ASSERT_NEAR(
+				static_cast<float>(fixed_sine(random_led(), t)),
+				std::sin(2*PI*x), 1e-4);
+	}
+	ASSERT_FLOAT_EQ(pixled::chrono::Phase(0)(random_led(), 10), 0.f);
+
+	// Signals of the phase change at each time step
+	ASSERT_TRUE(sine.mayChange(random_led(), 0));
+	ASSERT_TRUE(fixed_sine.mayChange(random_led(), 0));
+	ASSERT_FALSE(pixled::chrono::Phase(1).mayChange(random_led(), 0));
+	ASSERT_FALSE(pixled::chrono::FixedPhase(0).mayChange(random_led(), 0));
+}
+
+TEST_F(SignalTest, fixed_triangle) {
+	pixled::signal::FixedTriangle triangle(Cast<pixled::fixed>(pixled::chrono::T()) / 12);
+	pixled::signal::Triangle float_triangle(Cast<float>(pixled::chrono::T()) / 12);
+
+	for(pixled::time t = 0; t < 36; t++)
+		ASSERT_NEAR(
+				static_cast<float>(triangle(random_led(), t)),
+				float_triangle(random_led(), t), 1e-4);
+}
@@ -0,0 +1,49 @@
+#include "pixled/thread_pool.h"
+#include "gmock/gmock.h"
+
+#include <atomic>
+
+using namespace testing;
+
+TEST(ThreadPool, parallel_for) {
+	pixled::ThreadPool pool(4);
+	ASSERT_EQ(pool.threadCount(), 4);
+
+	std::vector<int> values(1000, 0);
+	pool.parallelFor(values.size(), [&values] (std::size_t i) {
+			values[i] = i;
+			});
+	for(std::size_t i = 0; i < values.size(); i++)
+		ASSERT_EQ(values[i], i);
+}
+
+TEST(ThreadPool, nested_parallel_for) {
+	pixled::ThreadPool pool(2);
+	std::atomic<int> count {0};
+	std::atomic<int> done {0};
+	// More nested loops than workers: waiting workers must help
+	for(int i = 0; i < 8; i++) {
+		pool.submit([&pool, &count, &done] {
+				pool.parallelFor(100, [&count] (std::size_t) {
+						count++;
+						});
+				done++;
+				});
+	}
+	while(done < 8)
+		std::this_thread::yield();
+	ASSERT_EQ(count, 800);
+}
+
+TEST(ThreadPool, destructor_waits_for_tasks) {
+	std::atomic<int> count {0};
+	{
+		pixled::ThreadPool pool(3);
+		for(int i = 0; i < 100; i++)
+			pool.submit([&count] {
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+					count++;
+					});
+	}
+	ASSERT_EQ(count, 100);
+}